@@ -0,0 +1,633 @@
+#include "asyncFile.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+// Name:   getBestBackend()
+// Desc:   Find the fastest backend the kernel supports.
+// Param:  None
+// Return: The backend to use when none is chosen.
+IO_BACKENDS AsyncFile::getBestBackend()
+{
+	static const IO_BACKENDS bestBackend = isBackendSupported(IO_BACKENDS::URING) ? IO_BACKENDS::URING : IO_BACKENDS::THREAD_POOL;
+
+	return bestBackend;
+}
+
+// Name:   isBackendSupported(IO_BACKENDS backend)
+// Desc:   Check if a backend can be used. io_uring is probed once for a
+//         ring and for the read and write operations, which older
+//         kernels and some sandboxes do not have.
+// Param:  backend: The backend to check.
+// Return: A boolean: True if the AsyncFile class can use the backend.
+bool AsyncFile::isBackendSupported(IO_BACKENDS backend)
+{
+	static const bool uringSupported = []() {
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+
+		const int ringFile = syscall(__NR_io_uring_setup, 1, &params);
+		if (ringFile < 0)
+			return false;
+
+		const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+		io_uring_probe* probe = (io_uring_probe*)calloc(1, probeSize);
+		const bool probed = probe && syscall(__NR_io_uring_register, ringFile, IORING_REGISTER_PROBE, probe, 256) >= 0
+			&& probe->last_op >= IORING_OP_WRITE
+			&& (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)
+			&& (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED);
+
+		free(probe);
+		::close(ringFile);
+
+		return probed;
+	}();
+
+	switch (backend)
+	{
+		case IO_BACKENDS::THREAD_POOL:
+			return true;
+		case IO_BACKENDS::URING:
+			return uringSupported;
+		default:
+			return false;
+	}
+}
+
+// Name:   getBackendName(IO_BACKENDS backend)
+// Desc:   Retrieve the name of a backend as it is typed on the command line.
+// Param:  backend: The backend to name.
+// Return: A constant string with the name of the backend.
+const char* AsyncFile::getBackendName(IO_BACKENDS backend)
+{
+	switch (backend)
+	{
+		case IO_BACKENDS::STREAMS:
+			return "streams";
+		case IO_BACKENDS::THREAD_POOL:
+			return "threads";
+		case IO_BACKENDS::URING:
+			return "io_uring";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   getBackendFromName(const string& name, IO_BACKENDS& backend)
+// Desc:   Find the backend with a name.
+// Param:  name: The name of the backend.
+//         backend: Receives the backend.
+// Return: A boolean: True if there is a backend with the name.
+bool AsyncFile::getBackendFromName(const std::string& name, IO_BACKENDS& backend)
+{
+	for (int currBackend = 0; currBackend < IO_BACKENDS::NUM_IO_BACKENDS; currBackend++)
+	{
+		if (name == getBackendName((IO_BACKENDS)currBackend))
+		{
+			backend = (IO_BACKENDS)currBackend;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Name:   AsyncFile(IO_BACKENDS backend, unsigned int depth)
+// Desc:   Constructor that allocates the buffers and sets up the ring.
+//         A backend that is not supported falls back to the best one,
+//         and a ring that cannot be set up to the thread pool.
+// Param:  backend: The backend to use.
+//         depth: The number of requests that can be in flight at once.
+// Return: None
+AsyncFile::AsyncFile(IO_BACKENDS backend, unsigned int depth)
+	: backend(backend), requests(std::max(1u, depth)), fileDescriptor(-1), writing(false), fileSize(0), nextOffset(0),
+	current(0), handedOut(SIZE_MAX), ringFile(-1), submitRingMemory(nullptr), submitRingSize(0), completeRingMemory(nullptr),
+	completeRingSize(0), submitEntries(nullptr), submitEntriesSize(0)
+{
+	if (!isBackendSupported(this->backend))
+		this->backend = getBestBackend();
+
+	if (this->backend == IO_BACKENDS::URING && !setupRing(requests.size()))
+		this->backend = IO_BACKENDS::THREAD_POOL;
+
+	for (IoRequest& request : requests)
+	{
+		request.data = (char*)aligned_alloc(alignment, blockSize);
+		request.length = 0;
+		request.offset = 0;
+		request.pending = false;
+		request.completed = false;
+		request.result = 0;
+	}
+}
+
+// Name:   ~AsyncFile()
+// Desc:   Destructor. Waits for the requests in flight, since they still
+//         use the buffers, then closes the file and the ring.
+// Param:  None
+// Return: None
+AsyncFile::~AsyncFile()
+{
+	close();
+	closeRing();
+
+	for (IoRequest& request : requests)
+		free(request.data);
+}
+
+// Name:   openRead(const string& fileName)
+// Desc:   Open a file for reading and queue the reads of its first blocks.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if the file was opened.
+bool AsyncFile::openRead(const std::string& fileName)
+{
+	struct stat fileStat;
+
+	close();
+	error.clear();
+
+	fileDescriptor = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fileDescriptor < 0)
+		return setError("The file could not be opened", errno);
+
+	if (fstat(fileDescriptor, &fileStat) != 0)
+		return setError("The file could not be read", errno);
+
+	posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	writing = false;
+	fileSize = fileStat.st_size;
+	nextOffset = 0;
+	current = 0;
+	handedOut = SIZE_MAX;
+
+	for (IoRequest& request : requests)
+	{
+		if (nextOffset >= fileSize)
+			break;
+
+		request.offset = nextOffset;
+		request.length = std::min<uint64_t>(blockSize, fileSize - nextOffset);
+		nextOffset += request.length;
+
+		if (!submit(request))
+			return false;
+	}
+
+	return true;
+}
+
+// Name:   openWrite(const string& fileName)
+// Desc:   Create or truncate a file for writing.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if the file was opened.
+bool AsyncFile::openWrite(const std::string& fileName)
+{
+	close();
+	error.clear();
+
+	fileDescriptor = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fileDescriptor < 0)
+		return setError("The file could not be created", errno);
+
+	writing = true;
+	fileSize = 0;
+	nextOffset = 0;
+	current = 0;
+
+	for (IoRequest& request : requests)
+		request.length = 0;
+
+	return true;
+}
+
+// Name:   read(const char*& data, size_t& length)
+// Desc:   Retrieve the next block of the file. The buffer of the block
+//         stays valid until the next call, which queues the read of a
+//         later block into it.
+// Param:  data: Receives the bytes of the block.
+//         length: Receives the number of bytes, 0 at the end of the file.
+// Return: A boolean: False if a read failed.
+bool AsyncFile::read(const char*& data, size_t& length)
+{
+	length = 0;
+
+	if (fileDescriptor < 0 || writing)
+		return error.empty();
+
+	// The buffer given out last is free again, and it is the last in line
+	if (handedOut != SIZE_MAX && nextOffset < fileSize)
+	{
+		IoRequest& request = requests[handedOut];
+
+		request.offset = nextOffset;
+		request.length = std::min<uint64_t>(blockSize, fileSize - nextOffset);
+		nextOffset += request.length;
+
+		if (!submit(request))
+			return false;
+	}
+
+	handedOut = SIZE_MAX;
+
+	IoRequest& request = requests[current];
+
+	if (!request.pending)
+		return true;
+
+	if (!finish(request))
+		return false;
+
+	data = request.data;
+	length = request.result;
+	handedOut = current;
+	current = (current + 1) % requests.size();
+
+	return true;
+}
+
+// Name:   write(const char* data, size_t length)
+// Desc:   Add bytes to the end of the file. They are copied into the
+//         current buffer, which is queued once it holds a whole block.
+//         The call only waits when every buffer is in flight.
+// Param:  data: The bytes to write.
+//         length: The number of bytes.
+// Return: A boolean: False if a write failed.
+bool AsyncFile::write(const char* data, size_t length)
+{
+	if (fileDescriptor < 0 || !writing || !error.empty())
+		return false;
+
+	while (length > 0)
+	{
+		IoRequest& request = requests[current];
+
+		if (request.pending)
+		{
+			if (!finish(request))
+				return false;
+
+			request.length = 0;
+		}
+
+		const size_t copied = std::min(length, blockSize - request.length);
+
+		memcpy(request.data + request.length, data, copied);
+		request.length += copied;
+		data += copied;
+		length -= copied;
+
+		if (request.length == blockSize)
+		{
+			request.offset = nextOffset;
+			nextOffset += blockSize;
+
+			if (!submit(request))
+				return false;
+
+			current = (current + 1) % requests.size();
+		}
+	}
+
+	return true;
+}
+
+// Name:   close()
+// Desc:   Queue the last partial block of a file being written, wait for
+//         every request in flight and close the file.
+// Param:  None
+// Return: A boolean: True if every read or write succeeded.
+bool AsyncFile::close()
+{
+	if (fileDescriptor < 0)
+		return error.empty();
+
+	IoRequest& last = requests[current];
+
+	if (writing && error.empty() && !last.pending && last.length > 0)
+	{
+		last.offset = nextOffset;
+		nextOffset += last.length;
+		submit(last);
+	}
+
+	finishAll();
+
+	if (::close(fileDescriptor) != 0)
+		setError("The file could not be closed", errno);
+
+	fileDescriptor = -1;
+
+	for (IoRequest& request : requests)
+		request.length = 0;
+
+	return error.empty();
+}
+
+// Name:   getBackend()
+// Desc:   Retrieve the backend in use, after any fallback.
+// Param:  None
+// Return: The backend.
+IO_BACKENDS AsyncFile::getBackend() const
+{
+	return backend;
+}
+
+// Name:   getError()
+// Desc:   Retrieve why the first failed operation failed.
+// Param:  None
+// Return: A constant reference to the message, empty if nothing failed.
+const std::string& AsyncFile::getError() const
+{
+	return error;
+}
+
+// Name:   getIoPool()
+// Desc:   Retrieve the thread pool of the THREAD_POOL backend, shared by
+//         every file. It has a thread for each request one file can
+//         have in flight.
+// Param:  None
+// Return: A reference to the thread pool.
+ThreadPool& AsyncFile::getIoPool()
+{
+	static ThreadPool ioThreads(defaultDepth);
+
+	return ioThreads;
+}
+
+// Name:   setupRing(unsigned int entries)
+// Desc:   Create an io_uring and map its submission queue, completion
+//         queue and submission entries. Kernels that share one mapping
+//         for both queues only need it mapped once.
+// Param:  entries: The number of submission entries.
+// Return: A boolean: True if the ring is ready.
+bool AsyncFile::setupRing(unsigned int entries)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	ringFile = syscall(__NR_io_uring_setup, entries, &params);
+	if (ringFile < 0)
+		return false;
+
+	submitRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	completeRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		submitRingSize = completeRingSize = std::max(submitRingSize, completeRingSize);
+
+	submitRingMemory = mmap(nullptr, submitRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQ_RING);
+	if (submitRingMemory == MAP_FAILED)
+	{
+		submitRingMemory = nullptr;
+		closeRing();
+		return false;
+	}
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		completeRingMemory = submitRingMemory;
+	else
+	{
+		completeRingMemory = mmap(nullptr, completeRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_CQ_RING);
+		if (completeRingMemory == MAP_FAILED)
+		{
+			completeRingMemory = nullptr;
+			closeRing();
+			return false;
+		}
+	}
+
+	submitEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	submitEntries = (io_uring_sqe*)mmap(nullptr, submitEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQES);
+	if (submitEntries == MAP_FAILED)
+	{
+		submitEntries = nullptr;
+		closeRing();
+		return false;
+	}
+
+	char* submitRing = (char*)submitRingMemory;
+	char* completeRing = (char*)completeRingMemory;
+
+	submitHead = (unsigned int*)(submitRing + params.sq_off.head);
+	submitTail = (unsigned int*)(submitRing + params.sq_off.tail);
+	submitMask = (unsigned int*)(submitRing + params.sq_off.ring_mask);
+	submitArray = (unsigned int*)(submitRing + params.sq_off.array);
+	completeHead = (unsigned int*)(completeRing + params.cq_off.head);
+	completeTail = (unsigned int*)(completeRing + params.cq_off.tail);
+	completeMask = (unsigned int*)(completeRing + params.cq_off.ring_mask);
+	completeEntries = (io_uring_cqe*)(completeRing + params.cq_off.cqes);
+
+	return true;
+}
+
+// Name:   closeRing()
+// Desc:   Unmap the queues of the ring and close it.
+// Param:  None
+// Return: None
+void AsyncFile::closeRing()
+{
+	if (submitEntries)
+		munmap(submitEntries, submitEntriesSize);
+	if (completeRingMemory && completeRingMemory != submitRingMemory)
+		munmap(completeRingMemory, completeRingSize);
+	if (submitRingMemory)
+		munmap(submitRingMemory, submitRingSize);
+	if (ringFile >= 0)
+		::close(ringFile);
+
+	submitEntries = nullptr;
+	completeRingMemory = nullptr;
+	submitRingMemory = nullptr;
+	ringFile = -1;
+}
+
+// Name:   submit(IoRequest& request)
+// Desc:   Start the read or write of a request on the backend.
+// Param:  request: The request with its buffer, length and offset set.
+// Return: A boolean: False if the request could not be started.
+bool AsyncFile::submit(IoRequest& request)
+{
+	request.pending = true;
+	request.completed = false;
+
+	if (backend == IO_BACKENDS::URING)
+		return submitRing(request);
+
+	const int file = fileDescriptor;
+	char* const data = request.data;
+	const size_t length = request.length;
+	const off_t offset = request.offset;
+	const bool isWrite = writing;
+
+	request.job = getIoPool().submit([file, data, length, offset, isWrite]() -> ssize_t {
+		const ssize_t result = isWrite ? pwrite(file, data, length, offset) : pread(file, data, length, offset);
+
+		return result < 0 ? -errno : result;
+	});
+
+	return true;
+}
+
+// Name:   submitRing(IoRequest& request)
+// Desc:   Put a request in the submission queue of the ring and tell the
+//         kernel about it. The index of the request is its user data, so
+//         the completion can be matched to it.
+// Param:  request: The request to start.
+// Return: A boolean: False if the kernel refused the request.
+bool AsyncFile::submitRing(IoRequest& request)
+{
+	const unsigned int tail = *submitTail;
+	const unsigned int index = tail & *submitMask;
+	io_uring_sqe& entry = submitEntries[index];
+
+	memset(&entry, 0, sizeof(entry));
+	entry.opcode = writing ? IORING_OP_WRITE : IORING_OP_READ;
+	entry.fd = fileDescriptor;
+	entry.addr = (uint64_t)request.data;
+	entry.len = request.length;
+	entry.off = request.offset;
+	entry.user_data = &request - requests.data();
+	submitArray[index] = index;
+
+	// The entry has to be visible to the kernel before the new tail
+	__atomic_store_n(submitTail, tail + 1, __ATOMIC_RELEASE);
+
+	int result;
+	do
+		result = syscall(__NR_io_uring_enter, ringFile, 1, 0, 0, nullptr, 0);
+	while (result < 0 && errno == EINTR);
+
+	if (result < 0)
+	{
+		request.pending = false;
+		return setError("The request could not be queued", errno);
+	}
+
+	return true;
+}
+
+// Name:   reapRing(bool wait)
+// Desc:   Take one completion off the ring and store its result in the
+//         request it belongs to.
+// Param:  wait: A boolean to wait for a completion if there is none yet.
+// Return: A boolean: True if a completion was taken.
+bool AsyncFile::reapRing(bool wait)
+{
+	const unsigned int head = *completeHead;
+
+	while (head == __atomic_load_n(completeTail, __ATOMIC_ACQUIRE))
+	{
+		if (!wait)
+			return false;
+
+		if (syscall(__NR_io_uring_enter, ringFile, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+			return setError("The completions could not be read", errno);
+	}
+
+	const io_uring_cqe& entry = completeEntries[head & *completeMask];
+	IoRequest& request = requests[entry.user_data];
+
+	request.result = entry.res;
+	request.completed = true;
+
+	// The kernel can reuse the entry once the head has moved past it
+	__atomic_store_n(completeHead, head + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+// Name:   finish(IoRequest& request)
+// Desc:   Wait for a request to complete. A read that stops short of its
+//         length before the end of the file, or a short write, is
+//         finished with blocking calls.
+// Param:  request: The request to wait for.
+// Return: A boolean: False if the request failed.
+bool AsyncFile::finish(IoRequest& request)
+{
+	if (!request.pending)
+		return true;
+
+	// Waiting on the ring can complete other requests first, they keep their result until they are finished
+	if (backend == IO_BACKENDS::URING)
+	{
+		while (!request.completed)
+		{
+			if (!reapRing(true))
+			{
+				request.pending = false;
+				return false;
+			}
+		}
+	}
+	else
+		request.result = request.job.get();
+
+	request.pending = false;
+
+	if (request.result < 0)
+		return setError(writing ? "The file could not be written" : "The file could not be read", -request.result);
+
+	while ((size_t)request.result < request.length)
+	{
+		const size_t done = request.result;
+		const ssize_t result = writing
+			? pwrite(fileDescriptor, request.data + done, request.length - done, request.offset + done)
+			: pread(fileDescriptor, request.data + done, request.length - done, request.offset + done);
+
+		if (result < 0 && errno == EINTR)
+			continue;
+		if (result < 0)
+			return setError(writing ? "The file could not be written" : "The file could not be read", errno);
+
+		// The file got shorter since it was opened
+		if (result == 0)
+		{
+			if (writing)
+				return setError("The file could not be written", EIO);
+			break;
+		}
+
+		request.result += result;
+	}
+
+	return true;
+}
+
+// Name:   finishAll()
+// Desc:   Wait for every request in flight, even after one has failed.
+// Param:  None
+// Return: A boolean: False if any request failed.
+bool AsyncFile::finishAll()
+{
+	bool finished = true;
+
+	for (IoRequest& request : requests)
+	{
+		if (!finish(request))
+			finished = false;
+	}
+
+	return finished;
+}
+
+// Name:   setError(const string& message, int errorNumber)
+// Desc:   Keep the first error of the file.
+// Param:  message: What failed.
+//         errorNumber: The errno value of the failure.
+// Return: A boolean: Always false, so failures can return it.
+bool AsyncFile::setError(const std::string& message, int errorNumber)
+{
+	if (error.empty())
+		error = message + ": " + strerror(errorNumber) + ".";
+
+	return false;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <future>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+
+/*****************************************************************************
+# Description: An enum of the ways task files can be read and written.
+               STREAMS is the blocking iostream path of the task manager,
+			   THREAD_POOL and URING are the backends of the AsyncFile
+			   class.
+			   The AsyncFile class reads or writes one file in large
+			   blocks with several requests in flight, so the caller can
+			   parse one block while the next ones are read, or format
+			   the next block while the last ones are written. The
+			   buffers are aligned and every request starts at a
+			   multiple of the block size. The URING backend queues the
+			   requests on an io_uring set up with the raw system calls,
+			   the THREAD_POOL backend runs pread and pwrite on a shared
+			   thread pool and is used when io_uring is not available.
+#****************************************************************************/
+
+enum IO_BACKENDS { STREAMS, THREAD_POOL, URING, NUM_IO_BACKENDS };
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+class ThreadPool;
+
+class AsyncFile
+{
+public:
+	static const size_t blockSize = 1 << 20;
+	static const size_t alignment = 4096;
+	static const unsigned int defaultDepth = 4;
+
+	static IO_BACKENDS getBestBackend();
+	static bool isBackendSupported(IO_BACKENDS backend);
+	static const char* getBackendName(IO_BACKENDS backend);
+	static bool getBackendFromName(const std::string& name, IO_BACKENDS& backend);
+
+	AsyncFile(IO_BACKENDS backend = getBestBackend(), unsigned int depth = defaultDepth);
+	~AsyncFile();
+
+	AsyncFile(const AsyncFile&) = delete;
+	AsyncFile& operator=(const AsyncFile&) = delete;
+
+	bool openRead(const std::string& fileName);
+	bool openWrite(const std::string& fileName);
+	bool read(const char*& data, size_t& length);
+	bool write(const char* data, size_t length);
+	bool close();
+
+	IO_BACKENDS getBackend() const;
+	const std::string& getError() const;
+
+private:
+	struct IoRequest
+	{
+		char* data;
+		size_t length;
+		uint64_t offset;
+		bool pending;
+		bool completed;
+		ssize_t result;
+		std::future<ssize_t> job;
+	};
+
+	static ThreadPool& getIoPool();
+
+	bool setupRing(unsigned int entries);
+	void closeRing();
+	bool submit(IoRequest& request);
+	bool submitRing(IoRequest& request);
+	bool reapRing(bool wait);
+	bool finish(IoRequest& request);
+	bool finishAll();
+	bool setError(const std::string& message, int errorNumber);
+
+	IO_BACKENDS backend;
+	std::vector<IoRequest> requests;
+	std::string error;
+	int fileDescriptor;
+	bool writing;
+	uint64_t fileSize;
+	uint64_t nextOffset;
+	size_t current;
+	size_t handedOut;
+
+	// The io_uring and its shared rings
+	int ringFile;
+	void* submitRingMemory;
+	size_t submitRingSize;
+	void* completeRingMemory;
+	size_t completeRingSize;
+	io_uring_sqe* submitEntries;
+	size_t submitEntriesSize;
+	unsigned int* submitHead;
+	unsigned int* submitTail;
+	unsigned int* submitMask;
+	unsigned int* submitArray;
+	unsigned int* completeHead;
+	unsigned int* completeTail;
+	unsigned int* completeMask;
+	io_uring_cqe* completeEntries;
+};
@@ -0,0 +1,1734 @@
+#include "benchmarks.h"
+#include "taskManager.h"
+#include "taskArchive.h"
+#include "taskServer.h"
+#include "taskClient.h"
+#include "taskFilter.h"
+#include "undoLog.h"
+#include "taskExporter.h"
+#include "taskTags.h"
+#include "segmentStore.h"
+#include "crc32c.h"
+#include "parallelSort.h"
+#include "asyncFile.h"
+#include "recurrence.h"
+#include "sharedStore.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+#include <thread>
+#include <algorithm>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <malloc.h>
+
+// Name:   run(const string& name, const vector<string>& args)
+// Desc:   Run a benchmark by name.
+// Param:  name: The name of the benchmark.
+//         args: The arguments that follow the name.
+// Return: An integer exit code: 0 if the benchmark ran, 1 otherwise.
+int Benchmarks::run(const std::string& name, const std::vector<std::string>& args)
+{
+	if (name == "codec")
+		return benchCodec(args);
+	if (name == "dedup")
+		return benchDedup(args);
+	if (name == "daemon")
+		return benchDaemon(args);
+	if (name == "filter")
+		return benchFilter(args);
+	if (name == "columns")
+		return benchColumns(args);
+	if (name == "undo")
+		return benchUndo(args);
+	if (name == "export")
+		return benchExport(args);
+	if (name == "tags")
+		return benchTags(args);
+	if (name == "memory")
+		return benchMemory(args);
+	if (name == "segments")
+		return benchSegments(args);
+	if (name == "checksum")
+		return benchChecksum(args);
+	if (name == "sort")
+		return benchSort(args);
+	if (name == "io")
+		return benchIo(args);
+	if (name == "reminders")
+		return benchReminders(args);
+	if (name == "graph")
+		return benchGraph(args);
+	if (name == "shared")
+		return benchShared(args);
+
+	std::cout << "Unknown benchmark: " << name << std::endl;
+	listBenchmarks();
+
+	return 1;
+}
+
+// Name:   listBenchmarks()
+// Desc:   Display the available benchmarks.
+// Param:  None
+// Return: None
+void Benchmarks::listBenchmarks()
+{
+	std::cout << "Benchmarks:" << std::endl;
+	std::cout << "    codec [tasks]    Compressed file size, load time and decode speed" << std::endl;
+	std::cout << "    dedup [rows]     Duplicate detection on an import with 10% duplicates" << std::endl;
+	std::cout << "    daemon [clients] [requests] [tasks]" << std::endl;
+	std::cout << "                     Daemon requests/sec and latency against one load, edit and save" << std::endl;
+	std::cout << "    filter [tasks]   Compiled filters with index pruning against a tree interpreter" << std::endl;
+	std::cout << "    columns [tasks]  Due date range counts per scan kernel in tasks/ns" << std::endl;
+	std::cout << "    undo [tasks] [edits]" << std::endl;
+	std::cout << "                     Undo and redo time per step against copying the list" << std::endl;
+	std::cout << "    export [tasks]   CSV and JSON lines export speed per thread count against saving" << std::endl;
+	std::cout << "    tags [tasks]     Priority and tag queries through the postings against a list scan" << std::endl;
+	std::cout << "    memory [tasks]   Bytes per task of the records, names and indexes against the heap" << std::endl;
+	std::cout << "    segments [tasks] Segmented store saves, range loads and compaction against a text file" << std::endl;
+	std::cout << "    checksum [tasks] CRC-32C speed per kernel and recovery from a damaged and a torn file" << std::endl;
+	std::cout << "    sort [tasks]     Parallel view sorts and filter scans per thread count against std::sort" << std::endl;
+	std::cout << "    io [tasks]       Text saves and loads per I/O backend with a warm and a cold page cache" << std::endl;
+	std::cout << "    reminders [tasks]" << std::endl;
+	std::cout << "                     Reminder timer upkeep per edit and a fast forward against a daily scan" << std::endl;
+	std::cout << "    graph [tasks]    Dependency inserts, unblocking and actionable queries against a list scan" << std::endl;
+	std::cout << "    shared [tasks]   Shared list joins, edits and syncs between two stores against a reload" << std::endl;
+}
+
+// Name:   fillTasks(TaskManager& manager, int numTasks, unsigned int seed)
+// Desc:   Fill a task manager with a repeatable synthetic task list. Names
+//         come from a small pool with a few very common names, due dates
+//         drift forward through the list and about 40% are completed.
+// Param:  manager: The task manager to fill.
+//         numTasks: The number of tasks to add.
+//         seed: The seed for the random number generator.
+// Return: None
+void Benchmarks::fillTasks(TaskManager& manager, int numTasks, unsigned int seed)
+{
+	static const char* words[] = { "Report", "Review", "Deploy", "Backup", "Invoice", "Sync", "Audit", "Meeting", "Cleanup", "Release" };
+	static const char* teams[] = { "ops", "web", "data", "infra", "sales" };
+	const int numWords = sizeof(words) / sizeof(words[0]);
+	const int numTeams = sizeof(teams) / sizeof(teams[0]);
+	const int startSerial = Date(1, 1, 2024).getSerial();
+
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	std::uniform_int_distribution<int> noise(-15, 15);
+	std::vector<std::string> names;
+
+	for (int i = 0; i < 500; i++)
+		names.push_back(std::string(words[i % numWords]) + " " + teams[(i / numWords) % numTeams] + " " + std::to_string(i / (numWords * numTeams)));
+
+	manager.emptyTasks();
+
+	for (int i = 0; i < numTasks; i++)
+	{
+		const double skew = unit(random);
+		const std::string& name = names[(size_t)(names.size() * skew * skew * skew)];
+		const int serial = startSerial + (int)((long long)i * 730 / numTasks) + noise(random);
+
+		if (unit(random) < 0.01)
+			manager.addTask(name, Date::fromSerial(serial), Recurrence(FREQUENCIES::WEEKLY, 1, Date::fromSerial(serial + 365)));
+		else
+			manager.addTask(name, Date::fromSerial(serial));
+	}
+
+	// Complete tasks through the list so the flags are spread out
+	std::bernoulli_distribution completed(0.4);
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		if (completed(random))
+			manager.completeTask(currNode);
+	}
+}
+
+// Name:   getSeconds(Clock::time_point start)
+// Desc:   Retrieve the time since a point in time.
+// Param:  start: The point in time to measure from.
+// Return: The number of seconds since start.
+double Benchmarks::getSeconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Name:   getTempFile(const string& name)
+// Desc:   Build a path in the temporary directory for benchmark files.
+// Param:  name: The file name to use.
+// Return: A string that holds the full path.
+std::string Benchmarks::getTempFile(const std::string& name)
+{
+	return (std::filesystem::temp_directory_path() / ("stm_bench_" + name)).string();
+}
+
+// Name:   getCount(const vector<string>& args, size_t argNum, int defaultCount)
+// Desc:   Read a positive count from the benchmark arguments.
+// Param:  args: The benchmark arguments.
+//         argNum: The position of the count in the arguments.
+//         defaultCount: The count to use if the argument is missing or invalid.
+// Return: The count to use.
+int Benchmarks::getCount(const std::vector<std::string>& args, size_t argNum, int defaultCount)
+{
+	if (argNum >= args.size())
+		return defaultCount;
+
+	int count = atoi(args[argNum].c_str());
+
+	return count > 0 ? count : defaultCount;
+}
+
+// Name:   getPercentile(vector<double>& values, double percentile)
+// Desc:   Find a percentile of a list of measurements.
+// Param:  values: The measurements, reordered by the search.
+//         percentile: The percentile to find, from 0 to 100.
+// Return: The measurement at the percentile, 0 if there are none.
+double Benchmarks::getPercentile(std::vector<double>& values, double percentile)
+{
+	if (values.empty())
+		return 0;
+
+	size_t position = std::min(values.size() - 1, (size_t)(values.size() * percentile / 100));
+	std::nth_element(values.begin(), values.begin() + position, values.end());
+
+	return values[position];
+}
+
+// Name:   getHeapBytes()
+// Desc:   Retrieve the bytes allocated from the heap, including the
+//         allocator's own headers and the blocks it maps directly.
+// Param:  None
+// Return: The number of bytes in use.
+size_t Benchmarks::getHeapBytes()
+{
+	const struct mallinfo2 info = mallinfo2();
+
+	return info.uordblks + info.hblkhd;
+}
+
+// Name:   dropCachedPages(const string& fileName)
+// Desc:   Write a file back to disk and ask the kernel to drop its pages
+//         from the page cache, so the next read comes from the disk.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if the kernel took the advice.
+bool Benchmarks::dropCachedPages(const std::string& fileName)
+{
+	const int file = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (file < 0)
+		return false;
+
+	const bool dropped = fdatasync(file) == 0 && posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(file);
+
+	return dropped;
+}
+
+// Name:   benchCodec(const vector<string>& args)
+// Desc:   Compare the text and compressed file formats: file size, time
+//         to load into a task manager and raw block decode speed.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 on failure.
+int Benchmarks::benchCodec(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const std::string textFile = getTempFile("codec.txt");
+	const std::string archiveFile = getTempFile(std::string("codec") + TaskArchive::fileExtension);
+	TaskManager manager;
+
+	fillTasks(manager, numTasks);
+
+	if (!manager.saveToFile(textFile) || !manager.saveToFile(archiveFile))
+	{
+		std::cout << "Could not write the benchmark files." << std::endl;
+		return 1;
+	}
+
+	const double textSize = (double)std::filesystem::file_size(textFile);
+	const double archiveSize = (double)std::filesystem::file_size(archiveFile);
+
+	// Load into empty managers so freeing the old list is not measured
+	manager.emptyTasks();
+	TaskManager textManager;
+	Clock::time_point start = Clock::now();
+	textManager.loadFromFile(textFile);
+	const double textLoad = getSeconds(start);
+
+	TaskManager archiveManager;
+	start = Clock::now();
+	archiveManager.loadFromFile(archiveFile);
+	const double archiveLoad = getSeconds(start);
+
+	TaskArchive archive;
+	std::vector<ArchiveRecord> records;
+	const int repeats = 5;
+
+	archive.open(archiveFile);
+	start = Clock::now();
+
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		for (uint32_t blockNum = 0; blockNum < archive.getNumBlocks(); blockNum++)
+			archive.decodeBlock(blockNum, records);
+	}
+
+	const double decode = getSeconds(start) / repeats;
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Tasks:             " << numTasks << std::endl;
+	std::cout << "Text file:         " << textSize / 1e6 << " MB" << std::endl;
+	std::cout << "Compressed file:   " << archiveSize / 1e6 << " MB (" << archive.getNumBlocks() << " blocks)" << std::endl;
+	std::cout << "Compression ratio: " << textSize / archiveSize << "x" << std::endl;
+	std::cout << "Text load:         " << textLoad << " s" << std::endl;
+	std::cout << "Compressed load:   " << archiveLoad << " s" << std::endl;
+	std::cout << "Block decode:      " << decode * 1e3 << " ms, " << archiveSize / decode / 1e9 << " GB/s compressed, "
+		<< textSize / decode / 1e9 << " GB/s text equivalent" << std::endl;
+
+	std::filesystem::remove(textFile);
+	std::filesystem::remove(archiveFile);
+
+	return 0;
+}
+
+// Name:   benchDedup(const vector<string>& args)
+// Desc:   Import a text file where 10% of the rows repeat an earlier row
+//         (with different case and spacing) and compare the time against
+//         a load without duplicate detection.
+// Param:  args: The number of rows to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 on failure.
+int Benchmarks::benchDedup(const std::vector<std::string>& args)
+{
+	const int numRows = getCount(args, 0, 1000000);
+	const std::string importFile = getTempFile("dedup.txt");
+	const int startSerial = Date(1, 1, 2024).getSerial();
+	std::vector<std::pair<std::string, int>> rows;
+	std::mt19937 random(7);
+	std::ofstream file(importFile);
+
+	if (!file.is_open())
+	{
+		std::cout << "Could not write the benchmark file." << std::endl;
+		return 1;
+	}
+
+	for (int i = 0; i < numRows; i++)
+	{
+		std::pair<std::string, int> row;
+
+		if (i > 0 && random() % 10 == 0)
+		{
+			row = rows[random() % rows.size()];
+			for (char& nameChar : row.first)
+				nameChar = toupper((unsigned char)nameChar);
+			row.first = " " + row.first + "  ";
+		}
+		else
+		{
+			row = { "Item " + std::to_string(i) + " " + std::to_string(random() % 1000), startSerial + (int)(random() % 730) };
+			rows.push_back(row);
+		}
+
+		const Date dueDate = Date::fromSerial(row.second);
+		file << row.first << "," << dueDate.getMonth() << "," << dueDate.getDay() << "," << dueDate.getYear() << "," << (random() % 2);
+
+		if (i + 1 < numRows)
+			file << "\n";
+	}
+
+	file.close();
+	rows.clear();
+
+	TaskManager plainManager;
+	Clock::time_point start = Clock::now();
+	plainManager.loadFromFile(importFile);
+	const double plainLoad = getSeconds(start);
+
+	DedupEngine indexOnly(DEDUP_POLICIES::KEEP_ALL);
+	start = Clock::now();
+	indexOnly.indexTasks(plainManager);
+	const double indexTime = getSeconds(start);
+	plainManager.emptyTasks();
+
+	TaskManager dedupManager;
+	DedupEngine dedup(DEDUP_POLICIES::SKIP_DUPLICATES);
+	start = Clock::now();
+	dedupManager.importFromFile(importFile, dedup);
+	const double dedupLoad = getSeconds(start);
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Rows:                " << numRows << std::endl;
+	std::cout << "Duplicates found:    " << dedup.getReport().numDuplicates << " (" << dedupManager.getNumTasks() << " tasks kept)" << std::endl;
+	std::cout << "Load without dedup:  " << plainLoad << " s" << std::endl;
+	std::cout << "Import with skip:    " << dedupLoad << " s" << std::endl;
+	std::cout << "Hash table only:     " << indexTime << " s, " << numRows / indexTime / 1e6 << " M rows/s" << std::endl;
+	std::cout << "Hash table memory:   " << dedup.getMemoryUsage() / 1e6 << " MB, "
+		<< (double)dedup.getMemoryUsage() / numRows << " bytes per row" << std::endl;
+
+	std::filesystem::remove(importFile);
+
+	return 0;
+}
+
+// Name:   benchDaemon(const vector<string>& args)
+// Desc:   Run a daemon on a temporary socket and have several clients send
+//         it a mix of requests (60% queries, 20% adds, 10% completes, 10%
+//         next due), then compare the latency against a script that loads
+//         the file, makes one edit and saves it.
+// Param:  args: The number of clients (default 8), the total number of
+//               requests (default 100000) and the number of tasks in the
+//               file (default 100000).
+// Return: An integer exit code: 0 on success, 1 on failure.
+int Benchmarks::benchDaemon(const std::vector<std::string>& args)
+{
+	const int numClients = getCount(args, 0, 8);
+	const int numRequests = getCount(args, 1, 100000);
+	const int numTasks = getCount(args, 2, 100000);
+	const std::string taskFile = getTempFile("daemon.txt");
+	const std::string socketPath = getTempFile("daemon.sock");
+	TaskManager manager;
+
+	fillTasks(manager, numTasks);
+
+	if (!manager.saveToFile(taskFile))
+	{
+		std::cout << "Could not write the benchmark file." << std::endl;
+		return 1;
+	}
+
+	// What each request costs without the daemon
+	Clock::time_point start = Clock::now();
+	manager.loadFromFile(taskFile);
+	manager.addTask("Script task", Date(1, 1, 2025));
+	manager.saveToFile(taskFile);
+	const double scriptTime = getSeconds(start);
+
+	manager.emptyTasks();
+	TaskServer server;
+
+	if (!server.start(socketPath, taskFile))
+	{
+		std::cout << "Could not start the daemon." << std::endl;
+		return 1;
+	}
+
+	std::thread serverThread(&TaskServer::run, &server);
+	std::vector<std::vector<double>> latencies(numClients);
+	std::vector<std::thread> clients;
+	std::vector<bool> failed(numClients, false);
+
+	start = Clock::now();
+
+	for (int clientNum = 0; clientNum < numClients; clientNum++)
+	{
+		clients.emplace_back([&, clientNum]() {
+			const int clientRequests = numRequests / numClients + (clientNum < numRequests % numClients ? 1 : 0);
+			std::vector<double>& clientLatencies = latencies[clientNum];
+			std::vector<std::string> response;
+			std::mt19937 random(clientNum + 1);
+			std::string lastId = "0";
+			TaskClient client;
+
+			if (!client.connectTo(socketPath))
+			{
+				failed[clientNum] = true;
+				return;
+			}
+
+			clientLatencies.reserve(clientRequests);
+
+			for (int i = 0; i < clientRequests; i++)
+			{
+				const unsigned int kind = random() % 10;
+				std::string request;
+
+				if (kind < 6)
+					request = "QUERY\t" + std::to_string(1 + random() % 3) + "\t20";
+				else if (kind < 8)
+					request = "ADD\tClient " + std::to_string(clientNum) + " task " + std::to_string(i) + "\t6/15/2025";
+				else if (kind < 9)
+					request = "COMPLETE\t" + lastId;
+				else
+					request = "NEXT\t10";
+
+				Clock::time_point sent = Clock::now();
+
+				if (!client.request(request, response))
+				{
+					failed[clientNum] = true;
+					return;
+				}
+
+				clientLatencies.push_back(getSeconds(sent));
+
+				if (kind >= 6 && kind < 8 && response[0].size() > 3)
+					lastId = response[0].substr(3);
+			}
+		});
+	}
+
+	for (std::thread& client : clients)
+		client.join();
+
+	const double totalTime = getSeconds(start);
+
+	server.stop();
+	serverThread.join();
+
+	std::vector<double> allLatencies;
+	for (const std::vector<double>& clientLatencies : latencies)
+		allLatencies.insert(allLatencies.end(), clientLatencies.begin(), clientLatencies.end());
+
+	std::filesystem::remove(taskFile);
+
+	if (std::find(failed.begin(), failed.end(), true) != failed.end())
+	{
+		std::cout << "A client lost its connection to the daemon." << std::endl;
+		return 1;
+	}
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Tasks:               " << numTasks << std::endl;
+	std::cout << "Clients:             " << numClients << std::endl;
+	std::cout << "Requests:            " << allLatencies.size() << " in " << totalTime << " s" << std::endl;
+	std::cout << "Requests/sec:        " << std::setprecision(0) << allLatencies.size() / totalTime << std::setprecision(3) << std::endl;
+	std::cout << "Latency p50:         " << getPercentile(allLatencies, 50) * 1e6 << " us" << std::endl;
+	std::cout << "Latency p99:         " << getPercentile(allLatencies, 99) * 1e6 << " us" << std::endl;
+	std::cout << "Latency p99.9:       " << getPercentile(allLatencies, 99.9) * 1e6 << " us" << std::endl;
+	std::cout << "Latency max:         " << getPercentile(allLatencies, 100) * 1e6 << " us" << std::endl;
+	std::cout << "Load, edit and save: " << scriptTime * 1e3 << " ms per edit without the daemon" << std::endl;
+
+	return 0;
+}
+
+// Name:   benchFilter(const vector<string>& args)
+// Desc:   Run a set of filters three ways: the tree interpreter over every
+//         task, the compiled program over every task and the compiled
+//         program over the part of the views the filter allows.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the results differ.
+int Benchmarks::benchFilter(const std::vector<std::string>& args)
+{
+	static const char* expressions[] = {
+		"!completed && due < 3/1/2024 && name ~ \"report\"",
+		"!completed",
+		"completed && name ~ \"ops\"",
+		"due >= 6/1/2025 && due <= 6/30/2025",
+		"name ~ \"audit\" || recurring",
+		"!(completed || name == \"Review web 0\") && due > 1/1/2025"
+	};
+	const int numTasks = getCount(args, 0, 1000000);
+	const int repeats = 5;
+	TaskManager manager;
+	bool failed = false;
+
+	fillTasks(manager, numTasks);
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", M tasks/s over the whole list (ms per run)" << std::endl;
+
+	for (const char* expression : expressions)
+	{
+		TaskFilter filter;
+		size_t treeCount = 0;
+		size_t programCount = 0;
+		size_t indexCount = 0;
+
+		filter.compile(expression);
+
+		Clock::time_point start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			treeCount = 0;
+			for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+				treeCount += filter.matchesTree(currNode->task);
+		}
+		const double treeTime = getSeconds(start) / repeats;
+
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			programCount = 0;
+			for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+				programCount += filter.matches(currNode->task);
+		}
+		const double programTime = getSeconds(start) / repeats;
+
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+			indexCount = filter.apply(manager, VIEWS::INSERTION_ORDER).size();
+		const double indexTime = getSeconds(start) / repeats;
+
+		failed = failed || treeCount != programCount || treeCount != indexCount;
+
+		std::cout << std::endl << expression << std::endl;
+		std::cout << "    Matches:        " << treeCount << (treeCount != programCount || treeCount != indexCount ? " (results differ!)" : "") << std::endl;
+		std::cout << "    Tree:           " << numTasks / treeTime / 1e6 << " (" << treeTime * 1e3 << ")" << std::endl;
+		std::cout << "    Program:        " << numTasks / programTime / 1e6 << " (" << programTime * 1e3 << ")" << std::endl;
+		std::cout << "    Program+index:  " << numTasks / indexTime / 1e6 << " (" << indexTime * 1e3 << "), " << filter.getScanName(manager) << std::endl;
+	}
+
+	return failed ? 1 : 0;
+}
+
+// Name:   benchColumns(const vector<string>& args)
+// Desc:   Count the incomplete tasks due in a set of date ranges with
+//         every scan kernel the processor supports, check the counts and
+//         match lists against a plain loop over the task list and report
+//         the speed for one range per scan and for all ranges in one scan.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the results differ.
+int Benchmarks::benchColumns(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int repeats = 20;
+	TaskManager manager;
+	DueColumns columns;
+	bool failed = false;
+
+	fillTasks(manager, numTasks);
+
+	// Remove every tenth task so the scans have to skip free slots
+	std::vector<const Node*> removed;
+	int taskNum = 0;
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		if (++taskNum % 10 == 0)
+			removed.push_back(currNode);
+	}
+	for (const Node* node : removed)
+		manager.deleteTask(node);
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		columns.append(currNode->task.getDueSerial(), currNode->task.getCompleted());
+
+	const int start2024 = Date(1, 1, 2024).getSerial();
+	const int middle = Date(6, 15, 2025).getSerial();
+	std::vector<DueRange> ranges = { { INT_MIN, middle - 1 }, { middle, middle + 6 }, { middle, middle + 30 },
+		{ start2024, start2024 + 365 }, { INT_MIN, INT_MAX }, { middle + 1000, INT_MAX } };
+	for (int month = 1; ranges.size() < DueColumns::maxRanges; month++)
+		ranges.push_back({ Date(month, 1, 2025).getSerial(), Date(month, Date::getDaysInMonth(month, 2025), 2025).getSerial() });
+
+	// The reference is a plain loop over the task list
+	std::vector<uint64_t> expected(ranges.size(), 0);
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		const int serial = currNode->task.getDueSerial();
+		for (size_t range = 0; range < ranges.size(); range++)
+			expected[range] += !currNode->task.getCompleted() && serial >= ranges[range].firstSerial && serial <= ranges[range].lastSerial;
+	}
+
+	if (manager.countDue(ranges, true) != expected)
+	{
+		std::cout << "TaskManager::countDue counts differ from the reference" << std::endl;
+		failed = true;
+	}
+	for (const DueRange& range : ranges)
+	{
+		std::vector<const Node*> tasks = manager.getTasksDueIn(range, true);
+		bool matched = true;
+
+		for (size_t task = 0; task < tasks.size() && matched; task++)
+		{
+			const int serial = tasks[task]->task.getDueSerial();
+			matched = !tasks[task]->task.getCompleted() && serial >= range.firstSerial && serial <= range.lastSerial
+				&& (task == 0 || tasks[task - 1]->sequence < tasks[task]->sequence);
+		}
+		if (!matched || tasks.size() != expected[&range - &ranges[0]])
+		{
+			std::cout << "TaskManager::getTasksDueIn tasks differ from the reference" << std::endl;
+			failed = true;
+		}
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Tasks: " << manager.getNumTasks() << " in " << columns.getNumSlots() << " slots, " << ranges.size()
+		<< " ranges, tasks/ns (ms per scan)" << std::endl;
+
+	for (int kernel = 0; kernel < DUE_KERNELS::NUM_KERNELS; kernel++)
+	{
+		if (!DueColumns::isKernelSupported((DUE_KERNELS)kernel))
+		{
+			std::cout << "    " << std::left << std::setw(8) << DueColumns::getKernelName((DUE_KERNELS)kernel) << std::right << "not supported" << std::endl;
+			continue;
+		}
+
+		std::vector<uint64_t> counts(ranges.size(), 0);
+		std::vector<std::vector<uint64_t>> bitmaps(ranges.size());
+		uint64_t sink = 0;
+
+		columns.countRanges(ranges.data(), ranges.size(), true, counts.data(), bitmaps.data(), (DUE_KERNELS)kernel);
+		bool matched = counts == expected;
+		for (size_t range = 0; range < ranges.size(); range++)
+		{
+			uint64_t bits = 0;
+			for (uint64_t word : bitmaps[range])
+				bits += __builtin_popcountll(word);
+			matched = matched && bits == expected[range];
+		}
+		failed = failed || !matched;
+
+		// One range per scan, the way a single dashboard count would run
+		Clock::time_point start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			uint64_t count = 0;
+			columns.countRanges(&ranges[repeat % ranges.size()], 1, true, &count, nullptr, (DUE_KERNELS)kernel);
+			sink += count;
+		}
+		const double singleTime = getSeconds(start) / repeats;
+
+		// Every range in a single scan
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			columns.countRanges(ranges.data(), ranges.size(), true, counts.data(), nullptr, (DUE_KERNELS)kernel);
+			sink += counts[0];
+		}
+		const double multiTime = getSeconds(start) / repeats;
+
+		std::cout << "    " << std::left << std::setw(8) << DueColumns::getKernelName((DUE_KERNELS)kernel) << std::right
+			<< "1 range: " << columns.getNumSlots() / singleTime / 1e9 << " (" << singleTime * 1e3 << ")"
+			<< ", " << ranges.size() << " ranges: " << columns.getNumSlots() * ranges.size() / multiTime / 1e9
+			<< " (" << multiTime * 1e3 << ")" << (matched ? "" : " (results differ!)") << (sink ? "" : " ") << std::endl;
+	}
+
+	// The plain loop over the list for comparison
+	Clock::time_point start = Clock::now();
+	uint64_t count = 0;
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		const int serial = currNode->task.getDueSerial();
+		count += !currNode->task.getCompleted() && serial >= ranges[1].firstSerial && serial <= ranges[1].lastSerial;
+	}
+	const double listTime = getSeconds(start);
+	std::cout << "    " << std::left << std::setw(8) << "List" << std::right << "1 range: " << manager.getNumTasks() / listTime / 1e9
+		<< " (" << listTime * 1e3 << ")" << (count == expected[1] ? "" : " (results differ!)") << std::endl;
+
+	return failed ? 1 : 0;
+}
+
+// Name:   benchUndo(const vector<string>& args)
+// Desc:   Make random adds, removes and completions with an undo history,
+//         undo them all and redo them all, checking the list matches the
+//         list before and after the edits. The time per step is compared
+//         with taking a snapshot of the list through a copy.
+// Param:  args: The number of tasks to generate (default 1000000) and the
+//         number of edits (default 10000).
+// Return: An integer exit code: 0 on success, 1 if the lists differ.
+int Benchmarks::benchUndo(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int numEdits = getCount(args, 1, 10000);
+	TaskManager manager;
+	UndoLog history(64 << 20);
+	std::mt19937 random(2);
+
+	fillTasks(manager, numTasks);
+
+	// Every task line in list order, to compare the list after undo and redo
+	auto getLines = [](const TaskManager& manager)
+	{
+		std::vector<std::string> lines;
+		for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+			lines.push_back(TaskManager::formatTaskLine(currNode->task));
+		return lines;
+	};
+
+	const std::vector<std::string> before = getLines(manager);
+	const int startSerial = Date(1, 1, 2024).getSerial();
+	int numChanges = 0;
+
+	for (int edit = 0; edit < numEdits; edit++)
+	{
+		const int choice = random() % 3;
+
+		if (choice == 0 || manager.getNumTasks() == 0)
+		{
+			manager.addTask("Added " + std::to_string(edit), Date::fromSerial(startSerial + random() % 730));
+			history.recordAdd(manager.getLastTask());
+			numChanges++;
+			continue;
+		}
+
+		// Pick a task through the due date view so the edit does not walk the list
+		ViewIterator position = manager.findDue(VIEWS::BY_DUE_DATE, startSerial + random() % 730);
+		const Node* node = position != manager.viewEnd(VIEWS::BY_DUE_DATE) ? *position : manager.getLastTask();
+
+		if (choice == 1)
+		{
+			history.recordRemove(node);
+			manager.deleteTask(node);
+			numChanges++;
+		}
+		else if (!node->task.getCompleted())
+		{
+			history.recordComplete(node);
+			manager.completeTask(node);
+			numChanges++;
+		}
+	}
+
+	const std::vector<std::string> after = getLines(manager);
+	int numUndone = 0;
+	int numRedone = 0;
+
+	Clock::time_point start = Clock::now();
+	while (history.undo(manager))
+		numUndone++;
+	const double undoTime = getSeconds(start);
+	const bool undoMatched = getLines(manager) == before;
+
+	start = Clock::now();
+	while (history.redo(manager))
+		numRedone++;
+	const double redoTime = getSeconds(start);
+	const bool redoMatched = getLines(manager) == after;
+
+	// The snapshot a copy based undo would take before every edit
+	TaskManager snapshot;
+	start = Clock::now();
+	snapshot = manager;
+	const double copyTime = getSeconds(start);
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Tasks: " << numTasks << ", edits: " << numEdits << ", history: " << history.getMemoryUsed() / 1024 << " KB" << std::endl;
+	std::cout << "    Undo:      " << numUndone << " steps, " << undoTime / std::max(1, numUndone) * 1e6 << " us per step"
+		<< (undoMatched ? "" : " (list differs!)") << std::endl;
+	std::cout << "    Redo:      " << numRedone << " steps, " << redoTime / std::max(1, numRedone) * 1e6 << " us per step"
+		<< (redoMatched ? "" : " (list differs!)") << std::endl;
+	std::cout << "    Snapshot:  " << copyTime * 1e3 << " ms per copy" << std::endl;
+
+	return undoMatched && redoMatched && numUndone == numChanges ? 0 : 1;
+}
+
+// Name:   benchExport(const vector<string>& args)
+// Desc:   Export a task list as CSV and as JSON lines with one thread and
+//         with one thread per processor, and save it as a text file for
+//         comparison. Every export is checked for one line per task.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if an export failed.
+int Benchmarks::benchExport(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const std::string fileName = getTempFile("export");
+	const unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	TaskManager manager;
+	bool failed = false;
+
+	fillTasks(manager, numTasks);
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", M tasks/s (MB/s)" << std::endl;
+
+	Clock::time_point start = Clock::now();
+	manager.saveToFile(fileName);
+	const double saveTime = getSeconds(start);
+	std::cout << "    Save (text file):    " << numTasks / saveTime / 1e6 << " ("
+		<< std::filesystem::file_size(fileName) / saveTime / 1e6 << ")" << std::endl;
+
+	for (int format = 0; format < EXPORT_FORMATS::NUM_FORMATS; format++)
+	{
+		for (unsigned int numThreads = 1; numThreads <= maxThreads; numThreads = numThreads == maxThreads ? maxThreads + 1 : maxThreads)
+		{
+			TaskExporter exporter((EXPORT_FORMATS)format, numThreads);
+
+			start = Clock::now();
+			bool exported = exporter.open(fileName) && exporter.exportView(manager, VIEWS::INSERTION_ORDER);
+			exported = exporter.close() && exported;
+			const double exportTime = getSeconds(start);
+
+			// The CSV header is the one extra line
+			std::ifstream file(fileName, std::ios::binary);
+			const long numLines = std::count(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), '\n');
+			const bool matched = exported && numLines == numTasks + (format == EXPORT_FORMATS::CSV ? 1 : 0);
+			failed = failed || !matched;
+
+			std::cout << "    " << std::left << std::setw(6) << TaskExporter::getFormatName((EXPORT_FORMATS)format) << std::right
+				<< numThreads << " thread(s): " << numTasks / exportTime / 1e6 << " (" << exporter.getNumBytes() / exportTime / 1e6 << ")"
+				<< (matched ? "" : " (export failed!)") << std::endl;
+		}
+	}
+
+	std::filesystem::remove(fileName);
+
+	return failed ? 1 : 0;
+}
+
+// Name:   benchTags(const vector<string>& args)
+// Desc:   Give a task list random priorities and tags, then run filters
+//         that need a priority or tags through the label postings and
+//         through the compiled program on every task. The matches of
+//         both are checked to be the same tasks.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the results differ.
+int Benchmarks::benchTags(const std::vector<std::string>& args)
+{
+	static const char* tagNames[] = { "ops", "web", "data", "infra", "sales", "urgent", "blocked", "review" };
+	static const double tagShares[] = { 0.2, 0.15, 0.1, 0.05, 0.05, 0.02, 0.01, 0.3 };
+	static const char* expressions[] = {
+		"!completed && priority == 1 && tag == ops",
+		"priority == 2 && tag == web && tag == data",
+		"tag == urgent && tag == blocked",
+		"!completed && tag == infra && due < 1/1/2025",
+		"completed && priority == 3 && tag == review && name ~ \"report\""
+	};
+	const int numTasks = getCount(args, 0, 1000000);
+	const int numTags = sizeof(tagNames) / sizeof(tagNames[0]);
+	const int repeats = 5;
+	TaskManager source;
+	TaskManager manager;
+	bool failed = false;
+
+	fillTasks(source, numTasks);
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	std::discrete_distribution<int> priorities({ 40, 10, 20, 30 });
+	uint64_t tagBits[numTags];
+
+	for (int tag = 0; tag < numTags; tag++)
+		tagBits[tag] = (uint64_t)1 << TaskTags::intern(tagNames[tag]);
+
+	for (const Node* currNode = source.getTasks(); currNode; currNode = currNode->next)
+	{
+		const Task& task = currNode->task;
+		TaskRecord record = { std::string(task.getName()), task.getDueDate(), task.getCompleted(),
+			task.getRecurrence() ? TaskManager::formatRecurrence(*task.getRecurrence()) : std::string(), priorities(random), 0, {} };
+
+		for (int tag = 0; tag < numTags; tag++)
+		{
+			if (unit(random) < tagShares[tag])
+				record.tags |= tagBits[tag];
+		}
+
+		manager.addTask(record);
+	}
+	source.emptyTasks();
+
+	// Remove every tenth task so the postings have free slots
+	std::vector<const Node*> removed;
+	int taskNum = 0;
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		if (++taskNum % 10 == 0)
+			removed.push_back(currNode);
+	}
+	for (const Node* node : removed)
+		manager.deleteTask(node);
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Tasks: " << manager.getNumTasks() << ", ms per query" << std::endl;
+
+	for (const char* expression : expressions)
+	{
+		TaskFilter filter;
+		std::vector<const Node*> scanned;
+		std::vector<const Node*> posted;
+
+		filter.compile(expression);
+
+		Clock::time_point start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			scanned.clear();
+			for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+			{
+				if (filter.matches(currNode->task))
+					scanned.push_back(currNode);
+			}
+		}
+		const double scanTime = getSeconds(start) / repeats;
+
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+			posted = filter.apply(manager, VIEWS::INSERTION_ORDER);
+		const double postingTime = getSeconds(start) / repeats;
+
+		const bool matched = scanned == posted;
+		failed = failed || !matched;
+
+		std::cout << std::endl << expression << std::endl;
+		std::cout << "    Matches:   " << scanned.size() << (matched ? "" : " (results differ!)") << std::endl;
+		std::cout << "    List scan: " << scanTime * 1e3 << std::endl;
+		std::cout << "    Postings:  " << postingTime * 1e3 << " (" << scanTime / postingTime << "x), " << filter.getScanName(manager) << std::endl;
+	}
+
+	return failed ? 1 : 0;
+}
+
+// Name:   benchMemory(const vector<string>& args)
+// Desc:   Fill a task list and break down the memory it uses per task,
+//         then check the breakdown against how much the heap grew.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the breakdown is off
+//         from the heap by more than 10%.
+int Benchmarks::benchMemory(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	TaskManager manager;
+
+	const size_t heapBefore = getHeapBytes();
+	Clock::time_point start = Clock::now();
+	fillTasks(manager, numTasks);
+	const double fillTime = getSeconds(start);
+	const size_t heapBytes = getHeapBytes() - heapBefore;
+	const MemoryUsage usage = manager.memoryUsage();
+
+	const auto showLine = [&usage](const char* label, size_t bytes) {
+		std::cout << "    " << std::left << std::setw(11) << label << std::right << std::setw(9) << bytes / 1e6 << " MB, "
+			<< std::setw(6) << (double)bytes / usage.numTasks << " bytes per task" << std::endl;
+	};
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << usage.numTasks << " in " << fillTime << " s, " << sizeof(Node) << " byte nodes, "
+		<< sizeof(Task) << " byte tasks" << std::endl;
+	showLine("Records:", usage.recordBytes);
+	showLine("Names:", usage.nameBytes);
+	showLine("Rules:", usage.ruleBytes);
+	showLine("Indexes:", usage.indexBytes);
+	showLine("Overhead:", usage.overheadBytes);
+	showLine("Total:", usage.totalBytes);
+	showLine("Heap:", heapBytes);
+	std::cout << "    10M tasks: " << (double)usage.totalBytes / usage.numTasks * 1e7 / (1 << 20) << " MB" << std::endl;
+
+	const double difference = ((double)usage.totalBytes - (double)heapBytes) / heapBytes;
+
+	if (difference > 0.1 || difference < -0.1)
+	{
+		std::cout << "The breakdown is " << difference * 100 << "% off from the heap." << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+// Name:   benchSegments(const vector<string>& args)
+// Desc:   Save a task list as a text file and as a segmented store, then
+//         edit one month at a time and save only the changes. The store
+//         is loaded whole and for one month, and compacted. Every load
+//         is checked against the tasks of the list.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if a load differs.
+int Benchmarks::benchSegments(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int numEdits = 4;
+	const std::string textFile = getTempFile("segments.txt");
+	const std::string storeName = getTempFile("segments") + SegmentStore::storeExtension;
+	const int startSerial = Date(1, 1, 2024).getSerial();
+	TaskManager manager;
+	TaskManager loaded;
+	SegmentManifest manifest;
+
+	// Every task line in list order, to compare the loads with the list
+	auto getLines = [](const TaskManager& manager)
+	{
+		std::vector<std::string> lines;
+		for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+			lines.push_back(TaskManager::formatTaskLine(currNode->task));
+		return lines;
+	};
+
+	fillTasks(manager, numTasks);
+	std::filesystem::remove_all(storeName);
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", ms" << std::endl;
+
+	Clock::time_point start = Clock::now();
+	manager.saveToFile(textFile);
+	const double textSaveTime = getSeconds(start);
+
+	start = Clock::now();
+	SegmentStore::create(storeName, SEGMENT_KEYS::DUE_MONTH);
+	manager.saveToFile(storeName);
+	const double storeSaveTime = getSeconds(start);
+	SegmentStore::readManifest(storeName, manifest);
+
+	std::cout << "    Save text file:        " << textSaveTime * 1e3 << std::endl;
+	std::cout << "    Save store:            " << storeSaveTime * 1e3 << ", " << manifest.segments.size() << " segments" << std::endl;
+
+	// Each edit completes and adds a few tasks in a different month
+	double editSaveTime = 0;
+
+	for (int edit = 0; edit < numEdits; edit++)
+	{
+		const int serial = startSerial + 45 + edit * 91;
+		ViewIterator position = manager.findDue(VIEWS::BY_DUE_DATE, serial);
+
+		for (int i = 0; i < 10 && position != manager.viewEnd(VIEWS::BY_DUE_DATE); i++, ++position)
+			manager.completeTask(*position);
+
+		manager.addTask("Added " + std::to_string(edit), Date::fromSerial(serial));
+
+		start = Clock::now();
+		manager.saveToFile(storeName);
+		editSaveTime += getSeconds(start);
+	}
+
+	SegmentStore::readManifest(storeName, manifest);
+	std::cout << "    Save one month:        " << editSaveTime / numEdits * 1e3 << " (" << storeSaveTime / (editSaveTime / numEdits)
+		<< "x), " << manifest.segments.size() << " segments" << std::endl;
+
+	const std::vector<std::string> lines = getLines(manager);
+
+	start = Clock::now();
+	loaded.loadFromFile(textFile);
+	const double textLoadTime = getSeconds(start);
+
+	start = Clock::now();
+	const bool storeLoaded = loaded.loadFromFile(storeName);
+	const double storeLoadTime = getSeconds(start);
+	const bool storeMatched = storeLoaded && getLines(loaded) == lines;
+
+	// The month of the first edit, counted in the list to check the range load
+	const Date firstDay = Date::fromSerial(startSerial + 45);
+	const int firstSerial = Date(firstDay.getMonth(), 1, firstDay.getYear()).getSerial();
+	const int lastSerial = firstSerial + Date::getDaysInMonth(firstDay.getMonth(), firstDay.getYear()) - 1;
+	int numInMonth = 0;
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		numInMonth += currNode->task.getDueSerial() >= firstSerial && currNode->task.getDueSerial() <= lastSerial;
+
+	start = Clock::now();
+	const bool rangeLoaded = loaded.loadDueRange(storeName, firstSerial, lastSerial) && loaded.getNumTasks() == numInMonth;
+	const double rangeLoadTime = getSeconds(start);
+
+	std::cout << "    Load text file:        " << textLoadTime * 1e3 << std::endl;
+	std::cout << "    Load store:            " << storeLoadTime * 1e3 << (storeMatched ? "" : " (tasks differ!)") << std::endl;
+	std::cout << "    Load one month:        " << rangeLoadTime * 1e3 << " (" << storeLoadTime / rangeLoadTime << "x), "
+		<< numInMonth << " tasks" << (rangeLoaded ? "" : " (tasks differ!)") << std::endl;
+
+	// Wait for a background compaction to let go of the store
+	start = Clock::now();
+	bool compacted = false;
+	while (!(compacted = SegmentStore::compact(storeName)) && getSeconds(start) < 60)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	const double compactTime = getSeconds(start);
+	SegmentStore::readManifest(storeName, manifest);
+
+	const bool compactMatched = compacted && loaded.loadFromFile(storeName) && getLines(loaded) == lines;
+
+	std::cout << "    Compact:               " << compactTime * 1e3 << ", " << manifest.segments.size() << " segments"
+		<< (compactMatched ? "" : " (tasks differ!)") << std::endl;
+
+	std::filesystem::remove(textFile);
+	std::filesystem::remove_all(storeName);
+
+	return storeMatched && rangeLoaded && compactMatched ? 0 : 1;
+}
+
+// Name:   benchChecksum(const vector<string>& args)
+// Desc:   Save a task list compressed and measure the checksum kernels on
+//         the file, a load and a verification. Then damage a block in the
+//         middle and cut the file off in its last block, and check that
+//         exactly the tasks of those blocks are reported lost.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the report is wrong.
+int Benchmarks::benchChecksum(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const std::string fileName = getTempFile("checksum") + TaskArchive::fileExtension;
+	TaskManager manager;
+	TaskArchive archive;
+	LoadReport report;
+	std::string error;
+
+	fillTasks(manager, numTasks);
+	manager.saveToFile(fileName);
+	archive.open(fileName);
+
+	std::ifstream file(fileName, std::ios::binary);
+	const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Tasks: " << numTasks << ", " << contents.size() / 1e6 << " MB in " << archive.getNumBlocks() << " blocks" << std::endl;
+
+	for (int kernel = 0; kernel < CRC_KERNELS::NUM_CRC_KERNELS; kernel++)
+	{
+		if (!Crc32c::isKernelSupported((CRC_KERNELS)kernel))
+		{
+			std::cout << "    " << std::left << std::setw(8) << Crc32c::getKernelName((CRC_KERNELS)kernel) << std::right << "not supported" << std::endl;
+			continue;
+		}
+
+		// Repeat the file so the time is long enough to measure
+		const int repeats = std::max<int>(1, (256 << 20) / std::max<size_t>(1, contents.size()));
+		uint32_t checksum = 0;
+
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < repeats; i++)
+			checksum = Crc32c::compute(contents.data(), contents.size(), checksum, (CRC_KERNELS)kernel);
+		const double checkTime = getSeconds(start);
+
+		std::cout << "    " << std::left << std::setw(8) << Crc32c::getKernelName((CRC_KERNELS)kernel) << std::right
+			<< contents.size() * repeats / checkTime / 1e9 << " GB/s" << std::endl;
+	}
+
+	Clock::time_point start = Clock::now();
+	manager.loadFromFile(fileName);
+	const double loadTime = getSeconds(start);
+
+	start = Clock::now();
+	TaskManager::verifyFile(fileName, report, error);
+	const double verifyTime = getSeconds(start);
+
+	std::cout << "    Load:   " << loadTime * 1e3 << " ms" << std::endl;
+	std::cout << "    Verify: " << verifyTime * 1e3 << " ms" << std::endl;
+
+	if (archive.getNumBlocks() < 3)
+	{
+		std::filesystem::remove(fileName);
+		return report.numLost == 0 ? 0 : 1;
+	}
+
+	// Flip a byte in the middle block and cut the last block in half
+	const uint32_t middleBlock = archive.getNumBlocks() / 2;
+	const uint32_t lastBlock = archive.getNumBlocks() - 1;
+	const ArchiveBlockInfo& middle = archive.getBlockInfo(middleBlock);
+	const ArchiveBlockInfo& last = archive.getBlockInfo(lastBlock);
+	std::string damaged = contents.substr(0, last.offset + last.byteLength / 2);
+	damaged[middle.offset + middle.byteLength / 2] ^= 0x40;
+
+	std::ofstream damagedFile(fileName, std::ios::binary | std::ios::trunc);
+	damagedFile << damaged;
+	damagedFile.close();
+
+	start = Clock::now();
+	const bool loaded = manager.loadFromFile(fileName);
+	const double recoverTime = getSeconds(start);
+	const LoadReport& lostReport = manager.getLoadReport();
+	const uint64_t expectedLost = middle.numTasks + last.numTasks;
+	const bool reported = loaded && lostReport.lost.size() == 2 && lostReport.numLost == expectedLost
+		&& lostReport.lost[0].firstRecord == (uint64_t)middleBlock * TaskArchive::tasksPerBlock + 1
+		&& lostReport.lost[1].firstRecord == (uint64_t)lastBlock * TaskArchive::tasksPerBlock + 1
+		&& (uint64_t)manager.getNumTasks() == numTasks - expectedLost;
+
+	std::cout << "    Damaged load: " << recoverTime * 1e3 << " ms, " << lostReport.numLost << " tasks lost"
+		<< (reported ? "" : " (report is wrong!)") << std::endl;
+
+	for (const LostRecords& lost : lostReport.lost)
+		std::cout << "        " << TaskManager::formatLostRecords(lost) << std::endl;
+
+	std::filesystem::remove(fileName);
+
+	return reported && report.numLost == 0 ? 0 : 1;
+}
+
+// Name:   benchSort(const vector<string>& args)
+// Desc:   Sort the packed keys of the due date view and the nodes by
+//         name, and filter the nodes on a name, with std::sort and a plain
+//         loop and then on thread pools of 1, 2, 4 and more threads, up to
+//         the number of processors. The sorts start from shuffled nodes
+//         and every result is checked against the serial one.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the results differ.
+int Benchmarks::benchSort(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int maxThreads = std::max(4, ThreadPool::getDefaultThreadCount());
+	const int repeats = 3;
+	TaskManager manager;
+	TaskFilter filter;
+	std::vector<const Node*> nodes;
+	std::vector<std::pair<uint64_t, const Node*>> keys;
+	std::mt19937 random(7);
+	bool failed = false;
+
+	fillTasks(manager, numTasks);
+	filter.compile("name ~ \"report\"");
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		nodes.push_back(currNode);
+
+	std::shuffle(nodes.begin(), nodes.end(), random);
+
+	for (const Node* node : nodes)
+		keys.push_back({ (uint64_t)(uint32_t)(node->task.getDueSerial() + 1) << 32 | node->sequence, node });
+
+	const auto matchesName = [&filter](const Node* node) { return filter.matches(node->task); };
+
+	// Serial baselines
+	std::vector<std::pair<uint64_t, const Node*>> sortedKeys;
+	std::vector<const Node*> sortedNodes;
+	std::vector<const Node*> matches;
+
+	Clock::time_point start = Clock::now();
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		sortedKeys = keys;
+		std::sort(sortedKeys.begin(), sortedKeys.end());
+	}
+	const double keyTime = getSeconds(start) / repeats;
+
+	start = Clock::now();
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		sortedNodes = nodes;
+		std::sort(sortedNodes.begin(), sortedNodes.end(), NodeOrder{ VIEWS::BY_NAME });
+	}
+	const double nameTime = getSeconds(start) / repeats;
+
+	start = Clock::now();
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		matches.clear();
+		std::copy_if(nodes.begin(), nodes.end(), std::back_inserter(matches), matchesName);
+	}
+	const double filterTime = getSeconds(start) / repeats;
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", " << ThreadPool::getDefaultThreadCount() << " processor(s), ms per run (speedup)" << std::endl;
+	std::cout << "                 Due keys          Names             Filter" << std::endl;
+	std::cout << "    std::sort    " << std::left << std::setw(18) << keyTime * 1e3 << std::setw(18) << nameTime * 1e3
+		<< filterTime * 1e3 << std::right << std::endl;
+
+	for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		ThreadPool pool(numThreads);
+		std::vector<std::pair<uint64_t, const Node*>> parallelKeys;
+		std::vector<const Node*> parallelNodes;
+		std::vector<const Node*> parallelMatches;
+
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			parallelKeys = keys;
+			ParallelSort::sort(parallelKeys, std::less<std::pair<uint64_t, const Node*>>(), pool);
+		}
+		const double parallelKeyTime = getSeconds(start) / repeats;
+
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			parallelNodes = nodes;
+			ParallelSort::sort(parallelNodes, NodeOrder{ VIEWS::BY_NAME }, pool);
+		}
+		const double parallelNameTime = getSeconds(start) / repeats;
+
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+			parallelMatches = ParallelSort::filter(nodes, matchesName, pool);
+		const double parallelFilterTime = getSeconds(start) / repeats;
+
+		const bool differ = parallelKeys != sortedKeys || parallelNodes != sortedNodes || parallelMatches != matches;
+		failed = failed || differ;
+
+		std::ostringstream keyColumn;
+		std::ostringstream nameColumn;
+		keyColumn << std::fixed << std::setprecision(1) << parallelKeyTime * 1e3 << " (" << keyTime / parallelKeyTime << "x)";
+		nameColumn << std::fixed << std::setprecision(1) << parallelNameTime * 1e3 << " (" << nameTime / parallelNameTime << "x)";
+
+		std::cout << "    " << numThreads << " thread(s) " << (numThreads < 10 ? " " : "") << std::left << std::setw(18) << keyColumn.str()
+			<< std::setw(18) << nameColumn.str() << std::right << parallelFilterTime * 1e3 << " (" << filterTime / parallelFilterTime << "x)"
+			<< (differ ? " (results differ!)" : "") << std::endl;
+	}
+
+	return failed ? 1 : 0;
+}
+
+// Name:   benchIo(const vector<string>& args)
+// Desc:   Save and load a text task file with the blocking streams and
+//         with every asynchronous backend the kernel supports. Loads are
+//         timed with the file in the page cache and after its pages were
+//         dropped. Every save has to match the streams save and every
+//         load has to find all the tasks.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the results differ.
+int Benchmarks::benchIo(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int repeats = 3;
+	const std::string fileName = getTempFile("io.txt");
+	const std::string checkName = getTempFile("io_check.txt");
+	TaskManager manager;
+	bool failed = false;
+	bool dropped = true;
+
+	fillTasks(manager, numTasks);
+	manager.setIoBackend(IO_BACKENDS::STREAMS);
+	manager.saveToFile(checkName);
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", " << std::filesystem::file_size(checkName) / 1e6 << " MB, ms per run" << std::endl;
+	std::cout << "                 Save      Warm load Cold load" << std::endl;
+
+	for (int backend = 0; backend < IO_BACKENDS::NUM_IO_BACKENDS; backend++)
+	{
+		if (backend != IO_BACKENDS::STREAMS && !AsyncFile::isBackendSupported((IO_BACKENDS)backend))
+		{
+			std::cout << "    " << std::left << std::setw(13) << AsyncFile::getBackendName((IO_BACKENDS)backend) << std::right << "not supported" << std::endl;
+			continue;
+		}
+
+		TaskManager loaded;
+		bool saved = true;
+		bool allLoaded = true;
+
+		manager.setIoBackend((IO_BACKENDS)backend);
+		loaded.setIoBackend((IO_BACKENDS)backend);
+
+		Clock::time_point start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+			saved = manager.saveToFile(fileName) && saved;
+		const double saveTime = getSeconds(start) / repeats;
+
+		start = Clock::now();
+		for (int repeat = 0; repeat < repeats; repeat++)
+			allLoaded = loaded.loadFromFile(fileName) && loaded.getNumTasks() == numTasks && allLoaded;
+		const double warmTime = getSeconds(start) / repeats;
+
+		double coldTime = 0;
+		for (int repeat = 0; repeat < repeats; repeat++)
+		{
+			dropped = dropCachedPages(fileName) && dropped;
+
+			start = Clock::now();
+			allLoaded = loaded.loadFromFile(fileName) && loaded.getNumTasks() == numTasks && allLoaded;
+			coldTime += getSeconds(start) / repeats;
+		}
+
+		std::ifstream savedFile(fileName, std::ios::binary);
+		std::ifstream checkFile(checkName, std::ios::binary);
+		const bool matches = std::equal(std::istreambuf_iterator<char>(savedFile), std::istreambuf_iterator<char>(),
+			std::istreambuf_iterator<char>(checkFile), std::istreambuf_iterator<char>());
+
+		failed = failed || !saved || !allLoaded || !matches;
+
+		std::cout << "    " << std::left << std::setw(13) << AsyncFile::getBackendName((IO_BACKENDS)backend)
+			<< std::setw(10) << saveTime * 1e3 << std::setw(10) << warmTime * 1e3 << std::right << coldTime * 1e3
+			<< (saved && allLoaded && matches ? "" : " (results differ!)") << std::endl;
+	}
+
+	if (!dropped)
+		std::cout << "The page cache could not be dropped, cold loads may have been served from memory." << std::endl;
+
+	std::filesystem::remove(fileName);
+	std::filesystem::remove(checkName);
+
+	return failed ? 1 : 0;
+}
+
+// Name:   benchReminders(const vector<string>& args)
+// Desc:   Time the reminder timers of a task list: setting them all,
+//         the cost they add to adding, completing and deleting a task,
+//         and a simulated clock moved forward one day at a time over
+//         every due date. The reminders of the first days are checked
+//         against a scan of every task per day, which is what finding
+//         them without timers would take.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the reminders differ.
+int Benchmarks::benchReminders(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int numEdits = std::max(1, std::min(numTasks, 100000));
+	const int numScanDays = 30;
+	const int startSerial = Date(1, 1, 2024).getSerial();
+	const int endSerial = startSerial + 730 + 365 + 2;
+	TaskManager managers[2];
+	int64_t now = startSerial * Reminders::secondsPerDay - 1;
+	uint64_t numFired = 0;
+	double rebuildTime = 0;
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", edits: " << numEdits << ", ns per edit" << std::endl;
+	std::cout << "                 Add       Complete  Delete" << std::endl;
+
+	// The same list with and without timers, so the difference is their upkeep
+	for (int withTimers = 0; withTimers < 2; withTimers++)
+	{
+		TaskManager& manager = managers[withTimers];
+		std::vector<const Node*> added;
+
+		fillTasks(manager, numTasks);
+
+		if (withTimers)
+		{
+			const Clock::time_point start = Clock::now();
+			manager.startReminders([&numFired](const Reminder&) { numFired++; }, [&now]() { return now; });
+			rebuildTime = getSeconds(start);
+		}
+
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < numEdits; i++)
+		{
+			manager.addTask("Reminder edit", Date::fromSerial(startSerial + i % 730));
+			added.push_back(manager.getLastTask());
+		}
+		const double addTime = getSeconds(start);
+
+		start = Clock::now();
+		for (const Node* node : added)
+			manager.completeTask(node);
+		const double completeTime = getSeconds(start);
+
+		start = Clock::now();
+		for (const Node* node : added)
+			manager.deleteTask(node);
+		const double deleteTime = getSeconds(start);
+
+		std::cout << "    " << std::left << std::setw(13) << (withTimers ? "Timers" : "No timers") << std::setw(10) << addTime / numEdits * 1e9
+			<< std::setw(10) << completeTime / numEdits * 1e9 << std::right << deleteTime / numEdits * 1e9 << std::endl;
+	}
+
+	TaskManager& manager = managers[1];
+	std::vector<uint64_t> firedPerDay;
+
+	Clock::time_point start = Clock::now();
+	for (int serial = startSerial; serial < endSerial; serial++)
+	{
+		const uint64_t numBefore = numFired;
+
+		now = serial * Reminders::secondsPerDay;
+		manager.checkReminders();
+		firedPerDay.push_back(numFired - numBefore);
+	}
+	const double forwardTime = getSeconds(start);
+
+	// Without timers every task has to be looked at every day
+	bool matched = true;
+	start = Clock::now();
+	for (int serial = startSerial; serial < startSerial + numScanDays; serial++)
+	{
+		uint64_t numDue = 0;
+
+		for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		{
+			if (currNode->task.getCompleted())
+				continue;
+
+			for (OccurrenceIterator occurrence(currNode->task, serial - 1, serial); occurrence.isValid(); occurrence.next())
+				numDue += !occurrence.isCompleted();
+		}
+
+		matched = matched && numDue == firedPerDay[serial - startSerial];
+	}
+	const double scanTime = getSeconds(start) / numScanDays;
+
+	std::cout << "    Set all timers: " << rebuildTime * 1e3 << " ms, " << manager.memoryUsage().indexBytes / 1e6 << " MB of indexes" << std::endl;
+	std::cout << "    Fast forward:   " << endSerial - startSerial << " days, " << numFired << " reminders, "
+		<< forwardTime / (endSerial - startSerial) * 1e6 << " us per day" << std::endl;
+	std::cout << "    Daily scan:     " << scanTime * 1e6 << " us per day (" << scanTime / (forwardTime / (endSerial - startSerial))
+		<< "x)" << (matched ? "" : " (reminders differ!)") << std::endl;
+
+	return matched ? 0 : 1;
+}
+
+// Name:   benchGraph(const vector<string>& args)
+// Desc:   Time the dependencies of a task list: chains of tasks where
+//         each one waits for the one before, edges refused because they
+//         would close a chain into a cycle, completing the head of every
+//         chain so the next task is unblocked, and a page of actionable
+//         tasks read from the view against a scan of the list that
+//         checks the blockers of every task.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the answers differ.
+int Benchmarks::benchGraph(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int chainLength = 5;
+	const int pageSize = 50;
+	const int numQueries = 100;
+	TaskManager manager;
+	std::vector<const Node*> nodes;
+
+	fillTasks(manager, numTasks);
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		nodes.push_back(currNode);
+
+	const int numChains = (int)nodes.size() / chainLength;
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", chains of " << chainLength << ": " << numChains << std::endl;
+
+	Clock::time_point start = Clock::now();
+	for (int chain = 0; chain < numChains; chain++)
+		for (int i = 1; i < chainLength; i++)
+			manager.addDependency(nodes[chain * chainLength + i - 1], nodes[chain * chainLength + i]);
+	const double insertTime = getSeconds(start);
+	const int numEdges = manager.getNumDependencies();
+
+	// Each refused edge searches the whole chain before it gives up
+	int numRefused = 0;
+	start = Clock::now();
+	for (int chain = 0; chain < numChains; chain++)
+		numRefused += !manager.addDependency(nodes[chain * chainLength + chainLength - 1], nodes[chain * chainLength]);
+	const double cycleTime = getSeconds(start);
+
+	// Only an open head unblocks its next task, so the count is checked against that
+	int numOpenHeads = 0;
+	const int actionableBefore = manager.getNumActionable();
+	start = Clock::now();
+	for (int chain = 0; chain < numChains; chain++)
+	{
+		const Node* head = nodes[chain * chainLength];
+
+		numOpenHeads += !head->task.getCompleted();
+		manager.completeTask(head);
+	}
+	const double completeTime = getSeconds(start);
+
+	std::vector<const Node*> viewPage;
+	start = Clock::now();
+	for (int query = 0; query < numQueries; query++)
+		viewPage = manager.getActionable(pageSize);
+	const double viewTime = getSeconds(start) / numQueries;
+
+	// Without the counts every task needs a look at each of its blockers
+	std::vector<const Node*> scanPage;
+	int numScanned = 0;
+	start = Clock::now();
+	for (ViewIterator pos = manager.viewBegin(VIEWS::BY_DUE_DATE); pos != manager.viewEnd(VIEWS::BY_DUE_DATE); ++pos)
+	{
+		const Node* node = *pos;
+		bool blocked = node->task.getCompleted();
+
+		for (const Node* blocker : manager.getBlockers(node))
+			blocked = blocked || !blocker->task.getCompleted();
+
+		if (!blocked)
+		{
+			if ((int)scanPage.size() < pageSize)
+				scanPage.push_back(node);
+			numScanned++;
+		}
+	}
+	const double scanTime = getSeconds(start);
+
+	const bool matched = numRefused == numChains && viewPage == scanPage && numScanned == manager.getNumActionable()
+		&& (numChains == 0 || manager.getNumActionable() != actionableBefore || numOpenHeads == 0);
+
+	std::cout << "    Add edge:       " << insertTime / std::max(1, numEdges) * 1e9 << " ns, " << numEdges << " edges, "
+		<< manager.memoryUsage().indexBytes / 1e6 << " MB of indexes" << std::endl;
+	std::cout << "    Refuse cycle:   " << cycleTime / std::max(1, numChains) * 1e9 << " ns per edge over " << chainLength << " tasks" << std::endl;
+	std::cout << "    Complete head:  " << completeTime / std::max(1, numChains) * 1e9 << " ns, " << actionableBefore << " -> "
+		<< manager.getNumActionable() << " actionable" << std::endl;
+	std::cout << "    First " << pageSize << " actionable: " << viewTime * 1e6 << " us from the view, " << scanTime * 1e6
+		<< " us from a scan (" << scanTime / viewTime << "x)" << (matched ? "" : " (answers differ!)") << std::endl;
+
+	return matched ? 0 : 1;
+}
+
+// Name:   benchShared(const vector<string>& args)
+// Desc:   Time a task list shared through shared memory: the first store
+//         loads the file into the region, a second one joins it, edits
+//         on the first reach the region and the second applies them. The
+//         join and the sync are compared with loading the file, which is
+//         what a process without the region does to see the edits.
+// Param:  args: The number of tasks to generate (default 1000000).
+// Return: An integer exit code: 0 on success, 1 if the lists differ.
+int Benchmarks::benchShared(const std::vector<std::string>& args)
+{
+	const int numTasks = getCount(args, 0, 1000000);
+	const int numEdits = SharedStore::changeRingSize - 1;
+	const std::string fileName = getTempFile("shared.txt");
+	TaskManager first;
+	TaskManager second;
+	TaskManager reloaded;
+	SharedStore firstStore(first);
+	SharedStore secondStore(second);
+	SyncReport report;
+
+	fillTasks(first, numTasks);
+	if (!first.saveToFile(fileName))
+	{
+		std::cout << "Could not write " << fileName << std::endl;
+		return 1;
+	}
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Tasks: " << numTasks << ", edits: " << numEdits << std::endl;
+
+	Clock::time_point start = Clock::now();
+	bool attached = firstStore.attach(fileName);
+	const double createTime = getSeconds(start);
+
+	start = Clock::now();
+	attached = attached && secondStore.attach(fileName);
+	const double joinTime = getSeconds(start);
+
+	if (!attached)
+	{
+		std::cout << "Could not share " << fileName << ": " << firstStore.getError() << secondStore.getError() << std::endl;
+		std::filesystem::remove(fileName);
+		return 1;
+	}
+
+	// Each edit takes the lock and writes one record and its line, the same edits on a list of its own do neither
+	double editTimes[2] = { 0, 0 };
+	TaskManager* editManagers[2] = { &reloaded, &first };
+
+	fillTasks(reloaded, numTasks);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::vector<const Node*> nodes;
+		std::mt19937 random(7);
+
+		for (const Node* currNode = editManagers[pass]->getTasks(); currNode; currNode = currNode->next)
+			nodes.push_back(currNode);
+
+		start = Clock::now();
+		for (int edit = 0; edit < numEdits && !nodes.empty(); edit++)
+		{
+			const Node* node = nodes[random() % nodes.size()];
+
+			if (node->task.getCompleted())
+				editManagers[pass]->uncompleteTask(node);
+			else
+				editManagers[pass]->completeTask(node);
+		}
+		editTimes[pass] = getSeconds(start) / numEdits;
+	}
+
+	start = Clock::now();
+	const bool synced = secondStore.hasChanged() && secondStore.sync(report);
+	const double syncTime = getSeconds(start);
+
+	start = Clock::now();
+	const bool saved = secondStore.save();
+	const double saveTime = getSeconds(start);
+
+	// Nothing changed since, so the second save leaves the file alone
+	start = Clock::now();
+	const bool savedAgain = firstStore.save();
+	const double unchangedTime = getSeconds(start);
+
+	start = Clock::now();
+	const bool loaded = reloaded.loadFromFile(fileName);
+	const double loadTime = getSeconds(start);
+
+	bool matched = synced && saved && savedAgain && loaded && report.mode == SYNC_MODES::DIFFED
+		&& second.getNumTasks() == first.getNumTasks() && reloaded.getNumTasks() == first.getNumTasks();
+
+	for (const Node *firstNode = first.getTasks(), *secondNode = second.getTasks(), *loadedNode = reloaded.getTasks();
+		matched && firstNode; firstNode = firstNode->next, secondNode = secondNode->next, loadedNode = loadedNode->next)
+	{
+		const std::string line = TaskManager::formatTaskLine(firstNode->task);
+
+		matched = line == TaskManager::formatTaskLine(secondNode->task) && line == TaskManager::formatTaskLine(loadedNode->task);
+	}
+
+	std::cout << "    Create region:  " << createTime * 1e3 << " ms with the load, " << firstStore.getBytesUsed() / 1e6 << " MB used of "
+		<< firstStore.getRegionBytes() / 1e6 << " MB mapped" << std::endl;
+	std::cout << "    Join region:    " << joinTime * 1e3 << " ms, a load takes " << loadTime * 1e3 << " ms" << std::endl;
+	std::cout << "    Edit:           " << editTimes[1] * 1e9 << " ns per complete through the region, " << editTimes[0] * 1e9
+		<< " ns without it" << std::endl;
+	std::cout << "    Sync:           " << syncTime * 1e3 << " ms for " << report.numUpdated << " updated tasks ("
+		<< loadTime / syncTime << "x faster than a load)" << std::endl;
+	std::cout << "    Save:           " << saveTime * 1e3 << " ms, " << unchangedTime * 1e6 << " us when nothing changed"
+		<< (matched ? "" : " (lists differ!)") << std::endl;
+	std::cout << "    Per process:    " << second.memoryUsage().totalBytes / 1e6 << " MB of records, names and indexes" << std::endl;
+
+	firstStore.detach();
+	secondStore.detach();
+	std::filesystem::remove(fileName);
+
+	return matched ? 0 : 1;
+}
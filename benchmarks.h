@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+
+/*****************************************************************************
+# Description: The Benchmarks class holds the performance measurements
+               that can be run from the command line. Each benchmark
+			   creates its own synthetic task list and prints its
+			   results to the console.
+#****************************************************************************/
+
+class TaskManager;
+
+class Benchmarks
+{
+public:
+	static int run(const std::string& name, const std::vector<std::string>& args);
+	static void listBenchmarks();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	static void fillTasks(TaskManager& manager, int numTasks, unsigned int seed = 1);
+	static double getSeconds(Clock::time_point start);
+	static std::string getTempFile(const std::string& name);
+	static int getCount(const std::vector<std::string>& args, size_t argNum, int defaultCount);
+	static double getPercentile(std::vector<double>& values, double percentile);
+	static size_t getHeapBytes();
+	static bool dropCachedPages(const std::string& fileName);
+
+	static int benchCodec(const std::vector<std::string>& args);
+	static int benchDedup(const std::vector<std::string>& args);
+	static int benchDaemon(const std::vector<std::string>& args);
+	static int benchFilter(const std::vector<std::string>& args);
+	static int benchColumns(const std::vector<std::string>& args);
+	static int benchUndo(const std::vector<std::string>& args);
+	static int benchExport(const std::vector<std::string>& args);
+	static int benchTags(const std::vector<std::string>& args);
+	static int benchMemory(const std::vector<std::string>& args);
+	static int benchSegments(const std::vector<std::string>& args);
+	static int benchChecksum(const std::vector<std::string>& args);
+	static int benchSort(const std::vector<std::string>& args);
+	static int benchIo(const std::vector<std::string>& args);
+	static int benchReminders(const std::vector<std::string>& args);
+	static int benchGraph(const std::vector<std::string>& args);
+	static int benchShared(const std::vector<std::string>& args);
+};
@@ -0,0 +1,720 @@
+#include "commandLine.h"
+#include "benchmarks.h"
+#include "taskServer.h"
+#include "taskClient.h"
+#include "taskFilter.h"
+#include "taskExporter.h"
+#include "segmentStore.h"
+#include "traceReplay.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <csignal>
+#include <climits>
+#include <cstdint>
+#include <chrono>
+
+// Name:   run(int argc, char* argv[])
+// Desc:   Run the command given on the command line.
+// Param:  argc: The number of arguments.
+//         argv: The arguments, starting with the program name.
+// Return: An integer exit code: 0 on success.
+int CommandLine::run(int argc, char* argv[])
+{
+	const std::string command = argv[1];
+	std::vector<std::string> args(argv + 2, argv + argc);
+
+	if (command == "bench")
+		return commandBench(args);
+	if (command == "daemon")
+		return commandDaemon(args);
+	if (command == "client")
+		return commandClient(args);
+	if (command == "list")
+		return commandList(args);
+	if (command == "export")
+		return commandExport(args);
+	if (command == "store")
+		return commandStore(args);
+	if (command == "compact")
+		return commandCompact(args);
+	if (command == "verify")
+		return commandVerify(args);
+	if (command == "remind")
+		return commandRemind(args);
+	if (command == "generate")
+		return commandGenerate(args);
+	if (command == "trace")
+		return commandTrace(args);
+	if (command == "replay")
+		return commandReplay(args);
+
+	showUsage(argv[0]);
+
+	return command == "help" ? 0 : 1;
+}
+
+// Name:   showUsage(const string& programName)
+// Desc:   Display the available commands.
+// Param:  programName: The name the program was started with.
+// Return: None
+void CommandLine::showUsage(const std::string& programName)
+{
+	std::cout << "Usage: " << programName << " [command]" << std::endl;
+	std::cout << "Without a command the interactive menu is started." << std::endl << std::endl;
+	std::cout << "Commands:" << std::endl;
+	std::cout << "    bench <name> [args]    Run a benchmark" << std::endl;
+	std::cout << "    list [--filter <expression>] [--view <0-" << VIEWS::NUM_VIEWS - 1 << ">] <file>" << std::endl;
+	std::cout << "                           Print the tasks of a file that match a filter, for example:" << std::endl;
+	std::cout << "                           !completed && due < 12/01/2024 && name ~ \"report\"" << std::endl;
+	std::cout << "    export [--format csv|jsonl] [--filter <expression>] [--view <0-" << VIEWS::NUM_VIEWS - 1 << ">] <file> [output]" << std::endl;
+	std::cout << "                           Write the tasks of a file as CSV or JSON lines to a file or stdout" << std::endl;
+	std::cout << "    store [--key month|quarter|year] <file> <store" << SegmentStore::storeExtension << ">" << std::endl;
+	std::cout << "                           Copy a task file into a store segmented by due date" << std::endl;
+	std::cout << "    compact <store" << SegmentStore::storeExtension << ">    Merge the small and shadowed segments of a store" << std::endl;
+	std::cout << "    verify <file>          Check the checksums and records of a file without loading it" << std::endl;
+	std::cout << "    remind [--from <mm/dd/yyyy>] [--days <n>] <file>" << std::endl;
+	std::cout << "                           Print the reminders of a file that fire in the days from a date" << std::endl;
+	std::cout << "    generate [--tasks <n>] [workload options] <file>" << std::endl;
+	std::cout << "                           Write a synthetic task list to a file" << std::endl;
+	std::cout << "    trace [--ops <n>] [--mix <op>=<weight>,...] [--page <n>] [workload options] <file>" << std::endl;
+	std::cout << "                           Write a trace of add, complete, delete, display, save and load" << std::endl;
+	std::cout << "                           operations, for example: --mix add=30,display=60,save=1" << std::endl;
+	std::cout << "    replay <file> <trace>  Run a trace against a task file and print the latency" << std::endl;
+	std::cout << "                           percentiles per operation and the peak resident memory" << std::endl;
+	std::cout << "                           Workload options: --name-length <min>-<max> --from <mm/dd/yyyy>" << std::endl;
+	std::cout << "                           --days <n> --dates uniform|normal|soon --completed <share>" << std::endl;
+	std::cout << "                           --completion random|early --seed <n>" << std::endl;
+	std::cout << "    daemon <file> [socket] Serve a task file over a Unix socket" << std::endl;
+	std::cout << "    client [-s socket] <request> [fields]" << std::endl;
+	std::cout << "                           Send one request to the daemon, for example:" << std::endl;
+	std::cout << "                           ADD <name> <m/d/y>, COMPLETE <id>, DELETE <id>," << std::endl;
+	std::cout << "                           QUERY <view> <count>, NEXT <count>, COUNT, SAVE, STOP" << std::endl;
+	std::cout << "    help                   Show this message" << std::endl << std::endl;
+	Benchmarks::listBenchmarks();
+}
+
+// Name:   commandBench(const vector<string>& args)
+// Desc:   Run a benchmark.
+// Param:  args: The benchmark name followed by its arguments.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandBench(const std::vector<std::string>& args)
+{
+	if (args.empty())
+	{
+		Benchmarks::listBenchmarks();
+		return 1;
+	}
+
+	return Benchmarks::run(args[0], std::vector<std::string>(args.begin() + 1, args.end()));
+}
+
+// Name:   commandDaemon(const vector<string>& args)
+// Desc:   Serve a task file until the daemon is sent STOP or is
+//         interrupted, then save the file if it changed.
+// Param:  args: The task file and optionally the socket path.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandDaemon(const std::vector<std::string>& args)
+{
+	if (args.empty())
+	{
+		std::cout << "A task file is needed." << std::endl;
+		return 1;
+	}
+
+	const std::string socketPath = args.size() > 1 ? args[1] : TaskServer::defaultSocket;
+	TaskServer server;
+	sigset_t signals;
+
+	// The signals are taken by a thread that stops the server cleanly
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+	if (!server.start(socketPath, args[0]))
+	{
+		std::cout << "Could not serve " << args[0] << " on " << socketPath << "." << std::endl;
+		return 1;
+	}
+
+	std::thread signalThread([&server, signals]() {
+		int signal = 0;
+		sigwait(&signals, &signal);
+		server.stop();
+	});
+
+	std::cout << "Serving " << server.getNumTasks() << " task(s) from " << args[0] << " on " << socketPath << std::endl;
+	server.run();
+
+	// The thread holds the server, so it is woken and joined before the server goes away
+	pthread_kill(signalThread.native_handle(), SIGTERM);
+	signalThread.join();
+
+	if (server.isModified() && !server.save())
+	{
+		std::cout << "Could not save " << args[0] << "." << std::endl;
+		return 1;
+	}
+
+	std::cout << "Stopped." << std::endl;
+
+	return 0;
+}
+
+// Name:   commandClient(const vector<string>& args)
+// Desc:   Send one request to a running daemon and print the response.
+// Param:  args: An optional -s and socket path, then the request fields.
+// Return: An integer exit code: 0 if the daemon answered OK.
+int CommandLine::commandClient(const std::vector<std::string>& args)
+{
+	std::string socketPath = TaskServer::defaultSocket;
+	size_t first = 0;
+
+	if (args.size() > 1 && args[0] == "-s")
+	{
+		socketPath = args[1];
+		first = 2;
+	}
+
+	if (first >= args.size())
+	{
+		std::cout << "A request is needed." << std::endl;
+		return 1;
+	}
+
+	std::string request = args[first];
+	for (size_t i = first + 1; i < args.size(); i++)
+		request += "\t" + args[i];
+
+	TaskClient client;
+	std::vector<std::string> response;
+
+	if (!client.connectTo(socketPath) || !client.request(request, response))
+	{
+		std::cout << "Could not reach the daemon on " << socketPath << "." << std::endl;
+		return 1;
+	}
+
+	for (const std::string& line : response)
+		std::cout << line << std::endl;
+
+	return response[0].compare(0, 2, "OK") == 0 ? 0 : 1;
+}
+
+// Name:   commandList(const vector<string>& args)
+// Desc:   Print the tasks of a file in the task file format, optionally
+//         only the ones that match a filter and in the order of a view.
+// Param:  args: The options followed by the task file.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandList(const std::vector<std::string>& args)
+{
+	std::string fileName;
+	std::string expression;
+	int view = VIEWS::INSERTION_ORDER;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--filter" && i + 1 < args.size())
+			expression = args[++i];
+		else if (args[i] == "--view" && i + 1 < args.size())
+			view = atoi(args[++i].c_str());
+		else
+			fileName = args[i];
+	}
+
+	if (fileName.empty() || view < VIEWS::INSERTION_ORDER || view >= VIEWS::NUM_VIEWS)
+	{
+		std::cout << "A task file and a view from 0 to " << VIEWS::NUM_VIEWS - 1 << " are needed." << std::endl;
+		return 1;
+	}
+
+	TaskFilter filter;
+	TaskManager manager;
+	int firstSerial = INT_MIN;
+	int lastSerial = INT_MAX;
+
+	if (!filter.compile(expression))
+	{
+		std::cout << "Invalid filter: " << filter.getError() << std::endl;
+		return 1;
+	}
+
+	// A store only reads the segments the filter can match in
+	filter.getDueBounds(firstSerial, lastSerial);
+
+	if (!manager.checkFileExists(fileName) || !manager.loadDueRange(fileName, firstSerial, lastSerial))
+	{
+		std::cout << "Could not load " << fileName << "." << std::endl;
+		return 1;
+	}
+
+	showLostRecords(manager.getLoadReport(), 5);
+
+	// The tags of the file are only known once it is loaded
+	filter.compile(expression);
+
+	std::string output;
+	for (const Node* node : filter.apply(manager, (VIEWS)view))
+		output += TaskManager::formatTaskLine(node->task) + "\n";
+
+	std::cout << output;
+
+	return 0;
+}
+
+// Name:   commandExport(const vector<string>& args)
+// Desc:   Export the tasks of a file as CSV or JSON lines, optionally only
+//         the ones that match a filter and in the order of a view.
+// Param:  args: The options followed by the task file and the output
+//         file, the standard output if there is none or it is "-".
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandExport(const std::vector<std::string>& args)
+{
+	std::vector<std::string> fileNames;
+	std::string expression;
+	EXPORT_FORMATS format = EXPORT_FORMATS::CSV;
+	int view = VIEWS::INSERTION_ORDER;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--format" && i + 1 < args.size())
+		{
+			if (!TaskExporter::getFormatFromName(args[++i], format))
+			{
+				std::cerr << "Unknown format: " << args[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (args[i] == "--filter" && i + 1 < args.size())
+			expression = args[++i];
+		else if (args[i] == "--view" && i + 1 < args.size())
+			view = atoi(args[++i].c_str());
+		else
+			fileNames.push_back(args[i]);
+	}
+
+	// The messages go to stderr so they never end up in an export to stdout
+	if (fileNames.empty() || fileNames.size() > 2 || view < VIEWS::INSERTION_ORDER || view >= VIEWS::NUM_VIEWS)
+	{
+		std::cerr << "A task file and a view from 0 to " << VIEWS::NUM_VIEWS - 1 << " are needed." << std::endl;
+		return 1;
+	}
+
+	TaskFilter filter;
+	TaskManager manager;
+	TaskExporter exporter(format);
+	int firstSerial = INT_MIN;
+	int lastSerial = INT_MAX;
+
+	if (!filter.compile(expression))
+	{
+		std::cerr << "Invalid filter: " << filter.getError() << std::endl;
+		return 1;
+	}
+
+	filter.getDueBounds(firstSerial, lastSerial);
+
+	if (!manager.checkFileExists(fileNames[0]) || !manager.loadDueRange(fileNames[0], firstSerial, lastSerial))
+	{
+		std::cerr << "Could not load " << fileNames[0] << "." << std::endl;
+		return 1;
+	}
+
+	showLostRecords(manager.getLoadReport(), 5);
+	filter.compile(expression);
+
+	bool exported = exporter.open(fileNames.size() > 1 ? fileNames[1] : "-");
+
+	// An empty filter matches everything, so the view is streamed without collecting it
+	if (exported && expression.find_first_not_of(" \t") == std::string::npos)
+		exported = exporter.exportView(manager, (VIEWS)view);
+	else if (exported)
+		exported = exporter.exportTasks(filter.apply(manager, (VIEWS)view));
+
+	if (!exporter.close() || !exported)
+	{
+		std::cerr << exporter.getError() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+// Name:   commandStore(const vector<string>& args)
+// Desc:   Copy the tasks of a file into a segmented store. An existing
+//         store is emptied first and takes the new partition key.
+// Param:  args: The options followed by the task file and the store.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandStore(const std::vector<std::string>& args)
+{
+	std::vector<std::string> fileNames;
+	SEGMENT_KEYS key = SEGMENT_KEYS::DUE_MONTH;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--key" && i + 1 < args.size())
+		{
+			if (!SegmentStore::getKeyFromName(args[++i], key))
+			{
+				std::cout << "Unknown key: " << args[i] << std::endl;
+				return 1;
+			}
+		}
+		else
+			fileNames.push_back(args[i]);
+	}
+
+	if (fileNames.size() != 2 || !SegmentStore::isStoreName(fileNames[1]))
+	{
+		std::cout << "A task file and a store ending in " << SegmentStore::storeExtension << " are needed." << std::endl;
+		return 1;
+	}
+
+	TaskManager manager;
+
+	if (!manager.checkFileExists(fileNames[0]) || !manager.loadFromFile(fileNames[0]))
+	{
+		std::cout << "Could not load " << fileNames[0] << "." << std::endl;
+		return 1;
+	}
+
+	if (!SegmentStore::create(fileNames[1], key) || !manager.saveToFile(fileNames[1]))
+	{
+		std::cout << "Could not save " << fileNames[1] << "." << std::endl;
+		return 1;
+	}
+
+	SegmentManifest manifest;
+	SegmentStore::readManifest(fileNames[1], manifest);
+
+	std::cout << "Stored " << manager.getNumTasks() << " tasks in " << manifest.segments.size() << " segments by "
+		<< SegmentStore::getKeyName(key) << "." << std::endl;
+
+	return 0;
+}
+
+// Name:   commandCompact(const vector<string>& args)
+// Desc:   Compact a segmented store now instead of in the background.
+// Param:  args: The store.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandCompact(const std::vector<std::string>& args)
+{
+	SegmentManifest manifest;
+
+	if (args.size() != 1 || !SegmentStore::readManifest(args[0], manifest))
+	{
+		std::cout << "A segmented store is needed." << std::endl;
+		return 1;
+	}
+
+	const size_t numSegments = manifest.segments.size();
+
+	if (!SegmentStore::compact(args[0]) || !SegmentStore::readManifest(args[0], manifest))
+	{
+		std::cout << "Could not compact " << args[0] << ", it may be in use." << std::endl;
+		return 1;
+	}
+
+	std::cout << "Compacted " << numSegments << " segments into " << manifest.segments.size() << "." << std::endl;
+
+	return 0;
+}
+
+// Name:   commandVerify(const vector<string>& args)
+// Desc:   Check every record of a file without loading it and list the
+//         records that are lost.
+// Param:  args: The file to check.
+// Return: An integer exit code: 0 if every record can be read.
+int CommandLine::commandVerify(const std::vector<std::string>& args)
+{
+	LoadReport report;
+	std::string error;
+
+	if (args.size() != 1)
+	{
+		std::cout << "A task file is needed." << std::endl;
+		return 1;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (!TaskManager::verifyFile(args[0], report, error))
+	{
+		std::cout << "Could not verify " << args[0] << ": " << error << std::endl;
+		return 1;
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << args[0] << ": " << report.numRecords - report.numLost << " of " << report.numRecords
+		<< " records intact, checked in " << (int)(seconds * 1e3) << " ms." << std::endl;
+	showLostRecords(report, SIZE_MAX);
+
+	return report.numLost == 0 ? 0 : 1;
+}
+
+// Name:   commandRemind(const vector<string>& args)
+// Desc:   Print the reminders a file gives over a range of days, one event
+//         line each: the time, due or overdue, the date of the occurrence
+//         and the task name. The reminders run on a simulated clock that
+//         jumps from one reminder to the next, so a year takes no longer
+//         than a day.
+// Param:  args: The options followed by the task file.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandRemind(const std::vector<std::string>& args)
+{
+	std::string fileName;
+	std::string fromText;
+	Date fromDate = Date::today();
+	int numDays = 7;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--from" && i + 1 < args.size())
+		{
+			fromText = args[++i];
+			fromDate = Date(fromText);
+		}
+		else if (args[i] == "--days" && i + 1 < args.size())
+			numDays = atoi(args[++i].c_str());
+		else
+			fileName = args[i];
+	}
+
+	if (fileName.empty() || fromDate.getSerial() < 0 || numDays <= 0)
+	{
+		std::cout << "A task file, a start date as mm/dd/yyyy and a positive number of days are needed." << std::endl;
+		return 1;
+	}
+
+	TaskManager manager;
+
+	if (!manager.checkFileExists(fileName) || !manager.loadFromFile(fileName))
+	{
+		std::cout << "Could not load " << fileName << "." << std::endl;
+		return 1;
+	}
+
+	showLostRecords(manager.getLoadReport(), 5);
+
+	// The clock starts just before the first day, so its reminders at midnight fire
+	const int64_t endTime = (fromDate.getSerial() + (int64_t)numDays) * Reminders::secondsPerDay;
+	int64_t now = fromDate.getSerial() * Reminders::secondsPerDay - 1;
+	std::string output;
+
+	manager.startReminders([&output](const Reminder& reminder) { output += Reminders::formatTime(reminder.time) + "\t" + Reminders::formatReminder(reminder) + "\n"; },
+		[&now]() { return now; });
+
+	for (int64_t next = manager.getNextReminderTime(); next < endTime; next = manager.getNextReminderTime())
+	{
+		now = next;
+		manager.checkReminders();
+	}
+
+	std::cout << output;
+
+	return 0;
+}
+
+// Name:   commandGenerate(const vector<string>& args)
+// Desc:   Write a synthetic task list shaped by the workload options. The
+//         extension of the file picks the format, as for a save.
+// Param:  args: The options followed by the task file.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandGenerate(const std::vector<std::string>& args)
+{
+	WorkloadProfile profile = Workload::getDefaultProfile();
+	std::string fileName;
+	long long numTasks = 10000;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--tasks" && i + 1 < args.size())
+			numTasks = atoll(args[++i].c_str());
+		else if (!parseWorkloadOption(args, i, profile))
+			fileName = args[i];
+	}
+
+	if (fileName.empty() || numTasks < 0 || profile.startSerial < 0)
+	{
+		std::cout << "A task file, valid workload options and a number of tasks are needed." << std::endl;
+		return 1;
+	}
+
+	TaskManager manager;
+	Workload workload(profile);
+
+	workload.fillTasks(manager, numTasks);
+
+	if (!manager.saveToFile(fileName))
+	{
+		std::cout << "Could not save " << fileName << "." << std::endl;
+		return 1;
+	}
+
+	std::cout << "Wrote " << manager.getNumTasks() << " task(s), " << manager.getNumCompleted() << " completed, to " << fileName << std::endl;
+
+	return 0;
+}
+
+// Name:   commandTrace(const vector<string>& args)
+// Desc:   Write a trace of operations picked by the weights of the mix.
+//         Added tasks are shaped by the workload options.
+// Param:  args: The options followed by the trace file.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandTrace(const std::vector<std::string>& args)
+{
+	WorkloadProfile profile = Workload::getDefaultProfile();
+	std::string fileName;
+	long long numOps = 10000;
+	bool valid = true;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--ops" && i + 1 < args.size())
+			numOps = atoll(args[++i].c_str());
+		else if (args[i] == "--mix" && i + 1 < args.size())
+			valid = Workload::parseMix(args[++i], profile) && valid;
+		else if (args[i] == "--page" && i + 1 < args.size())
+			profile.pageSize = atoi(args[++i].c_str());
+		else if (!parseWorkloadOption(args, i, profile))
+			fileName = args[i];
+	}
+
+	if (!valid || fileName.empty() || numOps < 0 || profile.pageSize <= 0 || profile.startSerial < 0)
+	{
+		std::cout << "A trace file, a mix such as add=30,display=60,save=1 and valid workload options are needed." << std::endl;
+		return 1;
+	}
+
+	Workload workload(profile);
+
+	if (!workload.writeTrace(fileName, numOps))
+	{
+		std::cout << "Could not write " << fileName << "." << std::endl;
+		return 1;
+	}
+
+	std::cout << "Wrote " << numOps << " operation(s) to " << fileName << std::endl;
+
+	return 0;
+}
+
+// Name:   commandReplay(const vector<string>& args)
+// Desc:   Run a trace against a task file and print the count and the
+//         latency percentiles of each kind of operation, and the peak
+//         resident memory of the process.
+// Param:  args: The task file followed by the trace file.
+// Return: An integer exit code: 0 on success.
+int CommandLine::commandReplay(const std::vector<std::string>& args)
+{
+	static const double percentiles[] = { 50, 90, 99, 100 };
+
+	if (args.size() != 2)
+	{
+		std::cout << "A task file and a trace file are needed." << std::endl;
+		return 1;
+	}
+
+	TaskManager manager;
+	TraceReplay replay(manager, args[0]);
+
+	if (!replay.run(args[1]))
+	{
+		std::cout << replay.getError() << std::endl;
+		return 1;
+	}
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Loaded " << args[0] << " in " << replay.getLoadSeconds() * 1e3 << " ms, ran the trace in "
+		<< replay.getTotalSeconds() * 1e3 << " ms, " << manager.getNumTasks() << " task(s) left" << std::endl;
+	std::cout << "Operation      Count     p50 us     p90 us     p99 us     Max us" << std::endl;
+
+	for (int op = 0; op < TRACE_OPS::NUM_TRACE_OPS; op++)
+	{
+		std::cout << std::left << std::setw(9) << Workload::getOpName((TRACE_OPS)op) << std::right << std::setw(11) << replay.getNumOps((TRACE_OPS)op);
+
+		for (double percentile : percentiles)
+			std::cout << std::setw(11) << replay.getPercentile((TRACE_OPS)op, percentile) * 1e6;
+
+		std::cout << std::endl;
+	}
+
+	if (replay.getNumSkipped())
+		std::cout << replay.getNumSkipped() << " complete(s) and delete(s) were skipped on an empty list." << std::endl;
+
+	std::cout << "Peak resident memory: " << TraceReplay::getPeakResidentBytes() / 1e6 << " MB" << std::endl;
+
+	return 0;
+}
+
+// Name:   parseWorkloadOption(const vector<string>& args, size_t& argNum, WorkloadProfile& profile)
+// Desc:   Read an option that shapes a generated list or the tasks a
+//         trace adds. Invalid values leave the profile so the caller
+//         refuses it: a negative start date, or the default for the rest.
+// Param:  args: The arguments.
+//         argNum: The index of the option, moved past its value.
+//         profile: The profile the option is set in.
+// Return: A boolean: False if the argument is not a workload option.
+bool CommandLine::parseWorkloadOption(const std::vector<std::string>& args, size_t& argNum, WorkloadProfile& profile)
+{
+	if (argNum + 1 >= args.size())
+		return false;
+
+	const std::string& option = args[argNum];
+	std::string value = args[argNum + 1];
+
+	if (option == "--name-length")
+	{
+		const size_t dash = value.find('-');
+
+		profile.minNameLength = atoi(value.c_str());
+		profile.maxNameLength = dash == std::string::npos ? profile.minNameLength : atoi(value.c_str() + dash + 1);
+	}
+	else if (option == "--from")
+		profile.startSerial = Date(value).getSerial();
+	else if (option == "--days")
+		profile.numDays = atoi(value.c_str());
+	else if (option == "--dates")
+	{
+		if (!Workload::getDatesFromName(value, profile.dates))
+			profile.startSerial = -1;
+	}
+	else if (option == "--completed")
+		profile.completedShare = atof(value.c_str());
+	else if (option == "--completion")
+	{
+		if (!Workload::getCompletionFromName(value, profile.completion))
+			profile.startSerial = -1;
+	}
+	else if (option == "--seed")
+		profile.seed = (unsigned int)strtoul(value.c_str(), nullptr, 10);
+	else
+		return false;
+
+	argNum++;
+
+	return true;
+}
+
+// Name:   showLostRecords(const LoadReport& report, size_t maxShown)
+// Desc:   Print the lost records of a load or verification to stderr, so
+//         they never end up in an export to stdout.
+// Param:  report: The report to print.
+//         maxShown: The most runs of records to list.
+// Return: None
+void CommandLine::showLostRecords(const LoadReport& report, size_t maxShown)
+{
+	if (report.numLost == 0)
+		return;
+
+	std::cerr << report.numLost << " of " << report.numRecords << " records could not be read:" << std::endl;
+
+	for (size_t i = 0; i < report.lost.size() && i < maxShown; i++)
+		std::cerr << "    " << TaskManager::formatLostRecords(report.lost[i]) << std::endl;
+
+	if (report.lost.size() > maxShown)
+		std::cerr << "    ..." << std::endl;
+}
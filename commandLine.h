@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/*****************************************************************************
+# Description: The CommandLine class runs the program without the menu
+               when it is started with arguments.
+#****************************************************************************/
+
+struct LoadReport;
+struct WorkloadProfile;
+
+class CommandLine
+{
+public:
+	int run(int argc, char* argv[]);
+
+private:
+	void showUsage(const std::string& programName);
+
+	int commandBench(const std::vector<std::string>& args);
+	int commandDaemon(const std::vector<std::string>& args);
+	int commandClient(const std::vector<std::string>& args);
+	int commandList(const std::vector<std::string>& args);
+	int commandExport(const std::vector<std::string>& args);
+	int commandStore(const std::vector<std::string>& args);
+	int commandCompact(const std::vector<std::string>& args);
+	int commandVerify(const std::vector<std::string>& args);
+	int commandRemind(const std::vector<std::string>& args);
+	int commandGenerate(const std::vector<std::string>& args);
+	int commandTrace(const std::vector<std::string>& args);
+	int commandReplay(const std::vector<std::string>& args);
+	bool parseWorkloadOption(const std::vector<std::string>& args, size_t& argNum, WorkloadProfile& profile);
+	void showLostRecords(const LoadReport& report, size_t maxShown);
+};
@@ -1,5 +1,7 @@
 #include "consoleIO.h"
 #include <iomanip>
+#include <cstdlib>
+#include <cctype>
 
 int ConsoleIO::messageMargin = 0;
 
@@ -108,6 +110,43 @@ int ConsoleIO::getIntInput(const std::string& message, int minNumber, int maxNum
 	return choice;
 }
 
+// Name:   getMenuInput(const string& message, int minNumber, int maxNumber, const string& letters)
+// Desc:   Get a menu choice from the user: a number in a range or one of a
+//         few letters, ignoring case.
+// Param:  message: A string that holds a statement for the user.
+//         minNumber: An integer for the lowest value a number can be.
+//         maxNumber: An integer for the highest value a number can be.
+//         letters: The lowercase letters that can be chosen.
+// Return: The number that the user chose, or maxNumber + 1 plus the
+//         position of the letter in letters. maxNumber if the input ends.
+int ConsoleIO::getMenuInput(const std::string& message, int minNumber, int maxNumber, const std::string& letters)
+{
+	std::string choice;
+
+	displayMessage(message, false);
+
+	while (std::cin >> choice)
+	{
+		std::cin.ignore(100, '\n');
+
+		if (choice.size() == 1 && letters.find((char)tolower(choice[0])) != std::string::npos)
+			return maxNumber + 1 + (int)letters.find((char)tolower(choice[0]));
+
+		char* numberEnd = nullptr;
+		long number = strtol(choice.c_str(), &numberEnd, 10);
+
+		if (*numberEnd == '\0' && numberEnd != choice.c_str() && number >= minNumber && number <= maxNumber)
+			return (int)number;
+
+		displayMessage("Invalid Input!");
+		displayMessage(message, false);
+	}
+
+	std::cin.clear();
+
+	return maxNumber;
+}
+
 // Name:   getCharInput(const string& message, const char choices[], int numChoices)
 // Desc:   Get a char value from the user.
 // Param:  message: A string that holds a statement for the user.
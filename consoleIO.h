@@ -18,6 +18,7 @@ public:
 	int setTitle(const std::string& title, int spacesBefore = 0, char fillChar = '=');
 	void displayMessage(const std::string& message, bool useEndline = true, int numSpaces = messageMargin);
 	int getIntInput(const std::string& message, int minNumber, int maxNumber);
+	int getMenuInput(const std::string& message, int minNumber, int maxNumber, const std::string& letters);
 	char getCharInput(const std::string& message, const char choices[], int numChoices);
 
 	void setMessageMargin(int marginSize);
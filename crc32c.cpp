@@ -0,0 +1,280 @@
+#include "crc32c.h"
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define CRC32C_X86
+#endif
+
+// Name:   getBestKernel()
+// Desc:   Find the fastest kernel the processor supports.
+// Param:  None
+// Return: The kernel to use when none is chosen.
+CRC_KERNELS Crc32c::getBestKernel()
+{
+	static const CRC_KERNELS bestKernel = isKernelSupported(CRC_KERNELS::SSE42) ? CRC_KERNELS::SSE42 : CRC_KERNELS::SLICE_BY_8;
+
+	return bestKernel;
+}
+
+// Name:   isKernelSupported(CRC_KERNELS kernel)
+// Desc:   Check if the processor can run a kernel.
+// Param:  kernel: The kernel to check.
+// Return: A boolean: True if the kernel can be used.
+bool Crc32c::isKernelSupported(CRC_KERNELS kernel)
+{
+	switch (kernel)
+	{
+		case CRC_KERNELS::SLICE_BY_8:
+			return true;
+#ifdef CRC32C_X86
+		case CRC_KERNELS::SSE42:
+			return __builtin_cpu_supports("sse4.2");
+#endif
+		default:
+			return false;
+	}
+}
+
+// Name:   getKernelName(CRC_KERNELS kernel)
+// Desc:   Retrieve a display name for a kernel.
+// Param:  kernel: The kernel to name.
+// Return: A constant string with the name of the kernel.
+const char* Crc32c::getKernelName(CRC_KERNELS kernel)
+{
+	switch (kernel)
+	{
+		case CRC_KERNELS::SLICE_BY_8:
+			return "table";
+		case CRC_KERNELS::SSE42:
+			return "SSE4.2";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   compute(const void* data, size_t length, uint32_t crc, CRC_KERNELS kernel)
+// Desc:   Compute the checksum of a buffer, or continue the checksum of
+//         the data before it.
+// Param:  data: The bytes to check.
+//         length: The number of bytes.
+//         crc: The checksum of the data before the buffer, 0 to start.
+//         kernel: The kernel to use, the best one if it is not supported.
+// Return: The checksum of everything so far.
+uint32_t Crc32c::compute(const void* data, size_t length, uint32_t crc, CRC_KERNELS kernel)
+{
+	if (kernel == CRC_KERNELS::NUM_CRC_KERNELS || !isKernelSupported(kernel))
+		kernel = getBestKernel();
+
+	// The running state is the inverted checksum, so chained calls give the same result as one
+	if (kernel == CRC_KERNELS::SSE42)
+		return ~computeSse42((const uint8_t*)data, length, ~crc);
+
+	return ~computeTable((const uint8_t*)data, length, ~crc);
+}
+
+// Name:   getTables()
+// Desc:   Build the eight lookup tables of the table kernel the first
+//         time they are needed. Table k holds the state change of a byte
+//         followed by k zero bytes.
+// Param:  None
+// Return: A pointer to the 8 x 256 table entries.
+const uint32_t* Crc32c::getTables()
+{
+	static const struct Tables
+	{
+		Tables()
+		{
+			for (uint32_t byte = 0; byte < 256; byte++)
+			{
+				uint32_t state = byte;
+
+				for (int bit = 0; bit < 8; bit++)
+					state = (state >> 1) ^ (state & 1 ? polynomial : 0);
+
+				entries[0][byte] = state;
+			}
+
+			for (int table = 1; table < 8; table++)
+			{
+				for (uint32_t byte = 0; byte < 256; byte++)
+					entries[table][byte] = (entries[table - 1][byte] >> 8) ^ entries[0][entries[table - 1][byte] & 0xff];
+			}
+		}
+
+		uint32_t entries[8][256];
+	} tables;
+
+	return tables.entries[0];
+}
+
+// Name:   getShiftTables()
+// Desc:   Build the tables that move a checksum state over a long and a
+//         short part of zero bytes. Moving the state is linear, so only
+//         the 32 single bit states are run through the zero bytes and
+//         each table entry is the sum of the images of its bits.
+// Param:  None
+// Return: A pointer to the long part table followed by the short one.
+const Crc32c::ShiftTable* Crc32c::getShiftTables()
+{
+	static const struct ShiftTables
+	{
+		ShiftTables()
+		{
+			const size_t partLengths[2] = { longPart, shortPart };
+			const uint32_t* byteTable = getTables();
+
+			for (int part = 0; part < 2; part++)
+			{
+				uint32_t images[32];
+
+				for (int bit = 0; bit < 32; bit++)
+				{
+					uint32_t state = (uint32_t)1 << bit;
+
+					for (size_t i = 0; i < partLengths[part]; i++)
+						state = (state >> 8) ^ byteTable[state & 0xff];
+
+					images[bit] = state;
+				}
+
+				for (int byte = 0; byte < 4; byte++)
+				{
+					for (uint32_t value = 0; value < 256; value++)
+					{
+						uint32_t image = 0;
+
+						for (int bit = 0; bit < 8; bit++)
+							image ^= (value >> bit) & 1 ? images[byte * 8 + bit] : 0;
+
+						tables[part].entries[byte][value] = image;
+					}
+				}
+			}
+		}
+
+		ShiftTable tables[2];
+	} shiftTables;
+
+	return shiftTables.tables;
+}
+
+// Name:   shift(const ShiftTable& table, uint32_t state)
+// Desc:   Move a checksum state over a part of zero bytes.
+// Param:  table: The shift table of the part length.
+//         state: The state to move.
+// Return: The state after the zero bytes.
+uint32_t Crc32c::shift(const ShiftTable& table, uint32_t state)
+{
+	return table.entries[0][state & 0xff] ^ table.entries[1][(state >> 8) & 0xff]
+		^ table.entries[2][(state >> 16) & 0xff] ^ table.entries[3][state >> 24];
+}
+
+// Name:   computeTable(const uint8_t* data, size_t length, uint32_t state)
+// Desc:   Update the checksum state with eight table lookups per 8 bytes.
+//         The bytes are read as a little endian word.
+// Param:  data: The bytes to check.
+//         length: The number of bytes.
+//         state: The inverted checksum so far.
+// Return: The new state.
+uint32_t Crc32c::computeTable(const uint8_t* data, size_t length, uint32_t state)
+{
+	const uint32_t* tables = getTables();
+
+	while (length >= 8)
+	{
+		uint64_t word = 0;
+		memcpy(&word, data, 8);
+		word ^= state;
+
+		state = tables[7 * 256 + (word & 0xff)] ^ tables[6 * 256 + ((word >> 8) & 0xff)]
+			^ tables[5 * 256 + ((word >> 16) & 0xff)] ^ tables[4 * 256 + ((word >> 24) & 0xff)]
+			^ tables[3 * 256 + ((word >> 32) & 0xff)] ^ tables[2 * 256 + ((word >> 40) & 0xff)]
+			^ tables[1 * 256 + ((word >> 48) & 0xff)] ^ tables[(word >> 56) & 0xff];
+
+		data += 8;
+		length -= 8;
+	}
+
+	while (length--)
+		state = (state >> 8) ^ tables[(state ^ *data++) & 0xff];
+
+	return state;
+}
+
+#ifdef CRC32C_X86
+
+// Name:   computeSse42(const uint8_t* data, size_t length, uint32_t state)
+// Desc:   Update the checksum state with the crc32 instruction, 8 bytes at
+//         a time. Only this function is compiled for SSE4.2, it is called
+//         after the processor was checked for it.
+// Param:  See computeTable.
+// Return: The new state.
+__attribute__((target("sse4.2")))
+uint32_t Crc32c::computeSse42(const uint8_t* data, size_t length, uint32_t state)
+{
+	const ShiftTable* shiftTables = getShiftTables();
+	const size_t partLengths[2] = { longPart, shortPart };
+	uint64_t wideState = state;
+
+	// Each crc32 takes three cycles, but three independent ones finish in about the same time
+	for (int part = 0; part < 2; part++)
+	{
+		const size_t partLength = partLengths[part];
+
+		while (length >= partLength * 3)
+		{
+			uint64_t secondState = 0;
+			uint64_t thirdState = 0;
+
+			for (size_t i = 0; i < partLength; i += 8)
+			{
+				uint64_t words[3];
+				memcpy(&words[0], data + i, 8);
+				memcpy(&words[1], data + partLength + i, 8);
+				memcpy(&words[2], data + partLength * 2 + i, 8);
+
+				wideState = _mm_crc32_u64(wideState, words[0]);
+				secondState = _mm_crc32_u64(secondState, words[1]);
+				thirdState = _mm_crc32_u64(thirdState, words[2]);
+			}
+
+			// The state of a whole is the state of the front moved over the back, plus the back from zero
+			wideState = shift(shiftTables[part], (uint32_t)wideState) ^ secondState;
+			wideState = shift(shiftTables[part], (uint32_t)wideState) ^ thirdState;
+
+			data += partLength * 3;
+			length -= partLength * 3;
+		}
+	}
+
+	while (length >= 8)
+	{
+		uint64_t word = 0;
+		memcpy(&word, data, 8);
+		wideState = _mm_crc32_u64(wideState, word);
+
+		data += 8;
+		length -= 8;
+	}
+
+	state = (uint32_t)wideState;
+
+	while (length--)
+		state = _mm_crc32_u8(state, *data++);
+
+	return state;
+}
+
+#else
+
+// Name:   computeSse42(...)
+// Desc:   Not available on this processor, isKernelSupported() is false.
+// Param:  See computeTable.
+// Return: The new state.
+uint32_t Crc32c::computeSse42(const uint8_t* data, size_t length, uint32_t state)
+{
+	return computeTable(data, length, state);
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: An enum of the kernels that can compute a checksum.
+               The Crc32c class computes CRC-32C (Castagnoli) checksums of
+			   the blocks of task files. The SSE4.2 kernel uses the crc32
+			   instruction on 8 bytes at a time when the processor has
+			   it, on three parts of the buffer at once so the latency of
+			   the instruction is hidden, and the three checksums are
+			   combined with tables that shift a checksum over a part.
+			   The table kernel reads 8 bytes at a time from eight lookup
+			   tables on any processor. Both give the same result.
+#****************************************************************************/
+
+enum CRC_KERNELS { SLICE_BY_8, SSE42, NUM_CRC_KERNELS };
+
+class Crc32c
+{
+public:
+	static CRC_KERNELS getBestKernel();
+	static bool isKernelSupported(CRC_KERNELS kernel);
+	static const char* getKernelName(CRC_KERNELS kernel);
+
+	static uint32_t compute(const void* data, size_t length, uint32_t crc = 0, CRC_KERNELS kernel = NUM_CRC_KERNELS);
+
+private:
+	static const uint32_t polynomial = 0x82f63b78;
+
+	// The lengths of the parts the SSE4.2 kernel checks three at a time
+	static const size_t longPart = 8192;
+	static const size_t shortPart = 256;
+
+	struct ShiftTable
+	{
+		uint32_t entries[4][256];
+	};
+
+	static const uint32_t* getTables();
+	static const ShiftTable* getShiftTables();
+	static uint32_t shift(const ShiftTable& table, uint32_t state);
+	static uint32_t computeTable(const uint8_t* data, size_t length, uint32_t state);
+	static uint32_t computeSse42(const uint8_t* data, size_t length, uint32_t state);
+};
@@ -1,36 +1,11 @@
 #include "date.h"
 #include <regex>
+#include <ctime>
 
-
-// Name:   Date()
-// Desc:   Default constructor.
-// Param:  None
-// Return: None
-Date::Date()
-	: month(0), day(0), year(0)
-{
-
-}
-
-// Name:   Date(int month, int day, int year)
-// Desc:   Constructor that takes in separate integers
-//         for month, day, and year.
-// Param:  month: An integer representing the month.
-//         day:   An integer representing the day.
-//         year:  An integer representing the year.
-// Return: None
-Date::Date(int month, int day, int year)
-	: month(month), day(day), year(year)
-{
-	if (month < 1 || month > 12)
-		month = 0;
-
-	if (day < 1 || day > 31)
-		day = 0;
-
-	if (year < 1970)
-		year = 0;
-}
+// The arithmetic is constexpr, so check a few known dates at compile time
+static_assert(Date(1, 1, 1970).getSerial() == 0 && Date::fromSerial(19723).getYear() == 2024, "serial dates");
+static_assert(Date(1, 31, 2024).addMonths(1).getDay() == 29 && Date(3, 1, 2024).addDays(-1).getDay() == 29, "date arithmetic");
+static_assert(Date(1, 1, 2021).getWeekday() == 5 && Date(1, 1, 2021).getIsoWeek() == 53 && Date(1, 1, 2021).getIsoWeekYear() == 2020, "ISO weeks");
 
 // Name:   Date(string& date)
 // Desc:   Constructor that takes in a string for the date.
@@ -52,6 +27,19 @@ Date::Date(std::string& date)
 	}
 }
 
+// Name:   today()
+// Desc:   Creates a date for the current day in the local time zone.
+// Param:  None
+// Return: The date of today.
+Date Date::today()
+{
+	std::time_t now = std::time(nullptr);
+	std::tm local;
+	localtime_r(&now, &local);
+
+	return Date(local.tm_mon + 1, local.tm_mday, local.tm_year + 1900);
+}
+
 // Name:   setMonth(int month)
 // Desc:   Sets a value for the month member.
 // Param:  month: An integer representing the month.
@@ -94,33 +82,6 @@ bool Date::setYear(int year)
 	return true;
 }
 
-// Name:   getMonth()
-// Desc:   Retrieves the value for the month member.
-// Param:  None
-// Return: month: An integer representing the month.
-const int Date::getMonth() const
-{
-	return month;
-}
-
-// Name:   getDay()
-// Desc:   Retrieves the value for the day member.
-// Param:  None
-// Return: day: An integer representing the day.
-const int Date::getDay() const
-{
-	return day;
-}
-
-// Name:   getYear()
-// Desc:   Retrieves the value for the year member.
-// Param:  None
-// Return: year: An integer representing the year.
-const int Date::getYear() const
-{
-	return year;
-}
-
 // Name:   validateDate(string& date)
 // Desc:   Validates a string's format to make sure it is correct for a
 //         date. The string can be modified if it is only missing a 0
@@ -2,28 +2,277 @@
 #include <string>
 
 /*****************************************************************************
-# Description: Custom class for handling dates.
+# Description: Custom class for handling dates. The arithmetic works on
+               serial day numbers and is constexpr, so it is defined in
+			   this header and can be folded at compile time.
 #****************************************************************************/
 
 class Date
 {
 public:
 	static bool validateDate(std::string& date);
+	static constexpr Date fromSerial(int serial);
+	static constexpr bool isLeapYear(int year);
+	static constexpr int getDaysInMonth(int month, int year);
+	static constexpr bool isValidDate(long month, long day, long year);
+	static Date today();
 
-	Date();
-	Date(int month, int day, int year);
+	constexpr Date();
+	constexpr Date(int month, int day, int year);
 	Date(std::string& date);
 
 	bool setMonth(int month);
 	bool setDay(int day);
 	bool setYear(int year);
 
-	const int getMonth() const;
-	const int getDay() const;
-	const int getYear() const;
-		
+	constexpr int getMonth() const;
+	constexpr int getDay() const;
+	constexpr int getYear() const;
+	constexpr int getSerial() const;
+
+	constexpr Date addDays(int days) const;
+	constexpr Date addMonths(int months) const;
+	constexpr int daysUntil(const Date& other) const;
+	constexpr int getWeekday() const;
+	constexpr int getWeekStart() const;
+	constexpr int getIsoWeek() const;
+	constexpr int getIsoWeekYear() const;
+
 private:
 	int month;
 	int day;
 	int year;
 };
+
+// Name:   Date()
+// Desc:   Default constructor.
+// Param:  None
+// Return: None
+constexpr Date::Date()
+	: month(0), day(0), year(0)
+{
+
+}
+
+// Name:   Date(int month, int day, int year)
+// Desc:   Constructor that takes in separate integers
+//         for month, day, and year.
+// Param:  month: An integer representing the month.
+//         day:   An integer representing the day.
+//         year:  An integer representing the year.
+// Return: None
+constexpr Date::Date(int month, int day, int year)
+	: month(month), day(day), year(year)
+{
+	if (month < 1 || month > 12)
+		month = 0;
+
+	if (day < 1 || day > 31)
+		day = 0;
+
+	if (year < 1970)
+		year = 0;
+}
+
+// Name:   getMonth()
+// Desc:   Retrieves the value for the month member.
+// Param:  None
+// Return: month: An integer representing the month.
+constexpr int Date::getMonth() const
+{
+	return month;
+}
+
+// Name:   getDay()
+// Desc:   Retrieves the value for the day member.
+// Param:  None
+// Return: day: An integer representing the day.
+constexpr int Date::getDay() const
+{
+	return day;
+}
+
+// Name:   getYear()
+// Desc:   Retrieves the value for the year member.
+// Param:  None
+// Return: year: An integer representing the year.
+constexpr int Date::getYear() const
+{
+	return year;
+}
+
+// Name:   getSerial()
+// Desc:   Converts the date into a serial day number so dates can be
+//         compared and sorted with a single integer comparison.
+// Param:  None
+// Return: The number of days since 01/01/1970, or -1 if the date is not set.
+constexpr int Date::getSerial() const
+{
+	if (month == 0 || day == 0 || year == 0)
+		return -1;
+
+	// Shift the year so it starts in March, leap days then fall at the end
+	const int shiftedYear = year - (month <= 2 ? 1 : 0);
+	const int era = shiftedYear / 400;
+	const int yearOfEra = shiftedYear - era * 400;
+	const int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+	return era * 146097 + dayOfEra - 719468;
+}
+
+// Name:   fromSerial(int serial)
+// Desc:   Creates a date from a serial day number.
+// Param:  serial: The number of days since 01/01/1970.
+// Return: The date for the serial, or an unset date if the serial is negative.
+constexpr Date Date::fromSerial(int serial)
+{
+	if (serial < 0)
+		return Date();
+
+	const int shiftedSerial = serial + 719468;
+	const int era = shiftedSerial / 146097;
+	const int dayOfEra = shiftedSerial - era * 146097;
+	const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	const int shiftedMonth = (5 * dayOfYear + 2) / 153;
+	const int day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+	const int month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+
+	return Date(month, day, yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+// Name:   isLeapYear(int year)
+// Desc:   Check if a year has a 29th of February.
+// Param:  year: An integer representing the year.
+// Return: boolean: true if the year is a leap year, false if not.
+constexpr bool Date::isLeapYear(int year)
+{
+	return (year % 100 != 0 && year % 4 == 0) || year % 400 == 0;
+}
+
+// Name:   getDaysInMonth(int month, int year)
+// Desc:   Retrieve the number of days in a month.
+// Param:  month: An integer representing the month.
+//         year: An integer representing the year, used for leap years.
+// Return: The number of days in the month, or 0 if the month is not valid.
+constexpr int Date::getDaysInMonth(int month, int year)
+{
+	constexpr int daysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+	if (month < 1 || month > 12)
+		return 0;
+
+	if (month == 2 && isLeapYear(year))
+		return 29;
+
+	return daysInMonth[month - 1];
+}
+
+// Name:   isValidDate(long month, long day, long year)
+// Desc:   Check that a month, day and year read from text name a day of
+//         the calendar that a date keeps as it is, from 01/01/1970 to
+//         12/31/9999. Any other date would be changed by its serial.
+// Param:  month: The month that was read.
+//         day: The day that was read.
+//         year: The year that was read.
+// Return: boolean: true if the date is valid, false if not.
+constexpr bool Date::isValidDate(long month, long day, long year)
+{
+	return month >= 1 && month <= 12 && year >= 1970 && year <= 9999 && day >= 1 && day <= getDaysInMonth(month, year);
+}
+
+// Name:   addDays(int days)
+// Desc:   Move the date forward or back by a number of days.
+// Param:  days: The number of days to add, negative to subtract.
+// Return: The new date, or an unset date if this date is not set or
+//         the result is before 01/01/1970.
+constexpr Date Date::addDays(int days) const
+{
+	const int serial = getSerial();
+
+	return serial < 0 ? Date() : fromSerial(serial + days);
+}
+
+// Name:   addMonths(int months)
+// Desc:   Move the date forward or back by a number of months. A day
+//         past the end of the new month is moved to its last day.
+// Param:  months: The number of months to add, negative to subtract.
+// Return: The new date, or an unset date if this date is not set or
+//         the result is before 01/01/1970.
+constexpr Date Date::addMonths(int months) const
+{
+	if (getSerial() < 0)
+		return Date();
+
+	const int monthCount = year * 12 + month - 1 + months;
+	const int newYear = monthCount / 12;
+	const int newMonth = monthCount % 12 + 1;
+
+	if (monthCount < 1970 * 12)
+		return Date();
+
+	return Date(newMonth, day < getDaysInMonth(newMonth, newYear) ? day : getDaysInMonth(newMonth, newYear), newYear);
+}
+
+// Name:   daysUntil(const Date& other)
+// Desc:   Count the days from this date to another date.
+// Param:  other: The date to count to.
+// Return: The number of days, negative if other is before this date.
+constexpr int Date::daysUntil(const Date& other) const
+{
+	return other.getSerial() - getSerial();
+}
+
+// Name:   getWeekday()
+// Desc:   Retrieve the day of the week.
+// Param:  None
+// Return: The ISO day of the week: 1 for Monday through 7 for Sunday,
+//         or 0 if the date is not set.
+constexpr int Date::getWeekday() const
+{
+	const int serial = getSerial();
+
+	// 01/01/1970 was a Thursday
+	return serial < 0 ? 0 : (serial + 3) % 7 + 1;
+}
+
+// Name:   getWeekStart()
+// Desc:   Retrieve the Monday of the week the date is in. Tasks with the
+//         same week start are due in the same week.
+// Param:  None
+// Return: The serial date of the Monday, or -1 if the date is not set.
+//         The first days of 1970 give the Monday before, -3.
+constexpr int Date::getWeekStart() const
+{
+	const int serial = getSerial();
+
+	return serial < 0 ? -1 : serial - (serial + 3) % 7;
+}
+
+// Name:   getIsoWeek()
+// Desc:   Retrieve the ISO 8601 week number. Week 1 is the week with the
+//         first Thursday of the year in it.
+// Param:  None
+// Return: The week number from 1 to 53, or 0 if the date is not set.
+constexpr int Date::getIsoWeek() const
+{
+	if (getSerial() < 0)
+		return 0;
+
+	// The Thursday of the week decides which year the week belongs to
+	const int thursday = getWeekStart() + 3;
+	const int firstDay = Date(1, 1, fromSerial(thursday).getYear()).getSerial();
+
+	return (thursday - firstDay) / 7 + 1;
+}
+
+// Name:   getIsoWeekYear()
+// Desc:   Retrieve the year the ISO 8601 week number belongs to, which can
+//         differ from the year around New Year's Day.
+// Param:  None
+// Return: The week year, or 0 if the date is not set.
+constexpr int Date::getIsoWeekYear() const
+{
+	return getSerial() < 0 ? 0 : fromSerial(getWeekStart() + 3).getYear();
+}
@@ -0,0 +1,316 @@
+#include "dedupEngine.h"
+#include "taskManager.h"
+#include <cctype>
+
+namespace
+{
+	// Marks a slot whose task was removed so probing continues past it
+	const Node* const erasedSlot = reinterpret_cast<const Node*>(&erasedSlot);
+}
+
+// Name:   getPolicyName(DEDUP_POLICIES policy)
+// Desc:   Retrieve a display name for a duplicate policy.
+// Param:  policy: The policy to name.
+// Return: A constant string with the name of the policy.
+const char* DedupEngine::getPolicyName(DEDUP_POLICIES policy)
+{
+	switch (policy)
+	{
+		case DEDUP_POLICIES::KEEP_ALL:
+			return "Keep All";
+		case DEDUP_POLICIES::SKIP_DUPLICATES:
+			return "Skip (Keep First)";
+		case DEDUP_POLICIES::REPLACE_DUPLICATES:
+			return "Replace (Keep Last)";
+		case DEDUP_POLICIES::MERGE_COMPLETION:
+			return "Merge Completion";
+		default:
+			return "Unknown";
+	}
+}
+
+// Name:   DedupEngine(DEDUP_POLICIES policy)
+// Desc:   Constructor that sets the policy for duplicates.
+// Param:  policy: What the task manager does with a duplicate task.
+// Return: None
+DedupEngine::DedupEngine(DEDUP_POLICIES policy)
+	: policy(policy), report{ 0, 0, 0, 0, {} }, numUsed(0), numErased(0)
+{
+}
+
+// Name:   reserve(size_t numTasks)
+// Desc:   Size the table for a number of tasks so it does not grow while
+//         they are added. The table is kept at most half full.
+// Param:  numTasks: The number of tasks that will be indexed.
+// Return: None
+void DedupEngine::reserve(size_t numTasks)
+{
+	size_t numSlots = 16;
+
+	while (numSlots < numTasks * 2)
+		numSlots *= 2;
+
+	if (numSlots <= slots.size())
+		return;
+
+	std::vector<Slot> oldSlots(numSlots, Slot{ 0, nullptr });
+	oldSlots.swap(slots);
+	numUsed = 0;
+	numErased = 0;
+
+	for (const Slot& slot : oldSlots)
+	{
+		if (slot.node && slot.node != erasedSlot)
+		{
+			slots[findSlot(slot.node->task.getName(), slot.node->task.getDueSerial(), slot.hash)] = slot;
+			numUsed++;
+		}
+	}
+}
+
+// Name:   clear()
+// Desc:   Remove every task from the table and reset the report.
+// Param:  None
+// Return: None
+void DedupEngine::clear()
+{
+	slots.clear();
+	numUsed = 0;
+	numErased = 0;
+	report = DedupReport{ 0, 0, 0, 0, {} };
+}
+
+// Name:   indexTasks(const TaskManager& manager)
+// Desc:   Add the tasks of a task manager to the table. Duplicates that
+//         are already in the list are counted but not changed.
+// Param:  manager: The task manager to index.
+// Return: None
+void DedupEngine::indexTasks(const TaskManager& manager)
+{
+	reserve(numUsed + manager.getNumTasks());
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		if (find(currNode->task.getName(), currNode->task.getDueDate()))
+			recordDuplicate(currNode->task.getName(), currNode->task.getDueDate());
+		else
+			insert(currNode);
+	}
+}
+
+// Name:   find(string_view name, const Date& dueDate)
+// Desc:   Find the task that has the same normalized name and due date.
+// Param:  name: A string that holds the task name.
+//         dueDate: The task's due date.
+// Return: A constant pointer to the matching node, or nullptr if there is none.
+const Node* DedupEngine::find(std::string_view name, const Date& dueDate) const
+{
+	if (slots.empty())
+		return nullptr;
+
+	const int serial = dueDate.getSerial();
+	const Node* node = slots[findSlot(name, serial, hashKey(name, serial))].node;
+
+	return node == erasedSlot ? nullptr : node;
+}
+
+// Name:   insert(const Node* node)
+// Desc:   Add a task to the table. A task with the same key is replaced.
+// Param:  node: The node of the task.
+// Return: None
+void DedupEngine::insert(const Node* node)
+{
+	if ((numUsed + numErased + 1) * 2 > slots.size())
+		grow();
+
+	const std::string_view name = node->task.getName();
+	const int serial = node->task.getDueSerial();
+	const uint64_t hash = hashKey(name, serial);
+	Slot& slot = slots[findSlot(name, serial, hash)];
+
+	if (!slot.node)
+		numUsed++;
+	else if (slot.node == erasedSlot)
+	{
+		numUsed++;
+		numErased--;
+	}
+
+	slot = Slot{ hash, node };
+}
+
+// Name:   erase(const Node* node)
+// Desc:   Remove a task from the table if it is the one stored for its key.
+// Param:  node: The node of the task.
+// Return: None
+void DedupEngine::erase(const Node* node)
+{
+	if (slots.empty())
+		return;
+
+	const std::string_view name = node->task.getName();
+	const int serial = node->task.getDueSerial();
+	Slot& slot = slots[findSlot(name, serial, hashKey(name, serial))];
+
+	if (slot.node == node)
+	{
+		slot.node = erasedSlot;
+		numUsed--;
+		numErased++;
+	}
+}
+
+// Name:   recordDuplicate(string_view name, const Date& dueDate)
+// Desc:   Count a duplicate and keep it as an example for the report.
+// Param:  name: A string that holds the task name.
+//         dueDate: The task's due date.
+// Return: None
+void DedupEngine::recordDuplicate(std::string_view name, const Date& dueDate)
+{
+	report.numDuplicates++;
+
+	if (report.examples.size() < DedupReport::maxExamples)
+	{
+		report.examples.push_back(std::string(name) + " | " + std::to_string(dueDate.getMonth()) + "/"
+			+ std::to_string(dueDate.getDay()) + "/" + std::to_string(dueDate.getYear()));
+	}
+}
+
+// Name:   getPolicy()
+// Desc:   Retrieve the policy for duplicates.
+// Param:  None
+// Return: The policy member.
+DEDUP_POLICIES DedupEngine::getPolicy() const
+{
+	return policy;
+}
+
+// Name:   getReport()
+// Desc:   Retrieve the duplicates found so far.
+// Param:  None
+// Return: A constant reference to the report.
+const DedupReport& DedupEngine::getReport() const
+{
+	return report;
+}
+
+// Name:   getMemoryUsage()
+// Desc:   Retrieve the memory used by the hash table.
+// Param:  None
+// Return: The size of the table in bytes.
+size_t DedupEngine::getMemoryUsage() const
+{
+	return slots.capacity() * sizeof(Slot);
+}
+
+// Name:   nextNameChar(string_view name, size_t& position)
+// Desc:   Read the next character of a name as it is after normalizing:
+//         leading and trailing whitespace is dropped, runs of whitespace
+//         become one space and letters are lower case. Names are compared
+//         and hashed this way without building a normalized copy.
+// Param:  name: The name to read from.
+//         position: The position to read at, moved past what was read.
+// Return: The next character, or -1 at the end of the name.
+int DedupEngine::nextNameChar(std::string_view name, size_t& position)
+{
+	const size_t length = name.length();
+
+	if (position == 0)
+	{
+		while (position < length && isspace((unsigned char)name[position]))
+			position++;
+	}
+
+	if (position >= length)
+		return -1;
+
+	if (isspace((unsigned char)name[position]))
+	{
+		while (position < length && isspace((unsigned char)name[position]))
+			position++;
+
+		return position < length ? ' ' : -1;
+	}
+
+	return tolower((unsigned char)name[position++]);
+}
+
+// Name:   hashKey(string_view name, int serial)
+// Desc:   Hash a normalized name and a serial date with FNV-1a and a final mix.
+// Param:  name: The task name.
+//         serial: The serial due date.
+// Return: The 64 bit hash.
+uint64_t DedupEngine::hashKey(std::string_view name, int serial)
+{
+	uint64_t hash = 14695981039346656037ull;
+	size_t position = 0;
+
+	for (int nameChar = nextNameChar(name, position); nameChar >= 0; nameChar = nextNameChar(name, position))
+		hash = (hash ^ (uint64_t)nameChar) * 1099511628211ull;
+
+	hash ^= (uint64_t)(uint32_t)serial * 0x9e3779b97f4a7c15ull;
+	hash ^= hash >> 31;
+	hash *= 0xbf58476d1ce4e5b9ull;
+	hash ^= hash >> 29;
+
+	return hash;
+}
+
+// Name:   sameName(string_view left, string_view right)
+// Desc:   Compare two names after normalizing them.
+// Param:  left: The first name.
+//         right: The second name.
+// Return: A boolean: True if the names are the same.
+bool DedupEngine::sameName(std::string_view left, std::string_view right)
+{
+	size_t leftPosition = 0;
+	size_t rightPosition = 0;
+
+	while (true)
+	{
+		const int leftChar = nextNameChar(left, leftPosition);
+		const int rightChar = nextNameChar(right, rightPosition);
+
+		if (leftChar != rightChar)
+			return false;
+		if (leftChar < 0)
+			return true;
+	}
+}
+
+// Name:   findSlot(string_view name, int serial, uint64_t hash)
+// Desc:   Probe the table for a key with linear probing.
+// Param:  name: The task name.
+//         serial: The serial due date.
+//         hash: The hash of the name and date.
+// Return: The slot holding the key, or the slot where it should be inserted.
+size_t DedupEngine::findSlot(std::string_view name, int serial, uint64_t hash) const
+{
+	const size_t mask = slots.size() - 1;
+	size_t firstErased = slots.size();
+
+	for (size_t index = hash & mask;; index = (index + 1) & mask)
+	{
+		const Slot& slot = slots[index];
+
+		if (!slot.node)
+			return firstErased < slots.size() ? firstErased : index;
+
+		if (slot.node == erasedSlot)
+		{
+			if (firstErased == slots.size())
+				firstErased = index;
+		}
+		else if (slot.hash == hash && slot.node->task.getDueSerial() == serial && sameName(slot.node->task.getName(), name))
+			return index;
+	}
+}
+
+// Name:   grow()
+// Desc:   Double the size of the table and drop the removed slots.
+// Param:  None
+// Return: None
+void DedupEngine::grow()
+{
+	reserve(slots.empty() ? 8 : slots.size());
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "date.h"
+
+/*****************************************************************************
+# Description: An enum of what to do with a task that duplicates one that
+               is already in the list (same name and due date).
+			   The DedupEngine class finds duplicates in linear time with
+			   an open addressing hash table keyed by the normalized name
+			   (trimmed, lower case, single spaces) and the serial date.
+			   The table stores a hash and a node pointer per task.
+#****************************************************************************/
+
+enum DEDUP_POLICIES { KEEP_ALL, SKIP_DUPLICATES, REPLACE_DUPLICATES, MERGE_COMPLETION };
+
+struct Node;
+class TaskManager;
+
+struct DedupReport
+{
+	static const size_t maxExamples = 10;
+
+	int numDuplicates;
+	int numSkipped;
+	int numReplaced;
+	int numMerged;
+	std::vector<std::string> examples;
+};
+
+class DedupEngine
+{
+public:
+	static const char* getPolicyName(DEDUP_POLICIES policy);
+
+	DedupEngine(DEDUP_POLICIES policy = DEDUP_POLICIES::KEEP_ALL);
+
+	void reserve(size_t numTasks);
+	void clear();
+	void indexTasks(const TaskManager& manager);
+
+	const Node* find(std::string_view name, const Date& dueDate) const;
+	void insert(const Node* node);
+	void erase(const Node* node);
+	void recordDuplicate(std::string_view name, const Date& dueDate);
+
+	DEDUP_POLICIES getPolicy() const;
+	const DedupReport& getReport() const;
+	size_t getMemoryUsage() const;
+
+private:
+	struct Slot
+	{
+		uint64_t hash;
+		const Node* node;
+	};
+
+	static int nextNameChar(std::string_view name, size_t& position);
+	static uint64_t hashKey(std::string_view name, int serial);
+	static bool sameName(std::string_view left, std::string_view right);
+
+	size_t findSlot(std::string_view name, int serial, uint64_t hash) const;
+	void grow();
+
+	DEDUP_POLICIES policy;
+	DedupReport report;
+	std::vector<Slot> slots;
+	size_t numUsed;
+	size_t numErased;
+};
@@ -0,0 +1,416 @@
+#include "dueColumns.h"
+#include <algorithm>
+#include <climits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DUE_COLUMNS_X86
+#endif
+
+// Name:   getBestKernel()
+// Desc:   Find the fastest kernel the processor supports.
+// Param:  None
+// Return: The kernel to use when none is chosen.
+DUE_KERNELS DueColumns::getBestKernel()
+{
+	static const DUE_KERNELS bestKernel = isKernelSupported(DUE_KERNELS::AVX2) ? DUE_KERNELS::AVX2
+		: isKernelSupported(DUE_KERNELS::SSE2) ? DUE_KERNELS::SSE2 : DUE_KERNELS::SCALAR;
+
+	return bestKernel;
+}
+
+// Name:   isKernelSupported(DUE_KERNELS kernel)
+// Desc:   Check if the processor can run a kernel.
+// Param:  kernel: The kernel to check.
+// Return: A boolean: True if the kernel can be used.
+bool DueColumns::isKernelSupported(DUE_KERNELS kernel)
+{
+	switch (kernel)
+	{
+		case DUE_KERNELS::SCALAR:
+			return true;
+#ifdef DUE_COLUMNS_X86
+		case DUE_KERNELS::SSE2:
+			return __builtin_cpu_supports("sse2");
+		case DUE_KERNELS::AVX2:
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+	}
+}
+
+// Name:   getKernelName(DUE_KERNELS kernel)
+// Desc:   Retrieve a display name for a kernel.
+// Param:  kernel: The kernel to name.
+// Return: A constant string with the name of the kernel.
+const char* DueColumns::getKernelName(DUE_KERNELS kernel)
+{
+	switch (kernel)
+	{
+		case DUE_KERNELS::SCALAR:
+			return "scalar";
+		case DUE_KERNELS::SSE2:
+			return "SSE2";
+		case DUE_KERNELS::AVX2:
+			return "AVX2";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   DueColumns()
+// Desc:   Default constructor for empty columns.
+// Param:  None
+// Return: None
+DueColumns::DueColumns()
+	: numSlots(0), numErased(0)
+{
+}
+
+// Name:   clear()
+// Desc:   Remove every task from the columns.
+// Param:  None
+// Return: None
+void DueColumns::clear()
+{
+	serials.clear();
+	completedWords.clear();
+	usedWords.clear();
+	numSlots = 0;
+	numErased = 0;
+}
+
+// Name:   reserve(size_t numTasks)
+// Desc:   Make room for a number of tasks.
+// Param:  numTasks: The number of tasks to make room for.
+// Return: None
+void DueColumns::reserve(size_t numTasks)
+{
+	const size_t numWords = (numTasks + 63) / 64;
+
+	serials.reserve(numWords * 64);
+	completedWords.reserve(numWords);
+	usedWords.reserve(numWords);
+}
+
+// Name:   append(int serial, bool completed)
+// Desc:   Add a task to the end of the columns. The serial column always
+//         holds whole words of 64 tasks, unused slots are never counted.
+// Param:  serial: The serial due date of the task.
+//         completed: A boolean that is true if the task is completed.
+// Return: The slot of the task.
+uint32_t DueColumns::append(int serial, bool completed)
+{
+	const uint32_t slot = numSlots++;
+
+	if (slot % 64 == 0)
+	{
+		serials.resize(serials.size() + 64, 0);
+		completedWords.push_back(0);
+		usedWords.push_back(0);
+	}
+
+	serials[slot] = serial;
+	usedWords[slot / 64] |= (uint64_t)1 << (slot % 64);
+
+	if (completed)
+		completedWords[slot / 64] |= (uint64_t)1 << (slot % 64);
+
+	return slot;
+}
+
+// Name:   insert(uint32_t slot, int serial, bool completed)
+// Desc:   Add a task in a free slot, or past the end of the columns. The
+//         slots skipped at the end are left free.
+// Param:  slot: The slot for the task, chosen by the owner.
+//         serial: The serial due date of the task.
+//         completed: A boolean that is true if the task is completed.
+// Return: None
+void DueColumns::insert(uint32_t slot, int serial, bool completed)
+{
+	if (slot >= numSlots)
+	{
+		const size_t numWords = slot / 64 + 1;
+
+		serials.resize(numWords * 64, 0);
+		completedWords.resize(numWords, 0);
+		usedWords.resize(numWords, 0);
+		numErased += slot - numSlots;
+		numSlots = slot + 1;
+	}
+	else
+		numErased--;
+
+	serials[slot] = serial;
+	usedWords[slot / 64] |= (uint64_t)1 << (slot % 64);
+
+	if (completed)
+		completedWords[slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+// Name:   setCompleted(uint32_t slot)
+// Desc:   Mark the task in a slot as completed.
+// Param:  slot: The slot of the task.
+// Return: None
+void DueColumns::setCompleted(uint32_t slot)
+{
+	completedWords[slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+// Name:   clearCompleted(uint32_t slot)
+// Desc:   Mark the task in a slot as not completed.
+// Param:  slot: The slot of the task.
+// Return: None
+void DueColumns::clearCompleted(uint32_t slot)
+{
+	completedWords[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+}
+
+// Name:   erase(uint32_t slot)
+// Desc:   Free the slot of a removed task.
+// Param:  slot: The slot of the task.
+// Return: None
+void DueColumns::erase(uint32_t slot)
+{
+	usedWords[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+	completedWords[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+	numErased++;
+}
+
+// Name:   getNumSlots()
+// Desc:   Retrieve the number of slots, including the freed ones.
+// Param:  None
+// Return: The number of slots.
+size_t DueColumns::getNumSlots() const
+{
+	return numSlots;
+}
+
+// Name:   getNumErased()
+// Desc:   Retrieve the number of freed slots.
+// Param:  None
+// Return: The number of slots of removed tasks.
+size_t DueColumns::getNumErased() const
+{
+	return numErased;
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the memory used by the columns, including their unused room.
+// Param:  None
+// Return: The number of bytes.
+size_t DueColumns::getMemoryUsed() const
+{
+	return serials.capacity() * sizeof(int32_t) + (completedWords.capacity() + usedWords.capacity()) * sizeof(uint64_t);
+}
+
+// Name:   getUsedWords(int completedState, vector<uint64_t>& words)
+// Desc:   Retrieve a bitmap of the slots in use, for other indexes over
+//         the same slots to be intersected with.
+// Param:  completedState: 0 for only incomplete tasks, 1 for only
+//         completed tasks, -1 for every task.
+//         words: Receives a bit per slot.
+// Return: None
+void DueColumns::getUsedWords(int completedState, std::vector<uint64_t>& words) const
+{
+	words.resize(usedWords.size());
+
+	for (size_t word = 0; word < usedWords.size(); word++)
+	{
+		if (completedState == 0)
+			words[word] = usedWords[word] & ~completedWords[word];
+		else if (completedState == 1)
+			words[word] = completedWords[word];
+		else
+			words[word] = usedWords[word];
+	}
+}
+
+// Name:   countRanges(const DueRange* ranges, size_t numRanges, bool incompleteOnly, uint64_t* counts,
+//                     vector<uint64_t>* bitmaps, DUE_KERNELS kernel)
+// Desc:   Count the tasks due in each of several ranges in one pass over
+//         the columns. Each chunk of the columns is matched against every
+//         range while it is still in the cache.
+// Param:  ranges: The inclusive ranges of serial dates, at most maxRanges.
+//         numRanges: The number of ranges.
+//         incompleteOnly: A boolean to only count incomplete tasks.
+//         counts: Receives the number of tasks in each range.
+//         bitmaps: An array of one vector per range that receives a bit per
+//                  slot for the tasks in the range, or nullptr.
+//         kernel: The kernel to use, the best supported one by default.
+// Return: None
+void DueColumns::countRanges(const DueRange* ranges, size_t numRanges, bool incompleteOnly, uint64_t* counts,
+	std::vector<uint64_t>* bitmaps, DUE_KERNELS kernel) const
+{
+	MatchChunk matchChunk = matchScalar;
+	const size_t numWords = usedWords.size();
+	uint64_t liveWords[wordsPerChunk];
+
+	if (kernel == DUE_KERNELS::NUM_KERNELS || !isKernelSupported(kernel))
+		kernel = getBestKernel();
+
+	if (kernel == DUE_KERNELS::SSE2)
+		matchChunk = matchSse2;
+	else if (kernel == DUE_KERNELS::AVX2)
+		matchChunk = matchAvx2;
+
+	numRanges = std::min(numRanges, maxRanges);
+	std::fill(counts, counts + numRanges, 0);
+
+	for (size_t range = 0; bitmaps && range < numRanges; range++)
+		bitmaps[range].assign(numWords, 0);
+
+	for (size_t chunkStart = 0; chunkStart < numWords; chunkStart += wordsPerChunk)
+	{
+		const size_t chunkWords = std::min(wordsPerChunk, numWords - chunkStart);
+
+		for (size_t word = 0; word < chunkWords; word++)
+			liveWords[word] = usedWords[chunkStart + word] & (incompleteOnly ? ~completedWords[chunkStart + word] : ~(uint64_t)0);
+
+		for (size_t range = 0; range < numRanges; range++)
+		{
+			if (ranges[range].lastSerial < ranges[range].firstSerial)
+				continue;
+
+			// A serial is in the range if its unsigned distance from the start is at most the length
+			const uint32_t firstSerial = (uint32_t)ranges[range].firstSerial;
+			const uint32_t rangeLength = (uint32_t)ranges[range].lastSerial - firstSerial;
+
+			counts[range] += matchChunk(&serials[chunkStart * 64], liveWords, chunkWords, firstSerial, rangeLength,
+				bitmaps ? &bitmaps[range][chunkStart] : nullptr);
+		}
+	}
+}
+
+// Name:   matchScalar(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+//                     uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+// Desc:   Match a chunk of the columns against a range one task at a time.
+// Param:  serials: The serial dates of the chunk, 64 per word.
+//         liveWords: A bit per task that may be counted.
+//         numWords: The number of words in the chunk.
+//         firstSerial: The first serial date of the range.
+//         rangeLength: The last serial date minus the first.
+//         bitmap: Receives a word of matches per word of the chunk, or nullptr.
+// Return: The number of matching tasks.
+uint64_t DueColumns::matchScalar(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+	uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+{
+	uint64_t count = 0;
+
+	for (size_t word = 0; word < numWords; word++)
+	{
+		const int32_t* wordSerials = serials + word * 64;
+		uint64_t matches = 0;
+
+		for (int i = 0; i < 64; i++)
+			matches |= (uint64_t)((uint32_t)wordSerials[i] - firstSerial <= rangeLength) << i;
+
+		matches &= liveWords[word];
+		count += __builtin_popcountll(matches);
+
+		if (bitmap)
+			bitmap[word] = matches;
+	}
+
+	return count;
+}
+
+#ifdef DUE_COLUMNS_X86
+
+// Name:   matchSse2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+//                   uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+// Desc:   Match a chunk of the columns against a range four tasks at a
+//         time. SSE2 only compares signed numbers, so both sides of the
+//         unsigned distance check have their sign bit flipped first.
+// Param:  See matchScalar.
+// Return: The number of matching tasks.
+uint64_t DueColumns::matchSse2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+	uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+{
+	const __m128i first = _mm_set1_epi32((int32_t)firstSerial);
+	const __m128i signBit = _mm_set1_epi32(INT_MIN);
+	const __m128i limit = _mm_set1_epi32((int32_t)(rangeLength ^ 0x80000000u));
+	uint64_t count = 0;
+
+	for (size_t word = 0; word < numWords; word++)
+	{
+		const __m128i* wordSerials = (const __m128i*)(serials + word * 64);
+		uint64_t outside = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			__m128i distance = _mm_xor_si128(_mm_sub_epi32(_mm_loadu_si128(wordSerials + i), first), signBit);
+			outside |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(distance, limit))) << (i * 4);
+		}
+
+		const uint64_t matches = ~outside & liveWords[word];
+		count += __builtin_popcountll(matches);
+
+		if (bitmap)
+			bitmap[word] = matches;
+	}
+
+	return count;
+}
+
+// Name:   matchAvx2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+//                   uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+// Desc:   Match a chunk of the columns against a range eight tasks at a
+//         time. Only this function is compiled for AVX2, it is called
+//         after the processor was checked for it.
+// Param:  See matchScalar.
+// Return: The number of matching tasks.
+__attribute__((target("avx2,popcnt")))
+uint64_t DueColumns::matchAvx2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+	uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+{
+	const __m256i first = _mm256_set1_epi32((int32_t)firstSerial);
+	const __m256i signBit = _mm256_set1_epi32(INT_MIN);
+	const __m256i limit = _mm256_set1_epi32((int32_t)(rangeLength ^ 0x80000000u));
+	uint64_t count = 0;
+
+	for (size_t word = 0; word < numWords; word++)
+	{
+		const __m256i* wordSerials = (const __m256i*)(serials + word * 64);
+		uint64_t outside = 0;
+
+		for (int i = 0; i < 8; i++)
+		{
+			__m256i distance = _mm256_xor_si256(_mm256_sub_epi32(_mm256_loadu_si256(wordSerials + i), first), signBit);
+			outside |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(distance, limit))) << (i * 8);
+		}
+
+		const uint64_t matches = ~outside & liveWords[word];
+		count += __builtin_popcountll(matches);
+
+		if (bitmap)
+			bitmap[word] = matches;
+	}
+
+	return count;
+}
+
+#else
+
+// Name:   matchSse2(...)
+// Desc:   Not available on this processor, isKernelSupported() is false.
+// Param:  See matchScalar.
+// Return: The number of matching tasks.
+uint64_t DueColumns::matchSse2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+	uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+{
+	return matchScalar(serials, liveWords, numWords, firstSerial, rangeLength, bitmap);
+}
+
+// Name:   matchAvx2(...)
+// Desc:   Not available on this processor, isKernelSupported() is false.
+// Param:  See matchScalar.
+// Return: The number of matching tasks.
+uint64_t DueColumns::matchAvx2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+	uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap)
+{
+	return matchScalar(serials, liveWords, numWords, firstSerial, rangeLength, bitmap);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: An enum of the kernels that can scan the due date column.
+               The DueRange structure is an inclusive range of serial dates.
+			   The DueColumns class keeps the due date and completed flag
+			   of every task in packed columns: one 32 bit serial date per
+			   task and one bit per task for completed and for in use.
+			   A scan counts the tasks due in several ranges at once, 64
+			   tasks at a time, with SSE2 or AVX2 when the processor has
+			   them. Erased tasks leave a free slot behind until the
+			   owner inserts another task in it.
+#****************************************************************************/
+
+enum DUE_KERNELS { SCALAR, SSE2, AVX2, NUM_KERNELS };
+
+struct DueRange
+{
+	int firstSerial;
+	int lastSerial;
+};
+
+class DueColumns
+{
+public:
+	static const size_t maxRanges = 16;
+
+	static DUE_KERNELS getBestKernel();
+	static bool isKernelSupported(DUE_KERNELS kernel);
+	static const char* getKernelName(DUE_KERNELS kernel);
+
+	DueColumns();
+
+	void clear();
+	void reserve(size_t numTasks);
+	uint32_t append(int serial, bool completed);
+	void insert(uint32_t slot, int serial, bool completed);
+	void setCompleted(uint32_t slot);
+	void clearCompleted(uint32_t slot);
+	void erase(uint32_t slot);
+
+	size_t getNumSlots() const;
+	size_t getNumErased() const;
+	size_t getMemoryUsed() const;
+	void getUsedWords(int completedState, std::vector<uint64_t>& words) const;
+
+	void countRanges(const DueRange* ranges, size_t numRanges, bool incompleteOnly, uint64_t* counts,
+		std::vector<uint64_t>* bitmaps = nullptr, DUE_KERNELS kernel = NUM_KERNELS) const;
+
+private:
+	// The columns are scanned in chunks that stay in the L1 cache while every range is matched
+	static const size_t wordsPerChunk = 64;
+
+	typedef uint64_t (*MatchChunk)(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+		uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap);
+
+	static uint64_t matchScalar(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+		uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap);
+	static uint64_t matchSse2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+		uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap);
+	static uint64_t matchAvx2(const int32_t* serials, const uint64_t* liveWords, size_t numWords,
+		uint32_t firstSerial, uint32_t rangeLength, uint64_t* bitmap);
+
+	std::vector<int32_t> serials;
+	std::vector<uint64_t> completedWords;
+	std::vector<uint64_t> usedWords;
+	size_t numSlots;
+	size_t numErased;
+};
@@ -0,0 +1,546 @@
+#include "fileWatcher.h"
+#include "taskArchive.h"
+#include "segmentStore.h"
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <algorithm>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <limits.h>
+
+// Name:   getModeName(SYNC_MODES mode)
+// Desc:   Retrieve a display name for the way a file was synced.
+// Param:  mode: The mode to name.
+// Return: A constant string with the name of the mode.
+const char* FileWatcher::getModeName(SYNC_MODES mode)
+{
+	switch (mode)
+	{
+		case SYNC_MODES::APPENDED:
+			return "appended";
+		case SYNC_MODES::DIFFED:
+			return "changed";
+		case SYNC_MODES::RELOADED:
+			return "reloaded";
+		case SYNC_MODES::SKIPPED:
+			return "rewritten";
+		default:
+			return "unchanged";
+	}
+}
+
+// Name:   FileWatcher()
+// Desc:   Default constructor that does not watch any file.
+// Param:  None
+// Return: None
+FileWatcher::FileWatcher()
+	: inotifyFd(-1), watchFd(-1), syncedSize(0), syncedInode(0), syncedTime(0), syncedSignature(0), numSyncedLines(0)
+{
+}
+
+// Name:   ~FileWatcher()
+// Desc:   Destructor that stops watching the file.
+// Param:  None
+// Return: None
+FileWatcher::~FileWatcher()
+{
+	stop();
+}
+
+// Name:   start(const string& fileName, const TaskManager& manager)
+// Desc:   Start watching a task file. The directory of the file is watched
+//         instead of the file itself so a program that saves by renaming
+//         a new file over the old one is noticed as well.
+// Param:  fileName: The name of the file to watch.
+//         manager: The task list, which has to match the file right now.
+// Return: A boolean: True if the file is being watched.
+bool FileWatcher::start(const std::string& fileName, const TaskManager& manager)
+{
+	stop();
+
+	size_t slash = fileName.rfind('/');
+	std::string directory = slash == std::string::npos ? "." : fileName.substr(0, slash + 1);
+
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0)
+		return false;
+
+	watchFd = inotify_add_watch(inotifyFd, directory.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_DELETE);
+	if (watchFd < 0)
+	{
+		stop();
+		return false;
+	}
+
+	this->fileName = fileName;
+	markSynced(manager);
+
+	return true;
+}
+
+// Name:   stop()
+// Desc:   Stop watching the file.
+// Param:  None
+// Return: None
+void FileWatcher::stop()
+{
+	if (inotifyFd >= 0)
+		close(inotifyFd);
+
+	inotifyFd = -1;
+	watchFd = -1;
+	syncedLines.clear();
+	numSyncedLines = 0;
+}
+
+// Name:   isWatching()
+// Desc:   Check if a file is being watched.
+// Param:  None
+// Return: A boolean: True if a file is being watched.
+bool FileWatcher::isWatching() const
+{
+	return inotifyFd >= 0;
+}
+
+// Name:   getFileName()
+// Desc:   Retrieve the name of the watched file.
+// Param:  None
+// Return: A constant string with the file name.
+const std::string& FileWatcher::getFileName() const
+{
+	return fileName;
+}
+
+// Name:   hasChanged()
+// Desc:   Read the pending inotify events without waiting and check if any
+//         of them are for the watched file.
+// Param:  None
+// Return: A boolean: True if the file may have changed since the last call.
+bool FileWatcher::hasChanged()
+{
+	if (inotifyFd < 0)
+		return false;
+
+	alignas(inotify_event) char buffer[sizeof(inotify_event) * 16 + NAME_MAX + 1];
+	size_t slash = fileName.rfind('/');
+	std::string baseName = slash == std::string::npos ? fileName : fileName.substr(slash + 1);
+	bool changed = false;
+	ssize_t length = 0;
+
+	while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+	{
+		for (char* position = buffer; position < buffer + length; )
+		{
+			const inotify_event* event = (const inotify_event*)position;
+
+			// An overflowed queue may have dropped an event for the file
+			if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && baseName == event->name))
+				changed = true;
+
+			position += sizeof(inotify_event) + event->len;
+		}
+	}
+
+	return changed;
+}
+
+// Name:   markSynced(const TaskManager& manager)
+// Desc:   Record that the task list matches the file, after it was loaded
+//         or saved. Only a hash and a count are kept for each distinct
+//         task line, the lines themselves are not.
+// Param:  manager: The task list.
+// Return: None
+void FileWatcher::markSynced(const TaskManager& manager)
+{
+	off_t size = 0;
+	ino_t inode = 0;
+	int64_t modifiedTime = 0;
+
+	syncedLines.clear();
+	numSyncedLines = 0;
+
+	// A compressed file or a store is always loaded again, so its lines are not needed
+	if (!TaskArchive::isArchiveName(fileName) && !SegmentStore::isStoreName(fileName))
+	{
+		syncedLines.reserve(manager.getNumTasks());
+
+		for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+			syncedLines[hashTask(currNode->task)]++;
+
+		numSyncedLines = manager.getNumTasks();
+	}
+
+	readFileState(size, inode, modifiedTime);
+	recordFileState(size, inode, modifiedTime);
+}
+
+// Name:   sync(TaskManager& manager, SyncReport& report, bool canReload)
+// Desc:   Bring the task list up to date with the file. A file that only
+//         grew is read from where the last sync ended. A file that was
+//         rewritten is compared to the last sync and a file that mostly
+//         changed, a compressed file or a store is loaded again.
+// Param:  manager: The task list to update.
+//         report: Receives how the list was updated, SKIPPED if the file
+//         had to be loaded again and that was not allowed.
+//         canReload: A boolean to allow replacing the list with the file,
+//         false while the list has edits that are not saved.
+// Return: A boolean: True if the file could be read.
+bool FileWatcher::sync(TaskManager& manager, SyncReport& report, bool canReload)
+{
+	off_t size = 0;
+	ino_t inode = 0;
+	int64_t modifiedTime = 0;
+
+	report = { SYNC_MODES::UNCHANGED, 0, 0, 0 };
+
+	if (!readFileState(size, inode, modifiedTime))
+		return false;
+
+	if (size == syncedSize && inode == syncedInode && modifiedTime == syncedTime)
+		return true;
+
+	if (!TaskArchive::isArchiveName(fileName) && !SegmentStore::isStoreName(fileName))
+	{
+		// The file only grew if the end of what was synced is still the same
+		if (inode == syncedInode && size > syncedSize && readSignature(syncedSize) == syncedSignature
+			&& syncAppended(manager, report))
+			return true;
+
+		if (syncDiffed(manager, report))
+			return true;
+	}
+
+	if (canReload)
+		reload(manager, report);
+	else
+		report.mode = SYNC_MODES::SKIPPED;
+
+	return true;
+}
+
+// Name:   makeTask(const TaskRecord& record)
+// Desc:   Create a task from a parsed line of a task file.
+// Param:  record: The parsed line.
+// Return: A Task object.
+Task FileWatcher::makeTask(const TaskRecord& record)
+{
+	Task task(record.name, record.dueDate, record.completed);
+
+	if (!record.recurrenceFields.empty())
+		task.setRecurrence(TaskManager::parseRecurrence(record.recurrenceFields));
+
+	task.setPriority(record.priority);
+	task.setTags(record.tags);
+
+	return task;
+}
+
+// Name:   hashTask(const Task& task)
+// Desc:   Hash a task the way it is written to a task file, so lines that
+//         are formatted differently but hold the same task match.
+// Param:  task: The task to hash.
+// Return: The hash of the task.
+uint64_t FileWatcher::hashTask(const Task& task)
+{
+	return std::hash<std::string>()(TaskManager::formatTaskLine(task));
+}
+
+// Name:   hashLine(const string& line, TaskRecord& record, uint64_t& hash)
+// Desc:   Parse and hash one line of a task file.
+// Param:  line: A string that holds the line without its newline.
+//         record: Receives the parsed line.
+//         hash: Receives the hash of the task.
+// Return: A boolean: True if the line holds a task.
+bool FileWatcher::hashLine(const std::string& line, TaskRecord& record, uint64_t& hash)
+{
+	if (line.empty() || !TaskManager::parseTaskLine(line, record))
+		return false;
+
+	hash = hashTask(makeTask(record));
+
+	return true;
+}
+
+// Name:   readFileState(off_t& size, ino_t& inode, int64_t& modifiedTime)
+// Desc:   Read the size, inode and modification time of the file.
+// Param:  size: Receives the size of the file in bytes.
+//         inode: Receives the inode number of the file.
+//         modifiedTime: Receives the modification time in nanoseconds.
+// Return: A boolean: True if the file exists.
+bool FileWatcher::readFileState(off_t& size, ino_t& inode, int64_t& modifiedTime) const
+{
+	struct stat status;
+
+	if (stat(fileName.c_str(), &status) != 0)
+		return false;
+
+	size = status.st_size;
+	inode = status.st_ino;
+	modifiedTime = (int64_t)status.st_mtim.tv_sec * 1000000000 + status.st_mtim.tv_nsec;
+
+	return true;
+}
+
+// Name:   readSignature(off_t size)
+// Desc:   Hash the bytes just before an offset in the file. If they still
+//         match the last sync, the file was appended to and not rewritten.
+// Param:  size: The offset the bytes end at.
+// Return: The hash of up to signatureLength bytes before the offset.
+uint64_t FileWatcher::readSignature(off_t size) const
+{
+	std::ifstream file(fileName, std::ios::binary);
+	off_t start = std::max((off_t)0, size - (off_t)signatureLength);
+	std::string bytes(size - start, '\0');
+
+	file.seekg(start);
+	file.read(&bytes[0], bytes.size());
+	bytes.resize(file.gcount());
+
+	return std::hash<std::string>()(bytes);
+}
+
+// Name:   syncAppended(TaskManager& manager, SyncReport& report)
+// Desc:   Add the tasks of the lines that were appended since the last sync.
+// Param:  manager: The task list to update.
+//         report: Receives the number of tasks that were added.
+// Return: A boolean: False if the last synced line was extended instead,
+//         or an appended line waits for other lines, which has to be
+//         compared like a rewrite.
+bool FileWatcher::syncAppended(TaskManager& manager, SyncReport& report)
+{
+	off_t size = 0;
+	ino_t inode = 0;
+	int64_t modifiedTime = 0;
+	std::ifstream file(fileName, std::ios::binary);
+	char lastByte = '\n';
+
+	if (!readFileState(size, inode, modifiedTime) || !file)
+		return false;
+
+	if (syncedSize > 0)
+	{
+		file.seekg(syncedSize - 1);
+		file.get(lastByte);
+	}
+	else
+		file.seekg(0);
+
+	// Read up to the size that was checked, later bytes are left for the next sync
+	std::string tail(size - syncedSize, '\0');
+	file.read(&tail[0], tail.size());
+	tail.resize(file.gcount());
+
+	if (lastByte != '\n' && !tail.empty() && tail[0] != '\n')
+		return false;
+
+	std::istringstream lines(tail);
+	std::string line;
+	std::vector<std::pair<TaskRecord, uint64_t>> appended;
+	TaskRecord record;
+	uint64_t hash = 0;
+
+	while (std::getline(lines, line))
+	{
+		if (!hashLine(line, record, hash))
+			continue;
+
+		// Adding a task does not resolve the ^line fields, only a load does
+		if (!record.blockerLines.empty())
+			return false;
+
+		appended.push_back({ record, hash });
+	}
+
+	for (const std::pair<TaskRecord, uint64_t>& task : appended)
+	{
+		manager.addTask(task.first);
+		syncedLines[task.second]++;
+		numSyncedLines++;
+		report.numAdded++;
+	}
+
+	report.mode = SYNC_MODES::APPENDED;
+	recordFileState(syncedSize + tail.size(), inode, modifiedTime);
+
+	return true;
+}
+
+// Name:   syncDiffed(TaskManager& manager, SyncReport& report)
+// Desc:   Compare a rewritten file to the last sync and apply only the
+//         lines that changed. A removed line and an added line for the
+//         same task (same name and due date) update that task in place.
+// Param:  manager: The task list to update.
+//         report: Receives the number of tasks that were changed.
+// Return: A boolean: False if more than half of the lines changed, in
+//         which case loading the file again is cheaper, or if the file
+//         or the list has dependencies. The lines are compared without
+//         their ^line fields, and a dependency is only resolved by a load.
+bool FileWatcher::syncDiffed(TaskManager& manager, SyncReport& report)
+{
+	off_t size = 0;
+	ino_t inode = 0;
+	int64_t modifiedTime = 0;
+	std::ifstream file(fileName, std::ios::binary);
+
+	if (!readFileState(size, inode, modifiedTime) || !file)
+		return false;
+
+	std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	std::unordered_map<uint64_t, uint32_t> fileLines;
+	std::vector<std::pair<uint64_t, size_t>> lineStarts;
+	TaskRecord record;
+	uint64_t hash = 0;
+
+	if (manager.getNumDependencies() > 0)
+		return false;
+
+	fileLines.reserve(numSyncedLines);
+
+	for (size_t start = 0; start < contents.size(); )
+	{
+		size_t end = std::min(contents.find('\n', start), contents.size());
+
+		if (hashLine(contents.substr(start, end - start), record, hash))
+		{
+			if (!record.blockerLines.empty())
+				return false;
+
+			fileLines[hash]++;
+			lineStarts.push_back({ hash, start });
+		}
+
+		start = end + 1;
+	}
+
+	// Count the lines on each side that the other side does not have
+	std::unordered_map<uint64_t, uint32_t> removedLines;
+	size_t numAdded = 0;
+	size_t numRemoved = 0;
+
+	for (const std::pair<const uint64_t, uint32_t>& line : syncedLines)
+	{
+		std::unordered_map<uint64_t, uint32_t>::const_iterator found = fileLines.find(line.first);
+		uint32_t fileCount = found == fileLines.end() ? 0 : found->second;
+
+		if (line.second > fileCount)
+		{
+			removedLines[line.first] = line.second - fileCount;
+			numRemoved += line.second - fileCount;
+		}
+	}
+
+	if (lineStarts.size() + numRemoved > numSyncedLines)
+		numAdded = lineStarts.size() + numRemoved - numSyncedLines;
+
+	if ((numAdded + numRemoved) * 2 > std::max(numSyncedLines, lineStarts.size()))
+		return false;
+
+	// Parse only the added lines, keyed by name and due date to pair them with removed tasks
+	std::vector<TaskRecord> addedRecords;
+	std::unordered_multimap<std::string, size_t> addedTasks;
+	std::unordered_map<uint64_t, uint32_t> unmatched = fileLines;
+
+	for (const std::pair<const uint64_t, uint32_t>& line : syncedLines)
+	{
+		std::unordered_map<uint64_t, uint32_t>::iterator found = unmatched.find(line.first);
+		if (found != unmatched.end())
+			found->second -= std::min(found->second, line.second);
+	}
+
+	for (const std::pair<uint64_t, size_t>& line : lineStarts)
+	{
+		uint32_t& count = unmatched[line.first];
+		if (count == 0)
+			continue;
+
+		count--;
+		size_t end = std::min(contents.find('\n', line.second), contents.size());
+		TaskManager::parseTaskLine(contents.substr(line.second, end - line.second), record);
+		addedTasks.insert({ record.name + '\n' + std::to_string(record.dueDate.getSerial()), addedRecords.size() });
+		addedRecords.push_back(record);
+	}
+
+	// Find the tasks of the removed lines, stopping once they are all found
+	std::vector<const Node*> removedNodes;
+
+	for (const Node* currNode = manager.getTasks(); currNode && removedNodes.size() < numRemoved; currNode = currNode->next)
+	{
+		std::unordered_map<uint64_t, uint32_t>::iterator found = removedLines.find(hashTask(currNode->task));
+
+		if (found != removedLines.end() && found->second > 0)
+		{
+			found->second--;
+			removedNodes.push_back(currNode);
+		}
+	}
+
+	std::vector<bool> used(addedRecords.size(), false);
+
+	for (const Node* node : removedNodes)
+	{
+		std::unordered_multimap<std::string, size_t>::iterator pair =
+			addedTasks.find(std::string(node->task.getName()) + '\n' + std::to_string(node->task.getDueSerial()));
+
+		if (pair == addedTasks.end())
+		{
+			manager.deleteTask(node);
+			report.numRemoved++;
+			continue;
+		}
+
+		// The task keeps its place in the list, so the next save does not move it
+		manager.updateTask(node, addedRecords[pair->second]);
+		used[pair->second] = true;
+		addedTasks.erase(pair);
+		report.numUpdated++;
+	}
+
+	for (size_t i = 0; i < addedRecords.size(); i++)
+	{
+		if (used[i])
+			continue;
+
+		manager.addTask(addedRecords[i]);
+		report.numAdded++;
+	}
+
+	syncedLines.swap(fileLines);
+	numSyncedLines = lineStarts.size();
+	report.mode = SYNC_MODES::DIFFED;
+	recordFileState(contents.size(), inode, modifiedTime);
+
+	return true;
+}
+
+// Name:   reload(TaskManager& manager, SyncReport& report)
+// Desc:   Load the whole file again.
+// Param:  manager: The task list to replace.
+//         report: Receives the number of tasks that were loaded.
+// Return: None
+void FileWatcher::reload(TaskManager& manager, SyncReport& report)
+{
+	int numTasks = manager.getNumTasks();
+
+	manager.loadFromFile(fileName);
+	markSynced(manager);
+
+	report.mode = SYNC_MODES::RELOADED;
+	report.numRemoved = numTasks;
+	report.numAdded = manager.getNumTasks();
+}
+
+// Name:   recordFileState(off_t size, ino_t inode, int64_t modifiedTime)
+// Desc:   Record the state of the file at the end of a sync.
+// Param:  size: The number of bytes of the file that were synced.
+//         inode: The inode number of the file.
+//         modifiedTime: The modification time of the file in nanoseconds.
+// Return: None
+void FileWatcher::recordFileState(off_t size, ino_t inode, int64_t modifiedTime)
+{
+	syncedSize = size;
+	syncedInode = inode;
+	syncedTime = modifiedTime;
+	syncedSignature = readSignature(size);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <sys/types.h>
+#include "taskManager.h"
+
+/*****************************************************************************
+# Description: An enum of how a watched file was brought up to date.
+               The FileWatcher class uses inotify to notice when another
+			   program changes the task file and updates the task list
+			   by the size of the change. Appended lines are read from
+			   where the last sync ended, other rewrites are compared to
+			   the last sync line by line and only the tasks whose lines
+			   changed are added, updated or removed. The whole file is
+			   only loaded again when most of it changed, or when a
+			   rewritten file or the list has dependencies, since the
+			   ^line fields of a file are only resolved by a load. A
+			   caller with unsaved edits can hold the load back, the
+			   sync is then skipped and the list is left as it was.
+#****************************************************************************/
+
+enum SYNC_MODES { UNCHANGED, APPENDED, DIFFED, RELOADED, SKIPPED };
+
+struct SyncReport
+{
+	SYNC_MODES mode;
+	int numAdded;
+	int numRemoved;
+	int numUpdated;
+};
+
+class FileWatcher
+{
+public:
+	static const char* getModeName(SYNC_MODES mode);
+
+	FileWatcher();
+	FileWatcher(const FileWatcher& origWatcher) = delete;
+	const FileWatcher& operator=(const FileWatcher& origWatcher) = delete;
+	~FileWatcher();
+
+	bool start(const std::string& fileName, const TaskManager& manager);
+	void stop();
+	bool isWatching() const;
+	const std::string& getFileName() const;
+
+	bool hasChanged();
+	void markSynced(const TaskManager& manager);
+	bool sync(TaskManager& manager, SyncReport& report, bool canReload = true);
+
+private:
+	static const size_t signatureLength = 4096;
+
+	static Task makeTask(const TaskRecord& record);
+	static uint64_t hashTask(const Task& task);
+	static bool hashLine(const std::string& line, TaskRecord& record, uint64_t& hash);
+
+	bool readFileState(off_t& size, ino_t& inode, int64_t& modifiedTime) const;
+	uint64_t readSignature(off_t size) const;
+	bool syncAppended(TaskManager& manager, SyncReport& report);
+	bool syncDiffed(TaskManager& manager, SyncReport& report);
+	void reload(TaskManager& manager, SyncReport& report);
+	void recordFileState(off_t size, ino_t inode, int64_t modifiedTime);
+
+	std::string fileName;
+	int inotifyFd;
+	int watchFd;
+	off_t syncedSize;
+	ino_t syncedInode;
+	int64_t syncedTime;
+	uint64_t syncedSignature;
+	size_t numSyncedLines;
+	std::unordered_map<uint64_t, uint32_t> syncedLines;
+};
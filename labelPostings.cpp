@@ -0,0 +1,180 @@
+#include "labelPostings.h"
+#include <algorithm>
+
+// Name:   LabelPostings()
+// Desc:   Default constructor for empty postings.
+// Param:  None
+// Return: None
+LabelPostings::LabelPostings()
+{
+	clear();
+}
+
+// Name:   clear()
+// Desc:   Remove every task from the postings.
+// Param:  None
+// Return: None
+void LabelPostings::clear()
+{
+	for (int priority = 0; priority <= Task::maxPriority; priority++)
+	{
+		priorityBitmaps[priority].clear();
+		priorityCounts[priority] = 0;
+	}
+
+	for (int tagId = 0; tagId < TaskTags::maxTags; tagId++)
+	{
+		tagBitmaps[tagId].clear();
+		tagCounts[tagId] = 0;
+	}
+}
+
+// Name:   insert(uint32_t slot, int priority, uint64_t tags)
+// Desc:   Add the labels of the task in a slot. Tasks without a priority
+//         or tags are not posted anywhere.
+// Param:  slot: The due column slot of the task.
+//         priority: The priority of the task, 0 for none.
+//         tags: The tag mask of the task.
+// Return: None
+void LabelPostings::insert(uint32_t slot, int priority, uint64_t tags)
+{
+	if (priority > 0 && priority <= Task::maxPriority)
+	{
+		setBit(priorityBitmaps[priority], slot);
+		priorityCounts[priority]++;
+	}
+
+	for (uint64_t bits = tags; bits; bits &= bits - 1)
+	{
+		const int tagId = __builtin_ctzll(bits);
+
+		setBit(tagBitmaps[tagId], slot);
+		tagCounts[tagId]++;
+	}
+}
+
+// Name:   erase(uint32_t slot, int priority, uint64_t tags)
+// Desc:   Remove the labels of the task in a slot.
+// Param:  slot: The due column slot of the task.
+//         priority: The priority the task was inserted with.
+//         tags: The tag mask the task was inserted with.
+// Return: None
+void LabelPostings::erase(uint32_t slot, int priority, uint64_t tags)
+{
+	if (priority > 0 && priority <= Task::maxPriority)
+	{
+		clearBit(priorityBitmaps[priority], slot);
+		priorityCounts[priority]--;
+	}
+
+	for (uint64_t bits = tags; bits; bits &= bits - 1)
+	{
+		const int tagId = __builtin_ctzll(bits);
+
+		clearBit(tagBitmaps[tagId], slot);
+		tagCounts[tagId]--;
+	}
+}
+
+// Name:   getNumWithPriority(int priority)
+// Desc:   Retrieve the number of tasks with a priority.
+// Param:  priority: The priority from 1 to Task::maxPriority.
+// Return: The number of tasks.
+size_t LabelPostings::getNumWithPriority(int priority) const
+{
+	return priority > 0 && priority <= Task::maxPriority ? priorityCounts[priority] : 0;
+}
+
+// Name:   getNumWithTag(int tagId)
+// Desc:   Retrieve the number of tasks with a tag.
+// Param:  tagId: The id of the tag.
+// Return: The number of tasks.
+size_t LabelPostings::getNumWithTag(int tagId) const
+{
+	return tagId >= 0 && tagId < TaskTags::maxTags ? tagCounts[tagId] : 0;
+}
+
+// Name:   intersect(int priority, uint64_t tags, vector<uint64_t>& words)
+// Desc:   Keep only the slots that have a priority and every one of a set
+//         of tags. The bitmaps are applied from the one with the fewest
+//         tasks, which usually ends the soonest and shortens the result.
+// Param:  priority: The priority the tasks need, 0 for any.
+//         tags: The tags the tasks need, 0 for any.
+//         words: A bitmap of the slots to consider, receives the slots
+//                that pass.
+// Return: The number of slots that pass.
+size_t LabelPostings::intersect(int priority, uint64_t tags, std::vector<uint64_t>& words) const
+{
+	std::vector<std::pair<size_t, const std::vector<uint64_t>*>> bitmaps;
+
+	if (priority > 0 && priority <= Task::maxPriority)
+		bitmaps.push_back({ priorityCounts[priority], &priorityBitmaps[priority] });
+
+	for (uint64_t bits = tags; bits; bits &= bits - 1)
+	{
+		const int tagId = __builtin_ctzll(bits);
+		bitmaps.push_back({ tagCounts[tagId], &tagBitmaps[tagId] });
+	}
+
+	std::sort(bitmaps.begin(), bitmaps.end());
+
+	// A bitmap only reaches as far as its last slot, the words past it are empty
+	for (const std::pair<size_t, const std::vector<uint64_t>*>& bitmap : bitmaps)
+	{
+		const std::vector<uint64_t>& posting = *bitmap.second;
+
+		if (words.size() > posting.size())
+			words.resize(posting.size());
+
+		for (size_t word = 0; word < words.size(); word++)
+			words[word] &= posting[word];
+	}
+
+	size_t count = 0;
+
+	for (uint64_t word : words)
+		count += __builtin_popcountll(word);
+
+	return count;
+}
+
+// Name:   setBit(vector<uint64_t>& bitmap, uint32_t slot)
+// Desc:   Set the bit of a slot, growing the bitmap to reach it.
+// Param:  bitmap: The bitmap to change.
+//         slot: The slot to set.
+// Return: None
+void LabelPostings::setBit(std::vector<uint64_t>& bitmap, uint32_t slot)
+{
+	if (bitmap.size() <= slot / 64)
+		bitmap.resize(slot / 64 + 1, 0);
+
+	bitmap[slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+// Name:   clearBit(vector<uint64_t>& bitmap, uint32_t slot)
+// Desc:   Clear the bit of a slot.
+// Param:  bitmap: The bitmap to change.
+//         slot: The slot to clear.
+// Return: None
+void LabelPostings::clearBit(std::vector<uint64_t>& bitmap, uint32_t slot)
+{
+	if (slot / 64 < bitmap.size())
+		bitmap[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the memory used by the bitmaps.
+// Param:  None
+// Return: The number of bytes.
+size_t LabelPostings::getMemoryUsed() const
+{
+	size_t bytes = 0;
+
+	for (const std::vector<uint64_t>& bitmap : priorityBitmaps)
+		bytes += bitmap.capacity() * sizeof(uint64_t);
+
+	for (const std::vector<uint64_t>& bitmap : tagBitmaps)
+		bytes += bitmap.capacity() * sizeof(uint64_t);
+
+	return bytes;
+}
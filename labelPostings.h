@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "task.h"
+#include "taskTags.h"
+
+/*****************************************************************************
+# Description: The LabelPostings class keeps one bitmap per priority and per
+               tag with a bit for each due column slot that has it. A query
+			   for a priority and a set of tags ANDs the bitmaps together,
+			   starting with the one that has the fewest tasks, instead of
+			   testing every task.
+#****************************************************************************/
+
+class LabelPostings
+{
+public:
+	LabelPostings();
+
+	void clear();
+	void insert(uint32_t slot, int priority, uint64_t tags);
+	void erase(uint32_t slot, int priority, uint64_t tags);
+
+	size_t getNumWithPriority(int priority) const;
+	size_t getNumWithTag(int tagId) const;
+	size_t intersect(int priority, uint64_t tags, std::vector<uint64_t>& words) const;
+	size_t getMemoryUsed() const;
+
+private:
+	static void setBit(std::vector<uint64_t>& bitmap, uint32_t slot);
+	static void clearBit(std::vector<uint64_t>& bitmap, uint32_t slot);
+
+	std::vector<uint64_t> priorityBitmaps[Task::maxPriority + 1];
+	std::vector<uint64_t> tagBitmaps[TaskTags::maxTags];
+	size_t priorityCounts[Task::maxPriority + 1];
+	size_t tagCounts[TaskTags::maxTags];
+};
@@ -1,7 +1,14 @@
 #include "simpleTaskManager.h"
+#include "commandLine.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+	if (argc > 1)
+	{
+		CommandLine commandLine;
+		return commandLine.run(argc, argv);
+	}
+
 	SimpleTaskManager program;
 	program.programLoop();
 	
@@ -0,0 +1,113 @@
+#include "nameArena.h"
+#include <cstring>
+
+std::mutex NameArena::arenaMutex;
+std::vector<char*> NameArena::chunks;
+char* NameArena::freeLists[NameArena::numClasses] = {};
+char* NameArena::chunkPosition = nullptr;
+size_t NameArena::chunkRemaining = 0;
+size_t NameArena::bytesUsed = 0;
+size_t NameArena::bytesReserved = 0;
+
+// Name:   getBlockSize(size_t length)
+// Desc:   Retrieve how many bytes a name of a length takes in the arena.
+// Param:  length: The length of the name.
+// Return: The size of the block the name is stored in.
+size_t NameArena::getBlockSize(size_t length)
+{
+	if (length > maxClassLength)
+		return length;
+
+	return (length + classSize - 1) / classSize * classSize;
+}
+
+// Name:   allocate(size_t length)
+// Desc:   Get a block for a name, from the free list of its size class if
+//         a name of the same class was released, else from the current
+//         chunk.
+// Param:  length: The length of the name, more than zero.
+// Return: A pointer to the block.
+char* NameArena::allocate(size_t length)
+{
+	const size_t blockSize = getBlockSize(length);
+	std::lock_guard<std::mutex> lock(arenaMutex);
+
+	bytesUsed += blockSize;
+
+	if (length > maxClassLength)
+	{
+		bytesReserved += blockSize;
+		return new char[blockSize];
+	}
+
+	// A free block holds the pointer to the next free block of its class
+	char*& freeList = freeLists[blockSize / classSize - 1];
+
+	if (freeList)
+	{
+		char* block = freeList;
+		memcpy(&freeList, block, sizeof(char*));
+		return block;
+	}
+
+	if (chunkRemaining < blockSize)
+	{
+		chunks.push_back(new char[chunkSize]);
+		chunkPosition = chunks.back();
+		chunkRemaining = chunkSize;
+		bytesReserved += chunkSize;
+	}
+
+	char* block = chunkPosition;
+	chunkPosition += blockSize;
+	chunkRemaining -= blockSize;
+
+	return block;
+}
+
+// Name:   release(char* data, size_t length)
+// Desc:   Give back the block of a name.
+// Param:  data: The block from allocate().
+//         length: The length the block was allocated for.
+// Return: None
+void NameArena::release(char* data, size_t length)
+{
+	const size_t blockSize = getBlockSize(length);
+	std::lock_guard<std::mutex> lock(arenaMutex);
+
+	bytesUsed -= blockSize;
+
+	if (length > maxClassLength)
+	{
+		bytesReserved -= blockSize;
+		delete[] data;
+		return;
+	}
+
+	char*& freeList = freeLists[blockSize / classSize - 1];
+	memcpy(data, &freeList, sizeof(char*));
+	freeList = data;
+}
+
+// Name:   getBytesUsed()
+// Desc:   Retrieve the bytes of the blocks that hold names.
+// Param:  None
+// Return: The number of bytes.
+size_t NameArena::getBytesUsed()
+{
+	std::lock_guard<std::mutex> lock(arenaMutex);
+
+	return bytesUsed;
+}
+
+// Name:   getBytesReserved()
+// Desc:   Retrieve the bytes the arena took from the heap, including the
+//         free blocks and the unused end of the current chunk.
+// Param:  None
+// Return: The number of bytes.
+size_t NameArena::getBytesReserved()
+{
+	std::lock_guard<std::mutex> lock(arenaMutex);
+
+	return bytesReserved;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: The NameArena class holds the task names that are too long
+               to be stored inline. Names are carved from 64 KB chunks in
+			   16 byte size classes, and a released name goes on the free
+			   list of its class to be reused, so there is no allocator
+			   header per name. Names longer than the largest class get a
+			   block of their own. The arena is shared by every task in
+			   the process.
+#****************************************************************************/
+
+class NameArena
+{
+public:
+	static char* allocate(size_t length);
+	static void release(char* data, size_t length);
+	static size_t getBlockSize(size_t length);
+
+	static size_t getBytesUsed();
+	static size_t getBytesReserved();
+
+private:
+	static const size_t chunkSize = 1 << 16;
+	static const size_t classSize = 16;
+	static const size_t maxClassLength = 256;
+	static const size_t numClasses = maxClassLength / classSize;
+
+	static std::mutex arenaMutex;
+	static std::vector<char*> chunks;
+	static char* freeLists[numClasses];
+	static char* chunkPosition;
+	static size_t chunkRemaining;
+	static size_t bytesUsed;
+	static size_t bytesReserved;
+};
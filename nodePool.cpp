@@ -0,0 +1,122 @@
+#include "nodePool.h"
+#include <new>
+
+// Name:   NodePool()
+// Desc:   Default constructor for an empty pool.
+// Param:  None
+// Return: None
+NodePool::NodePool()
+	: numSlots(0)
+{
+}
+
+// Name:   ~NodePool()
+// Desc:   Destructor. The owner has to destroy its nodes first.
+// Param:  None
+// Return: None
+NodePool::~NodePool()
+{
+	clear();
+}
+
+// Name:   create(string_view name, const Date& dueDate, bool completed)
+// Desc:   Build a node in a free slot, or in a new slot at the end.
+// Param:  name: A string that holds the task name.
+//         dueDate: A Date object that holds the task's due date.
+//         completed: A boolean to determine if the task is completed.
+// Return: A pointer to the node, with its slot set.
+Node* NodePool::create(std::string_view name, const Date& dueDate, bool completed)
+{
+	unsigned int slot;
+
+	if (!freeSlots.empty())
+	{
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else
+	{
+		if (numSlots == chunks.size() * nodesPerChunk)
+			chunks.push_back(static_cast<Node*>(::operator new(nodesPerChunk * sizeof(Node))));
+
+		slot = numSlots++;
+	}
+
+	Node* node = new (&chunks[slot / nodesPerChunk][slot % nodesPerChunk]) Node(name, dueDate, completed);
+	node->slot = slot;
+
+	return node;
+}
+
+// Name:   destroy(Node* node)
+// Desc:   Destroy a node and free its slot for the next node.
+// Param:  node: A node from create().
+// Return: None
+void NodePool::destroy(Node* node)
+{
+	const unsigned int slot = node->slot;
+
+	node->~Node();
+	freeSlots.push_back(slot);
+}
+
+// Name:   clear()
+// Desc:   Give the chunks back to the heap. Every node has to be
+//         destroyed first.
+// Param:  None
+// Return: None
+void NodePool::clear()
+{
+	for (Node* chunk : chunks)
+		::operator delete(chunk);
+
+	std::vector<Node*>().swap(chunks);
+	std::vector<unsigned int>().swap(freeSlots);
+	numSlots = 0;
+}
+
+// Name:   get(unsigned int slot)
+// Desc:   Retrieve the node in a slot.
+// Param:  slot: The slot of a node that has not been destroyed.
+// Return: A pointer to the node.
+Node* NodePool::get(unsigned int slot) const
+{
+	return &chunks[slot / nodesPerChunk][slot % nodesPerChunk];
+}
+
+// Name:   getNumSlots()
+// Desc:   Retrieve the number of slots handed out, including free ones.
+// Param:  None
+// Return: The number of slots.
+size_t NodePool::getNumSlots() const
+{
+	return numSlots;
+}
+
+// Name:   getNumNodes()
+// Desc:   Retrieve the number of nodes that are not destroyed.
+// Param:  None
+// Return: The number of nodes.
+size_t NodePool::getNumNodes() const
+{
+	return numSlots - freeSlots.size();
+}
+
+// Name:   getBytesReserved()
+// Desc:   Retrieve the memory held by the chunks and the free slot list.
+// Param:  None
+// Return: The number of bytes.
+size_t NodePool::getBytesReserved() const
+{
+	return chunks.size() * nodesPerChunk * sizeof(Node) + chunks.capacity() * sizeof(Node*)
+		+ freeSlots.capacity() * sizeof(unsigned int);
+}
+
+// Name:   getBytesFree()
+// Desc:   Retrieve the part of getBytesReserved() that does not hold a node.
+// Param:  None
+// Return: The number of bytes.
+size_t NodePool::getBytesFree() const
+{
+	return getBytesReserved() - getNumNodes() * sizeof(Node);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include "task.h"
+
+/*****************************************************************************
+# Description: A node structure for use with a doubly linked list.
+               The NodePool class owns the nodes of a task list. Nodes are
+			   built in place in chunks of 4096, so a task costs no heap
+			   header of its own, and a node's slot is its position in
+			   the pool. The slot of a removed node is reused by the next
+			   node, which keeps the slot numbers dense for the indexes
+			   that are kept per slot.
+#****************************************************************************/
+
+struct Node
+{
+	Node(std::string_view name, const Date& dueDate, bool completed)
+		: task(name, dueDate, completed), next(nullptr), prev(nullptr), sequence(0), slot(0)
+	{
+	}
+
+	Task task;
+	Node* next;
+	Node* prev;
+	unsigned int sequence;
+	unsigned int slot;
+};
+
+class NodePool
+{
+public:
+	static const size_t nodesPerChunk = 4096;
+
+	NodePool();
+	NodePool(const NodePool& origPool) = delete;
+	const NodePool& operator=(const NodePool& origPool) = delete;
+	~NodePool();
+
+	Node* create(std::string_view name, const Date& dueDate, bool completed);
+	void destroy(Node* node);
+	void clear();
+
+	Node* get(unsigned int slot) const;
+	size_t getNumSlots() const;
+	size_t getNumNodes() const;
+	size_t getBytesReserved() const;
+	size_t getBytesFree() const;
+
+private:
+	std::vector<Node*> chunks;
+	std::vector<unsigned int> freeSlots;
+	size_t numSlots;
+};
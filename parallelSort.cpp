@@ -0,0 +1,53 @@
+#include "parallelSort.h"
+
+// Name:   getPool()
+// Desc:   Retrieve the thread pool shared by the sorts and filters, with
+//         one worker per hardware thread.
+// Param:  None
+// Return: A reference to the shared thread pool.
+ThreadPool& ParallelSort::getPool()
+{
+	static ThreadPool pool;
+
+	return pool;
+}
+
+// Name:   getNumChunks(size_t numItems, const ThreadPool& pool)
+// Desc:   Decide how many chunks to split a vector into.
+// Param:  numItems: The number of items in the vector.
+//         pool: The thread pool the chunks would run on.
+// Return: The number of chunks, 1 to stay on the calling thread.
+size_t ParallelSort::getNumChunks(size_t numItems, const ThreadPool& pool)
+{
+	if (numItems < serialThreshold)
+		return 1;
+
+	return pool.getNumThreads();
+}
+
+// Name:   getBounds(size_t numItems, size_t numChunks)
+// Desc:   Split a vector into chunks of nearly the same size.
+// Param:  numItems: The number of items in the vector.
+//         numChunks: The number of chunks.
+// Return: A vector of numChunks + 1 offsets, chunk i is [bounds[i], bounds[i + 1]).
+std::vector<size_t> ParallelSort::getBounds(size_t numItems, size_t numChunks)
+{
+	std::vector<size_t> bounds;
+
+	for (size_t chunk = 0; chunk <= numChunks; chunk++)
+		bounds.push_back(numItems * chunk / numChunks);
+
+	return bounds;
+}
+
+// Name:   waitAll(vector<future<void>>& jobs)
+// Desc:   Wait for queued jobs to finish and forget them.
+// Param:  jobs: The futures of the jobs.
+// Return: None
+void ParallelSort::waitAll(std::vector<std::future<void>>& jobs)
+{
+	for (std::future<void>& job : jobs)
+		job.wait();
+
+	jobs.clear();
+}
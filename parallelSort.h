@@ -0,0 +1,179 @@
+#pragma once
+#include "threadPool.h"
+#include <vector>
+#include <future>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: The ParallelSort class sorts and filters vectors of node
+               pointers or small keys on a thread pool. The vector is split
+			   into one chunk per worker thread, the chunks are sorted at
+			   the same time and then merged in rounds. Each merge is cut
+			   into parts by a binary search on the two runs so every
+			   round keeps all the workers busy, not only the first one.
+			   Vectors below the serial threshold, or a pool with a single
+			   thread, are sorted with std::sort on the calling thread.
+			   The functions wait for their jobs, so they must not be
+			   called from a job running on the same pool.
+#****************************************************************************/
+
+class ParallelSort
+{
+public:
+	static const size_t serialThreshold = 65536;
+
+	static ThreadPool& getPool();
+	static size_t getNumChunks(size_t numItems, const ThreadPool& pool);
+	static std::vector<size_t> getBounds(size_t numItems, size_t numChunks);
+	static void waitAll(std::vector<std::future<void>>& jobs);
+
+	// Name:   sort(vector<T>& items, Compare less, ThreadPool& pool)
+	// Desc:   Sort a vector, in parallel when it is large enough.
+	// Param:  items: The vector to sort.
+	//         less: The comparison that orders the items.
+	//         pool: The thread pool to run the chunks on.
+	// Return: None
+	template <typename T, typename Compare>
+	static void sort(std::vector<T>& items, Compare less, ThreadPool& pool = getPool())
+	{
+		const size_t numChunks = getNumChunks(items.size(), pool);
+
+		if (numChunks < 2)
+		{
+			std::sort(items.begin(), items.end(), less);
+			return;
+		}
+
+		const std::vector<size_t> bounds = getBounds(items.size(), numChunks);
+		std::vector<std::future<void>> jobs;
+
+		for (size_t chunk = 0; chunk < numChunks; chunk++)
+		{
+			jobs.push_back(pool.submit([&items, &bounds, less, chunk]()
+			{
+				std::sort(items.begin() + bounds[chunk], items.begin() + bounds[chunk + 1], less);
+			}));
+		}
+
+		waitAll(jobs);
+
+		std::vector<T> buffer(items.size());
+		std::vector<T>* source = &items;
+		std::vector<T>* target = &buffer;
+
+		for (size_t width = 1; width < numChunks; width *= 2)
+		{
+			for (size_t first = 0; first < numChunks; first += 2 * width)
+			{
+				const size_t middle = std::min(first + width, numChunks);
+				const size_t last = std::min(first + 2 * width, numChunks);
+
+				mergeRuns(*source, *target, bounds[first], bounds[middle], bounds[last], last - first, less, pool, jobs);
+			}
+
+			waitAll(jobs);
+			std::swap(source, target);
+		}
+
+		if (source != &items)
+			items.swap(buffer);
+	}
+
+	// Name:   filter(const vector<T>& items, Predicate keep, ThreadPool& pool)
+	// Desc:   Copy the items that pass a test, in parallel when there are
+	//         enough of them. The kept items stay in their order.
+	// Param:  items: The items to test.
+	//         keep: The test, called with one item at a time.
+	//         pool: The thread pool to run the chunks on.
+	// Return: A vector of the kept items.
+	template <typename T, typename Predicate>
+	static std::vector<T> filter(const std::vector<T>& items, Predicate keep, ThreadPool& pool = getPool())
+	{
+		const size_t numChunks = getNumChunks(items.size(), pool);
+		std::vector<T> results;
+
+		if (numChunks < 2)
+		{
+			std::copy_if(items.begin(), items.end(), std::back_inserter(results), keep);
+			return results;
+		}
+
+		const std::vector<size_t> bounds = getBounds(items.size(), numChunks);
+		std::vector<std::vector<T>> kept(numChunks);
+		std::vector<std::future<void>> jobs;
+
+		for (size_t chunk = 0; chunk < numChunks; chunk++)
+		{
+			jobs.push_back(pool.submit([&items, &bounds, &kept, keep, chunk]()
+			{
+				std::copy_if(items.begin() + bounds[chunk], items.begin() + bounds[chunk + 1],
+					std::back_inserter(kept[chunk]), keep);
+			}));
+		}
+
+		waitAll(jobs);
+
+		size_t numKept = 0;
+		for (const std::vector<T>& part : kept)
+			numKept += part.size();
+
+		results.reserve(numKept);
+		for (const std::vector<T>& part : kept)
+			results.insert(results.end(), part.begin(), part.end());
+
+		return results;
+	}
+
+private:
+	// Name:   mergeRuns(const vector<T>& source, vector<T>& target, size_t first,
+	//                   size_t middle, size_t last, size_t numParts, Compare less,
+	//                   ThreadPool& pool, vector<future<void>>& jobs)
+	// Desc:   Queue the jobs that merge two sorted runs of the source into
+	//         the same place in the target. The left run is cut into equal
+	//         parts and each cut is found in the right run with a lower
+	//         bound, so equal items keep the left run first as in std::merge.
+	// Param:  source: The vector that holds the runs.
+	//         target: The vector that receives the merged run.
+	//         first: The start of the left run.
+	//         middle: The end of the left run and the start of the right run.
+	//         last: The end of the right run.
+	//         numParts: The number of jobs to cut the merge into.
+	//         less: The comparison that orders the items.
+	//         pool: The thread pool to run the jobs on.
+	//         jobs: Receives the futures of the queued jobs.
+	// Return: None
+	template <typename T, typename Compare>
+	static void mergeRuns(const std::vector<T>& source, std::vector<T>& target, size_t first, size_t middle,
+		size_t last, size_t numParts, Compare less, ThreadPool& pool, std::vector<std::future<void>>& jobs)
+	{
+		size_t leftStart = first;
+		size_t rightStart = middle;
+
+		for (size_t part = 1; part <= numParts; part++)
+		{
+			size_t leftEnd = middle;
+			size_t rightEnd = last;
+
+			if (part < numParts)
+			{
+				leftEnd = first + (middle - first) * part / numParts;
+				rightEnd = leftEnd < middle
+					? std::lower_bound(source.begin() + rightStart, source.begin() + last, source[leftEnd], less) - source.begin()
+					: last;
+			}
+
+			const size_t output = leftStart + rightStart - middle;
+
+			jobs.push_back(pool.submit([&source, &target, leftStart, leftEnd, rightStart, rightEnd, output, less]()
+			{
+				std::merge(source.begin() + leftStart, source.begin() + leftEnd,
+					source.begin() + rightStart, source.begin() + rightEnd, target.begin() + output, less);
+			}));
+
+			leftStart = leftEnd;
+			rightStart = rightEnd;
+		}
+	}
+};
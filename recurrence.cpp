@@ -0,0 +1,304 @@
+#include "recurrence.h"
+#include "task.h"
+#include <algorithm>
+
+// Name:   getFrequencyCode(FREQUENCIES frequency)
+// Desc:   Retrieve the character used for a frequency in task files.
+// Param:  frequency: The frequency to convert.
+// Return: A character for the frequency.
+char Recurrence::getFrequencyCode(FREQUENCIES frequency)
+{
+	switch (frequency)
+	{
+		case FREQUENCIES::DAILY:
+			return 'd';
+		case FREQUENCIES::WEEKLY:
+			return 'w';
+		case FREQUENCIES::MONTHLY:
+			return 'm';
+		case FREQUENCIES::YEARLY:
+			return 'y';
+		default:
+			return 'n';
+	}
+}
+
+// Name:   getFrequencyFromCode(char code)
+// Desc:   Retrieve the frequency for a character used in task files.
+// Param:  code: The character to convert.
+// Return: The frequency for the character, NEVER if it is not known.
+FREQUENCIES Recurrence::getFrequencyFromCode(char code)
+{
+	switch (code)
+	{
+		case 'd':
+			return FREQUENCIES::DAILY;
+		case 'w':
+			return FREQUENCIES::WEEKLY;
+		case 'm':
+			return FREQUENCIES::MONTHLY;
+		case 'y':
+			return FREQUENCIES::YEARLY;
+		default:
+			return FREQUENCIES::NEVER;
+	}
+}
+
+// Name:   Recurrence(FREQUENCIES frequency, int interval, const Date& endDate)
+// Desc:   Constructor that takes in the rule for the recurrence.
+// Param:  frequency: How often the task repeats.
+//         interval: The number of days, weeks, months or years between occurrences.
+//         endDate: The last date an occurrence can be on, an unset date for no end.
+// Return: None
+Recurrence::Recurrence(FREQUENCIES frequency, int interval, const Date& endDate)
+	: frequency(frequency), interval(interval < 1 ? 1 : interval), endDate(endDate)
+{
+}
+
+// Name:   getFrequency()
+// Desc:   Retrieve how often the task repeats.
+// Param:  None
+// Return: The frequency member.
+FREQUENCIES Recurrence::getFrequency() const
+{
+	return frequency;
+}
+
+// Name:   getInterval()
+// Desc:   Retrieve the number of periods between occurrences.
+// Param:  None
+// Return: The interval member as an integer.
+int Recurrence::getInterval() const
+{
+	return interval;
+}
+
+// Name:   getEndDate()
+// Desc:   Retrieve the last date an occurrence can be on.
+// Param:  None
+// Return: The endDate member as a constant Date object.
+const Date& Recurrence::getEndDate() const
+{
+	return endDate;
+}
+
+// Name:   getCompletedSerials()
+// Desc:   Retrieve the serial dates of the completed occurrences.
+// Param:  None
+// Return: A sorted vector of serial dates.
+const std::vector<int>& Recurrence::getCompletedSerials() const
+{
+	return completedSerials;
+}
+
+// Name:   getOccurrence(const Date& startDate, int index)
+// Desc:   Work out the date of one occurrence. Monthly and yearly occurrences
+//         that land past the end of a short month are moved to its last day.
+// Param:  startDate: The date of the first occurrence.
+//         index: The number of the occurrence, starting at 0.
+// Return: The serial date of the occurrence, or -1 if it is past the end date.
+int Recurrence::getOccurrence(const Date& startDate, int index) const
+{
+	const int startSerial = startDate.getSerial();
+	int serial = -1;
+
+	if (startSerial < 0 || index < 0)
+		return -1;
+
+	switch (frequency)
+	{
+		case FREQUENCIES::DAILY:
+			serial = startSerial + index * interval;
+			break;
+
+		case FREQUENCIES::WEEKLY:
+			serial = startSerial + index * interval * 7;
+			break;
+
+		case FREQUENCIES::MONTHLY:
+		case FREQUENCIES::YEARLY:
+			serial = startDate.addMonths(index * interval * (frequency == FREQUENCIES::YEARLY ? 12 : 1)).getSerial();
+			break;
+
+		default:
+			serial = index == 0 ? startSerial : -1;
+			break;
+	}
+
+	if (endDate.getSerial() >= 0 && serial > endDate.getSerial())
+		return -1;
+
+	return serial;
+}
+
+// Name:   getFirstIndex(const Date& startDate, int fromSerial)
+// Desc:   Work out the first occurrence that is on or after a date without
+//         stepping through the occurrences before it.
+// Param:  startDate: The date of the first occurrence.
+//         fromSerial: The serial date to start from.
+// Return: The index of the first occurrence on or after fromSerial.
+int Recurrence::getFirstIndex(const Date& startDate, int fromSerial) const
+{
+	const int startSerial = startDate.getSerial();
+
+	if (fromSerial <= startSerial)
+		return 0;
+
+	int index = 0;
+
+	switch (frequency)
+	{
+		case FREQUENCIES::DAILY:
+			index = (fromSerial - startSerial + interval - 1) / interval;
+			break;
+
+		case FREQUENCIES::WEEKLY:
+			index = (fromSerial - startSerial + interval * 7 - 1) / (interval * 7);
+			break;
+
+		case FREQUENCIES::MONTHLY:
+		case FREQUENCIES::YEARLY:
+		{
+			// Estimate from the month difference, then step past any short month
+			Date fromDate = Date::fromSerial(fromSerial);
+			int months = (fromDate.getYear() - startDate.getYear()) * 12 + fromDate.getMonth() - startDate.getMonth();
+			int period = interval * (frequency == FREQUENCIES::YEARLY ? 12 : 1);
+			index = std::max(0, months / period);
+
+			while (true)
+			{
+				int serial = getOccurrence(startDate, index);
+				if (serial < 0 || serial >= fromSerial)
+					break;
+				index++;
+			}
+			break;
+		}
+
+		default:
+			index = 1;
+			break;
+	}
+
+	return index;
+}
+
+// Name:   isOccurrenceCompleted(int serial)
+// Desc:   Check if the occurrence on a date has been completed.
+// Param:  serial: The serial date of the occurrence.
+// Return: A boolean: True if the occurrence is completed.
+bool Recurrence::isOccurrenceCompleted(int serial) const
+{
+	return std::binary_search(completedSerials.begin(), completedSerials.end(), serial);
+}
+
+// Name:   completeOccurrence(int serial)
+// Desc:   Record an occurrence as completed.
+// Param:  serial: The serial date of the occurrence.
+// Return: A boolean: True if the occurrence was not already completed.
+bool Recurrence::completeOccurrence(int serial)
+{
+	std::vector<int>::iterator position = std::lower_bound(completedSerials.begin(), completedSerials.end(), serial);
+
+	if (position != completedSerials.end() && *position == serial)
+		return false;
+
+	completedSerials.insert(position, serial);
+
+	return true;
+}
+
+// Name:   uncompleteOccurrence(int serial)
+// Desc:   Remove the record of a completed occurrence.
+// Param:  serial: The serial date of the occurrence.
+// Return: A boolean: True if the occurrence was completed.
+bool Recurrence::uncompleteOccurrence(int serial)
+{
+	std::vector<int>::iterator position = std::lower_bound(completedSerials.begin(), completedSerials.end(), serial);
+
+	if (position == completedSerials.end() || *position != serial)
+		return false;
+
+	completedSerials.erase(position);
+
+	return true;
+}
+
+// Name:   OccurrenceIterator(const Task& task, int fromSerial, int toSerial)
+// Desc:   Constructor that finds the first occurrence of a task in a range.
+//         A task that does not repeat has a single occurrence on its due date.
+// Param:  task: The task to expand.
+//         fromSerial: The first serial date of the range.
+//         toSerial: The last serial date of the range.
+// Return: None
+OccurrenceIterator::OccurrenceIterator(const Task& task, int fromSerial, int toSerial)
+	: task(task), toSerial(toSerial), index(0), serial(-1)
+{
+	const Recurrence* rule = task.getRecurrence();
+
+	if (rule)
+		index = rule->getFirstIndex(task.getDueDate(), fromSerial);
+	else if (task.getDueSerial() < fromSerial)
+		index = 1;
+
+	findOccurrence();
+}
+
+// Name:   isValid()
+// Desc:   Check if the iterator is at an occurrence inside the range.
+// Param:  None
+// Return: A boolean: True if there is an occurrence.
+bool OccurrenceIterator::isValid() const
+{
+	return serial >= 0;
+}
+
+// Name:   getSerial()
+// Desc:   Retrieve the date of the current occurrence.
+// Param:  None
+// Return: The serial date of the occurrence.
+int OccurrenceIterator::getSerial() const
+{
+	return serial;
+}
+
+// Name:   isCompleted()
+// Desc:   Check if the current occurrence has been completed.
+// Param:  None
+// Return: A boolean: True if the occurrence or the whole task is completed.
+bool OccurrenceIterator::isCompleted() const
+{
+	const Recurrence* rule = task.getRecurrence();
+
+	return task.getCompleted() || (rule && rule->isOccurrenceCompleted(serial));
+}
+
+// Name:   next()
+// Desc:   Move the iterator to the next occurrence.
+// Param:  None
+// Return: None
+void OccurrenceIterator::next()
+{
+	if (serial < 0)
+		return;
+
+	index++;
+	findOccurrence();
+}
+
+// Name:   findOccurrence()
+// Desc:   Work out the date of the occurrence at the current index.
+// Param:  None
+// Return: None
+void OccurrenceIterator::findOccurrence()
+{
+	const Recurrence* rule = task.getRecurrence();
+
+	if (rule)
+		serial = rule->getOccurrence(task.getDueDate(), index);
+	else
+		serial = index == 0 ? task.getDueSerial() : -1;
+
+	if (serial > toSerial)
+		serial = -1;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "date.h"
+
+/*****************************************************************************
+# Description: An enum of how often a recurring task repeats.
+               The Recurrence class holds the rule for a recurring task
+			   and the occurrences that have been completed. Occurrences
+			   are never stored, the OccurrenceIterator class works them
+			   out one at a time for a range of dates.
+#****************************************************************************/
+
+enum FREQUENCIES { NEVER, DAILY, WEEKLY, MONTHLY, YEARLY };
+
+class Recurrence
+{
+public:
+	static char getFrequencyCode(FREQUENCIES frequency);
+	static FREQUENCIES getFrequencyFromCode(char code);
+
+	Recurrence(FREQUENCIES frequency = FREQUENCIES::NEVER, int interval = 1, const Date& endDate = Date());
+
+	FREQUENCIES getFrequency() const;
+	int getInterval() const;
+	const Date& getEndDate() const;
+	const std::vector<int>& getCompletedSerials() const;
+
+	int getOccurrence(const Date& startDate, int index) const;
+	int getFirstIndex(const Date& startDate, int fromSerial) const;
+	bool isOccurrenceCompleted(int serial) const;
+	bool completeOccurrence(int serial);
+	bool uncompleteOccurrence(int serial);
+
+private:
+	FREQUENCIES frequency;
+	int interval;
+	Date endDate;
+	std::vector<int> completedSerials;
+};
+
+class Task;
+
+class OccurrenceIterator
+{
+public:
+	OccurrenceIterator(const Task& task, int fromSerial, int toSerial);
+
+	bool isValid() const;
+	int getSerial() const;
+	bool isCompleted() const;
+	void next();
+
+private:
+	void findOccurrence();
+
+	const Task& task;
+	int toSerial;
+	int index;
+	int serial;
+};
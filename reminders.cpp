@@ -0,0 +1,252 @@
+#include "reminders.h"
+#include "recurrence.h"
+#include <ctime>
+#include <climits>
+#include <algorithm>
+
+// Name:   getLocalTime()
+// Desc:   The default clock: the current local time.
+// Param:  None
+// Return: The seconds of local time since 1/1/1970.
+int64_t Reminders::getLocalTime()
+{
+	std::time_t now = std::time(nullptr);
+	std::tm local;
+	localtime_r(&now, &local);
+
+	return (int64_t)now + local.tm_gmtoff;
+}
+
+// Name:   getEventName(REMINDER_EVENTS event)
+// Desc:   Retrieve the name of a reminder as it is printed in event lines.
+// Param:  event: The reminder to name.
+// Return: A constant string with the name of the reminder.
+const char* Reminders::getEventName(REMINDER_EVENTS event)
+{
+	switch (event)
+	{
+		case REMINDER_EVENTS::OVERDUE:
+			return "overdue";
+		case REMINDER_EVENTS::DUE_NOW:
+			return "due";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   formatTime(int64_t time)
+// Desc:   Convert a reminder time to text.
+// Param:  time: The seconds of local time since 1/1/1970.
+// Return: A string in m/d/yyyy hh:mm form.
+std::string Reminders::formatTime(int64_t time)
+{
+	const int64_t serial = time >= 0 ? time / secondsPerDay : (time - secondsPerDay + 1) / secondsPerDay;
+	const int minutes = (time - serial * secondsPerDay) / 60;
+	const Date date = Date::fromSerial(serial);
+	char clockText[16];
+
+	snprintf(clockText, sizeof(clockText), "%02d:%02d", minutes / 60, minutes % 60);
+
+	return std::to_string(date.getMonth()) + "/" + std::to_string(date.getDay()) + "/" + std::to_string(date.getYear())
+		+ " " + clockText;
+}
+
+// Name:   formatReminder(const Reminder& reminder)
+// Desc:   Convert a reminder to the tab separated fields of an event line.
+// Param:  reminder: The reminder that fired.
+// Return: A string with due or overdue, the date of the occurrence as
+//         m/d/yyyy and the task name.
+std::string Reminders::formatReminder(const Reminder& reminder)
+{
+	const Date date = Date::fromSerial(reminder.serial);
+
+	return std::string(getEventName(reminder.event)) + "\t" + std::to_string(date.getMonth()) + "/" + std::to_string(date.getDay())
+		+ "/" + std::to_string(date.getYear()) + "\t" + std::string(reminder.node->task.getName());
+}
+
+// Name:   Reminders(const NodePool& nodes, const ReminderFunction& notify, const ClockFunction& clock)
+// Desc:   Constructor that starts the wheel at the current time of the clock.
+// Param:  nodes: The pool that owns the nodes, to find a node by its slot.
+//         notify: The function called with each reminder that fires.
+//         clock: The function that tells the time.
+// Return: None
+Reminders::Reminders(const NodePool& nodes, const ReminderFunction& notify, const ClockFunction& clock)
+	: nodes(nodes), notify(notify), clock(clock), wheel(clock())
+{
+}
+
+// Name:   schedule(const Node* node)
+// Desc:   Set the timer of a task to its next reminder after the time the
+//         wheel was last checked at. A task that is done, or whose last
+//         reminder is already past, has no timer.
+// Param:  node: The node of the task that was added or changed.
+// Return: None
+void Reminders::schedule(const Node* node)
+{
+	// Everything up to the last check is in the past, including a reminder at that very second
+	scheduleAfter(node, wheel.getTime(), REMINDER_EVENTS::DUE_NOW);
+}
+
+// Name:   cancel(const Node* node)
+// Desc:   Stop the timer of a task that is being removed.
+// Param:  node: The node of the task.
+// Return: None
+void Reminders::cancel(const Node* node)
+{
+	wheel.cancel(node->slot);
+}
+
+// Name:   rebuild(const Node* head)
+// Desc:   Set the timers of every task of a list that was just loaded.
+// Param:  head: The head of the linked list.
+// Return: None
+void Reminders::rebuild(const Node* head)
+{
+	wheel.clear(wheel.getTime());
+
+	for (const Node* currNode = head; currNode; currNode = currNode->next)
+		schedule(currNode);
+}
+
+// Name:   clear()
+// Desc:   Stop every timer.
+// Param:  None
+// Return: None
+void Reminders::clear()
+{
+	wheel.clear(wheel.getTime());
+}
+
+// Name:   check()
+// Desc:   Move the wheel to the time of the clock and fire the reminders
+//         that came up since the last check, oldest first.
+// Param:  None
+// Return: The number of reminders that fired.
+size_t Reminders::check()
+{
+	return wheel.advance(clock(), [this](uint32_t slot) { fire(slot); });
+}
+
+// Name:   getTime()
+// Desc:   Retrieve the time of the last check.
+// Param:  None
+// Return: The seconds of local time since 1/1/1970.
+int64_t Reminders::getTime() const
+{
+	return wheel.getTime();
+}
+
+// Name:   getNextTime()
+// Desc:   Retrieve when the next check could fire a reminder, so a loop
+//         can sleep until then.
+// Param:  None
+// Return: The seconds of local time since 1/1/1970, INT64_MAX if none.
+int64_t Reminders::getNextTime() const
+{
+	return wheel.getNextExpiry();
+}
+
+// Name:   getNumScheduled()
+// Desc:   Retrieve the number of tasks waiting for a reminder.
+// Param:  None
+// Return: The number of timers.
+size_t Reminders::getNumScheduled() const
+{
+	return wheel.getNumScheduled();
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the bytes used by the timers.
+// Param:  None
+// Return: The number of bytes.
+size_t Reminders::getMemoryUsed() const
+{
+	return wheel.getMemoryUsed() + events.capacity();
+}
+
+// Name:   findNext(const Task& task, int64_t afterTime, REMINDER_EVENTS afterEvent, int64_t& time, REMINDER_EVENTS& event)
+// Desc:   Find the first reminder of a task after a reminder. Occurrence
+//         s is due at the start of day s and overdue at the start of day
+//         s + 1, where the overdue reminder of one occurrence comes
+//         before the due reminder of the next.
+// Param:  task: The task.
+//         afterTime: The time of the reminder to start after.
+//         afterEvent: The kind of the reminder to start after.
+//         time: Receives the time of the next reminder.
+//         event: Receives the kind of the next reminder.
+// Return: A boolean: False if the task has no more reminders.
+bool Reminders::findNext(const Task& task, int64_t afterTime, REMINDER_EVENTS afterEvent, int64_t& time, REMINDER_EVENTS& event)
+{
+	if (task.getCompleted())
+		return false;
+
+	// An occurrence the day before can still have its overdue reminder ahead
+	const int64_t afterDay = afterTime >= 0 ? afterTime / secondsPerDay : -1;
+	const int fromSerial = (int)std::max<int64_t>(0, std::min<int64_t>(INT_MAX, afterDay - 1));
+
+	for (OccurrenceIterator occurrence(task, fromSerial, INT_MAX); occurrence.isValid(); occurrence.next())
+	{
+		if (occurrence.isCompleted())
+			continue;
+
+		const int64_t dueTime = occurrence.getSerial() * secondsPerDay;
+
+		if (dueTime > afterTime || (dueTime == afterTime && afterEvent < REMINDER_EVENTS::DUE_NOW))
+		{
+			time = dueTime;
+			event = REMINDER_EVENTS::DUE_NOW;
+			return true;
+		}
+
+		if (dueTime + secondsPerDay > afterTime)
+		{
+			time = dueTime + secondsPerDay;
+			event = REMINDER_EVENTS::OVERDUE;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Name:   scheduleAfter(const Node* node, int64_t afterTime, REMINDER_EVENTS afterEvent)
+// Desc:   Set the timer of a task to its first reminder after a reminder,
+//         or stop it if there is none.
+// Param:  node: The node of the task.
+//         afterTime: The time of the reminder to start after.
+//         afterEvent: The kind of the reminder to start after.
+// Return: None
+void Reminders::scheduleAfter(const Node* node, int64_t afterTime, REMINDER_EVENTS afterEvent)
+{
+	int64_t time = 0;
+	REMINDER_EVENTS event = REMINDER_EVENTS::DUE_NOW;
+
+	if (!findNext(node->task, afterTime, afterEvent, time, event))
+	{
+		wheel.cancel(node->slot);
+		return;
+	}
+
+	if (node->slot >= events.size())
+		events.resize(node->slot + 1);
+
+	events[node->slot] = event;
+	wheel.schedule(node->slot, time);
+}
+
+// Name:   fire(uint32_t slot)
+// Desc:   Give the reminder of a timer that expired and set the timer to
+//         the task's next reminder. The wheel is at the reminder's time.
+// Param:  slot: The slot of the task's node.
+// Return: None
+void Reminders::fire(uint32_t slot)
+{
+	const Node* node = nodes.get(slot);
+	const REMINDER_EVENTS event = (REMINDER_EVENTS)events[slot];
+	const int64_t time = wheel.getTime();
+	const int serial = time / secondsPerDay - (event == REMINDER_EVENTS::OVERDUE ? 1 : 0);
+
+	// The next timer is set first, so the function can change or remove the task
+	scheduleAfter(node, time, event);
+	notify({ node, event, serial, time });
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "nodePool.h"
+#include "timingWheel.h"
+
+/*****************************************************************************
+# Description: An enum of the reminders a task can give, in the order a
+               task gives them when they fall on the same second.
+			   The Reminder structure is one reminder that fired: the task,
+			   the date of the occurrence it is about and the time it
+			   fired at.
+			   The Reminders class keeps a timer for the next reminder of
+			   every incomplete task on a timing wheel, keyed by the node
+			   slot. A task is due at the start of its due date and
+			   overdue at the end of it, and a recurring task moves on to
+			   its next incomplete occurrence. Times are seconds of local
+			   time since 1/1/1970, so a day starts at a multiple of
+			   secondsPerDay. The clock is a function so tests and
+			   benchmarks can move time forward without waiting.
+#****************************************************************************/
+
+enum REMINDER_EVENTS { OVERDUE, DUE_NOW, NUM_REMINDER_EVENTS };
+
+struct Reminder
+{
+	const Node* node;
+	REMINDER_EVENTS event;
+	int serial;
+	int64_t time;
+};
+
+class Reminders
+{
+public:
+	typedef std::function<int64_t()> ClockFunction;
+	typedef std::function<void(const Reminder& reminder)> ReminderFunction;
+
+	static const int64_t secondsPerDay = 86400;
+
+	static int64_t getLocalTime();
+	static const char* getEventName(REMINDER_EVENTS event);
+	static std::string formatTime(int64_t time);
+	static std::string formatReminder(const Reminder& reminder);
+
+	Reminders(const NodePool& nodes, const ReminderFunction& notify, const ClockFunction& clock);
+
+	Reminders(const Reminders&) = delete;
+	Reminders& operator=(const Reminders&) = delete;
+
+	void schedule(const Node* node);
+	void cancel(const Node* node);
+	void rebuild(const Node* head);
+	void clear();
+	size_t check();
+
+	int64_t getTime() const;
+	int64_t getNextTime() const;
+	size_t getNumScheduled() const;
+	size_t getMemoryUsed() const;
+
+private:
+	static bool findNext(const Task& task, int64_t afterTime, REMINDER_EVENTS afterEvent, int64_t& time, REMINDER_EVENTS& event);
+	void scheduleAfter(const Node* node, int64_t afterTime, REMINDER_EVENTS afterEvent);
+	void fire(uint32_t slot);
+
+	const NodePool& nodes;
+	ReminderFunction notify;
+	ClockFunction clock;
+	TimingWheel wheel;
+	std::vector<uint8_t> events;
+};
@@ -0,0 +1,922 @@
+#include "segmentStore.h"
+#include "taskManager.h"
+#include "threadPool.h"
+#include "crc32c.h"
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <mutex>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+const char* SegmentStore::storeExtension = ".sts";
+
+namespace
+{
+	const char manifestMagic[] = "STS1";
+
+	struct StoredTask
+	{
+		unsigned int sequence;
+		TaskRecord record;
+		std::string line;
+	};
+
+	// Name:   parseSegmentLine(string& line, StoredTask& task)
+	// Desc:   Parse one line of a segment file: the insertion sequence,
+	//         the length of the name and the task line.
+	// Param:  line: The line without its newline, only the task line is
+	//         left in it.
+	//         task: Receives the sequence and the parsed task.
+	// Return: A boolean: True if the line holds a complete task.
+	bool parseSegmentLine(std::string& line, StoredTask& task)
+	{
+		const char* start = line.c_str();
+		char* end = nullptr;
+
+		task.sequence = strtoul(start, &end, 10);
+		if (end == start || *end != ',')
+			return false;
+
+		start = end + 1;
+		const size_t nameLength = strtoul(start, &end, 10);
+		if (end == start || *end != ',')
+			return false;
+
+		line.erase(0, end + 1 - line.c_str());
+
+		return TaskManager::parseTaskLine(line, task.record, nameLength);
+	}
+
+	// Name:   readSegmentFile(const string& path, const SegmentInfo& segment, uint64_t firstRecord,
+	//                         bool keepLines, vector<StoredTask>& tasks, LoadReport& report)
+	// Desc:   Read and parse every task of a segment file. A file that is
+	//         missing or does not match its checksum is lost as a whole,
+	//         otherwise each line that is not a task and the tasks missing
+	//         from the end are lost.
+	// Param:  path: The path of the segment file.
+	//         segment: The segment from the manifest.
+	//         firstRecord: The number of the first task of the segment in the store.
+	//         keepLines: A boolean to keep the task line of each task.
+	//         tasks: Receives the tasks.
+	//         report: Receives the lost tasks.
+	// Return: A boolean: False if the whole segment is lost.
+	bool readSegmentFile(const std::string& path, const SegmentInfo& segment, uint64_t firstRecord, bool keepLines,
+		std::vector<StoredTask>& tasks, LoadReport& report)
+	{
+		const std::string fileName = std::filesystem::path(path).filename().string();
+		std::ifstream file(path, std::ios::binary);
+		std::string contents;
+		std::string line;
+		StoredTask task;
+
+		tasks.clear();
+
+		if (!file.is_open())
+		{
+			TaskManager::addLostRecords(report, firstRecord, segment.numTasks, "segment " + fileName + " is missing");
+			return false;
+		}
+
+		contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		if (segment.hasChecksum && Crc32c::compute(contents.data(), contents.size()) != segment.checksum)
+		{
+			TaskManager::addLostRecords(report, firstRecord, segment.numTasks, "checksum mismatch in segment " + fileName);
+			return false;
+		}
+
+		uint64_t numLines = 0;
+		tasks.reserve(segment.numTasks);
+
+		for (size_t start = 0, end = 0; start < contents.size(); start = end + 1, numLines++)
+		{
+			end = std::min(contents.find('\n', start), contents.size());
+			line.assign(contents, start, end - start);
+
+			if (!parseSegmentLine(line, task))
+			{
+				TaskManager::addLostRecords(report, firstRecord + numLines, 1, "not a complete task in segment " + fileName);
+				continue;
+			}
+
+			if (keepLines)
+				task.line.swap(line);
+
+			tasks.push_back(std::move(task));
+		}
+
+		if (numLines < segment.numTasks)
+			TaskManager::addLostRecords(report, firstRecord + numLines, segment.numTasks - numLines, "torn tail in segment " + fileName);
+
+		return true;
+	}
+
+	// Name:   formatSegmentLine(const Node* node, const vector<const Node*>& blockers)
+	// Desc:   Convert a task into a line of a segment file. The name length
+	//         is kept so names with commas are read back whole. A task
+	//         names the tasks it waits for by their sequence plus one,
+	//         which stays the same when other months are rewritten.
+	// Param:  node: The node of the task.
+	//         blockers: The nodes of the tasks it waits for.
+	// Return: A string that holds the line with its newline.
+	std::string formatSegmentLine(const Node* node, const std::vector<const Node*>& blockers)
+	{
+		std::string line = std::to_string(node->sequence) + "," + std::to_string(node->task.getName().size()) + ","
+			+ TaskManager::formatTaskLine(node->task);
+
+		for (const Node* blocker : blockers)
+			line += ",^" + std::to_string((uint64_t)blocker->sequence + 1);
+
+		return line + "\n";
+	}
+}
+
+// Name:   getKeyName(SEGMENT_KEYS key)
+// Desc:   Retrieve the name of a partition key.
+// Param:  key: The key to name.
+// Return: A constant string with the name of the key.
+const char* SegmentStore::getKeyName(SEGMENT_KEYS key)
+{
+	switch (key)
+	{
+		case SEGMENT_KEYS::DUE_MONTH:
+			return "month";
+		case SEGMENT_KEYS::DUE_QUARTER:
+			return "quarter";
+		case SEGMENT_KEYS::DUE_YEAR:
+			return "year";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   getKeyFromName(const string& name, SEGMENT_KEYS& key)
+// Desc:   Find the partition key with a name.
+// Param:  name: The name of the key.
+//         key: Receives the key.
+// Return: A boolean: True if the name is a key.
+bool SegmentStore::getKeyFromName(const std::string& name, SEGMENT_KEYS& key)
+{
+	for (int currKey = 0; currKey < SEGMENT_KEYS::NUM_KEYS; currKey++)
+	{
+		if (name == getKeyName((SEGMENT_KEYS)currKey))
+		{
+			key = (SEGMENT_KEYS)currKey;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Name:   getMonthKey(int serial)
+// Desc:   Number the month a serial date is in.
+// Param:  serial: The serial date.
+// Return: The year times 12 plus the month from 0, or -1 for no date.
+int SegmentStore::getMonthKey(int serial)
+{
+	if (serial < 0)
+		return -1;
+
+	const Date date = Date::fromSerial(serial);
+
+	return date.getYear() * 12 + date.getMonth() - 1;
+}
+
+// Name:   getKey(SEGMENT_KEYS key, int monthKey)
+// Desc:   Convert a month number into the partition key of a store.
+// Param:  key: The partition key of the store.
+//         monthKey: A month from getMonthKey().
+// Return: The key the month is partitioned into, -1 for no date.
+int SegmentStore::getKey(SEGMENT_KEYS key, int monthKey)
+{
+	if (monthKey < 0)
+		return -1;
+
+	switch (key)
+	{
+		case SEGMENT_KEYS::DUE_QUARTER:
+			return monthKey / 3;
+		case SEGMENT_KEYS::DUE_YEAR:
+			return monthKey / 12;
+		default:
+			return monthKey;
+	}
+}
+
+// Name:   isStoreName(const string& fileName)
+// Desc:   Check if a file name uses the segmented store extension.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if the name is a segmented store.
+bool SegmentStore::isStoreName(const std::string& fileName)
+{
+	const size_t extensionLength = strlen(storeExtension);
+	const size_t lastChar = fileName.find_last_not_of('/');
+
+	// A trailing separator is allowed since a store is a directory
+	return lastChar != std::string::npos && lastChar + 1 > extensionLength
+		&& fileName.compare(lastChar + 1 - extensionLength, extensionLength, storeExtension) == 0;
+}
+
+// Name:   create(const string& storeName, SEGMENT_KEYS key)
+// Desc:   Create an empty store with a partition key, or empty an
+//         existing store and change its key.
+// Param:  storeName: The directory of the store.
+//         key: The key to partition the tasks by.
+// Return: A boolean: True if the store was created.
+bool SegmentStore::create(const std::string& storeName, SEGMENT_KEYS key)
+{
+	const std::string storePath = getStorePath(storeName);
+	std::error_code error;
+
+	std::filesystem::create_directories(storePath, error);
+
+	const int lockFile = lockStore(storePath, "LOCK", LOCK_EX);
+	if (lockFile < 0)
+		return false;
+
+	SegmentManifest manifest = { key, 0, 0, 1, {} };
+	SegmentManifest oldManifest;
+
+	// A new epoch tells the lists bound to the old contents to save in full
+	if (readManifest(storePath, oldManifest))
+	{
+		manifest.epoch = oldManifest.epoch + 1;
+		manifest.nextFile = oldManifest.nextFile;
+	}
+
+	const bool created = writeManifest(storePath, manifest);
+
+	if (created)
+		removeUnlisted(storePath, manifest);
+
+	unlockStore(lockFile);
+
+	return created;
+}
+
+// Name:   save(const TaskManager& manager, const string& storeName)
+// Desc:   Save a task list to a store. A list that is bound to the store
+//         only writes a new segment for each key with a changed month,
+//         any other list replaces every segment. The list is bound to
+//         the store afterwards, and a compaction is started in the
+//         background when enough segments are small or shadowed.
+// Param:  manager: The task manager to save.
+//         storeName: The directory of the store, created if needed.
+// Return: A boolean: True if saving is successful, false otherwise.
+bool SegmentStore::save(const TaskManager& manager, const std::string& storeName)
+{
+	const std::string storePath = getStorePath(storeName);
+	std::error_code error;
+
+	std::filesystem::create_directories(storePath, error);
+
+	const int lockFile = lockStore(storePath, "LOCK", LOCK_EX);
+	if (lockFile < 0)
+		return false;
+
+	SegmentManifest manifest = { SEGMENT_KEYS::DUE_MONTH, 0, 0, 1, {} };
+	const bool incremental = readManifest(storePath, manifest) && manager.storeBinding.storePath == storePath
+		&& manager.storeBinding.epoch == manifest.epoch;
+	std::set<int> keys;
+	std::map<int, std::vector<const Node*>> keyTasks;
+
+	if (incremental)
+	{
+		for (int monthKey : manager.storeBinding.dirtyMonths)
+			keys.insert(getKey(manifest.key, monthKey));
+	}
+	else
+		manifest.epoch++;
+
+	// The list is in sequence order, so every segment is too
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		const int key = getKey(manifest.key, getMonthKey(currNode->task.getDueSerial()));
+
+		if (!incremental || keys.count(key))
+			keyTasks[key].push_back(currNode);
+	}
+
+	if (!incremental)
+	{
+		for (const std::pair<const int, std::vector<const Node*>>& key : keyTasks)
+			keys.insert(key.first);
+
+		manifest.segments.clear();
+	}
+
+	const bool hasDependencies = manager.getNumDependencies() > 0;
+	bool saved = true;
+
+	// A key with no tasks left still gets an empty segment to shadow the older ones
+	for (int key : keys)
+	{
+		const std::vector<const Node*>& tasks = keyTasks[key];
+		std::ofstream file(getSegmentPath(storePath, manifest.nextFile), std::ios::binary);
+		std::string contents;
+
+		for (const Node* node : tasks)
+			contents += formatSegmentLine(node, hasDependencies ? manager.getBlockers(node) : std::vector<const Node*>());
+
+		file << contents;
+		file.close();
+
+		if (!file)
+		{
+			saved = false;
+			break;
+		}
+
+		manifest.segments.push_back({ manifest.nextFile++, key, key, (uint32_t)tasks.size(),
+			Crc32c::compute(contents.data(), contents.size()), true });
+	}
+
+	manifest.nextSequence = std::max(manifest.nextSequence, manager.nextSequence);
+	saved = saved && writeManifest(storePath, manifest);
+
+	if (saved && !incremental)
+		removeUnlisted(storePath, manifest);
+
+	unlockStore(lockFile);
+
+	if (!saved)
+		return false;
+
+	manager.storeBinding.storePath = storePath;
+	manager.storeBinding.epoch = manifest.epoch;
+	manager.storeBinding.dirtyMonths.clear();
+
+	if (needsCompaction(manifest))
+		scheduleCompaction(storePath);
+
+	return true;
+}
+
+// Name:   load(TaskManager& manager, const string& storeName, bool append, int firstSerial, int lastSerial)
+// Desc:   Read the tasks of a store that are due in a range. Only the
+//         segments that hold a key in the range are opened, and the
+//         tasks of every segment are merged back into list order. The
+//         tasks of damaged segments are skipped and listed in the load
+//         report. A list that replaces its tasks with the whole intact
+//         store keeps the insertion sequences of the store and is bound
+//         to it.
+// Param:  manager: The task manager to load into.
+//         storeName: The directory of the store.
+//         append: A boolean to keep the current tasks instead of replacing them.
+//         firstSerial: The first due date to load, INT_MIN for no limit.
+//         lastSerial: The last due date to load, INT_MAX for no limit.
+// Return: A boolean: True if loading was successful, false otherwise.
+bool SegmentStore::load(TaskManager& manager, const std::string& storeName, bool append, int firstSerial, int lastSerial)
+{
+	const std::string storePath = getStorePath(storeName);
+	const int lockFile = lockStore(storePath, "LOCK", LOCK_SH);
+	SegmentManifest manifest;
+
+	if (lockFile < 0 || !readManifest(storePath, manifest))
+	{
+		unlockStore(lockFile);
+		return false;
+	}
+
+	const std::unordered_map<int, uint32_t> owners = getOwners(manifest);
+	const int firstKey = firstSerial < 0 ? -1 : getKey(manifest.key, getMonthKey(firstSerial));
+	const int lastKey = lastSerial == INT_MAX ? INT_MAX : getKey(manifest.key, getMonthKey(lastSerial));
+	std::vector<StoredTask> tasks;
+	std::vector<StoredTask> segmentTasks;
+	uint64_t firstRecord = 1;
+
+	for (const SegmentInfo& segment : manifest.segments)
+	{
+		const uint64_t segmentRecord = firstRecord;
+		firstRecord += segment.numTasks;
+
+		if (!ownsKeyIn(segment, owners, firstKey, lastKey))
+			continue;
+
+		manager.loadReport.numRecords += segment.numTasks;
+
+		if (!readSegmentFile(getSegmentPath(storePath, segment.fileNumber), segment, segmentRecord, false, segmentTasks, manager.loadReport))
+			continue;
+
+		for (StoredTask& task : segmentTasks)
+		{
+			const int serial = task.record.dueDate.getSerial();
+			const std::unordered_map<int, uint32_t>::const_iterator owner = owners.find(getKey(manifest.key, getMonthKey(serial)));
+
+			if (owner != owners.end() && owner->second == segment.fileNumber && serial >= firstSerial && serial <= lastSerial)
+				tasks.push_back(std::move(task));
+		}
+	}
+
+	unlockStore(lockFile);
+
+	// The tasks are sorted by reference since a record is much larger than its sequence
+	std::vector<std::pair<unsigned int, const StoredTask*>> order;
+	order.reserve(tasks.size());
+
+	for (const StoredTask& storedTask : tasks)
+		order.emplace_back(storedTask.sequence, &storedTask);
+
+	std::sort(order.begin(), order.end());
+	manager.beginLoad(append);
+
+	std::vector<uint64_t> blockerLines;
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const StoredTask& storedTask = *order[i].second;
+		const TaskRecord& record = storedTask.record;
+		Node* newNode = manager.addLoadedTask(record.name, record.dueDate, record.completed);
+
+		if (!newNode)
+			continue;
+
+		if (!append)
+		{
+			newNode->sequence = storedTask.sequence;
+			manager.nextSequence = std::max(manager.nextSequence, storedTask.sequence + TaskManager::sequenceGap);
+		}
+
+		if (!record.recurrenceFields.empty())
+			manager.setRecurrence(newNode, TaskManager::parseRecurrence(record.recurrenceFields));
+
+		if (record.priority || record.tags)
+			manager.setLabels(newNode, record.priority, record.tags);
+
+		// The blockers are numbered by their place in the load, a blocker that was not read is left out
+		blockerLines.clear();
+		for (uint64_t blocker : record.blockerLines)
+		{
+			if (blocker - 1 > UINT_MAX)
+				continue;
+
+			const std::vector<std::pair<unsigned int, const StoredTask*>>::const_iterator found = std::lower_bound(
+				order.begin(), order.end(), std::make_pair((unsigned int)(blocker - 1), (const StoredTask*)nullptr));
+
+			if (found != order.end() && found->first == blocker - 1)
+				blockerLines.push_back(found - order.begin() + 1);
+		}
+
+		manager.addLoadedLine(newNode, i + 1, blockerLines);
+	}
+
+	manager.endLoad();
+
+	// Only a list that holds exactly what the store holds can save just its changes
+	if (!append && !manager.activeDedup && firstSerial == INT_MIN && lastSerial == INT_MAX && manager.loadReport.numLost == 0)
+	{
+		manager.nextSequence = std::max(manager.nextSequence, manifest.nextSequence);
+		manager.storeBinding.storePath = storePath;
+		manager.storeBinding.epoch = manifest.epoch;
+		manager.storeBinding.dirtyMonths.clear();
+	}
+
+	return true;
+}
+
+// Name:   readManifest(const string& storeName, SegmentManifest& manifest)
+// Desc:   Read the manifest of a store.
+// Param:  storeName: The directory of the store.
+//         manifest: Receives the manifest.
+// Return: A boolean: False if there is no valid manifest.
+bool SegmentStore::readManifest(const std::string& storeName, SegmentManifest& manifest)
+{
+	std::ifstream file(getStorePath(storeName) + "/MANIFEST");
+	std::string line;
+	std::string field;
+	std::string keyName;
+
+	if (!std::getline(file, line) || line != manifestMagic)
+		return false;
+
+	manifest.segments.clear();
+
+	while (std::getline(file, line))
+	{
+		std::istringstream fields(line);
+		SegmentInfo segment;
+
+		fields >> field;
+
+		if (field == "key")
+			fields >> keyName;
+		else if (field == "epoch")
+			fields >> manifest.epoch;
+		else if (field == "sequence")
+			fields >> manifest.nextSequence;
+		else if (field == "next")
+			fields >> manifest.nextFile;
+		else if (field == "segment" && fields >> segment.fileNumber >> segment.firstKey >> segment.lastKey >> segment.numTasks)
+		{
+			// Stores from before checksums were added have none
+			segment.hasChecksum = (bool)(fields >> segment.checksum);
+			manifest.segments.push_back(segment);
+		}
+		else
+			return false;
+	}
+
+	return getKeyFromName(keyName, manifest.key);
+}
+
+// Name:   verify(const string& storeName, LoadReport& report, string& error)
+// Desc:   Check the checksum of every segment of a store and parse its
+//         tasks without loading them.
+// Param:  storeName: The directory of the store.
+//         report: Receives the number of tasks and the lost ones.
+//         error: Receives why the store could not be checked at all.
+// Return: A boolean: True if the store could be checked.
+bool SegmentStore::verify(const std::string& storeName, LoadReport& report, std::string& error)
+{
+	const std::string storePath = getStorePath(storeName);
+	const int lockFile = lockStore(storePath, "LOCK", LOCK_SH);
+	SegmentManifest manifest;
+	std::vector<StoredTask> tasks;
+	uint64_t firstRecord = 1;
+
+	if (lockFile < 0 || !readManifest(storePath, manifest))
+	{
+		unlockStore(lockFile);
+		error = "The store has no valid manifest.";
+		return false;
+	}
+
+	for (const SegmentInfo& segment : manifest.segments)
+	{
+		report.numRecords += segment.numTasks;
+		readSegmentFile(getSegmentPath(storePath, segment.fileNumber), segment, firstRecord, false, tasks, report);
+		firstRecord += segment.numTasks;
+	}
+
+	unlockStore(lockFile);
+
+	return true;
+}
+
+// Name:   needsCompaction(const SegmentManifest& manifest)
+// Desc:   Check if enough segments are small or have keys that newer
+//         segments shadow for a compaction to be worth it.
+// Param:  manifest: The manifest of the store.
+// Return: A boolean: True if the store should be compacted.
+bool SegmentStore::needsCompaction(const SegmentManifest& manifest)
+{
+	const std::unordered_map<int, uint32_t> owners = getOwners(manifest);
+	size_t numCompactable = 0;
+
+	for (const SegmentInfo& segment : manifest.segments)
+	{
+		bool ownsAll = true;
+
+		for (int key = segment.firstKey; key <= segment.lastKey && ownsAll; key++)
+			ownsAll = owners.at(key) == segment.fileNumber;
+
+		numCompactable += !ownsAll || segment.numTasks < smallSegmentTasks;
+	}
+
+	return numCompactable >= compactionTrigger;
+}
+
+// Name:   compact(const string& storeName)
+// Desc:   Merge the small and shadowed segments of a store. The tasks
+//         they still own are read under a shared lock and grouped into
+//         segments of about targetSegmentTasks tasks over runs of keys
+//         that no kept segment holds. The new segments are written and
+//         listed under the exclusive lock, unless a save changed the
+//         store in the meantime, and the old files are deleted.
+// Param:  storeName: The directory of the store.
+// Return: A boolean: True if the store was compacted or did not need it,
+//         false if it could not be read or another compaction or a
+//         save got in the way.
+bool SegmentStore::compact(const std::string& storeName)
+{
+	const std::string storePath = getStorePath(storeName);
+	const int compactLock = lockStore(storePath, "COMPACT", LOCK_EX | LOCK_NB);
+	int lockFile = lockStore(storePath, "LOCK", LOCK_SH);
+	SegmentManifest manifest;
+
+	if (compactLock < 0 || lockFile < 0 || !readManifest(storePath, manifest))
+	{
+		unlockStore(lockFile);
+		unlockStore(compactLock);
+		return false;
+	}
+
+	const std::unordered_map<int, uint32_t> owners = getOwners(manifest);
+	std::vector<SegmentInfo> keptSegments;
+	std::vector<SegmentInfo> mergedSegments;
+	std::set<uint32_t> keptFiles;
+	bool shadowed = false;
+
+	for (const SegmentInfo& segment : manifest.segments)
+	{
+		bool ownsAll = true;
+
+		for (int key = segment.firstKey; key <= segment.lastKey && ownsAll; key++)
+			ownsAll = owners.at(key) == segment.fileNumber;
+
+		if (ownsAll && segment.numTasks >= smallSegmentTasks)
+		{
+			keptSegments.push_back(segment);
+			keptFiles.insert(segment.fileNumber);
+		}
+		else
+			mergedSegments.push_back(segment);
+
+		shadowed = shadowed || !ownsAll;
+	}
+
+	if (mergedSegments.size() < 2 && !shadowed)
+	{
+		unlockStore(lockFile);
+		unlockStore(compactLock);
+		return true;
+	}
+
+	std::map<int, std::vector<StoredTask>> keyTasks;
+	std::vector<StoredTask> segmentTasks;
+	LoadReport report = LoadReport();
+
+	for (const SegmentInfo& segment : mergedSegments)
+	{
+		if (!readSegmentFile(getSegmentPath(storePath, segment.fileNumber), segment, 1, true, segmentTasks, report))
+			break;
+
+		for (StoredTask& task : segmentTasks)
+		{
+			const int key = getKey(manifest.key, getMonthKey(task.record.dueDate.getSerial()));
+			const std::unordered_map<int, uint32_t>::const_iterator owner = owners.find(key);
+
+			if (owner != owners.end() && owner->second == segment.fileNumber)
+				keyTasks[key].push_back(std::move(task));
+		}
+	}
+
+	unlockStore(lockFile);
+
+	// A damaged segment is left as it is rather than merged without its lost tasks
+	const bool readAll = report.numLost == 0;
+
+	// A group of keys must not reach over a key that a kept segment holds
+	std::vector<SegmentInfo> newSegments;
+	std::vector<std::vector<const StoredTask*>> groups;
+
+	for (const std::pair<const int, std::vector<StoredTask>>& key : keyTasks)
+	{
+		bool startGroup = groups.empty() || groups.back().size() >= targetSegmentTasks;
+
+		for (int between = startGroup ? key.first : newSegments.back().lastKey + 1; between < key.first && !startGroup; between++)
+		{
+			const std::unordered_map<int, uint32_t>::const_iterator owner = owners.find(between);
+			startGroup = owner != owners.end() && keptFiles.count(owner->second);
+		}
+
+		if (startGroup)
+		{
+			newSegments.push_back({ 0, key.first, key.first, 0, 0, true });
+			groups.emplace_back();
+		}
+
+		newSegments.back().lastKey = key.first;
+
+		for (const StoredTask& storedTask : key.second)
+			groups.back().push_back(&storedTask);
+	}
+
+	std::vector<std::string> newContents(groups.size());
+
+	for (size_t i = 0; i < groups.size(); i++)
+	{
+		std::sort(groups[i].begin(), groups[i].end(), [](const StoredTask* left, const StoredTask* right) {
+			return left->sequence < right->sequence;
+		});
+
+		for (const StoredTask* storedTask : groups[i])
+			newContents[i] += std::to_string(storedTask->sequence) + "," + std::to_string(storedTask->record.name.size())
+				+ "," + storedTask->line + "\n";
+
+		newSegments[i].numTasks = groups[i].size();
+		newSegments[i].checksum = Crc32c::compute(newContents[i].data(), newContents[i].size());
+		newSegments[i].hasChecksum = true;
+	}
+
+	lockFile = lockStore(storePath, "LOCK", LOCK_EX);
+	SegmentManifest current;
+	bool compacted = readAll && lockFile >= 0 && readManifest(storePath, current) && current.nextFile == manifest.nextFile
+		&& current.epoch == manifest.epoch;
+
+	for (size_t i = 0; i < newSegments.size() && compacted; i++)
+	{
+		std::ofstream file(getSegmentPath(storePath, current.nextFile), std::ios::binary);
+
+		file << newContents[i];
+		file.close();
+
+		newSegments[i].fileNumber = current.nextFile++;
+		compacted = (bool)file;
+	}
+
+	if (compacted)
+	{
+		current.segments = keptSegments;
+		current.segments.insert(current.segments.end(), newSegments.begin(), newSegments.end());
+		compacted = writeManifest(storePath, current);
+	}
+
+	// Files left by a failed write are not listed and go too
+	if (compacted)
+		removeUnlisted(storePath, current);
+
+	unlockStore(lockFile);
+	unlockStore(compactLock);
+
+	return compacted;
+}
+
+// Name:   scheduleCompaction(const string& storeName)
+// Desc:   Compact a store on a background thread. A store that already
+//         waits for a compaction is not queued again, and the queued
+//         compactions finish before the program exits.
+// Param:  storeName: The directory of the store.
+// Return: None
+void SegmentStore::scheduleCompaction(const std::string& storeName)
+{
+	// Declared before the pool so they outlive its worker at exit
+	static std::mutex pendingMutex;
+	static std::set<std::string> pendingStores;
+	static ThreadPool compactor(1);
+
+	const std::string storePath = getStorePath(storeName);
+
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+
+		if (!pendingStores.insert(storePath).second)
+			return;
+	}
+
+	compactor.submit([storePath]() {
+		{
+			std::lock_guard<std::mutex> lock(pendingMutex);
+			pendingStores.erase(storePath);
+		}
+
+		return compact(storePath);
+	});
+}
+
+// Name:   getStorePath(const string& storeName)
+// Desc:   Normalize the directory of a store so the same store always
+//         has the same path.
+// Param:  storeName: The directory of the store.
+// Return: The absolute path without a trailing separator.
+std::string SegmentStore::getStorePath(const std::string& storeName)
+{
+	std::string storePath = std::filesystem::absolute(storeName).lexically_normal().string();
+
+	while (storePath.size() > 1 && storePath.back() == '/')
+		storePath.pop_back();
+
+	return storePath;
+}
+
+// Name:   getSegmentPath(const string& storePath, uint32_t fileNumber)
+// Desc:   Build the path of a segment file.
+// Param:  storePath: The directory of the store.
+//         fileNumber: The number of the segment.
+// Return: The path of the segment file.
+std::string SegmentStore::getSegmentPath(const std::string& storePath, uint32_t fileNumber)
+{
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "/%08u.seg", fileNumber);
+
+	return storePath + fileName;
+}
+
+// Name:   lockStore(const string& storePath, const char* lockName, int operation)
+// Desc:   Lock a lock file of a store. The locks are held per open file,
+//         so they work between threads as well as between processes.
+// Param:  storePath: The directory of the store.
+//         lockName: The name of the lock file.
+//         operation: LOCK_SH or LOCK_EX, optionally with LOCK_NB.
+// Return: The descriptor of the lock file, or -1 if it was not locked.
+int SegmentStore::lockStore(const std::string& storePath, const char* lockName, int operation)
+{
+	const int lockFile = open((storePath + "/" + lockName).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+	if (lockFile >= 0 && flock(lockFile, operation) != 0)
+	{
+		close(lockFile);
+		return -1;
+	}
+
+	return lockFile;
+}
+
+// Name:   unlockStore(int lockFile)
+// Desc:   Release a lock from lockStore().
+// Param:  lockFile: The descriptor of the lock file, -1 for none.
+// Return: None
+void SegmentStore::unlockStore(int lockFile)
+{
+	if (lockFile >= 0)
+		close(lockFile);
+}
+
+// Name:   writeManifest(const string& storePath, const SegmentManifest& manifest)
+// Desc:   Replace the manifest of a store. It is written to a temporary
+//         file and renamed over the old one, so a reader never sees half
+//         of it.
+// Param:  storePath: The directory of the store.
+//         manifest: The manifest to write.
+// Return: A boolean: True if the manifest was replaced.
+bool SegmentStore::writeManifest(const std::string& storePath, const SegmentManifest& manifest)
+{
+	const std::string fileName = storePath + "/MANIFEST";
+	std::ofstream file(fileName + ".tmp");
+
+	file << manifestMagic << "\n" << "key " << getKeyName(manifest.key) << "\n" << "epoch " << manifest.epoch << "\n"
+		<< "sequence " << manifest.nextSequence << "\n" << "next " << manifest.nextFile << "\n";
+
+	for (const SegmentInfo& segment : manifest.segments)
+	{
+		file << "segment " << segment.fileNumber << " " << segment.firstKey << " " << segment.lastKey << " " << segment.numTasks;
+
+		if (segment.hasChecksum)
+			file << " " << segment.checksum;
+
+		file << "\n";
+	}
+
+	file.close();
+
+	return file && rename((fileName + ".tmp").c_str(), fileName.c_str()) == 0;
+}
+
+// Name:   getOwners(const SegmentManifest& manifest)
+// Desc:   Find the segment that holds each key, the newest segment whose
+//         range has the key.
+// Param:  manifest: The manifest of the store.
+// Return: A map from each key to the file number of its segment.
+std::unordered_map<int, uint32_t> SegmentStore::getOwners(const SegmentManifest& manifest)
+{
+	std::unordered_map<int, uint32_t> owners;
+
+	for (const SegmentInfo& segment : manifest.segments)
+	{
+		for (int key = segment.firstKey; key <= segment.lastKey; key++)
+			owners[key] = segment.fileNumber;
+	}
+
+	return owners;
+}
+
+// Name:   ownsKeyIn(const SegmentInfo& segment, const unordered_map<int, uint32_t>& owners, int firstKey, int lastKey)
+// Desc:   Check if a segment holds any key of a range that no newer
+//         segment shadows.
+// Param:  segment: The segment to check.
+//         owners: The segment of each key, from getOwners().
+//         firstKey: The first key of the range.
+//         lastKey: The last key of the range.
+// Return: A boolean: True if the segment has to be read for the range.
+bool SegmentStore::ownsKeyIn(const SegmentInfo& segment, const std::unordered_map<int, uint32_t>& owners,
+	int firstKey, int lastKey)
+{
+	for (int key = std::max(segment.firstKey, firstKey); key <= std::min(segment.lastKey, lastKey); key++)
+	{
+		if (owners.at(key) == segment.fileNumber)
+			return true;
+	}
+
+	return false;
+}
+
+// Name:   removeUnlisted(const string& storePath, const SegmentManifest& manifest)
+// Desc:   Delete the segment files the manifest does not list. The
+//         exclusive lock of the store has to be held.
+// Param:  storePath: The directory of the store.
+//         manifest: The manifest that was just written.
+// Return: None
+void SegmentStore::removeUnlisted(const std::string& storePath, const SegmentManifest& manifest)
+{
+	std::set<std::string> listed;
+	std::error_code error;
+
+	for (const SegmentInfo& segment : manifest.segments)
+		listed.insert(getSegmentPath(storePath, segment.fileNumber));
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(storePath, error))
+	{
+		const std::string path = (std::filesystem::path(storePath) / entry.path().filename()).string();
+
+		if (entry.path().extension() == ".seg" && !listed.count(path))
+			std::filesystem::remove(entry.path(), error);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <climits>
+#include <cstdint>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: An enum of the keys tasks can be partitioned by.
+               The SegmentInfo structure is one segment file and the range
+			   of keys it holds. The SegmentManifest structure is the list
+			   of segments of a store, oldest first. The StoreBinding
+			   structure ties a task list to the store it was loaded from
+			   and collects the due months that changed since.
+			   The SegmentStore class saves a task list as a directory of
+			   segment files, one per due month by default, listed in a
+			   manifest. A task list that was loaded from a store only
+			   rewrites the months that changed: the new segment is added
+			   to the manifest and shadows the keys it holds in the older
+			   segments. A load for a due date range only opens the
+			   segments that hold keys in the range. A background
+			   compaction merges the small and shadowed segments into
+			   larger ones and deletes the files that are not needed.
+			   Each segment has a CRC-32C in the manifest, a segment that
+			   does not match it is reported and its tasks are skipped.
+
+			   Store layout (text files):
+			   MANIFEST: STS1, key <name>, epoch <n>, sequence <next>,
+			             next <file>, then one line per segment:
+			             segment <file> <first key> <last key> <tasks> <checksum>
+			   <file>.seg: sequence,name length,task line per task, with
+			             a ,^<sequence + 1> field for each task it waits for
+#****************************************************************************/
+
+enum SEGMENT_KEYS { DUE_MONTH, DUE_QUARTER, DUE_YEAR, NUM_KEYS };
+
+class TaskManager;
+struct LoadReport;
+
+struct SegmentInfo
+{
+	uint32_t fileNumber;
+	int firstKey;
+	int lastKey;
+	uint32_t numTasks;
+	uint32_t checksum;
+	bool hasChecksum;
+};
+
+struct SegmentManifest
+{
+	SEGMENT_KEYS key;
+	unsigned int epoch;
+	unsigned int nextSequence;
+	uint32_t nextFile;
+	std::vector<SegmentInfo> segments;
+};
+
+struct StoreBinding
+{
+	std::string storePath;
+	unsigned int epoch;
+	std::set<int> dirtyMonths;
+};
+
+class SegmentStore
+{
+public:
+	static const char* storeExtension;
+	static const uint32_t smallSegmentTasks = 256;
+	static const uint32_t targetSegmentTasks = 16384;
+	static const size_t compactionTrigger = 8;
+
+	static const char* getKeyName(SEGMENT_KEYS key);
+	static bool getKeyFromName(const std::string& name, SEGMENT_KEYS& key);
+	static int getMonthKey(int serial);
+	static int getKey(SEGMENT_KEYS key, int monthKey);
+	static bool isStoreName(const std::string& fileName);
+
+	static bool create(const std::string& storeName, SEGMENT_KEYS key);
+	static bool save(const TaskManager& manager, const std::string& storeName);
+	static bool load(TaskManager& manager, const std::string& storeName, bool append,
+		int firstSerial = INT_MIN, int lastSerial = INT_MAX);
+	static bool readManifest(const std::string& storeName, SegmentManifest& manifest);
+	static bool verify(const std::string& storeName, LoadReport& report, std::string& error);
+	static bool needsCompaction(const SegmentManifest& manifest);
+	static bool compact(const std::string& storeName);
+	static void scheduleCompaction(const std::string& storeName);
+
+private:
+	static std::string getStorePath(const std::string& storeName);
+	static std::string getSegmentPath(const std::string& storePath, uint32_t fileNumber);
+	static int lockStore(const std::string& storePath, const char* lockName, int operation);
+	static void unlockStore(int lockFile);
+	static bool writeManifest(const std::string& storePath, const SegmentManifest& manifest);
+	static std::unordered_map<int, uint32_t> getOwners(const SegmentManifest& manifest);
+	static bool ownsKeyIn(const SegmentInfo& segment, const std::unordered_map<int, uint32_t>& owners,
+		int firstKey, int lastKey);
+	static void removeUnlisted(const std::string& storePath, const SegmentManifest& manifest);
+};
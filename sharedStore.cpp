@@ -0,0 +1,1142 @@
+#include "sharedStore.h"
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <new>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The sequence counter has to work across processes");
+
+namespace
+{
+	const size_t minArenaBytes = (size_t)64 << 20;
+	const uint32_t minRecords = 1 << 18;
+	const int maxWaitMilliseconds = 5000;
+	const int maxOddReads = 64;
+
+	// Tasks are shared this far apart in order, so a task put back between two others has room
+	const uint64_t orderGap = 1 << 16;
+
+	// Name:   getHeaderBytes(size_t headerSize)
+	// Desc:   Round the header up to a cache line, where the records start.
+	// Param:  headerSize: The size of the header.
+	// Return: The number of bytes before the records.
+	size_t getHeaderBytes(size_t headerSize)
+	{
+		return (headerSize + 63) & ~(size_t)63;
+	}
+}
+
+// Name:   getRegionName(const string& fileName)
+// Desc:   Find the name of the shared memory region of a task file. Every
+//         name the file can be opened by leads to the same region.
+// Param:  fileName: The name of the task file.
+// Return: A string with the name of the region.
+std::string SharedStore::getRegionName(const std::string& fileName)
+{
+	std::error_code code;
+	std::filesystem::path path = std::filesystem::weakly_canonical(std::filesystem::absolute(fileName, code), code);
+	const std::string pathText = code ? fileName : path.string();
+	uint64_t hash = 14695981039346656037ull;
+	char name[32];
+
+	for (unsigned char c : pathText)
+	{
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+
+	snprintf(name, sizeof(name), "/simpletask-%016llx", (unsigned long long)hash);
+
+	return name;
+}
+
+// Name:   SharedStore(TaskManager& manager)
+// Desc:   Constructor that sets the task list kept in step with the region.
+// Param:  manager: The task manager of this process.
+// Return: None
+SharedStore::SharedStore(TaskManager& manager)
+	: manager(manager), header(nullptr), records(nullptr), arena(nullptr), regionBytes(0), syncedChange(0),
+	syncedSequence(0), numDropped(0), applying(false)
+{
+}
+
+// Name:   ~SharedStore()
+// Desc:   Destructor that leaves the region.
+// Param:  None
+// Return: None
+SharedStore::~SharedStore()
+{
+	detach();
+}
+
+// Name:   attach(const string& fileName)
+// Desc:   Share the list of a task file with the other processes that
+//         opened it. The first process loads the file into the region,
+//         the others replace their list with the one in the region.
+// Param:  fileName: The name of the task file.
+// Return: A boolean: True if the list is shared, see getError() if not.
+bool SharedStore::attach(const std::string& fileName)
+{
+	detach();
+
+	this->fileName = fileName;
+	regionName = getRegionName(fileName);
+	error.clear();
+
+	for (int attempt = 0; attempt < 100; attempt++)
+	{
+		int fd = shm_open(regionName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+		if (fd >= 0)
+		{
+			bool loaded = true;
+
+			if (manager.checkFileExists(fileName))
+				loaded = manager.loadFromFile(fileName);
+			else
+				manager.emptyTasks();
+
+			if (!loaded)
+				error = "Could not load " + fileName + ".";
+
+			const bool created = loaded && create(fd);
+			close(fd);
+
+			if (!created)
+			{
+				shm_unlink(regionName.c_str());
+				unmapRegion();
+				return false;
+			}
+
+			manager.setChangeHandler([this](const Node* node, bool removed) { publish(node, removed); });
+			return true;
+		}
+
+		if (errno != EEXIST)
+		{
+			error = "Could not open the shared memory: " + std::string(strerror(errno));
+			return false;
+		}
+
+		// The last process can remove the region between the two opens
+		fd = shm_open(regionName.c_str(), O_RDWR, 0600);
+
+		if (fd < 0)
+			continue;
+
+		const bool joined = join(fd);
+		close(fd);
+
+		if (joined)
+		{
+			manager.setChangeHandler([this](const Node* node, bool removed) { publish(node, removed); });
+			return true;
+		}
+
+		if (!error.empty())
+			return false;
+
+		// The region is being closed, so wait for it to be removed
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	error = "The shared memory of " + fileName + " is being closed by another process.";
+
+	return false;
+}
+
+// Name:   detach()
+// Desc:   Stop sharing the list. The last process to leave removes the
+//         region, so changes that were not saved are gone with it.
+// Param:  None
+// Return: None
+void SharedStore::detach()
+{
+	if (!header)
+		return;
+
+	manager.setChangeHandler(nullptr);
+
+	if (lock())
+	{
+		pid_t* last = header->processes + header->numProcesses;
+		pid_t* own = std::find(header->processes, last, getpid());
+
+		if (own != last)
+		{
+			*own = *(last - 1);
+			header->numProcesses--;
+		}
+
+		pruneProcesses();
+
+		if (header->numProcesses == 0)
+		{
+			header->closed = 1;
+			shm_unlink(regionName.c_str());
+		}
+
+		unlock();
+	}
+
+	unmapRegion();
+}
+
+// Name:   isAttached()
+// Desc:   Check if the list is shared.
+// Param:  None
+// Return: A boolean: True if the store is attached to a region.
+bool SharedStore::isAttached() const
+{
+	return header != nullptr;
+}
+
+// Name:   getFileName()
+// Desc:   Retrieve the task file that is shared.
+// Param:  None
+// Return: A constant reference to the file name.
+const std::string& SharedStore::getFileName() const
+{
+	return fileName;
+}
+
+// Name:   getError()
+// Desc:   Retrieve why the last attach or save failed.
+// Param:  None
+// Return: A constant reference to the message.
+const std::string& SharedStore::getError() const
+{
+	return error;
+}
+
+// Name:   hasChanged()
+// Desc:   Check if the region changed since the last sync without
+//         taking the mutex. Only the sequence counter is read.
+// Param:  None
+// Return: A boolean: True if another process changed the list.
+bool SharedStore::hasChanged() const
+{
+	return header && header->sequence.load(std::memory_order_acquire) != syncedSequence;
+}
+
+// Name:   sync(SyncReport& report)
+// Desc:   Apply the changes other processes made since the last sync to
+//         the list of this process. Only the tasks in the ring of
+//         changes are read, unless the process fell a whole ring behind.
+// Param:  report: Receives how the list was brought up to date.
+// Return: A boolean: False if the store is not attached.
+bool SharedStore::sync(SyncReport& report)
+{
+	std::vector<SharedTask> tasks;
+	uint64_t numChanges = 0;
+	uint64_t sequence = 0;
+
+	report = { SYNC_MODES::UNCHANGED, 0, 0, 0 };
+
+	if (!header)
+		return false;
+
+	const bool rebuild = readTasks(false, tasks, numChanges, sequence);
+
+	applying = true;
+
+	if (rebuild)
+		rebuildList(tasks, report);
+	else if (numChanges != syncedChange)
+	{
+		for (const SharedTask& task : tasks)
+			applyTask(task, report);
+
+		report.mode = SYNC_MODES::DIFFED;
+	}
+
+	applying = false;
+	syncedChange = numChanges;
+	syncedSequence = sequence;
+
+	return true;
+}
+
+// Name:   save()
+// Desc:   Write the shared list to the task file, unless no process has
+//         changed it since the last save. The mutex is held throughout,
+//         so the file gets the list exactly as it is in the region.
+// Param:  None
+// Return: A boolean: True if the file holds the shared list.
+bool SharedStore::save()
+{
+	SyncReport report;
+	bool saved = true;
+
+	if (!header || !lock())
+	{
+		error = "The list is not shared.";
+		return false;
+	}
+
+	sync(report);
+
+	if (header->savedChange != header->numChanges || !manager.checkFileExists(fileName))
+	{
+		saved = manager.saveToFile(fileName);
+
+		if (saved)
+			header->savedChange = header->numChanges;
+		else
+			error = "Could not save " + fileName + ".";
+	}
+
+	unlock();
+
+	return saved;
+}
+
+// Name:   hasUnsavedChanges()
+// Desc:   Check if any process changed the shared list since it was
+//         last saved.
+// Param:  None
+// Return: A boolean: True if the file is behind the region.
+bool SharedStore::hasUnsavedChanges() const
+{
+	return header && header->savedChange != header->numChanges;
+}
+
+// Name:   getNumAttached()
+// Desc:   Retrieve the number of processes that share the list.
+// Param:  None
+// Return: The number of processes, 0 if the store is not attached.
+int SharedStore::getNumAttached() const
+{
+	return header ? header->numProcesses : 0;
+}
+
+// Name:   getNumDropped()
+// Desc:   Retrieve the number of edits of this process that were not
+//         shared, because another process changed the task first or the
+//         region was full.
+// Param:  None
+// Return: The number of edits.
+uint64_t SharedStore::getNumDropped() const
+{
+	return numDropped;
+}
+
+// Name:   getRegionBytes()
+// Desc:   Retrieve the size of the region. Its pages only take memory
+//         once they are written.
+// Param:  None
+// Return: The number of bytes.
+size_t SharedStore::getRegionBytes() const
+{
+	return regionBytes;
+}
+
+// Name:   getBytesUsed()
+// Desc:   Retrieve the bytes of the region that hold the header, the
+//         records that were ever used and the lines.
+// Param:  None
+// Return: The number of bytes.
+size_t SharedStore::getBytesUsed() const
+{
+	if (!header)
+		return 0;
+
+	return getHeaderBytes(sizeof(Header)) + (size_t)header->numSlots * sizeof(Record) + header->arenaUsed;
+}
+
+// Name:   create(int fd)
+// Desc:   Size a new region for the list of this process and fill it.
+//         There is room for at least twice the tasks and four times the
+//         text of the file. Pages that are never written take no memory.
+// Param:  fd: The descriptor of the new region.
+// Return: A boolean: True if the region was set up.
+bool SharedStore::create(int fd)
+{
+	size_t lineBytes = 0;
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		lineBytes += TaskManager::formatTaskLine(currNode->task).size();
+
+	const uint32_t recordCapacity = std::max<uint32_t>(minRecords, (uint32_t)std::min<uint64_t>(UINT32_MAX - 1, (uint64_t)manager.getNumTasks() * 2));
+	const size_t arenaCapacity = std::max(minArenaBytes, lineBytes * 4);
+	const size_t bytes = getHeaderBytes(sizeof(Header)) + (size_t)recordCapacity * sizeof(Record) + arenaCapacity;
+
+	if (ftruncate(fd, bytes) != 0 || !mapRegion(fd, bytes))
+	{
+		error = "Could not size the shared memory: " + std::string(strerror(errno));
+		return false;
+	}
+
+	pthread_mutexattr_t attributes;
+	header = new (header) Header();
+
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+	pthread_mutex_init(&header->mutex, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+
+	header->magic = regionMagic;
+	header->recordCapacity = recordCapacity;
+	header->arenaCapacity = arenaCapacity;
+	header->freeSlot = noSlot;
+	header->nextOrder = orderGap;
+	records = reinterpret_cast<Record*>(reinterpret_cast<char*>(header) + getHeaderBytes(sizeof(Header)));
+	arena = reinterpret_cast<char*>(records + recordCapacity);
+
+	lock();
+	addProcess();
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		const uint32_t slot = allocateSlot();
+		std::string line = TaskManager::formatTaskLine(currNode->task);
+
+		if (slot == noSlot || !writeLine(slot, line, currNode->task.getName().size()))
+			break;
+
+		mapTask(slot, currNode, records[slot].version, records[slot].order);
+	}
+
+	syncedChange = 0;
+	syncedSequence = header->sequence.load();
+	header->ready.store(1, std::memory_order_release);
+	unlock();
+
+	return true;
+}
+
+// Name:   join(int fd)
+// Desc:   Map a region another process made and replace the list of
+//         this process with the shared list.
+// Param:  fd: The descriptor of the region.
+// Return: A boolean: True if the list is shared. On false the error is
+//         set, unless the region was being closed.
+bool SharedStore::join(int fd)
+{
+	struct stat status;
+	int waited = 0;
+
+	// The creator sizes the region first and marks it ready once the tasks are in
+	while (fstat(fd, &status) != 0 || (size_t)status.st_size < getHeaderBytes(sizeof(Header)))
+	{
+		if (++waited > maxWaitMilliseconds)
+		{
+			error = "The shared memory of " + fileName + " was never set up.";
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	if (!mapRegion(fd, status.st_size))
+	{
+		error = "Could not map the shared memory: " + std::string(strerror(errno));
+		return false;
+	}
+
+	while (!header->ready.load(std::memory_order_acquire))
+	{
+		if (++waited > maxWaitMilliseconds)
+		{
+			error = "The shared memory of " + fileName + " was never filled, remove /dev/shm" + regionName + " to start over.";
+			unmapRegion();
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	const size_t headerBytes = getHeaderBytes(sizeof(Header));
+
+	if (header->magic != regionMagic
+		|| regionBytes < headerBytes + (size_t)header->recordCapacity * sizeof(Record) + header->arenaCapacity)
+	{
+		error = "/dev/shm" + regionName + " is not the shared memory of a task list.";
+		unmapRegion();
+		return false;
+	}
+
+	records = reinterpret_cast<Record*>(reinterpret_cast<char*>(header) + headerBytes);
+	arena = reinterpret_cast<char*>(records + header->recordCapacity);
+
+	if (!lock())
+	{
+		error = "The shared memory of " + fileName + " cannot be locked.";
+		unmapRegion();
+		return false;
+	}
+
+	if (header->closed)
+	{
+		unlock();
+		unmapRegion();
+		return false;
+	}
+
+	if (!addProcess())
+	{
+		unlock();
+		unmapRegion();
+		error = "Too many processes share " + fileName + ".";
+		return false;
+	}
+
+	std::vector<SharedTask> tasks;
+	SyncReport report;
+	uint64_t numChanges = 0;
+	uint64_t sequence = 0;
+
+	readTasks(true, tasks, numChanges, sequence);
+	applying = true;
+	rebuildList(tasks, report);
+	applying = false;
+	syncedChange = numChanges;
+	syncedSequence = sequence;
+	unlock();
+
+	return true;
+}
+
+// Name:   mapRegion(int fd, size_t bytes)
+// Desc:   Map a region into this process.
+// Param:  fd: The descriptor of the region.
+//         bytes: The size of the region.
+// Return: A boolean: True if the region was mapped.
+bool SharedStore::mapRegion(int fd, size_t bytes)
+{
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (memory == MAP_FAILED)
+		return false;
+
+	header = static_cast<Header*>(memory);
+	regionBytes = bytes;
+
+	return true;
+}
+
+// Name:   unmapRegion()
+// Desc:   Unmap the region and forget which local task is which shared one.
+// Param:  None
+// Return: None
+void SharedStore::unmapRegion()
+{
+	if (header)
+		munmap(header, regionBytes);
+
+	header = nullptr;
+	records = nullptr;
+	arena = nullptr;
+	regionBytes = 0;
+	syncedChange = 0;
+	syncedSequence = 0;
+	nodesBySlot.clear();
+	versionsBySlot.clear();
+	ordersBySlot.clear();
+	slotsByNode.clear();
+}
+
+// Name:   lock()
+// Desc:   Take the mutex of the writers.
+// Param:  None
+// Return: A boolean: True if the mutex is held.
+bool SharedStore::lock()
+{
+	return recoverLock(pthread_mutex_lock(&header->mutex));
+}
+
+// Name:   tryLock()
+// Desc:   Take the mutex of the writers if no live process holds it.
+// Param:  None
+// Return: A boolean: True if the mutex is held.
+bool SharedStore::tryLock()
+{
+	return recoverLock(pthread_mutex_trylock(&header->mutex));
+}
+
+// Name:   recoverLock(int result)
+// Desc:   Finish taking the mutex. When a process died holding it, a
+//         write it left half done makes every process rebuild its list
+//         on the next sync, and the dead process is no longer counted.
+// Param:  result: What taking the mutex returned.
+// Return: A boolean: True if the mutex is held.
+bool SharedStore::recoverLock(int result)
+{
+	if (result != 0 && result != EOWNERDEAD)
+		return false;
+
+	if (result == EOWNERDEAD)
+		pthread_mutex_consistent(&header->mutex);
+
+	// Only a writer that died leaves the counter odd once the mutex is free
+	if (header->sequence.load() & 1)
+	{
+		header->numChanges += changeRingSize + 1;
+		header->sequence.fetch_add(1, std::memory_order_release);
+	}
+
+	if (result == EOWNERDEAD)
+		pruneProcesses();
+
+	return true;
+}
+
+// Name:   unlock()
+// Desc:   Release the mutex of the writers.
+// Param:  None
+// Return: None
+void SharedStore::unlock()
+{
+	pthread_mutex_unlock(&header->mutex);
+}
+
+// Name:   beginWrite()
+// Desc:   Make the sequence counter odd, so readers retry anything they
+//         copy until the write ends. The mutex has to be held.
+// Param:  None
+// Return: None
+void SharedStore::beginWrite()
+{
+	header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+// Name:   endWrite()
+// Desc:   Make the sequence counter even again once a write is done.
+// Param:  None
+// Return: None
+void SharedStore::endWrite()
+{
+	header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Name:   addProcess()
+// Desc:   Count this process as sharing the list. The mutex has to be held.
+// Param:  None
+// Return: A boolean: False if the most processes already share it.
+bool SharedStore::addProcess()
+{
+	pruneProcesses();
+
+	if (header->numProcesses >= maxProcesses)
+		return false;
+
+	header->processes[header->numProcesses++] = getpid();
+
+	return true;
+}
+
+// Name:   pruneProcesses()
+// Desc:   Stop counting the processes that ended without leaving. The
+//         mutex has to be held.
+// Param:  None
+// Return: None
+void SharedStore::pruneProcesses()
+{
+	for (uint32_t i = 0; i < header->numProcesses;)
+	{
+		if (kill(header->processes[i], 0) != 0 && errno == ESRCH)
+			header->processes[i] = header->processes[--header->numProcesses];
+		else
+			i++;
+	}
+}
+
+// Name:   publish(const Node* node, bool removed)
+// Desc:   Write a task this process added, changed or is removing to the
+//         region, called by the change handler of the list. The edit is
+//         dropped if another process changed the task since the last
+//         sync, or if the region is full.
+// Param:  node: The node of the task.
+//         removed: A boolean that is true if the task is being removed.
+// Return: None
+void SharedStore::publish(const Node* node, bool removed)
+{
+	if (applying || !header || !lock())
+		return;
+
+	uint32_t slot = node->slot < slotsByNode.size() ? slotsByNode[node->slot] : noSlot;
+
+	// With no change of another process pending, this one leaves the process up to date
+	const bool upToDate = header->numChanges == syncedChange;
+
+	if (slot == noSlot && removed)
+	{
+		unlock();
+		return;
+	}
+
+	if (slot != noSlot && records[slot].version != versionsBySlot[slot])
+	{
+		// The next sync brings the task back as the other process left it
+		if (removed)
+		{
+			unmapTask(slot);
+			versionsBySlot[slot] = records[slot].version - 1;
+		}
+
+		numDropped++;
+		unlock();
+		return;
+	}
+
+	beginWrite();
+
+	if (removed)
+	{
+		freeSlot(slot);
+		unmapTask(slot);
+	}
+	else
+	{
+		const std::string line = TaskManager::formatTaskLine(node->task);
+		const bool isNew = slot == noSlot;
+
+		if (isNew)
+			slot = allocateSlot();
+
+		if (slot == noSlot || !writeLine(slot, line, node->task.getName().size()))
+		{
+			if (isNew && slot != noSlot)
+				freeSlot(slot);
+
+			endWrite();
+			numDropped++;
+			error = "The shared memory of " + fileName + " is full.";
+			unlock();
+			return;
+		}
+
+		if (isNew)
+			records[slot].order = getNewOrder(node, records[slot].order);
+
+		mapTask(slot, node, records[slot].version, records[slot].order);
+	}
+
+	logChange(slot);
+	endWrite();
+
+	if (upToDate)
+	{
+		syncedChange = header->numChanges;
+		syncedSequence = header->sequence.load(std::memory_order_relaxed);
+	}
+
+	unlock();
+}
+
+// Name:   allocateSlot()
+// Desc:   Take a free record, a removed one first. A record removed by
+//         another process since the last sync still has its task in this
+//         process, so a record that was never used is taken instead.
+// Param:  None
+// Return: The slot of the record, noSlot if the table is full.
+uint32_t SharedStore::allocateSlot()
+{
+	const uint32_t firstFree = header->freeSlot;
+
+	if (firstFree != noSlot && (firstFree >= nodesBySlot.size() || !nodesBySlot[firstFree]))
+	{
+		header->freeSlot = records[firstFree].nextFree;
+		return firstFree;
+	}
+
+	if (header->numSlots < header->recordCapacity)
+		return header->numSlots++;
+
+	return noSlot;
+}
+
+// Name:   freeSlot(uint32_t slot)
+// Desc:   Remove the task of a record and put the record on the free
+//         list. Its version moves on, so an edit based on it is refused.
+// Param:  slot: The slot of the record.
+// Return: None
+void SharedStore::freeSlot(uint32_t slot)
+{
+	Record& record = records[slot];
+
+	if (record.used)
+	{
+		header->liveBytes -= record.lineLength;
+		header->numTasks--;
+	}
+
+	record.used = 0;
+	record.version++;
+	record.nextFree = header->freeSlot;
+	header->freeSlot = slot;
+}
+
+// Name:   writeLine(uint32_t slot, const string& line, size_t nameLength)
+// Desc:   Set the line of a record. Lines are only appended to the arena,
+//         so a reader never sees one being overwritten, and the arena is
+//         compacted when it runs out.
+// Param:  slot: The slot of the record.
+//         line: The text line of the task.
+//         nameLength: The length of the name at the start of the line.
+// Return: A boolean: False if the arena is full of live lines.
+bool SharedStore::writeLine(uint32_t slot, const std::string& line, size_t nameLength)
+{
+	Record& record = records[slot];
+
+	if (line.size() > header->arenaCapacity - header->arenaUsed)
+	{
+		compactArena();
+
+		if (line.size() > header->arenaCapacity - header->arenaUsed)
+			return false;
+	}
+
+	memcpy(arena + header->arenaUsed, line.data(), line.size());
+
+	if (record.used)
+		header->liveBytes -= record.lineLength;
+	else
+	{
+		record.used = 1;
+		record.order = header->nextOrder;
+		header->nextOrder += orderGap;
+		header->numTasks++;
+	}
+
+	record.offset = header->arenaUsed;
+	record.lineLength = line.size();
+	record.nameLength = nameLength;
+	record.version++;
+	header->arenaUsed += line.size();
+	header->liveBytes += line.size();
+
+	return true;
+}
+
+// Name:   compactArena()
+// Desc:   Move the live lines to the start of the arena, dropping the
+//         ones of removed and changed tasks. Readers retry around it.
+// Param:  None
+// Return: None
+void SharedStore::compactArena()
+{
+	std::string live;
+
+	live.reserve(header->liveBytes);
+
+	for (uint32_t slot = 0; slot < header->numSlots; slot++)
+	{
+		Record& record = records[slot];
+
+		if (!record.used)
+			continue;
+
+		const uint64_t offset = live.size();
+		live.append(arena + record.offset, record.lineLength);
+		record.offset = offset;
+	}
+
+	memcpy(arena, live.data(), live.size());
+	header->arenaUsed = live.size();
+	header->liveBytes = live.size();
+}
+
+// Name:   logChange(uint32_t slot)
+// Desc:   Add the slot of a changed record to the ring of changes.
+// Param:  slot: The slot of the record.
+// Return: None
+void SharedStore::logChange(uint32_t slot)
+{
+	header->numChanges++;
+	header->changes[header->numChanges % changeRingSize] = slot;
+}
+
+// Name:   readTasks(bool all, vector<SharedTask>& tasks, uint64_t& numChanges, uint64_t& sequence)
+// Desc:   Copy the records that changed since the last sync, or every
+//         record in use, in the order the tasks were first shared. The
+//         copy is taken again until no write ran during it. A counter
+//         that stays odd may be the write of a process that died, so the
+//         mutex is tried now and then, which repairs the counter.
+// Param:  all: A boolean to copy every record in use.
+//         tasks: Receives the records.
+//         numChanges: Receives the number of changes the copy is up to.
+//         sequence: Receives the sequence counter the copy is up to.
+// Return: A boolean: True if every record in use was copied.
+bool SharedStore::readTasks(bool all, std::vector<SharedTask>& tasks, uint64_t& numChanges, uint64_t& sequence)
+{
+	std::vector<uint32_t> slots;
+	int numOddReads = 0;
+
+	while (true)
+	{
+		const uint64_t before = header->sequence.load(std::memory_order_acquire);
+
+		if (before & 1)
+		{
+			if (++numOddReads % maxOddReads == 0 && tryLock())
+				unlock();
+			else
+				std::this_thread::yield();
+
+			continue;
+		}
+
+		numChanges = header->numChanges;
+
+		const bool copyAll = all || numChanges < syncedChange || numChanges - syncedChange > changeRingSize;
+		const uint32_t numSlots = std::min(header->numSlots, header->recordCapacity);
+		bool torn = false;
+
+		slots.clear();
+		tasks.clear();
+
+		if (copyAll)
+		{
+			for (uint32_t slot = 0; slot < numSlots; slot++)
+			{
+				if (records[slot].used)
+					slots.push_back(slot);
+			}
+		}
+		else
+		{
+			for (uint64_t change = syncedChange + 1; change <= numChanges; change++)
+				slots.push_back(header->changes[change % changeRingSize]);
+
+			std::sort(slots.begin(), slots.end());
+			slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+		}
+
+		tasks.resize(slots.size());
+
+		for (size_t i = 0; i < slots.size() && !torn; i++)
+			torn = slots[i] >= header->recordCapacity || !copyRecord(slots[i], tasks[i]);
+
+		// The copies only count if the counter did not move while they were taken
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (torn || header->sequence.load(std::memory_order_relaxed) != before)
+			continue;
+
+		std::sort(tasks.begin(), tasks.end(), [](const SharedTask& left, const SharedTask& right) {
+			return left.order != right.order ? left.order < right.order : left.slot < right.slot;
+		});
+		sequence = before;
+
+		return copyAll;
+	}
+}
+
+// Name:   copyRecord(uint32_t slot, SharedTask& task)
+// Desc:   Copy a record and its line. A record caught in the middle of a
+//         write can point anywhere, so it is checked before the line is
+//         copied.
+// Param:  slot: The slot of the record.
+//         task: Receives the copy.
+// Return: A boolean: False if the record cannot be right.
+bool SharedStore::copyRecord(uint32_t slot, SharedTask& task) const
+{
+	const Record record = records[slot];
+
+	task.slot = slot;
+	task.used = record.used != 0;
+	task.version = record.version;
+	task.order = record.order;
+	task.nameLength = record.nameLength;
+	task.line.clear();
+
+	if (!task.used)
+		return true;
+
+	if (record.offset > header->arenaCapacity || record.lineLength > header->arenaCapacity - record.offset
+		|| record.nameLength > record.lineLength)
+		return false;
+
+	task.line.assign(arena + record.offset, record.lineLength);
+
+	return true;
+}
+
+// Name:   rebuildList(vector<SharedTask>& tasks, SyncReport& report)
+// Desc:   Replace the list of this process with every shared task, the
+//         way a file is loaded.
+// Param:  tasks: Every record in use, in the order the tasks were shared.
+//         report: Receives the number of tasks.
+// Return: None
+void SharedStore::rebuildList(std::vector<SharedTask>& tasks, SyncReport& report)
+{
+	TaskRecord record{};
+
+	nodesBySlot.clear();
+	versionsBySlot.clear();
+	ordersBySlot.clear();
+	slotsByNode.clear();
+
+	manager.beginLoad(false);
+
+	for (const SharedTask& task : tasks)
+	{
+		if (!TaskManager::parseTaskLine(task.line, record, task.nameLength))
+			continue;
+
+		Node* newNode = manager.addLoadedTask(record.name, record.dueDate, record.completed);
+
+		if (!record.recurrenceFields.empty())
+			manager.setRecurrence(newNode, TaskManager::parseRecurrence(record.recurrenceFields));
+
+		manager.setLabels(newNode, record.priority, record.tags);
+		mapTask(task.slot, newNode, task.version, task.order);
+		report.numAdded++;
+	}
+
+	manager.endLoad();
+	report.mode = SYNC_MODES::RELOADED;
+}
+
+// Name:   applyTask(const SharedTask& task, SyncReport& report)
+// Desc:   Bring one task of the list of this process in line with its
+//         record. A changed task is updated where it is, so it keeps its
+//         place and its dependencies, and a new task is put in its place
+//         in the shared order, as it is in every other process.
+// Param:  task: The copy of the record.
+//         report: Counts the task as added, updated or removed.
+// Return: None
+void SharedStore::applyTask(const SharedTask& task, SyncReport& report)
+{
+	const Node* node = task.slot < nodesBySlot.size() ? nodesBySlot[task.slot] : nullptr;
+	TaskRecord record{};
+
+	// A record that was freed and taken again since the last sync holds another task
+	if (node && (!task.used || ordersBySlot[task.slot] != task.order))
+	{
+		unmapTask(task.slot);
+		manager.deleteTask(node);
+		report.numRemoved++;
+		node = nullptr;
+	}
+
+	if (!task.used || (node && versionsBySlot[task.slot] == task.version))
+		return;
+
+	if (!TaskManager::parseTaskLine(task.line, record, task.nameLength))
+		return;
+
+	if (node)
+	{
+		manager.updateTask(node, record);
+		versionsBySlot[task.slot] = task.version;
+		report.numUpdated++;
+		return;
+	}
+
+	const Node* newNode = manager.addTask(record);
+
+	mapTask(task.slot, newNode, task.version, task.order);
+	placeTask(newNode, task.slot, task.order);
+	report.numAdded++;
+}
+
+// Name:   placeTask(const Node* node, uint32_t slot, uint64_t order)
+// Desc:   Move a task that was added at the end of the list back past the
+//         tasks that were shared after it. Tasks only come later than the
+//         end when another process added them at the same time or put a
+//         removed task back, so the walk is short.
+// Param:  node: The local node of the task.
+//         slot: The slot of its record.
+//         order: The order of its record.
+// Return: None
+void SharedStore::placeTask(const Node* node, uint32_t slot, uint64_t order)
+{
+	const Node* prev = node->prev;
+
+	// A task that is not shared has no order, so it is passed over
+	while (prev)
+	{
+		const uint32_t prevSlot = prev->slot < slotsByNode.size() ? slotsByNode[prev->slot] : noSlot;
+
+		if (prevSlot != noSlot && (ordersBySlot[prevSlot] < order || (ordersBySlot[prevSlot] == order && prevSlot < slot)))
+			break;
+
+		prev = prev->prev;
+	}
+
+	manager.moveTask(node, prev);
+}
+
+// Name:   getNewOrder(const Node* node, uint64_t order)
+// Desc:   Choose the order of a task this process shares for the first
+//         time. A task that is not at the end of the list, such as a
+//         removed task an undo put back, is ordered between the shared
+//         tasks around it, so every process lists it in the same place.
+// Param:  node: The local node of the task.
+//         order: The order of a task added at the end.
+// Return: The order of the task, the order given if there is no room
+//         between its neighbours.
+uint64_t SharedStore::getNewOrder(const Node* node, uint64_t order) const
+{
+	const Node* next = node->next;
+	const Node* prev = node->prev;
+	uint32_t nextSlot = noSlot;
+	uint32_t prevSlot = noSlot;
+
+	for (; next && nextSlot == noSlot; next = next->next)
+		nextSlot = next->slot < slotsByNode.size() ? slotsByNode[next->slot] : noSlot;
+
+	if (nextSlot == noSlot)
+		return order;
+
+	for (; prev && prevSlot == noSlot; prev = prev->prev)
+		prevSlot = prev->slot < slotsByNode.size() ? slotsByNode[prev->slot] : noSlot;
+
+	const uint64_t prevOrder = prevSlot == noSlot ? 0 : ordersBySlot[prevSlot];
+	const uint64_t nextOrder = ordersBySlot[nextSlot];
+
+	if (nextOrder <= prevOrder || nextOrder - prevOrder < 2)
+		return order;
+
+	return prevOrder + (nextOrder - prevOrder) / 2;
+}
+
+// Name:   mapTask(uint32_t slot, const Node* node, uint32_t version, uint64_t order)
+// Desc:   Remember which local task a shared record is.
+// Param:  slot: The slot of the record.
+//         node: The local node of the task.
+//         version: The version of the record the task matches.
+//         order: The order of the record.
+// Return: None
+void SharedStore::mapTask(uint32_t slot, const Node* node, uint32_t version, uint64_t order)
+{
+	if (slot >= nodesBySlot.size())
+	{
+		nodesBySlot.resize(slot + 1, nullptr);
+		versionsBySlot.resize(slot + 1, 0);
+		ordersBySlot.resize(slot + 1, 0);
+	}
+
+	if (node->slot >= slotsByNode.size())
+		slotsByNode.resize(node->slot + 1, uint32_t(noSlot));
+
+	nodesBySlot[slot] = node;
+	versionsBySlot[slot] = version;
+	ordersBySlot[slot] = order;
+	slotsByNode[node->slot] = slot;
+}
+
+// Name:   unmapTask(uint32_t slot)
+// Desc:   Forget the local task of a shared record.
+// Param:  slot: The slot of the record.
+// Return: None
+void SharedStore::unmapTask(uint32_t slot)
+{
+	if (slot >= nodesBySlot.size() || !nodesBySlot[slot])
+		return;
+
+	slotsByNode[nodesBySlot[slot]->slot] = noSlot;
+	nodesBySlot[slot] = nullptr;
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <pthread.h>
+#include <sys/types.h>
+#include "taskManager.h"
+#include "fileWatcher.h"
+
+/*****************************************************************************
+# Description: The SharedStore class lets every process that opens the
+               same task file work on one live list. The shared copy of
+			   the list is kept in a named POSIX shared memory region: a
+			   table of task records, each the text line of its task in an
+			   arena, and a ring of the slots of the latest changes.
+			   Writers hold a robust process-shared mutex, readers copy
+			   what they need between two reads of a sequence counter that
+			   is odd during a write and try again if it moved, so a
+			   reader never waits for the mutex. A reader that keeps
+			   finding the counter odd tries the mutex, which repairs it
+			   after a writer that died. Each process still keeps a full
+			   TaskManager with its own copy of every task as well as its
+			   views and indexes, so N processes hold N + 1 copies of the
+			   tasks: the region does not save memory, it keeps the copies
+			   in step. Each process's edits reach the region through the
+			   change handler of the list, and the changes of other
+			   processes are applied from the ring without loading the
+			   file. A process that fell a whole ring behind rebuilds its
+			   list from the table. A save holds the mutex and writes the
+			   shared list, so the file is only written once for the
+			   changes of every process. An edit to a task another process
+			   changed first is dropped, and the next sync shows the other
+			   change. Tasks are listed in the order they were first
+			   shared in every process, and a changed task keeps its
+			   place. Dependencies stay with the process that made them.
+#****************************************************************************/
+
+class SharedStore
+{
+public:
+	static const uint32_t changeRingSize = 4096;
+	static const uint32_t maxProcesses = 64;
+
+	static std::string getRegionName(const std::string& fileName);
+
+	SharedStore(TaskManager& manager);
+	SharedStore(const SharedStore& origStore) = delete;
+	const SharedStore& operator=(const SharedStore& origStore) = delete;
+	~SharedStore();
+
+	bool attach(const std::string& fileName);
+	void detach();
+	bool isAttached() const;
+	const std::string& getFileName() const;
+	const std::string& getError() const;
+
+	bool hasChanged() const;
+	bool sync(SyncReport& report);
+	bool save();
+	bool hasUnsavedChanges() const;
+	int getNumAttached() const;
+	uint64_t getNumDropped() const;
+	size_t getRegionBytes() const;
+	size_t getBytesUsed() const;
+
+private:
+	static const uint32_t regionMagic = 0x53544d31;
+	static const uint32_t noSlot = UINT32_MAX;
+
+	struct Record
+	{
+		uint64_t order;
+		uint64_t offset;
+		uint32_t lineLength;
+		uint32_t nameLength;
+		uint32_t version;
+		uint32_t used;
+		uint32_t nextFree;
+		uint32_t reserved;
+	};
+
+	struct Header
+	{
+		uint32_t magic;
+		std::atomic<uint32_t> ready;
+		pthread_mutex_t mutex;
+		std::atomic<uint64_t> sequence;
+		uint64_t numChanges;
+		uint64_t savedChange;
+		uint64_t nextOrder;
+		uint64_t arenaCapacity;
+		uint64_t arenaUsed;
+		uint64_t liveBytes;
+		uint32_t recordCapacity;
+		uint32_t numSlots;
+		uint32_t freeSlot;
+		uint32_t numTasks;
+		uint32_t closed;
+		uint32_t numProcesses;
+		pid_t processes[maxProcesses];
+		uint32_t changes[changeRingSize];
+	};
+
+	struct SharedTask
+	{
+		uint32_t slot;
+		bool used;
+		uint32_t version;
+		uint64_t order;
+		uint32_t nameLength;
+		std::string line;
+	};
+
+	bool create(int fd);
+	bool join(int fd);
+	bool mapRegion(int fd, size_t bytes);
+	void unmapRegion();
+	bool lock();
+	bool tryLock();
+	bool recoverLock(int result);
+	void unlock();
+	void beginWrite();
+	void endWrite();
+	bool addProcess();
+	void pruneProcesses();
+
+	void publish(const Node* node, bool removed);
+	uint32_t allocateSlot();
+	void freeSlot(uint32_t slot);
+	bool writeLine(uint32_t slot, const std::string& line, size_t nameLength);
+	void compactArena();
+	void logChange(uint32_t slot);
+
+	bool readTasks(bool all, std::vector<SharedTask>& tasks, uint64_t& numChanges, uint64_t& sequence);
+	bool copyRecord(uint32_t slot, SharedTask& task) const;
+	void rebuildList(std::vector<SharedTask>& tasks, SyncReport& report);
+	void applyTask(const SharedTask& task, SyncReport& report);
+	void placeTask(const Node* node, uint32_t slot, uint64_t order);
+	uint64_t getNewOrder(const Node* node, uint64_t order) const;
+	void mapTask(uint32_t slot, const Node* node, uint32_t version, uint64_t order);
+	void unmapTask(uint32_t slot);
+
+	TaskManager& manager;
+	std::string fileName;
+	std::string regionName;
+	std::string error;
+	Header* header;
+	Record* records;
+	char* arena;
+	size_t regionBytes;
+	uint64_t syncedChange;
+	uint64_t syncedSequence;
+	uint64_t numDropped;
+	bool applying;
+
+	// The local node, the version it was synced at and the order of each shared slot, and the shared slot of each local node
+	std::vector<const Node*> nodesBySlot;
+	std::vector<uint32_t> versionsBySlot;
+	std::vector<uint64_t> ordersBySlot;
+	std::vector<uint32_t> slotsByNode;
+};
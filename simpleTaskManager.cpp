@@ -1,13 +1,24 @@
 #include "simpleTaskManager.h"
+#include "taskArchive.h"
+#include "segmentStore.h"
+#include "taskFilter.h"
+#include "taskTags.h"
+#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <chrono>
 
 // Name:   SimpleTaskManager()
 // Desc:   Default constructor that initializes the members.
 // Param:  None
 // Return: None
 SimpleTaskManager::SimpleTaskManager()
-	: currState(STATES::MENU), currFile("None"), running(true), fileModified(false)
+	: shared(manager), currState(STATES::MENU), currView(VIEWS::INSERTION_ORDER), currFile("None"), running(true), fileModified(false),
+	numDroppedShown(0), fileJobState(STATES::MENU), loadDedup(DEDUP_POLICIES::KEEP_ALL), fileWorker(1)
 {
 	messageMargin = 4;
+
+	manager.startReminders([this](const Reminder& reminder) { addReminderNotice(reminder); });
 }
 
 // Name:   programLoop()
@@ -18,6 +29,9 @@ void SimpleTaskManager::programLoop()
 {
 	while (running)
 	{
+		if (needsFileJob(currState))
+			finishFileJob(true);
+
 		switch (currState)
 		{
 			case STATES::MENU:
@@ -29,6 +43,18 @@ void SimpleTaskManager::programLoop()
 				stateDisplay();
 				break;
 
+			case STATES::CHANGEVIEW:
+				stateChangeView();
+				break;
+
+			case STATES::NEXTDUE:
+				stateNextDue();
+				break;
+
+			case STATES::AGENDA:
+				stateAgenda();
+				break;
+
 			case STATES::ADD:
 				stateAdd();
 				break;
@@ -49,14 +75,42 @@ void SimpleTaskManager::programLoop()
 				stateLoad();
 				break;
 
+			case STATES::IMPORT:
+				stateImport();
+				break;
+
 			case STATES::SAVE:
 				stateSave();
 				break;
 
+			case STATES::WORKSPACE:
+				stateWorkspace();
+				break;
+
+			case STATES::WATCH:
+				stateWatch();
+				break;
+
+			case STATES::SHARE:
+				stateShare();
+				break;
+
+			case STATES::DEPENDENCIES:
+				stateDependencies();
+				break;
+
 			case STATES::QUIT:
 				stateQuit();
 				break;
 
+			case STATES::UNDO:
+				stateUndo();
+				break;
+
+			case STATES::REDO:
+				stateRedo();
+				break;
+
 			default:
 				displayMessage("You shouldn't be here.");
 				running = false;
@@ -65,9 +119,13 @@ void SimpleTaskManager::programLoop()
 
 		if (running)
 		{
+			finishFileJob(false);
+			checkWatchedFile();
+			checkSharedList();
+			checkReminders();
 			addGap();
 			displayMessage("(Main Menu)");
-			currState = (STATES)getIntInput("Choice (0 for menu): ", STATES::MENU, STATES::QUIT);
+			currState = (STATES)getMenuInput("Choice (0 for menu): ", STATES::MENU, STATES::QUIT, "ur");
 		}
 	}
 
@@ -76,19 +134,162 @@ void SimpleTaskManager::programLoop()
 }
 
 // Name:   stateDisplay()
-// Desc:   Display the tasks to the console.
+// Desc:   Display the tasks to the console, optionally only the ones that
+//         match a filter such as: !completed && due < 12/01/2024
 // Param:  None
 // Return: None
 void SimpleTaskManager::stateDisplay()
 {
+	TaskFilter filter;
+	std::string expression;
+
 	addGap();
-	if (manager.getNumTasks() > 0)
+	if (manager.getNumTasks() < 1)
 	{
-		displayMessage("Tasks (Task Name | Due Date | Status):");
-		displayTasks(manager.getTasks());
+		displayMessage("There are no tasks in your list!");
+		return;
 	}
-	else
+
+	displayMessage("Filter (Enter for all tasks): ", false);
+	std::getline(std::cin, expression, '\n');
+
+	if (!filter.compile(expression))
+	{
+		displayMessage("Invalid filter: " + filter.getError());
+		return;
+	}
+
+	displayMessage("Tasks by " + std::string(TaskViews::getViewName(currView)) + " (Task Name | Due Date | Status):");
+
+	if (expression.find_first_not_of(" \t") == std::string::npos)
+	{
+		displayTasks(currView);
+		return;
+	}
+
+	std::vector<const Node*> matches = filter.apply(manager, currView);
+	displayTaskList(matches);
+
+	displayMessage(std::to_string(matches.size()) + " of " + std::to_string(manager.getNumTasks()) + " task(s) match the filter.");
+}
+
+// Name:   stateChangeView()
+// Desc:   Choose the order the tasks are displayed in.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateChangeView()
+{
+	addGap();
+	displayMessage("Current view: " + std::string(TaskViews::getViewName(currView)));
+
+	for (int view = 0; view < VIEWS::NUM_VIEWS; view++)
+	{
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << view + 1 << ". " << TaskViews::getViewName((VIEWS)view) << std::endl;
+	}
+
+	int userChoice = getIntInput("Choose a view (0 to cancel): ", 0, VIEWS::NUM_VIEWS);
+
+	if (userChoice != 0)
+	{
+		// The views are kept sorted by the task manager, so switching is free
+		currView = (VIEWS)(userChoice - 1);
+		displayMessage("View changed to: " + std::string(TaskViews::getViewName(currView)));
+	}
+}
+
+// Name:   stateNextDue()
+// Desc:   Display the incomplete tasks that are due the soonest.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateNextDue()
+{
+	addGap();
+	if (manager.getNumTasks() < 1)
+	{
+		displayMessage("There are no tasks in your list!");
+		return;
+	}
+
+	int count = getIntInput("How many tasks (1-100)? ", 1, 100);
+	std::vector<const Node*> nextDue = manager.getNextDue(count);
+
+	if (nextDue.empty())
+	{
+		displayMessage("There are no incomplete tasks!");
+		return;
+	}
+
+	const int today = Date::today().getSerial();
+	const std::vector<int> days = TaskManager::getDaysUntilDue(nextDue, today);
+	const std::vector<int> weeks = TaskManager::getWeeksUntilDue(nextDue, today);
+
+	displayMessage("Next Due Tasks (Task Name | Due Date | Status):");
+	for (size_t i = 0; i < nextDue.size(); i++)
+	{
+		// The tasks are in due date order, so each week is shown once
+		if (i == 0 || weeks[i] != weeks[i - 1])
+		{
+			if (weeks[i] < 0)
+				displayMessage("Before this week:");
+			else if (weeks[i] == 0)
+				displayMessage("This week:");
+			else if (weeks[i] == 1)
+				displayMessage("Next week:");
+			else
+				displayMessage("In " + std::to_string(weeks[i]) + " weeks:");
+		}
+
+		displayTask(i + 1, nextDue[i]->task, days[i]);
+	}
+}
+
+// Name:   stateAgenda()
+// Desc:   Display the task occurrences for a range of dates. Recurring
+//         tasks are only expanded for the days that are shown.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateAgenda()
+{
+	Date startDate;
+
+	addGap();
+	if (manager.getNumTasks() < 1)
+	{
 		displayMessage("There are no tasks in your list!");
+		return;
+	}
+
+	getDateInput("Enter start date as mm/dd/yyyy: ", startDate);
+	int numDays = getIntInput("How many days (1-366)? ", 1, 366);
+	std::vector<Occurrence> occurrences = manager.getOccurrences(startDate.getSerial(), startDate.getSerial() + numDays - 1);
+
+	if (occurrences.empty())
+	{
+		displayMessage("There are no tasks due in those days!");
+		return;
+	}
+
+	displayMessage("Agenda (Task Name | Due Date | Status):");
+	for (size_t i = 0; i < occurrences.size(); i++)
+	{
+		addSpaces(8);
+		std::cout << i + 1 << ". " << occurrences[i].node->task.getName() << " | ";
+		displayDate(Date::fromSerial(occurrences[i].serial));
+		std::cout << " | " << (occurrences[i].completed ? "Completed" : "Incomplete");
+		addGap();
+	}
+
+	addGap();
+	int userChoice = getIntInput("Choose a task to complete (0 to cancel): ", 0, occurrences.size());
+
+	if (userChoice != 0)
+	{
+		history.recordComplete(occurrences[userChoice - 1].node, occurrences[userChoice - 1].serial);
+		manager.completeOccurrence(occurrences[userChoice - 1].node, occurrences[userChoice - 1].serial);
+		displayMessage("Task has been completed!");
+		fileModified = true;
+	}
 }
 
 // Name:   stateAdd()
@@ -97,26 +298,46 @@ void SimpleTaskManager::stateDisplay()
 // Return: None
 void SimpleTaskManager::stateAdd()
 {
+	const char choices[] = { 'n', 'd', 'w', 'm', 'y' };
 	std::string name;
-	std::string tempDate;
-	bool validDate = false;
+	std::string tagText;
+	std::string badTag;
+	Date dueDate;
+	Date endDate;
+	TaskRecord record;
 
 	addGap();
 	displayMessage("Enter task name: ", false);
 	std::getline(std::cin, name, '\n');
+	getDateInput("Enter due date as mm/dd/yyyy: ", dueDate);
+
+	FREQUENCIES frequency = Recurrence::getFrequencyFromCode(getCharInput("Repeat (n)ever, (d)aily, (w)eekly, (m)onthly or (y)early? ", choices, sizeof(choices)));
 
-	while (!validDate)
+	if (frequency != FREQUENCIES::NEVER)
 	{
-		displayMessage("Enter due date as mm/dd/yyyy: ", false);
-		std::getline(std::cin, tempDate, '\n');
+		int interval = getIntInput("Repeat every how many periods (1-365)? ", 1, 365);
+		getDateInput("Enter end date as mm/dd/yyyy (blank for none): ", endDate, true);
+		record.recurrenceFields = TaskManager::formatRecurrence(Recurrence(frequency, interval, endDate));
+	}
 
-		if (Date::validateDate(tempDate))
-			validDate = true;
-		else
-			displayMessage("Invalid date!");
+	record.priority = getIntInput("Priority (1 highest to " + std::to_string(Task::maxPriority) + ", 0 for none): ", 0, Task::maxPriority);
+	displayMessage("Tags separated by spaces (blank for none): ", false);
+	std::getline(std::cin, tagText, '\n');
+
+	while (std::cin && !TaskTags::parseTags(tagText, record.tags, badTag))
+	{
+		displayMessage("'" + badTag + "' cannot be a tag, use letters, digits, - and _ (at most "
+			+ std::to_string(TaskTags::maxTags) + " different tags)");
+		displayMessage("Tags separated by spaces (blank for none): ", false);
+		std::getline(std::cin, tagText, '\n');
 	}
 
-	manager.addTask(name, Date(tempDate));
+	record.name = name;
+	record.dueDate = dueDate;
+	record.completed = false;
+
+	history.recordAdd(manager.addTask(record));
+
 	fileModified = true;
 	displayMessage("Task was added!");
 }
@@ -138,7 +359,7 @@ void SimpleTaskManager::stateComplete()
 	}
 
 	displayMessage("Your current list:");
-	displayTasks(manager.getTasks());
+	displayTasks(currView);
 	addGap();
 	userChoice = getIntInput("Choose a task to complete (0 to cancel): ", 0, maxTaskNum);
 
@@ -151,7 +372,10 @@ void SimpleTaskManager::stateComplete()
 
 	if (userChoice != 0)
 	{
-		manager.completeTask(userChoice);
+		const Node* node = manager.getTaskInView(currView, userChoice);
+
+		history.recordComplete(node);
+		manager.completeTask(node);
 		displayMessage("Task has been completed!");
 		fileModified = true;
 	}
@@ -174,7 +398,7 @@ void SimpleTaskManager::stateRemove()
 	}
 
 	displayMessage("Your current list:");
-	displayTasks(manager.getTasks());
+	displayTasks(currView);
 	addGap();
 	userChoice = getIntInput("Choose a task to remove (0 to cancel): ", 0, maxTaskNum);
 
@@ -188,7 +412,10 @@ void SimpleTaskManager::stateRemove()
 
 	if (userChoice != 0)
 	{
-		manager.deleteTask(userChoice);
+		const Node* node = manager.getTaskInView(currView, userChoice);
+
+		history.recordRemove(node);
+		manager.deleteTask(node);
 		displayMessage("Task has been removed!");
 		fileModified = true;
 	}
@@ -214,12 +441,23 @@ void SimpleTaskManager::stateSave()
 		{
 			displayMessage("Enter a name for your file: ", false);
 			std::getline(std::cin, currFile, '\n');
-			currFile.append(".txt");
+			setFileExtension(currFile);
 		}
 
-		manager.saveToFile(currFile);
-		displayMessage("File was saved!");
-		fileModified = false;
+		// A shared list is saved under its lock, so it is saved right away
+		if (shared.isAttached())
+		{
+			if (shared.save())
+			{
+				displayMessage("File was saved!");
+				fileModified = false;
+			}
+			else
+				displayMessage(shared.getError());
+			return;
+		}
+
+		startFileJob(STATES::SAVE, currFile);
 	}
 	else
 		displayMessage("File not saved!");
@@ -237,27 +475,625 @@ void SimpleTaskManager::stateLoad()
 		return;
 	}
 
-	if (manager.checkFileExists(currFile))
+	if (shared.isAttached())
 	{
-		manager.loadFromFile(currFile);
-		displayMessage("File was loaded!");
-		fileModified = false;
+		displayMessage("Stop sharing the file first.");
+		return;
 	}
+
+	if (manager.checkFileExists(currFile))
+		startFileJob(STATES::LOAD, currFile);
 	else
 		displayMessage("File does not exist!");
 }
 
+// Name:   stateImport()
+// Desc:   Add the tasks of another file to the current list and choose
+//         what happens to tasks that are already in the list.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateImport()
+{
+	const char choices[] = { 'k', 's', 'r', 'm' };
+	const DEDUP_POLICIES policies[] = { DEDUP_POLICIES::KEEP_ALL, DEDUP_POLICIES::SKIP_DUPLICATES,
+		DEDUP_POLICIES::REPLACE_DUPLICATES, DEDUP_POLICIES::MERGE_COMPLETION };
+	std::string fileName;
+
+	if (shared.isAttached())
+	{
+		displayMessage("Stop sharing the file first.");
+		return;
+	}
+
+	addGap();
+	displayMessage("Enter a name for the file to import: ", false);
+	std::getline(std::cin, fileName, '\n');
+	setFileExtension(fileName);
+
+	if (!manager.checkFileExists(fileName))
+	{
+		displayMessage("File does not exist!");
+		return;
+	}
+
+	char answer = getCharInput("Duplicates: (k)eep all, (s)kip, (r)eplace or (m)erge completion? ", choices, sizeof(choices));
+	DEDUP_POLICIES policy = policies[std::find(choices, choices + sizeof(choices), answer) - choices];
+	DedupEngine dedup(policy);
+	int numTasks = manager.getNumTasks();
+
+	// Replaced and merged duplicates change tasks the history knows about
+	history.clear();
+
+	if (!manager.importFromFile(fileName, dedup))
+	{
+		displayMessage("File could not be imported!");
+		return;
+	}
+
+	displayMessage(std::to_string(manager.getNumTasks() - numTasks) + " task(s) were imported!");
+	displayLostRecords(manager.getLoadReport());
+	displayDuplicates(dedup.getReport());
+	fileModified = true;
+}
+
 // Name:   stateChangeFile()
 // Desc:   Change the file name to use for saving and loading.
 // Param:  None
 // Return: None
 void SimpleTaskManager::stateChangeFile()
 {
-	displayMessage("Enter a name for your file: ", false);
+	if (shared.isAttached())
+	{
+		displayMessage("Stop sharing the file first.");
+		return;
+	}
+
+	displayMessage("Enter a name for your file (end with " + std::string(TaskArchive::fileExtension) + " to compress, "
+		+ std::string(SegmentStore::storeExtension) + " for a segmented store): ", false);
 	std::getline(std::cin, currFile, '\n');
-	currFile.append(".txt");
+	setFileExtension(currFile);
 	displayMessage("Filename changed to: " + currFile);
 	fileModified = false;
+
+	if (watcher.isWatching())
+	{
+		watcher.stop();
+		displayMessage("Stopped watching the old file.");
+	}
+}
+
+// Name:   setFileExtension(string& fileName)
+// Desc:   Add the text file extension unless the compressed or the
+//         store extension is used.
+// Param:  fileName: A string that holds the file name to change.
+// Return: None
+void SimpleTaskManager::setFileExtension(std::string& fileName)
+{
+	if (!TaskArchive::isArchiveName(fileName) && !SegmentStore::isStoreName(fileName))
+		fileName.append(".txt");
+}
+
+// Name:   stateWorkspace()
+// Desc:   Work with several task files at once. The incomplete tasks of
+//         every open file are shown as one list ordered by due date and
+//         changes are saved back to the file each task came from.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateWorkspace()
+{
+	int userChoice = -1;
+
+	while (userChoice != 0)
+	{
+		addGap();
+		displayMessage("Workspace files:");
+		for (int fileNum = 0; fileNum < workspace.getNumFiles(); fileNum++)
+		{
+			addSpaces(8);
+			std::cout << workspace.getFileName(fileNum) << " (" << workspace.getManager(fileNum).getNumTasks() << " tasks)";
+			if (workspace.isModified(fileNum))
+				std::cout << "*";
+			addGap();
+		}
+
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "1. Open Files" << std::endl;
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "2. Show Incomplete Tasks" << std::endl;
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "3. Complete Task" << std::endl;
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "4. Save Modified Files" << std::endl;
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "5. Close Files" << std::endl;
+		userChoice = getIntInput("Choice (0 to go back): ", 0, 5);
+
+		if (userChoice == 1)
+		{
+			std::string fileNames;
+			std::vector<std::string> fileList;
+
+			displayMessage("Enter file names separated by spaces: ", false);
+			std::getline(std::cin, fileNames, '\n');
+
+			std::istringstream stream(fileNames);
+			for (std::string fileName; stream >> fileName;)
+			{
+				setFileExtension(fileName);
+				fileList.push_back(fileName);
+			}
+
+			int numLoaded = workspace.openFiles(fileList);
+			displayMessage(std::to_string(numLoaded) + " file(s) were loaded!");
+		}
+		else if (userChoice == 2 || userChoice == 3)
+		{
+			std::vector<WorkspaceTask> tasks;
+			const int today = Date::today().getSerial();
+
+			displayMessage("Incomplete Tasks (Task Name | Due Date | Status | File):");
+			for (MergedIterator currTask = workspace.getMerged(VIEWS::INCOMPLETE_FIRST, true); currTask.isValid(); ++currTask)
+			{
+				tasks.push_back(*currTask);
+				displayTask(tasks.size(), tasks.back().node->task, tasks.back().node->task.getDueSerial() - today);
+				addSpaces(12);
+				std::cout << "in " << workspace.getFileName(tasks.back().fileNum) << std::endl;
+			}
+
+			if (tasks.empty())
+				displayMessage("There are no incomplete tasks!");
+			else if (userChoice == 3)
+			{
+				int taskNum = getIntInput("Choose a task to complete (0 to cancel): ", 0, tasks.size());
+
+				if (taskNum != 0)
+				{
+					workspace.completeTask(tasks[taskNum - 1]);
+					displayMessage("Task has been completed!");
+				}
+			}
+		}
+		else if (userChoice == 4)
+		{
+			int numSaved = workspace.saveModified();
+			displayMessage(std::to_string(numSaved) + " file(s) were saved!");
+		}
+		else if (userChoice == 5)
+		{
+			const char choices[] = { 'y', 'n' };
+
+			if (!workspace.hasModified() || getCharInput("Discard unsaved changes (y/n)? ", choices, sizeof(choices)) == 'y')
+				workspace.closeFiles();
+		}
+	}
+}
+
+// Name:   stateWatch()
+// Desc:   Start or stop watching the current file for changes made by
+//         other programs. The file is loaded first so the task list
+//         starts out matching it.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateWatch()
+{
+	if (watcher.isWatching())
+	{
+		watcher.stop();
+		displayMessage("Stopped watching " + currFile + ".");
+		return;
+	}
+
+	if (currFile == "None" || !manager.checkFileExists(currFile))
+	{
+		displayMessage("Please choose an existing file from the main menu.");
+		return;
+	}
+
+	if (shared.isAttached())
+	{
+		displayMessage("Stop sharing the file first.");
+		return;
+	}
+
+	if (fileModified)
+	{
+		const char choices[] = { 'y', 'n' };
+
+		displayMessage("Your unsaved changes will be replaced by the file.");
+		if (getCharInput("Do you still want to watch it (y/n)? ", choices, sizeof(choices)) != 'y')
+			return;
+	}
+
+	manager.loadFromFile(currFile);
+	history.clear();
+	fileModified = false;
+
+	if (watcher.start(currFile, manager))
+		displayMessage("Watching " + currFile + " for changes.");
+	else
+		displayMessage("File could not be watched!");
+}
+
+// Name:   stateShare()
+// Desc:   Start or stop sharing the current file with the other processes
+//         that share it. The first process to share a file loads it, the
+//         others take the list it holds.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateShare()
+{
+	const char choices[] = { 'y', 'n' };
+
+	if (shared.isAttached())
+	{
+		// The list goes away with the last process to stop sharing it
+		if (shared.getNumAttached() == 1 && shared.hasUnsavedChanges()
+			&& getCharInput("Save the changes to " + currFile + " first (y/n)? ", choices, sizeof(choices)) == 'y')
+			displayMessage(shared.save() ? "File was saved!" : shared.getError());
+
+		fileModified = shared.hasUnsavedChanges();
+		shared.detach();
+		displayMessage("Stopped sharing " + currFile + ".");
+		return;
+	}
+
+	if (currFile == "None" || !manager.checkFileExists(currFile))
+	{
+		displayMessage("Please choose an existing file from the main menu.");
+		return;
+	}
+
+	if (watcher.isWatching())
+	{
+		displayMessage("Stop watching the file first.");
+		return;
+	}
+
+	if (fileModified)
+	{
+		displayMessage("Your unsaved changes will be replaced by the shared list.");
+		if (getCharInput("Do you still want to share it (y/n)? ", choices, sizeof(choices)) != 'y')
+			return;
+	}
+
+	history.clear();
+
+	if (!shared.attach(currFile))
+	{
+		displayMessage(shared.getError());
+		return;
+	}
+
+	numDroppedShown = 0;
+	fileModified = shared.hasUnsavedChanges();
+	displayMessage("Sharing " + currFile + " with " + std::to_string(shared.getNumAttached() - 1) + " other process(es).");
+}
+
+// Name:   stateDependencies()
+// Desc:   Show the tasks that can be worked on now, and make tasks wait
+//         for other tasks or stop waiting.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateDependencies()
+{
+	int userChoice = -1;
+
+	while (userChoice != 0)
+	{
+		addGap();
+		if (manager.getNumTasks() < 1)
+		{
+			displayMessage("There are no tasks in your list!");
+			return;
+		}
+
+		displayMessage(std::to_string(manager.getNumDependencies()) + " dependencies, "
+			+ std::to_string(manager.getNumTasks() - manager.getNumCompleted() - manager.getNumActionable()) + " incomplete task(s) are blocked.");
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "1. Show Actionable Tasks" << std::endl;
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "2. Add Dependency" << std::endl;
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "3. Remove Dependency" << std::endl;
+		userChoice = getIntInput("Choice (0 to go back): ", 0, 3);
+
+		if (userChoice == 1)
+		{
+			const std::vector<const Node*> actionable = manager.getActionable(INT_MAX);
+
+			if (actionable.empty())
+				displayMessage("There are no actionable tasks!");
+			else
+			{
+				displayMessage("Actionable Tasks (Task Name | Due Date | Status):");
+				displayTaskList(actionable);
+			}
+		}
+		else if (userChoice == 2)
+		{
+			const Node* dependent = chooseTask("Choose the task that waits (0 to cancel): ");
+			const Node* blocker = dependent ? chooseTask("Choose the task it waits for (0 to cancel): ") : nullptr;
+
+			if (!blocker)
+				continue;
+
+			if (manager.addDependency(blocker, dependent))
+			{
+				displayMessage("Dependency has been added!");
+				fileModified = true;
+			}
+			else
+				displayMessage("The task already waits for it, or it would make the tasks wait for each other!");
+		}
+		else if (userChoice == 3)
+		{
+			const Node* dependent = chooseTask("Choose the task that waits (0 to cancel): ");
+
+			if (!dependent)
+				continue;
+
+			const std::vector<const Node*> blockers = manager.getBlockers(dependent);
+
+			if (blockers.empty())
+			{
+				displayMessage("That task does not wait for any task!");
+				continue;
+			}
+
+			displayMessage("It waits for:");
+			displayTaskList(blockers);
+
+			const int blockerNum = getIntInput("Choose the task to stop waiting for (0 to cancel): ", 0, blockers.size());
+
+			if (blockerNum != 0 && manager.removeDependency(blockers[blockerNum - 1], dependent))
+			{
+				displayMessage("Dependency has been removed!");
+				fileModified = true;
+			}
+		}
+	}
+}
+
+// Name:   chooseTask(const string& message)
+// Desc:   Display the list and let the user choose a task from it.
+// Param:  message: A string that holds the question for the user.
+// Return: A constant pointer to the node of the task, nullptr if cancelled.
+const Node* SimpleTaskManager::chooseTask(const std::string& message)
+{
+	displayMessage("Your current list:");
+	displayTasks(currView);
+	addGap();
+
+	const int taskNum = getIntInput(message, 0, manager.getNumTasks());
+
+	return taskNum == 0 ? nullptr : manager.getTaskInView(currView, taskNum);
+}
+
+// Name:   checkWatchedFile()
+// Desc:   Apply the changes other programs made to the watched file since
+//         the last check and tell the user what changed.
+// Param:  None
+// Return: None
+void SimpleTaskManager::checkWatchedFile()
+{
+	SyncReport report;
+	const char choices[] = { 'y', 'n' };
+
+	// A sync changes the list, so it waits for the file worker to be idle
+	if (fileJob.valid())
+		return;
+
+	// Loading the file again would throw away the edits that are not saved yet
+	if (!watcher.hasChanged() || !watcher.sync(manager, report, !fileModified) || report.mode == SYNC_MODES::UNCHANGED)
+		return;
+
+	if (report.mode == SYNC_MODES::SKIPPED)
+	{
+		addGap();
+		displayMessage(currFile + " was rewritten on disk and has to be loaded again, which replaces your unsaved changes.");
+
+		if (getCharInput("Do you want to load it (y/n)? ", choices, sizeof(choices)) != 'y')
+		{
+			watcher.stop();
+			displayMessage("Stopped watching " + currFile + ", save to keep your changes.");
+			return;
+		}
+
+		watcher.sync(manager, report);
+		fileModified = false;
+	}
+
+	history.clear();
+	addGap();
+	displayMessage(currFile + " was " + FileWatcher::getModeName(report.mode) + " on disk: "
+		+ std::to_string(report.numAdded) + " added, " + std::to_string(report.numUpdated) + " updated, "
+		+ std::to_string(report.numRemoved) + " removed.");
+}
+
+// Name:   checkSharedList()
+// Desc:   Apply the changes other processes made to the shared list since
+//         the last check and tell the user what changed.
+// Param:  None
+// Return: None
+void SimpleTaskManager::checkSharedList()
+{
+	SyncReport report;
+
+	if (fileJob.valid() || !shared.isAttached())
+		return;
+
+	if (shared.getNumDropped() != numDroppedShown)
+	{
+		addGap();
+		displayMessage(std::to_string(shared.getNumDropped() - numDroppedShown)
+			+ " change(s) could not be shared, another process changed the task first or the shared list is full.");
+		numDroppedShown = shared.getNumDropped();
+	}
+
+	if (shared.hasChanged() && shared.sync(report) && report.mode != SYNC_MODES::UNCHANGED)
+	{
+		history.clear();
+		addGap();
+		displayMessage(currFile + " was changed by other processes: " + std::to_string(report.numAdded) + " added, "
+			+ std::to_string(report.numUpdated) + " updated, " + std::to_string(report.numRemoved) + " removed.");
+	}
+
+	fileModified = shared.hasUnsavedChanges();
+}
+
+// Name:   checkReminders()
+// Desc:   Show the reminders that came up since the last check.
+// Param:  None
+// Return: None
+void SimpleTaskManager::checkReminders()
+{
+	const size_t maxShown = 5;
+
+	// The timers are rebuilt at the end of a load, which runs on the file worker
+	if (fileJob.valid())
+		return;
+
+	manager.checkReminders();
+
+	if (reminderNotices.empty())
+		return;
+
+	addGap();
+
+	for (size_t i = 0; i < reminderNotices.size() && i < maxShown; i++)
+		displayMessage("Reminder: " + reminderNotices[i]);
+
+	if (reminderNotices.size() > maxShown)
+		displayMessage("... and " + std::to_string(reminderNotices.size() - maxShown) + " more reminder(s).");
+
+	reminderNotices.clear();
+}
+
+// Name:   addReminderNotice(const Reminder& reminder)
+// Desc:   Keep the text of a reminder until the next menu prompt. The
+//         text is kept rather than the node, since the task can be
+//         removed before it is shown.
+// Param:  reminder: The reminder that fired.
+// Return: None
+void SimpleTaskManager::addReminderNotice(const Reminder& reminder)
+{
+	const Date date = Date::fromSerial(reminder.serial);
+	const std::string name(reminder.node->task.getName());
+	const std::string dateText = std::to_string(date.getMonth()) + "/" + std::to_string(date.getDay()) + "/" + std::to_string(date.getYear());
+
+	if (reminder.event == REMINDER_EVENTS::DUE_NOW)
+		reminderNotices.push_back(name + " is due today (" + dateText + ").");
+	else
+		reminderNotices.push_back(name + " is now overdue (was due " + dateText + ").");
+}
+
+// Name:   startFileJob(STATES state, const string& fileName)
+// Desc:   Load or save the task list on the file worker. A file that is
+//         done quickly is reported right away as before, a larger one is
+//         reported from the menu once it is done.
+// Param:  state: LOAD or SAVE.
+//         fileName: The file to load or save.
+// Return: None
+void SimpleTaskManager::startFileJob(STATES state, const std::string& fileName)
+{
+	fileJobState = state;
+	fileJobName = fileName;
+
+	if (state == STATES::LOAD)
+		fileJob = fileWorker.submit([this, fileName]() { return manager.loadFromFile(fileName, loadDedup); });
+	else
+		fileJob = fileWorker.submit([this, fileName]() { return manager.saveToFile(fileName); });
+
+	if (fileJob.wait_for(std::chrono::milliseconds(foregroundMilliseconds)) != std::future_status::ready)
+	{
+		displayMessage((state == STATES::LOAD ? "Loading " : "Saving ") + fileName + " in the background.");
+		return;
+	}
+
+	finishFileJob(false);
+}
+
+// Name:   finishFileJob(bool wait)
+// Desc:   Report a load or save that is done and bring the program state
+//         up to date with it.
+// Param:  wait: A boolean to wait for a job that is still running.
+// Return: None
+void SimpleTaskManager::finishFileJob(bool wait)
+{
+	if (!fileJob.valid())
+		return;
+
+	if (fileJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		if (!wait)
+			return;
+
+		displayMessage("Waiting for " + fileJobName + (fileJobState == STATES::LOAD ? " to load..." : " to be saved..."));
+	}
+
+	const bool succeeded = fileJob.get();
+
+	if (fileJobState == STATES::SAVE)
+	{
+		if (!succeeded)
+		{
+			displayMessage("File could not be saved!");
+			return;
+		}
+
+		displayMessage("File was saved!");
+		fileModified = false;
+
+		if (watcher.isWatching() && watcher.getFileName() == fileJobName)
+			watcher.markSynced(manager);
+
+		return;
+	}
+
+	if (!succeeded)
+	{
+		displayMessage("File could not be loaded!");
+		return;
+	}
+
+	history.clear();
+	displayMessage("File was loaded!");
+	displayLostRecords(manager.getLoadReport());
+	displayDuplicates(loadDedup.getReport());
+
+	// The list differs from a damaged file until it is saved without the lost records
+	fileModified = manager.getLoadReport().numLost > 0;
+
+	if (watcher.isWatching())
+		watcher.markSynced(manager);
+}
+
+// Name:   needsFileJob(STATES state)
+// Desc:   Check if a state has to wait for the load or save on the file
+//         worker. A save only reads the list, so the states that only
+//         display it can run next to one.
+// Param:  state: The state about to run.
+// Return: A boolean: True if the state has to wait.
+bool SimpleTaskManager::needsFileJob(STATES state) const
+{
+	if (!fileJob.valid())
+		return false;
+
+	switch (state)
+	{
+		case STATES::MENU:
+		case STATES::CHANGEVIEW:
+		case STATES::WORKSPACE:
+			return false;
+
+		case STATES::DISPLAY:
+		case STATES::NEXTDUE:
+			return fileJobState == STATES::LOAD;
+
+		// The agenda completes occurrences, so it waits for a save as well
+		default:
+			return true;
+	}
 }
 
 // Name:   stateQuit()
@@ -269,7 +1105,8 @@ void SimpleTaskManager::stateQuit()
 	const char choices[] = { 'y', 'n' };
 	char answer = 'y';
 
-	if (fileModified)
+	// The other processes that share the file keep its changes
+	if ((fileModified && shared.getNumAttached() <= 1) || workspace.hasModified())
 	{
 		displayMessage("You have an unsaved file.");
 		answer = getCharInput("Are you sure you want to quit (y/n)? ", choices, sizeof(choices));
@@ -279,6 +1116,56 @@ void SimpleTaskManager::stateQuit()
 		running = false;
 }
 
+// Name:   stateUndo()
+// Desc:   Reverse the last change to the task list.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateUndo()
+{
+	addGap();
+	if (!history.canUndo())
+	{
+		displayMessage("There is nothing to undo!");
+		return;
+	}
+
+	const std::string action = UndoLog::getActionName(history.getUndoAction());
+
+	if (!history.undo(manager))
+	{
+		displayMessage("The task list has changed, the history was cleared.");
+		return;
+	}
+
+	displayMessage(action + " was undone!");
+	fileModified = true;
+}
+
+// Name:   stateRedo()
+// Desc:   Apply the last undone change to the task list again.
+// Param:  None
+// Return: None
+void SimpleTaskManager::stateRedo()
+{
+	addGap();
+	if (!history.canRedo())
+	{
+		displayMessage("There is nothing to redo!");
+		return;
+	}
+
+	const std::string action = UndoLog::getActionName(history.getRedoAction());
+
+	if (!history.redo(manager))
+	{
+		displayMessage("The task list has changed, the history was cleared.");
+		return;
+	}
+
+	displayMessage(action + " was redone!");
+	fileModified = true;
+}
+
 // Name:   showMainMenu()
 // Desc:   Display the main menu to the console.
 // Param:  None
@@ -291,6 +1178,19 @@ void SimpleTaskManager::showMainMenu()
 	if (fileModified)
 		displayMessage("*", false, 0);
 	addGap();
+
+	if (fileJob.valid() && fileJobState == STATES::LOAD)
+		displayMessage("Loading " + fileJobName + "...");
+	else if (manager.getNumTasks() > 0)
+	{
+		// One scan of the due date column counts all three ranges
+		const int today = Date::today().getSerial();
+		const std::vector<uint64_t> counts = manager.countDue({ { INT_MIN, today - 1 }, { today, today + 6 }, { today, today + 30 } }, true);
+
+		displayMessage("Incomplete: " + std::to_string(counts[0]) + " overdue, " + std::to_string(counts[1]) + " due within a week, "
+			+ std::to_string(counts[2]) + " within a month");
+	}
+
 	addFill('-', borderLength, ConsoleIO::messageMargin);
 	addGap();
 	addSpaces(1);
@@ -298,6 +1198,12 @@ void SimpleTaskManager::showMainMenu()
 	addSpaces(ConsoleIO::messageMargin + 5);
 	std::cout << STATES::DISPLAY << ". Display Tasks" << std::endl;
 	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::CHANGEVIEW << ". Change View" << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::NEXTDUE << ". Next Due Tasks" << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::AGENDA << ". Agenda" << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
 	std::cout << STATES::ADD << ". Add Task" << std::endl;
 	addSpaces(ConsoleIO::messageMargin + 5);
 	std::cout << STATES::COMPLETE << ". Complete Task" << std::endl;
@@ -308,35 +1214,196 @@ void SimpleTaskManager::showMainMenu()
 	addSpaces(ConsoleIO::messageMargin + 5);
 	std::cout << STATES::LOAD << ". Load File" << std::endl;
 	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::IMPORT << ". Import File" << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
 	std::cout << STATES::SAVE << ". Save File" << std::endl;
 	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::WORKSPACE << ". Workspace" << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::WATCH << (watcher.isWatching() ? ". Stop Watching File" : ". Watch File") << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::SHARE << (shared.isAttached() ? ". Stop Sharing File" : ". Share File") << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
+	std::cout << STATES::DEPENDENCIES << ". Dependencies" << std::endl;
+	addSpaces(ConsoleIO::messageMargin + 5);
 	std::cout << STATES::QUIT << ". Quit" << std::endl;
+
+	if (history.canUndo())
+	{
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "U. Undo " << UndoLog::getActionName(history.getUndoAction()) << std::endl;
+	}
+
+	if (history.canRedo())
+	{
+		addSpaces(ConsoleIO::messageMargin + 5);
+		std::cout << "R. Redo " << UndoLog::getActionName(history.getRedoAction()) << std::endl;
+	}
 	addFill('-', borderLength, ConsoleIO::messageMargin);
 }
 
-// Name:   displayTasks(const Node* currNode)
+// Name:   displayTasks(VIEWS view)
 // Desc:   Display the list of tasks to the console.
-// Param:  currNode: A Node pointer that points to the head of the list.
+// Param:  view: The view that decides the order of the tasks.
 // Return: None
-void SimpleTaskManager::displayTasks(const Node* currNode)
+void SimpleTaskManager::displayTasks(VIEWS view)
 {
-	int counter = 1;
+	std::vector<const Node*> tasks;
+	tasks.reserve(manager.getNumTasks());
 
-	while (currNode)
+	for (ViewIterator currNode = manager.viewBegin(view); currNode != manager.viewEnd(view); ++currNode)
+		tasks.push_back(*currNode);
+
+	displayTaskList(tasks);
+}
+
+// Name:   displayTaskList(const vector<const Node*>& tasks)
+// Desc:   Display a numbered list of tasks to the console. Today's date
+//         and the days until each task is due are worked out once for
+//         the whole list.
+// Param:  tasks: The tasks to display in order.
+// Return: None
+void SimpleTaskManager::displayTaskList(const std::vector<const Node*>& tasks)
+{
+	const std::vector<int> days = TaskManager::getDaysUntilDue(tasks, Date::today().getSerial());
+
+	for (size_t i = 0; i < tasks.size(); i++)
+		displayTask(i + 1, tasks[i]->task, days[i]);
+}
+
+// Name:   displayTask(int taskNum, const Task& task, int daysUntilDue)
+// Desc:   Display a single task to the console. Incomplete tasks show how
+//         soon they are due or how long they are overdue.
+// Param:  taskNum: The number to show in front of the task.
+//         task: The task to display.
+//         daysUntilDue: The days from today to the due date.
+// Return: None
+void SimpleTaskManager::displayTask(int taskNum, const Task& task, int daysUntilDue)
+{
+	addSpaces(8);
+	std::cout << taskNum << ". " << task.getName() << " | ";
+	displayDate(task.getDueDate());
+	std::cout << " | ";
+
+	if (task.getCompleted())
+		std::cout << "Completed";
+	else if (daysUntilDue == 0)
+		std::cout << "Incomplete (due today)";
+	else if (daysUntilDue > 0)
+		std::cout << "Incomplete (due in " << daysUntilDue << (daysUntilDue == 1 ? " day)" : " days)");
+	else
+		std::cout << "Incomplete (overdue by " << -daysUntilDue << (daysUntilDue == -1 ? " day)" : " days)");
+
+	const Recurrence* rule = task.getRecurrence();
+	if (rule)
+	{
+		static const char* periods[] = { "", "day", "week", "month", "year" };
+		std::cout << " | Every " << rule->getInterval() << " " << periods[rule->getFrequency()] << (rule->getInterval() > 1 ? "s" : "");
+
+		if (rule->getEndDate().getSerial() >= 0)
+		{
+			std::cout << " until ";
+			displayDate(rule->getEndDate());
+		}
+	}
+
+	if (task.getPriority())
+		std::cout << " | P" << task.getPriority();
+
+	if (task.getTags())
+		std::cout << " | " << TaskTags::formatTags(task.getTags(), " ", "#");
+
+	addGap();
+}
+
+// Name:   displayDate(const Date& date)
+// Desc:   Display a date to the console as m/d/yyyy.
+// Param:  date: The date to display.
+// Return: None
+void SimpleTaskManager::displayDate(const Date& date)
+{
+	std::cout << date.getMonth() << "/" << date.getDay() << "/" << date.getYear();
+}
+
+// Name:   displayDuplicates(const DedupReport& report)
+// Desc:   Display the duplicate tasks that were found in a file.
+// Param:  report: The report from the dedup engine.
+// Return: None
+void SimpleTaskManager::displayDuplicates(const DedupReport& report)
+{
+	if (report.numDuplicates == 0)
+		return;
+
+	displayMessage(std::to_string(report.numDuplicates) + " duplicate task(s) were found:");
+
+	for (const std::string& example : report.examples)
+	{
+		addSpaces(8);
+		std::cout << example << std::endl;
+	}
+
+	if (report.numDuplicates > (int)report.examples.size())
 	{
 		addSpaces(8);
-		std::cout << counter << ". " << currNode->task.getName() << " | "
-			<< currNode->task.getDueDate().getMonth() << "/"
-			<< currNode->task.getDueDate().getDay() << "/"
-			<< currNode->task.getDueDate().getYear() << " | ";
+		std::cout << "..." << std::endl;
+	}
+}
+
+// Name:   displayLostRecords(const LoadReport& report)
+// Desc:   Show the records of the last load that could not be read. The
+//         file is written without them on the next save.
+// Param:  report: The load report of the task manager.
+// Return: None
+void SimpleTaskManager::displayLostRecords(const LoadReport& report)
+{
+	const size_t maxShown = 5;
 
-		if (currNode->task.getCompleted())
-			std::cout << "Completed";
-		else
-			std::cout << "Incomplete";
+	if (report.numLost == 0)
+		return;
 
-		addGap();
-		currNode = currNode->next;
-		counter++;
+	displayMessage(std::to_string(report.numLost) + " of " + std::to_string(report.numRecords)
+		+ " record(s) could not be read and were skipped:");
+
+	for (size_t i = 0; i < report.lost.size() && i < maxShown; i++)
+	{
+		addSpaces(8);
+		std::cout << TaskManager::formatLostRecords(report.lost[i]) << std::endl;
+	}
+
+	if (report.lost.size() > maxShown)
+	{
+		addSpaces(8);
+		std::cout << "..." << std::endl;
+	}
+}
+
+// Name:   getDateInput(const string& message, Date& date, bool allowBlank)
+// Desc:   Get a valid date from the user.
+// Param:  message: A string that holds a statement for the user.
+//         date: The Date object that receives the date.
+//         allowBlank: A boolean to allow an empty answer for no date.
+// Return: A boolean: True if a date was entered, false if it was left blank.
+bool SimpleTaskManager::getDateInput(const std::string& message, Date& date, bool allowBlank)
+{
+	std::string tempDate;
+
+	while (true)
+	{
+		displayMessage(message, false);
+		std::getline(std::cin, tempDate, '\n');
+
+		if (allowBlank && tempDate.empty())
+		{
+			date = Date();
+			return false;
+		}
+
+		if (Date::validateDate(tempDate))
+		{
+			date = Date(tempDate);
+			return true;
+		}
+
+		displayMessage("Invalid date!");
 	}
 }
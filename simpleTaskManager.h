@@ -1,15 +1,27 @@
 #pragma once
 #include "consoleIO.h"
 #include "taskManager.h"
+#include "workspace.h"
+#include "fileWatcher.h"
+#include "sharedStore.h"
+#include "undoLog.h"
+#include "threadPool.h"
+#include <future>
 
 /*****************************************************************************
 # Description: An enum of states that are used to determine which
                state the program should be in.
 			   The SimpleTaskManager class is the main program and
-			   is derived from ConsoleIO.
+			   is derived from ConsoleIO. Loads and saves run on a file
+			   worker thread so a large file does not hold up the menu,
+			   states that need the list wait for them to finish.
+			   Reminders that come up while the program runs are shown
+			   as notices before the menu prompt. A shared file is kept
+			   in step with the other processes that share it before
+			   every menu prompt.
 #****************************************************************************/
 
-enum STATES { MENU, DISPLAY, ADD, COMPLETE, REMOVE, CHANGEFILE, LOAD, SAVE, QUIT };
+enum STATES { MENU, DISPLAY, CHANGEVIEW, NEXTDUE, AGENDA, ADD, COMPLETE, REMOVE, CHANGEFILE, LOAD, IMPORT, SAVE, WORKSPACE, WATCH, SHARE, DEPENDENCIES, QUIT, UNDO, REDO };
 
 class SimpleTaskManager : public ConsoleIO
 {
@@ -19,19 +31,59 @@ public:
 
 private:
 	void stateDisplay();
+	void stateChangeView();
+	void stateNextDue();
+	void stateAgenda();
 	void stateAdd();
 	void stateComplete();
 	void stateRemove();
 	void stateSave();
 	void stateLoad();
+	void stateImport();
 	void stateChangeFile();
+	void stateWorkspace();
+	void stateWatch();
+	void stateShare();
+	void stateDependencies();
 	void stateQuit();
+	void stateUndo();
+	void stateRedo();
 	void showMainMenu();
-	void displayTasks(const Node* currNode);
+	void checkWatchedFile();
+	void checkSharedList();
+	void checkReminders();
+	void addReminderNotice(const Reminder& reminder);
+	void startFileJob(STATES state, const std::string& fileName);
+	void finishFileJob(bool wait);
+	bool needsFileJob(STATES state) const;
+	void setFileExtension(std::string& fileName);
+	void displayTasks(VIEWS view);
+	void displayTaskList(const std::vector<const Node*>& tasks);
+	const Node* chooseTask(const std::string& message);
+	void displayTask(int taskNum, const Task& task, int daysUntilDue);
+	void displayDate(const Date& date);
+	void displayDuplicates(const DedupReport& report);
+	void displayLostRecords(const LoadReport& report);
+	bool getDateInput(const std::string& message, Date& date, bool allowBlank = false);
 
 	TaskManager manager;
+	SharedStore shared;
+	Workspace workspace;
+	FileWatcher watcher;
+	UndoLog history;
 	STATES currState;
+	VIEWS currView;
 	std::string currFile;
 	bool running;
 	bool fileModified;
+	uint64_t numDroppedShown;
+	std::vector<std::string> reminderNotices;
+
+	// The load or save running on the file worker, which is stopped first
+	static const int foregroundMilliseconds = 200;
+	std::future<bool> fileJob;
+	STATES fileJobState;
+	std::string fileJobName;
+	DedupEngine loadDedup;
+	ThreadPool fileWorker;
 };
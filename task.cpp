@@ -1,32 +1,75 @@
 #include "task.h"
 
-// Name:   Task(string name, Date& dueDate, bool completed)
+static_assert(sizeof(Task) <= 48, "A task has to stay packed in 48 bytes");
+
+// Name:   Task(string_view name, Date& dueDate, bool completed)
 // Desc:   Constructor that takes in parameters.
 // Param:  name: A string that holds the task name.
 //         dueDate: The date that the task is due.
 //         completed: A boolean representing if the task is completed.
 // Return: None
-Task::Task(const std::string name, const Date& dueDate, bool completed)
-	: name(name), dueDate(dueDate), completed(completed)
+Task::Task(std::string_view name, const Date& dueDate, bool completed)
+	: name(name), dueSerial(dueDate.getSerial()), completed(completed), priority(0), tags(0)
 {
 }
 
+// Name:   Task(const Task& origTask)
+// Desc:   Copy constructor.
+// Param:  origTask: A reference to a Task object.
+// Return: None
+Task::Task(const Task& origTask)
+	: name(origTask.name), dueSerial(origTask.dueSerial), completed(origTask.completed),
+	priority(origTask.priority), tags(origTask.tags)
+{
+	if (origTask.recurrence)
+		recurrence.reset(new Recurrence(*origTask.recurrence));
+}
+
+// Name:   operator=()
+// Desc:   Allow the Task class to use the assignment operator.
+// Param:  origTask: A reference to a Task object.
+// Return: A constant reference to this object.
+const Task& Task::operator=(const Task& origTask)
+{
+	if (this != &origTask)
+	{
+		name = origTask.name;
+		dueSerial = origTask.dueSerial;
+		completed = origTask.completed;
+		recurrence.reset(origTask.recurrence ? new Recurrence(*origTask.recurrence) : nullptr);
+		priority = origTask.priority;
+		tags = origTask.tags;
+	}
+
+	return *this;
+}
+
 // Name:   getname()
 // Desc:   Retrieve the name of the task.
 // Param:  None
-// Return: The name member as a constant string.
-const std::string& Task::getName() const
+// Return: A view of the name, valid until the task is changed or removed.
+std::string_view Task::getName() const
 {
-	return name;
+	return name.view();
 }
 
 // Name:   getDueDate()
 // Desc:   Retrieve the due date of the task.
 // Param:  None
-// Return: The dueDate member as a constant Date object.
-const Date& Task::getDueDate() const
+// Return: The due date as a Date object.
+Date Task::getDueDate() const
+{
+	return Date::fromSerial(dueSerial);
+}
+
+// Name:   getDueSerial()
+// Desc:   Retrieve the due date of the task as a serial day number, for
+//         comparisons that do not need the month, day and year.
+// Param:  None
+// Return: The serial date, or -1 if the due date is not set.
+int Task::getDueSerial() const
 {
-	return dueDate;
+	return dueSerial;
 }
 
 // Name:   getCompleted()
@@ -38,6 +81,33 @@ bool Task::getCompleted() const
 	return completed;
 }
 
+// Name:   getRecurrence()
+// Desc:   Retrieve the recurrence rule of the task.
+// Param:  None
+// Return: A constant pointer to the rule, or nullptr if the task does not repeat.
+const Recurrence* Task::getRecurrence() const
+{
+	return recurrence.get();
+}
+
+// Name:   getPriority()
+// Desc:   Retrieve the priority of the task.
+// Param:  None
+// Return: The priority from 1 to maxPriority, or 0 for none.
+int Task::getPriority() const
+{
+	return priority;
+}
+
+// Name:   getTags()
+// Desc:   Retrieve the tags of the task.
+// Param:  None
+// Return: A mask with the bit of each tag id set.
+uint64_t Task::getTags() const
+{
+	return tags;
+}
+
 // Name:   setComplete()
 // Desc:   Set the task as completed.
 // Param:  None
@@ -46,3 +116,71 @@ void Task::setComplete()
 {
 	completed = true;
 }
+
+// Name:   setIncomplete()
+// Desc:   Set the task as not completed.
+// Param:  None
+// Return: None
+void Task::setIncomplete()
+{
+	completed = false;
+}
+
+// Name:   setRecurrence(const Recurrence& rule)
+// Desc:   Make the task repeat. The due date becomes the first occurrence.
+// Param:  rule: The recurrence rule to use, a rule that never repeats removes it.
+// Return: None
+void Task::setRecurrence(const Recurrence& rule)
+{
+	if (rule.getFrequency() == FREQUENCIES::NEVER)
+		recurrence.reset();
+	else
+		recurrence.reset(new Recurrence(rule));
+}
+
+// Name:   completeOccurrence(int serial)
+// Desc:   Record one occurrence of a recurring task as completed.
+// Param:  serial: The serial date of the occurrence.
+// Return: A boolean: True if the occurrence was not already completed.
+bool Task::completeOccurrence(int serial)
+{
+	if (!recurrence)
+		return false;
+
+	return recurrence->completeOccurrence(serial);
+}
+
+// Name:   uncompleteOccurrence(int serial)
+// Desc:   Remove the record of a completed occurrence of a recurring task.
+// Param:  serial: The serial date of the occurrence.
+// Return: A boolean: True if the occurrence was completed.
+bool Task::uncompleteOccurrence(int serial)
+{
+	if (!recurrence)
+		return false;
+
+	return recurrence->uncompleteOccurrence(serial);
+}
+
+// Name:   setPriority(int priority)
+// Desc:   Set the priority of the task.
+// Param:  priority: The priority from 1 to maxPriority, or 0 for none.
+// Return: A boolean: True if the priority is valid.
+bool Task::setPriority(int priority)
+{
+	if (priority < 0 || priority > maxPriority)
+		return false;
+
+	this->priority = priority;
+
+	return true;
+}
+
+// Name:   setTags(uint64_t tags)
+// Desc:   Set the tags of the task.
+// Param:  tags: A mask with the bit of each tag id set.
+// Return: None
+void Task::setTags(uint64_t tags)
+{
+	this->tags = tags;
+}
@@ -1,24 +1,50 @@
 #pragma once
-#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
 #include "date.h"
+#include "taskName.h"
+#include "recurrence.h"
 
 /*****************************************************************************
 # Description: A class that holds information for a task.
+               A recurring task also owns the rule for its occurrences.
+			   The priority is 1 for the most urgent through 3, or 0 for
+			   none, and the tags are a mask of ids from TaskTags. The
+			   members are packed into 48 bytes: the due date is kept as
+			   its serial day number and the name inline when it is short.
 #****************************************************************************/
 
 class Task
 {
 public:
-	Task(const std::string name, const Date& dueDate, bool completed = false);
+	static const int maxPriority = 3;
 
-	const std::string& getName() const;
-	const Date& getDueDate() const;
+	Task(std::string_view name, const Date& dueDate, bool completed = false);
+	Task(const Task& origTask);
+	const Task& operator=(const Task& origTask);
+
+	std::string_view getName() const;
+	Date getDueDate() const;
+	int getDueSerial() const;
 	bool getCompleted() const;
+	const Recurrence* getRecurrence() const;
+	int getPriority() const;
+	uint64_t getTags() const;
 
 	void setComplete();
+	void setIncomplete();
+	void setRecurrence(const Recurrence& rule);
+	bool completeOccurrence(int serial);
+	bool uncompleteOccurrence(int serial);
+	bool setPriority(int priority);
+	void setTags(uint64_t tags);
 
 private:
-	std::string name;
-	Date dueDate;
+	TaskName name;
+	int dueSerial;
 	bool completed;
+	uint8_t priority;
+	std::unique_ptr<Recurrence> recurrence;
+	uint64_t tags;
 };
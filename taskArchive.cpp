@@ -0,0 +1,837 @@
+#include "taskArchive.h"
+#include "taskManager.h"
+#include "taskTags.h"
+#include "crc32c.h"
+#include <fstream>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+
+const char* TaskArchive::fileExtension = ".stz";
+
+namespace
+{
+	const char archiveMagic[4] = { 'S', 'T', 'Z', '1' };
+	const uint32_t archiveVersion = 4;
+	const uint32_t firstLabelVersion = 2;
+	const uint32_t firstChecksumVersion = 3;
+	const uint32_t firstDependencyVersion = 4;
+	const size_t headerSize = 24;
+	const size_t indexEntrySize = 28;
+	const size_t oldIndexEntrySize = 24;
+	const size_t checksumSize = 4;
+}
+
+// Name:   isArchiveName(const string& fileName)
+// Desc:   Check if a file name uses the compressed file extension.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if the file should be saved compressed.
+bool TaskArchive::isArchiveName(const std::string& fileName)
+{
+	const size_t extensionLength = strlen(fileExtension);
+
+	return fileName.length() > extensionLength
+		&& fileName.compare(fileName.length() - extensionLength, extensionLength, fileExtension) == 0;
+}
+
+// Name:   isArchiveFile(const string& fileName)
+// Desc:   Check if a file starts with the compressed file header.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if the file is compressed.
+bool TaskArchive::isArchiveFile(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	char magic[sizeof(archiveMagic)] = {};
+
+	file.read(magic, sizeof(magic));
+
+	return file && memcmp(magic, archiveMagic, sizeof(magic)) == 0;
+}
+
+// Name:   save(const TaskManager& manager, const string& fileName)
+// Desc:   Write the task list to a compressed file. Names are numbered by
+//         how often they are used so the most common names get the
+//         shortest ids. Only the tags that are used go in the tag
+//         dictionary, numbered in tag id order. A dependency is saved
+//         with its dependent as the record number of the blocker. Every
+//         block and the part before the blocks get a checksum.
+// Param:  manager: The task manager to save.
+//         fileName: A string that holds a file name.
+// Return: A boolean: True if saving is successful, false otherwise.
+bool TaskArchive::save(const TaskManager& manager, const std::string& fileName)
+{
+	// The names are viewed in place, the tasks do not change while saving
+	std::unordered_map<std::string_view, uint32_t> nameCounts;
+	std::vector<std::string_view> nameOrder;
+	uint64_t usedTags = 0;
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+	{
+		if (nameCounts[currNode->task.getName()]++ == 0)
+			nameOrder.push_back(currNode->task.getName());
+
+		usedTags |= currNode->task.getTags();
+	}
+
+	std::stable_sort(nameOrder.begin(), nameOrder.end(), [&nameCounts](std::string_view left, std::string_view right) {
+		return nameCounts[left] > nameCounts[right];
+	});
+
+	std::unordered_map<std::string_view, uint32_t> nameIds;
+	std::string dictionary;
+
+	for (size_t i = 0; i < nameOrder.size(); i++)
+	{
+		nameIds[nameOrder[i]] = i;
+		writeVarint(dictionary, nameOrder[i].length());
+		dictionary.append(nameOrder[i]);
+	}
+
+	// The archive numbers the used tags from 0, a tag id only lasts while the program runs
+	int archiveTagIds[TaskTags::maxTags] = {};
+	int numArchiveTags = 0;
+
+	writeVarint(dictionary, __builtin_popcountll(usedTags));
+
+	for (uint64_t bits = usedTags; bits; bits &= bits - 1)
+	{
+		const std::string& tagName = TaskTags::getName(__builtin_ctzll(bits));
+
+		archiveTagIds[__builtin_ctzll(bits)] = numArchiveTags++;
+		writeVarint(dictionary, tagName.length());
+		dictionary.append(tagName);
+	}
+
+	// Encode each block's columns separately so a block can be decoded on its own
+	const std::vector<uint32_t> recordNumbers = manager.getLineNumbers();
+	std::vector<std::string> blockData;
+	std::vector<ArchiveBlockInfo> blockInfo;
+	const Node* currNode = manager.getTasks();
+
+	while (currNode)
+	{
+		std::string block;
+		std::string dates;
+		std::string flags;
+		std::string rules;
+		std::string labels;
+		std::string dependencies;
+		ArchiveBlockInfo info = { 0, 0, 0, 0, 0, 0 };
+		uint32_t numRules = 0;
+		uint32_t numLabeled = 0;
+		uint32_t numDependents = 0;
+		int prevSerial = 0;
+		uint8_t flagByte = 0;
+
+		for (; currNode && info.numTasks < tasksPerBlock; currNode = currNode->next)
+		{
+			const Task& task = currNode->task;
+			const int serial = task.getDueSerial();
+
+			if (info.numTasks == 0 || serial < info.firstSerial)
+				info.firstSerial = serial;
+			if (info.numTasks == 0 || serial > info.lastSerial)
+				info.lastSerial = serial;
+
+			writeVarint(block, nameIds[task.getName()]);
+			writeSignedVarint(dates, (int64_t)serial - prevSerial);
+			prevSerial = serial;
+
+			if (task.getCompleted())
+				flagByte |= 1 << (info.numTasks % 8);
+
+			if (info.numTasks % 8 == 7)
+			{
+				flags.push_back(flagByte);
+				flagByte = 0;
+			}
+
+			const Recurrence* rule = task.getRecurrence();
+			if (rule)
+			{
+				writeVarint(rules, info.numTasks);
+				rules.push_back((char)rule->getFrequency());
+				writeVarint(rules, rule->getInterval());
+				writeSignedVarint(rules, rule->getEndDate().getSerial());
+				writeVarint(rules, rule->getCompletedSerials().size());
+
+				int prevCompleted = serial;
+				for (int completedSerial : rule->getCompletedSerials())
+				{
+					writeSignedVarint(rules, (int64_t)completedSerial - prevCompleted);
+					prevCompleted = completedSerial;
+				}
+
+				numRules++;
+			}
+
+			if (task.getPriority() || task.getTags())
+			{
+				uint64_t archiveTags = 0;
+
+				for (uint64_t bits = task.getTags(); bits; bits &= bits - 1)
+					archiveTags |= (uint64_t)1 << archiveTagIds[__builtin_ctzll(bits)];
+
+				writeVarint(labels, info.numTasks);
+				labels.push_back((char)task.getPriority());
+				writeVarint(labels, archiveTags);
+				numLabeled++;
+			}
+
+			const std::vector<uint32_t>& blockers = manager.graph.getBlockers(currNode->slot);
+			if (!blockers.empty())
+			{
+				writeVarint(dependencies, info.numTasks);
+				writeVarint(dependencies, blockers.size());
+
+				for (uint32_t blocker : blockers)
+					writeVarint(dependencies, recordNumbers[blocker]);
+
+				numDependents++;
+			}
+
+			info.numTasks++;
+		}
+
+		if (info.numTasks % 8 != 0)
+			flags.push_back(flagByte);
+
+		block.append(dates);
+		block.append(flags);
+		writeVarint(block, numRules);
+		block.append(rules);
+		writeVarint(block, numLabeled);
+		block.append(labels);
+		writeVarint(block, numDependents);
+		block.append(dependencies);
+
+		info.byteLength = block.length();
+		info.checksum = Crc32c::compute(block.data(), block.length());
+		blockInfo.push_back(info);
+		blockData.push_back(std::move(block));
+	}
+
+	std::string header;
+	header.append(archiveMagic, sizeof(archiveMagic));
+	writeFixed(header, archiveVersion, 4);
+	writeFixed(header, manager.getNumTasks(), 4);
+	writeFixed(header, nameOrder.size(), 4);
+	writeFixed(header, blockInfo.size(), 4);
+	writeFixed(header, tasksPerBlock, 4);
+
+	std::string index;
+	uint64_t offset = headerSize + dictionary.length() + blockInfo.size() * indexEntrySize + checksumSize;
+
+	for (ArchiveBlockInfo& info : blockInfo)
+	{
+		info.offset = offset;
+		offset += info.byteLength;
+
+		writeFixed(index, info.offset, 8);
+		writeFixed(index, info.byteLength, 4);
+		writeFixed(index, info.numTasks, 4);
+		writeFixed(index, (uint32_t)info.firstSerial, 4);
+		writeFixed(index, (uint32_t)info.lastSerial, 4);
+		writeFixed(index, info.checksum, 4);
+	}
+
+	const uint32_t headChecksum = Crc32c::compute(index.data(), index.length(),
+		Crc32c::compute(dictionary.data(), dictionary.length(), Crc32c::compute(header.data(), header.length())));
+	writeFixed(index, headChecksum, 4);
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	file.write(header.data(), header.length());
+	file.write(dictionary.data(), dictionary.length());
+	file.write(index.data(), index.length());
+
+	for (const std::string& block : blockData)
+		file.write(block.data(), block.length());
+
+	file.close();
+
+	return !file.fail();
+}
+
+// Name:   TaskArchive()
+// Desc:   Default constructor.
+// Param:  None
+// Return: None
+TaskArchive::TaskArchive()
+	: numTasks(0), version(0)
+{
+}
+
+// Name:   open(const string& fileName)
+// Desc:   Read a compressed file into memory and decode its header,
+//         name and tag dictionaries and block index. Blocks are checked
+//         and decoded on request, so a file that was cut off in its
+//         blocks still opens. The tag names are given ids in the tag
+//         table.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if the file is a valid compressed file,
+//         getError() tells why not.
+bool TaskArchive::open(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+
+	error = "The file is not a compressed task file or is damaged before its blocks.";
+
+	if (!file.is_open())
+	{
+		error = "The file could not be opened.";
+		return false;
+	}
+
+	contents.resize(file.tellg());
+	file.seekg(0);
+	file.read((char*)contents.data(), contents.size());
+
+	if (!file || contents.size() < headerSize || memcmp(contents.data(), archiveMagic, sizeof(archiveMagic)) != 0)
+		return false;
+
+	version = readFixed(&contents[4], 4);
+
+	if (version < 1 || version > archiveVersion)
+	{
+		error = "The file is version " + std::to_string(version) + ", only versions up to "
+			+ std::to_string(archiveVersion) + " can be read.";
+		return false;
+	}
+
+	numTasks = readFixed(&contents[8], 4);
+	const uint32_t numNames = readFixed(&contents[12], 4);
+	const uint32_t numBlocks = readFixed(&contents[16], 4);
+
+	const uint8_t* data = contents.data() + headerSize;
+	const uint8_t* end = contents.data() + contents.size();
+
+	names.clear();
+	names.reserve(numNames);
+
+	for (uint32_t i = 0; i < numNames; i++)
+	{
+		uint64_t length = 0;
+
+		if (!readVarint(data, end, length) || length > (uint64_t)(end - data))
+			return false;
+
+		names.emplace_back((const char*)data, length);
+		data += length;
+	}
+
+	tagNames.clear();
+	tagBits.clear();
+
+	if (version >= firstLabelVersion)
+	{
+		uint64_t numTags = 0;
+
+		if (!readVarint(data, end, numTags) || numTags > TaskTags::maxTags)
+			return false;
+
+		for (uint64_t i = 0; i < numTags; i++)
+		{
+			uint64_t length = 0;
+
+			if (!readVarint(data, end, length) || length > (uint64_t)(end - data))
+				return false;
+
+			// A tag that does not fit in the table any more has no bit, its tasks are lost
+			tagNames.emplace_back((const char*)data, length);
+			const int tagId = TaskTags::intern(tagNames.back());
+			tagBits.push_back(tagId >= 0 ? (uint64_t)1 << tagId : 0);
+			data += length;
+		}
+	}
+
+	const bool hasChecksums = version >= firstChecksumVersion;
+	const size_t entrySize = hasChecksums ? indexEntrySize : oldIndexEntrySize;
+
+	if ((uint64_t)(end - data) < (uint64_t)numBlocks * entrySize + (hasChecksums ? checksumSize : 0))
+		return false;
+
+	blocks.resize(numBlocks);
+
+	for (ArchiveBlockInfo& info : blocks)
+	{
+		info.offset = readFixed(data, 8);
+		info.byteLength = readFixed(data + 8, 4);
+		info.numTasks = readFixed(data + 12, 4);
+		info.firstSerial = (int)readFixed(data + 16, 4);
+		info.lastSerial = (int)readFixed(data + 20, 4);
+		info.checksum = hasChecksums ? readFixed(data + 24, 4) : 0;
+		data += entrySize;
+	}
+
+	if (hasChecksums && readFixed(data, 4) != Crc32c::compute(contents.data(), data - contents.data()))
+	{
+		error = "The header, dictionaries or block index do not match their checksum.";
+		return false;
+	}
+
+	error.clear();
+
+	return true;
+}
+
+// Name:   addTasks(TaskManager& manager)
+// Desc:   Decode every block of the opened file and add its tasks to a
+//         task manager that is loading. The tasks of a damaged block and
+//         the tasks with a tag that no longer fits in the tag table are
+//         skipped and listed in the load report of the manager. The
+//         dependencies are added by the manager's endLoad(), without the
+//         ones on skipped tasks.
+// Param:  manager: The task manager to add the tasks to.
+// Return: A boolean: True if every block was decoded, false if one is damaged.
+bool TaskArchive::addTasks(TaskManager& manager)
+{
+	std::vector<ArchiveRecord> records;
+	uint64_t firstTask = 1;
+	bool decodedAll = true;
+
+	manager.loadReport.numRecords += numTasks;
+
+	for (uint32_t blockNum = 0; blockNum < getNumBlocks(); firstTask += blocks[blockNum++].numTasks)
+	{
+		if (!decodeBlock(blockNum, records))
+		{
+			TaskManager::addLostRecords(manager.loadReport, firstTask, blocks[blockNum].numTasks, error);
+			decodedAll = false;
+			continue;
+		}
+
+		for (uint32_t i = 0; i < records.size(); i++)
+		{
+			const ArchiveRecord& record = records[i];
+
+			// A save would write the task back without the tag, so it is not loaded
+			if (record.lostTag >= 0)
+			{
+				TaskManager::addLostRecords(manager.loadReport, firstTask + i, 1, getLostReason(record));
+				continue;
+			}
+
+			Node* newNode = manager.addLoadedTask(names[record.nameId], Date::fromSerial(record.serial), record.completed);
+
+			if (newNode && record.recurrence)
+				manager.setRecurrence(newNode, *record.recurrence);
+
+			if (newNode && (record.priority || record.tags))
+				manager.setLabels(newNode, record.priority, record.tags);
+
+			manager.addLoadedLine(newNode, firstTask + i, record.blockers);
+		}
+	}
+
+	return decodedAll;
+}
+
+// Name:   verify(LoadReport& report)
+// Desc:   Check and decode every block of the opened file without adding
+//         the tasks anywhere. Tasks are lost the way addTasks() loses them.
+// Param:  report: Receives the number of tasks and the lost ones.
+// Return: A boolean: True if every block was decoded, false if one is damaged.
+bool TaskArchive::verify(LoadReport& report)
+{
+	std::vector<ArchiveRecord> records;
+	uint64_t firstTask = 1;
+	bool decodedAll = true;
+
+	report.numRecords += numTasks;
+
+	for (uint32_t blockNum = 0; blockNum < getNumBlocks(); firstTask += blocks[blockNum++].numTasks)
+	{
+		if (!decodeBlock(blockNum, records))
+		{
+			TaskManager::addLostRecords(report, firstTask, blocks[blockNum].numTasks, error);
+			decodedAll = false;
+			continue;
+		}
+
+		for (uint32_t i = 0; i < records.size(); i++)
+		{
+			if (records[i].lostTag >= 0)
+				TaskManager::addLostRecords(report, firstTask + i, 1, getLostReason(records[i]));
+		}
+	}
+
+	return decodedAll;
+}
+
+// Name:   checkBlock(uint32_t blockNum)
+// Desc:   Check that a block is all in the file and matches its checksum.
+// Param:  blockNum: The number of the block to check.
+// Return: A boolean: True if the block is intact, getError() tells why not.
+bool TaskArchive::checkBlock(uint32_t blockNum)
+{
+	if (blockNum >= blocks.size())
+	{
+		error = "no such block";
+		return false;
+	}
+
+	const ArchiveBlockInfo& info = blocks[blockNum];
+
+	// A save that was cut off leaves the last blocks short or missing
+	if (info.offset > contents.size() || info.byteLength > contents.size() - info.offset)
+	{
+		error = "torn tail";
+		return false;
+	}
+
+	if (version >= firstChecksumVersion && Crc32c::compute(contents.data() + info.offset, info.byteLength) != info.checksum)
+	{
+		error = "checksum mismatch in block " + std::to_string(blockNum + 1);
+		return false;
+	}
+
+	return true;
+}
+
+// Name:   decodeBlock(uint32_t blockNum, vector<ArchiveRecord>& records)
+// Desc:   Check and decode the tasks of one block. The recurrence
+//         pointers in the records stay valid until the next block is
+//         decoded.
+// Param:  blockNum: The number of the block to decode.
+//         records: A vector that receives the decoded tasks.
+// Return: A boolean: True if the block was decoded, false if it is
+//         damaged, getError() tells why.
+bool TaskArchive::decodeBlock(uint32_t blockNum, std::vector<ArchiveRecord>& records)
+{
+	if (!checkBlock(blockNum))
+		return false;
+
+	// Only files without checksums get this far with a damaged block
+	error = "block " + std::to_string(blockNum + 1) + " could not be decoded";
+
+	const ArchiveBlockInfo& info = blocks[blockNum];
+	const uint8_t* data = contents.data() + info.offset;
+	const uint8_t* end = data + info.byteLength;
+	uint64_t value = 0;
+	int64_t delta = 0;
+	int serial = 0;
+
+	records.resize(info.numTasks);
+	recurrences.clear();
+
+	for (ArchiveRecord& record : records)
+	{
+		if (!readVarint(data, end, value) || value >= names.size())
+			return false;
+
+		record.nameId = (uint32_t)value;
+		record.recurrence = nullptr;
+		record.priority = 0;
+		record.tags = 0;
+		record.lostTag = -1;
+		record.blockers.clear();
+	}
+
+	for (ArchiveRecord& record : records)
+	{
+		if (!readSignedVarint(data, end, delta))
+			return false;
+
+		serial += (int)delta;
+		record.serial = serial;
+	}
+
+	const uint32_t flagBytes = (info.numTasks + 7) / 8;
+	if ((uint64_t)(end - data) < flagBytes)
+		return false;
+
+	for (uint32_t i = 0; i < info.numTasks; i++)
+		records[i].completed = (data[i / 8] >> (i % 8)) & 1;
+
+	data += flagBytes;
+
+	uint64_t numRules = 0;
+	if (!readVarint(data, end, numRules) || numRules > info.numTasks)
+		return false;
+
+	// Reserve up front so the record pointers are not moved by a reallocation
+	recurrences.reserve(numRules);
+
+	for (uint64_t i = 0; i < numRules; i++)
+	{
+		uint64_t taskIndex = 0;
+		uint64_t interval = 0;
+		uint64_t numCompleted = 0;
+		int64_t endSerial = 0;
+
+		if (!readVarint(data, end, taskIndex) || taskIndex >= info.numTasks || data >= end)
+			return false;
+
+		const int frequency = *data++;
+
+		// Older archives have no checksum, so a corrupt rule has to be caught before it is used
+		if (frequency > FREQUENCIES::YEARLY || !readVarint(data, end, interval) || interval > INT_MAX
+			|| !readSignedVarint(data, end, endSerial) || endSerial < INT_MIN || endSerial > INT_MAX
+			|| !readVarint(data, end, numCompleted))
+			return false;
+
+		recurrences.emplace_back((FREQUENCIES)frequency, (int)interval, Date::fromSerial((int)endSerial));
+
+		int completedSerial = records[taskIndex].serial;
+		for (uint64_t j = 0; j < numCompleted; j++)
+		{
+			if (!readSignedVarint(data, end, delta))
+				return false;
+
+			completedSerial += (int)delta;
+			recurrences.back().completeOccurrence(completedSerial);
+		}
+
+		records[taskIndex].recurrence = &recurrences.back();
+	}
+
+	if (version < firstLabelVersion)
+		return true;
+
+	uint64_t numLabeled = 0;
+	if (!readVarint(data, end, numLabeled) || numLabeled > info.numTasks)
+		return false;
+
+	for (uint64_t i = 0; i < numLabeled; i++)
+	{
+		uint64_t taskIndex = 0;
+		uint64_t archiveTags = 0;
+
+		if (!readVarint(data, end, taskIndex) || taskIndex >= info.numTasks || data >= end)
+			return false;
+
+		const int priority = *data++;
+
+		if (priority > Task::maxPriority || !readVarint(data, end, archiveTags)
+			|| (tagBits.size() < TaskTags::maxTags && archiveTags >> tagBits.size() != 0))
+			return false;
+
+		records[taskIndex].priority = priority;
+
+		for (uint64_t bits = archiveTags; bits; bits &= bits - 1)
+		{
+			const int tagNum = __builtin_ctzll(bits);
+
+			if (tagBits[tagNum])
+				records[taskIndex].tags |= tagBits[tagNum];
+			else
+				records[taskIndex].lostTag = tagNum;
+		}
+	}
+
+	if (version < firstDependencyVersion)
+		return true;
+
+	uint64_t numDependents = 0;
+	if (!readVarint(data, end, numDependents) || numDependents > info.numTasks)
+		return false;
+
+	for (uint64_t i = 0; i < numDependents; i++)
+	{
+		uint64_t taskIndex = 0;
+		uint64_t numBlockers = 0;
+
+		// Each blocker takes at least a byte, which bounds the count before anything is reserved
+		if (!readVarint(data, end, taskIndex) || taskIndex >= info.numTasks
+			|| !readVarint(data, end, numBlockers) || numBlockers > (uint64_t)(end - data))
+			return false;
+
+		std::vector<uint64_t>& blockers = records[taskIndex].blockers;
+		blockers.reserve(numBlockers);
+
+		for (uint64_t j = 0; j < numBlockers; j++)
+		{
+			if (!readVarint(data, end, value) || value < 1 || value > numTasks)
+				return false;
+
+			blockers.push_back(value);
+		}
+	}
+
+	return true;
+}
+
+// Name:   getLostReason(const ArchiveRecord& record)
+// Desc:   Describe why a decoded task that has a tag without a bit in the
+//         tag table is lost, in the words of the text file loader.
+// Param:  record: The decoded task.
+// Return: A string with the reason.
+std::string TaskArchive::getLostReason(const ArchiveRecord& record) const
+{
+	const std::string& tagName = tagNames[record.lostTag];
+
+	if (!TaskTags::isValidName(tagName))
+		return "#" + tagName + " is not a tag name";
+
+	return "tag #" + tagName + " does not fit in the table of " + std::to_string(TaskTags::maxTags) + " tags";
+}
+
+// Name:   getNumTasks()
+// Desc:   Retrieve the number of tasks in the file.
+// Param:  None
+// Return: The number of tasks.
+uint32_t TaskArchive::getNumTasks() const
+{
+	return numTasks;
+}
+
+// Name:   getNumBlocks()
+// Desc:   Retrieve the number of blocks in the file.
+// Param:  None
+// Return: The number of blocks.
+uint32_t TaskArchive::getNumBlocks() const
+{
+	return blocks.size();
+}
+
+// Name:   getBlockInfo(uint32_t blockNum)
+// Desc:   Retrieve the index entry of a block.
+// Param:  blockNum: The number of the block.
+// Return: A constant reference to the index entry.
+const ArchiveBlockInfo& TaskArchive::getBlockInfo(uint32_t blockNum) const
+{
+	return blocks[blockNum];
+}
+
+// Name:   getName(uint32_t nameId)
+// Desc:   Retrieve a task name from the dictionary.
+// Param:  nameId: The id of the name.
+// Return: A constant reference to the name.
+const std::string& TaskArchive::getName(uint32_t nameId) const
+{
+	return names[nameId];
+}
+
+// Name:   getVersion()
+// Desc:   Retrieve the format version of the opened file.
+// Param:  None
+// Return: The version number.
+uint32_t TaskArchive::getVersion() const
+{
+	return version;
+}
+
+// Name:   getFileSize()
+// Desc:   Retrieve the size of the opened file.
+// Param:  None
+// Return: The size of the file in bytes.
+size_t TaskArchive::getFileSize() const
+{
+	return contents.size();
+}
+
+// Name:   getError()
+// Desc:   Retrieve why the file could not be opened or the last block
+//         could not be decoded.
+// Param:  None
+// Return: A constant string with the error message.
+const std::string& TaskArchive::getError() const
+{
+	return error;
+}
+
+// Name:   writeVarint(string& buffer, uint64_t value)
+// Desc:   Append an unsigned integer using 7 bits per byte.
+// Param:  buffer: The buffer to append to.
+//         value: The value to append.
+// Return: None
+void TaskArchive::writeVarint(std::string& buffer, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		buffer.push_back((char)(value | 0x80));
+		value >>= 7;
+	}
+
+	buffer.push_back((char)value);
+}
+
+// Name:   writeSignedVarint(string& buffer, int64_t value)
+// Desc:   Append a signed integer as a zigzag encoded varint so small
+//         negative values also take a single byte.
+// Param:  buffer: The buffer to append to.
+//         value: The value to append.
+// Return: None
+void TaskArchive::writeSignedVarint(std::string& buffer, int64_t value)
+{
+	writeVarint(buffer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+// Name:   writeFixed(string& buffer, uint64_t value, int numBytes)
+// Desc:   Append an integer with a fixed number of little endian bytes.
+// Param:  buffer: The buffer to append to.
+//         value: The value to append.
+//         numBytes: The number of bytes to write.
+// Return: None
+void TaskArchive::writeFixed(std::string& buffer, uint64_t value, int numBytes)
+{
+	for (int i = 0; i < numBytes; i++)
+		buffer.push_back((char)(value >> (i * 8)));
+}
+
+// Name:   readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+// Desc:   Read an unsigned varint and move past it.
+// Param:  data: A pointer to the varint, moved past it on success.
+//         end: A pointer past the end of the readable data.
+//         value: Receives the value.
+// Return: A boolean: True if a complete varint was read.
+bool TaskArchive::readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+{
+	// Most ids and date deltas fit in one byte
+	if (data < end && *data < 0x80)
+	{
+		value = *data++;
+		return true;
+	}
+
+	value = 0;
+
+	for (int shift = 0; data < end && shift < 64; shift += 7)
+	{
+		const uint8_t byte = *data++;
+		value |= (uint64_t)(byte & 0x7f) << shift;
+
+		if (byte < 0x80)
+			return true;
+	}
+
+	return false;
+}
+
+// Name:   readSignedVarint(const uint8_t*& data, const uint8_t* end, int64_t& value)
+// Desc:   Read a zigzag encoded varint and move past it.
+// Param:  data: A pointer to the varint, moved past it on success.
+//         end: A pointer past the end of the readable data.
+//         value: Receives the value.
+// Return: A boolean: True if a complete varint was read.
+bool TaskArchive::readSignedVarint(const uint8_t*& data, const uint8_t* end, int64_t& value)
+{
+	uint64_t encoded = 0;
+
+	if (!readVarint(data, end, encoded))
+		return false;
+
+	value = (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+
+	return true;
+}
+
+// Name:   readFixed(const uint8_t* data, int numBytes)
+// Desc:   Read an integer with a fixed number of little endian bytes.
+// Param:  data: A pointer to the first byte.
+//         numBytes: The number of bytes to read.
+// Return: The value that was read.
+uint64_t TaskArchive::readFixed(const uint8_t* data, int numBytes)
+{
+	uint64_t value = 0;
+
+	for (int i = 0; i < numBytes; i++)
+		value |= (uint64_t)data[i] << (i * 8);
+
+	return value;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "recurrence.h"
+
+/*****************************************************************************
+# Description: The TaskArchive class reads and writes the compressed task
+               file format. Task names are stored once in a dictionary,
+			   due dates are delta and varint encoded, completion flags
+			   are packed into bits and the tasks are split into blocks
+			   that are listed in an index so any block can be decoded
+			   on its own. Tag names are stored once in a tag dictionary
+			   and each block lists the priority and tags of the tasks
+			   that have them. Each block has a CRC-32C in the index and
+			   the header, dictionaries and index have one after them,
+			   so a damaged or cut off block is found before it is
+			   decoded and only its tasks are lost. Each block also
+			   lists the tasks that wait for other tasks with the record
+			   numbers of their blockers. Version 1 files, without
+			   labels, version 2 files, without checksums, and version 3
+			   files, without dependencies, can still be read.
+
+			   File layout (all integers little endian):
+			   header | name dictionary | tag dictionary | block index |
+			   head checksum | blocks
+#****************************************************************************/
+
+class TaskManager;
+struct LoadReport;
+
+struct ArchiveRecord
+{
+	uint32_t nameId;
+	int serial;
+	bool completed;
+	const Recurrence* recurrence;
+	int priority;
+	uint64_t tags;
+	int lostTag;
+	std::vector<uint64_t> blockers;
+};
+
+struct ArchiveBlockInfo
+{
+	uint64_t offset;
+	uint32_t byteLength;
+	uint32_t numTasks;
+	int firstSerial;
+	int lastSerial;
+	uint32_t checksum;
+};
+
+class TaskArchive
+{
+public:
+	static const char* fileExtension;
+	static const uint32_t tasksPerBlock = 4096;
+
+	static bool isArchiveName(const std::string& fileName);
+	static bool isArchiveFile(const std::string& fileName);
+	static bool save(const TaskManager& manager, const std::string& fileName);
+
+	TaskArchive();
+
+	bool open(const std::string& fileName);
+	bool addTasks(TaskManager& manager);
+	bool verify(LoadReport& report);
+	bool checkBlock(uint32_t blockNum);
+	bool decodeBlock(uint32_t blockNum, std::vector<ArchiveRecord>& records);
+
+	uint32_t getNumTasks() const;
+	uint32_t getNumBlocks() const;
+	const ArchiveBlockInfo& getBlockInfo(uint32_t blockNum) const;
+	const std::string& getName(uint32_t nameId) const;
+	uint32_t getVersion() const;
+	size_t getFileSize() const;
+	const std::string& getError() const;
+
+private:
+	static void writeVarint(std::string& buffer, uint64_t value);
+	static void writeSignedVarint(std::string& buffer, int64_t value);
+	static void writeFixed(std::string& buffer, uint64_t value, int numBytes);
+	static bool readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value);
+	static bool readSignedVarint(const uint8_t*& data, const uint8_t* end, int64_t& value);
+	static uint64_t readFixed(const uint8_t* data, int numBytes);
+
+	std::string getLostReason(const ArchiveRecord& record) const;
+
+	std::vector<uint8_t> contents;
+	std::vector<std::string> names;
+	std::vector<std::string> tagNames;
+	std::vector<uint64_t> tagBits;
+	std::vector<ArchiveBlockInfo> blocks;
+	std::vector<Recurrence> recurrences;
+	uint32_t numTasks;
+	uint32_t version;
+	std::string error;
+};
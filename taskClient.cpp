@@ -0,0 +1,132 @@
+#include "taskClient.h"
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+
+// Name:   TaskClient()
+// Desc:   Default constructor that is not connected to a server.
+// Param:  None
+// Return: None
+TaskClient::TaskClient()
+	: fd(-1)
+{
+}
+
+// Name:   ~TaskClient()
+// Desc:   Destructor. Closes the connection.
+// Param:  None
+// Return: None
+TaskClient::~TaskClient()
+{
+	disconnect();
+}
+
+// Name:   connectTo(const string& socketPath)
+// Desc:   Connect to a server.
+// Param:  socketPath: The path of the server's Unix domain socket.
+// Return: A boolean: True if the connection was made.
+bool TaskClient::connectTo(const std::string& socketPath)
+{
+	sockaddr_un address = {};
+
+	disconnect();
+
+	if (socketPath.size() >= sizeof(address.sun_path))
+		return false;
+
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath.c_str());
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+		disconnect();
+
+	return fd >= 0;
+}
+
+// Name:   disconnect()
+// Desc:   Close the connection to the server.
+// Param:  None
+// Return: None
+void TaskClient::disconnect()
+{
+	if (fd >= 0)
+		close(fd);
+
+	fd = -1;
+	input.clear();
+}
+
+// Name:   request(const string& request, vector<string>& response)
+// Desc:   Send a request and wait for the whole response. A response that
+//         starts with OK and a count is followed by that many task lines.
+// Param:  request: A string that holds the tab separated request without a newline.
+//         response: Receives the response lines, the status line first.
+// Return: A boolean: True if a response was received.
+bool TaskClient::request(const std::string& request, std::vector<std::string>& response)
+{
+	const std::string message = request + "\n";
+	size_t sent = 0;
+	std::string line;
+
+	response.clear();
+
+	while (sent < message.size())
+	{
+		ssize_t length = send(fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+
+		if (length < 0 && errno != EINTR)
+			return false;
+
+		if (length > 0)
+			sent += length;
+	}
+
+	if (!readLine(line))
+		return false;
+
+	response.push_back(line);
+
+	// Only the task listings carry a count after OK
+	const bool listing = request.compare(0, 5, "QUERY") == 0 || request.compare(0, 4, "NEXT") == 0;
+	int numLines = listing && line.compare(0, 3, "OK\t") == 0 ? atoi(line.c_str() + 3) : 0;
+
+	for (int i = 0; i < numLines; i++)
+	{
+		if (!readLine(line))
+			return false;
+
+		response.push_back(line);
+	}
+
+	return true;
+}
+
+// Name:   readLine(string& line)
+// Desc:   Read one line from the server.
+// Param:  line: Receives the line without its newline.
+// Return: A boolean: False if the connection closed first.
+bool TaskClient::readLine(std::string& line)
+{
+	char buffer[16 * 1024];
+	size_t end = 0;
+
+	while ((end = input.find('\n')) == std::string::npos)
+	{
+		ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+
+		if (length == 0 || (length < 0 && errno != EINTR))
+			return false;
+
+		if (length > 0)
+			input.append(buffer, length);
+	}
+
+	line.assign(input, 0, end);
+	input.erase(0, end + 1);
+
+	return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/*****************************************************************************
+# Description: The TaskClient class connects to a TaskServer over its Unix
+               domain socket and sends requests one at a time.
+#****************************************************************************/
+
+class TaskClient
+{
+public:
+	TaskClient();
+	TaskClient(const TaskClient& origClient) = delete;
+	const TaskClient& operator=(const TaskClient& origClient) = delete;
+	~TaskClient();
+
+	bool connectTo(const std::string& socketPath);
+	void disconnect();
+	bool request(const std::string& request, std::vector<std::string>& response);
+
+private:
+	bool readLine(std::string& line);
+
+	int fd;
+	std::string input;
+};
@@ -0,0 +1,521 @@
+#include "taskExporter.h"
+#include "taskTags.h"
+#include <charconv>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Name:   getFormatName(EXPORT_FORMATS format)
+// Desc:   Retrieve the name of an export format as it is typed on the
+//         command line.
+// Param:  format: The format to name.
+// Return: A constant string with the name of the format.
+const char* TaskExporter::getFormatName(EXPORT_FORMATS format)
+{
+	switch (format)
+	{
+		case EXPORT_FORMATS::CSV:
+			return "csv";
+		case EXPORT_FORMATS::JSON_LINES:
+			return "jsonl";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   getFormatFromName(const string& name, EXPORT_FORMATS& format)
+// Desc:   Find the export format with a name.
+// Param:  name: The name of the format.
+//         format: Receives the format.
+// Return: A boolean: True if there is a format with the name.
+bool TaskExporter::getFormatFromName(const std::string& name, EXPORT_FORMATS& format)
+{
+	for (int currFormat = 0; currFormat < EXPORT_FORMATS::NUM_FORMATS; currFormat++)
+	{
+		if (name == getFormatName((EXPORT_FORMATS)currFormat))
+		{
+			format = (EXPORT_FORMATS)currFormat;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Name:   TaskExporter(EXPORT_FORMATS format, unsigned int numThreads)
+// Desc:   Constructor that sets the format and the number of threads.
+// Param:  format: The format to export in.
+//         numThreads: The number of threads that format a batch, 0 for
+//         one per processor.
+// Return: None
+TaskExporter::TaskExporter(EXPORT_FORMATS format, unsigned int numThreads)
+	: format(format), numThreads(numThreads), fileDescriptor(-1), ownsFile(false), numTasks(0), numBytes(0)
+{
+	if (this->numThreads == 0)
+		this->numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	buffers.resize(this->numThreads);
+}
+
+// Name:   ~TaskExporter()
+// Desc:   Destructor that closes the output file.
+// Param:  None
+// Return: None
+TaskExporter::~TaskExporter()
+{
+	close();
+}
+
+// Name:   open(const string& fileName)
+// Desc:   Start an export. The CSV header is written right away.
+// Param:  fileName: The file to write, replacing it if it exists. An
+//         empty name or "-" writes to the standard output.
+// Return: A boolean: True if the output could be opened.
+bool TaskExporter::open(const std::string& fileName)
+{
+	close();
+	numTasks = 0;
+	numBytes = 0;
+
+	if (fileName.empty() || fileName == "-")
+	{
+		fileDescriptor = STDOUT_FILENO;
+		ownsFile = false;
+	}
+	else
+	{
+		fileDescriptor = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		ownsFile = true;
+
+		if (fileDescriptor < 0)
+		{
+			error = "Could not open " + fileName + ": " + strerror(errno);
+			return false;
+		}
+	}
+
+	if (format == EXPORT_FORMATS::CSV)
+		return write("name,due_date,completed,frequency,interval,end_date,priority,tags\r\n");
+
+	return true;
+}
+
+// Name:   exportView(const TaskManager& manager, VIEWS view)
+// Desc:   Export every task of a task manager in the order of a view.
+// Param:  manager: The task manager to export.
+//         view: The view that decides the order of the tasks.
+// Return: A boolean: True if every task was written.
+bool TaskExporter::exportView(const TaskManager& manager, VIEWS view)
+{
+	std::vector<const Node*> batch;
+	batch.reserve(tasksPerBatch);
+
+	for (ViewIterator currNode = manager.viewBegin(view); currNode != manager.viewEnd(view); ++currNode)
+	{
+		batch.push_back(*currNode);
+
+		if (batch.size() == tasksPerBatch)
+		{
+			if (!exportBatch(batch.data(), batch.size()))
+				return false;
+
+			batch.clear();
+		}
+	}
+
+	return exportBatch(batch.data(), batch.size());
+}
+
+// Name:   exportTasks(const vector<const Node*>& tasks)
+// Desc:   Export a list of tasks, such as the matches of a filter.
+// Param:  tasks: The tasks to export in order.
+// Return: A boolean: True if every task was written.
+bool TaskExporter::exportTasks(const std::vector<const Node*>& tasks)
+{
+	for (size_t first = 0; first < tasks.size(); first += tasksPerBatch)
+	{
+		if (!exportBatch(tasks.data() + first, std::min(tasksPerBatch, tasks.size() - first)))
+			return false;
+	}
+
+	return true;
+}
+
+// Name:   close()
+// Desc:   Finish an export and close the output file.
+// Param:  None
+// Return: A boolean: True if the file was closed without an error.
+bool TaskExporter::close()
+{
+	bool closed = true;
+
+	if (fileDescriptor >= 0 && ownsFile && ::close(fileDescriptor) != 0)
+	{
+		error = std::string("Could not close the file: ") + strerror(errno);
+		closed = false;
+	}
+
+	fileDescriptor = -1;
+	ownsFile = false;
+
+	return closed;
+}
+
+// Name:   getError()
+// Desc:   Retrieve the reason the last export failed.
+// Param:  None
+// Return: A constant reference to the error message.
+const std::string& TaskExporter::getError() const
+{
+	return error;
+}
+
+// Name:   getNumTasks()
+// Desc:   Retrieve the number of tasks written since the output was opened.
+// Param:  None
+// Return: The number of tasks.
+uint64_t TaskExporter::getNumTasks() const
+{
+	return numTasks;
+}
+
+// Name:   getNumBytes()
+// Desc:   Retrieve the number of bytes written since the output was opened.
+// Param:  None
+// Return: The number of bytes.
+uint64_t TaskExporter::getNumBytes() const
+{
+	return numBytes;
+}
+
+// Name:   appendNumber(string& output, int number)
+// Desc:   Append a number in decimal.
+// Param:  output: The string to append to.
+//         number: The number to append.
+// Return: None
+void TaskExporter::appendNumber(std::string& output, int number)
+{
+	char digits[16];
+	const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number);
+
+	output.append(digits, result.ptr);
+}
+
+// Name:   appendDate(string& output, const Date& date)
+// Desc:   Append a date as yyyy-mm-dd, which sorts as text and is read by
+//         spreadsheets and JSON consumers alike. An unset date appends
+//         nothing.
+// Param:  output: The string to append to.
+//         date: The date to append.
+// Return: None
+void TaskExporter::appendDate(std::string& output, const Date& date)
+{
+	if (date.getSerial() < 0)
+		return;
+
+	char digits[16];
+	char* position = std::to_chars(digits, digits + 8, date.getYear()).ptr;
+
+	position[0] = '-';
+	position[1] = (char)('0' + date.getMonth() / 10);
+	position[2] = (char)('0' + date.getMonth() % 10);
+	position[3] = '-';
+	position[4] = (char)('0' + date.getDay() / 10);
+	position[5] = (char)('0' + date.getDay() % 10);
+
+	output.append(digits, position + 6);
+}
+
+// Name:   appendCsvText(string& output, string_view text)
+// Desc:   Append a CSV field. Fields with a comma, a quote or a line break
+//         are quoted and their quotes are doubled, as RFC 4180 requires.
+// Param:  output: The string to append to.
+//         text: The text of the field.
+// Return: None
+void TaskExporter::appendCsvText(std::string& output, std::string_view text)
+{
+	if (text.find_first_of(",\"\r\n") == std::string_view::npos)
+	{
+		output += text;
+		return;
+	}
+
+	output += '"';
+
+	for (char character : text)
+	{
+		if (character == '"')
+			output += '"';
+
+		output += character;
+	}
+
+	output += '"';
+}
+
+// Name:   appendJsonText(string& output, string_view text)
+// Desc:   Append a JSON string with its quotes. Quotes, backslashes and
+//         control characters are escaped, other bytes are copied as UTF-8.
+// Param:  output: The string to append to.
+//         text: The text of the string.
+// Return: None
+void TaskExporter::appendJsonText(std::string& output, std::string_view text)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+
+	output += '"';
+
+	for (char character : text)
+	{
+		switch (character)
+		{
+			case '"':
+				output += "\\\"";
+				break;
+			case '\\':
+				output += "\\\\";
+				break;
+			case '\n':
+				output += "\\n";
+				break;
+			case '\r':
+				output += "\\r";
+				break;
+			case '\t':
+				output += "\\t";
+				break;
+			default:
+				if ((unsigned char)character < 0x20)
+				{
+					output += "\\u00";
+					output += hexDigits[(unsigned char)character >> 4];
+					output += hexDigits[(unsigned char)character & 15];
+				}
+				else
+					output += character;
+				break;
+		}
+	}
+
+	output += '"';
+}
+
+// Name:   getFrequencyName(FREQUENCIES frequency)
+// Desc:   Retrieve the name of how often a task repeats.
+// Param:  frequency: The frequency to name.
+// Return: A constant string with the name, empty for tasks that never repeat.
+const char* TaskExporter::getFrequencyName(FREQUENCIES frequency)
+{
+	switch (frequency)
+	{
+		case FREQUENCIES::DAILY:
+			return "daily";
+		case FREQUENCIES::WEEKLY:
+			return "weekly";
+		case FREQUENCIES::MONTHLY:
+			return "monthly";
+		case FREQUENCIES::YEARLY:
+			return "yearly";
+		default:
+			return "";
+	}
+}
+
+// Name:   appendTags(string& output, uint64_t tags, const char* separator)
+// Desc:   Append the names of a set of tags. Tag names only hold letters,
+//         digits, '-' and '_', so they never need quoting or escaping.
+// Param:  output: The string to append to.
+//         tags: The tag mask.
+//         separator: The text to put between the names.
+// Return: None
+void TaskExporter::appendTags(std::string& output, uint64_t tags, const char* separator)
+{
+	for (uint64_t bits = tags; bits; bits &= bits - 1)
+	{
+		if (bits != tags)
+			output += separator;
+
+		output += TaskTags::getName(__builtin_ctzll(bits));
+	}
+}
+
+// Name:   formatCsv(const Task& task, string& output)
+// Desc:   Append a task as a CSV record. Tasks that do not repeat leave
+//         the recurrence fields empty, and the tags are one field with
+//         the names separated by spaces.
+// Param:  task: The task to format.
+//         output: The string to append to.
+// Return: None
+void TaskExporter::formatCsv(const Task& task, std::string& output) const
+{
+	const Recurrence* rule = task.getRecurrence();
+
+	appendCsvText(output, task.getName());
+	output += ',';
+	appendDate(output, task.getDueDate());
+	output += task.getCompleted() ? ",true," : ",false,";
+
+	if (rule)
+	{
+		output += getFrequencyName(rule->getFrequency());
+		output += ',';
+		appendNumber(output, rule->getInterval());
+		output += ',';
+		appendDate(output, rule->getEndDate());
+	}
+	else
+		output += ",,";
+
+	output += ',';
+	if (task.getPriority())
+		appendNumber(output, task.getPriority());
+
+	output += ',';
+	appendTags(output, task.getTags(), " ");
+	output += "\r\n";
+}
+
+// Name:   formatJson(const Task& task, string& output)
+// Desc:   Append a task as one line of JSON. The recurrence, priority and
+//         tags members are only written for tasks that have them.
+// Param:  task: The task to format.
+//         output: The string to append to.
+// Return: None
+void TaskExporter::formatJson(const Task& task, std::string& output) const
+{
+	const Recurrence* rule = task.getRecurrence();
+
+	output += "{\"name\":";
+	appendJsonText(output, task.getName());
+	output += ",\"due_date\":\"";
+	appendDate(output, task.getDueDate());
+	output += task.getCompleted() ? "\",\"completed\":true" : "\",\"completed\":false";
+
+	if (rule)
+	{
+		output += ",\"recurrence\":{\"frequency\":\"";
+		output += getFrequencyName(rule->getFrequency());
+		output += "\",\"interval\":";
+		appendNumber(output, rule->getInterval());
+
+		if (rule->getEndDate().getSerial() >= 0)
+		{
+			output += ",\"end_date\":\"";
+			appendDate(output, rule->getEndDate());
+			output += '"';
+		}
+
+		output += '}';
+	}
+
+	if (task.getPriority())
+	{
+		output += ",\"priority\":";
+		appendNumber(output, task.getPriority());
+	}
+
+	if (task.getTags())
+	{
+		output += ",\"tags\":[\"";
+		appendTags(output, task.getTags(), "\",\"");
+		output += "\"]";
+	}
+
+	output += "}\n";
+}
+
+// Name:   formatRange(const Node* const* tasks, size_t numTasks, string& output)
+// Desc:   Format a run of tasks into a buffer, replacing what it held.
+// Param:  tasks: The first task of the run.
+//         numTasks: The number of tasks in the run.
+//         output: The buffer to format into.
+// Return: None
+void TaskExporter::formatRange(const Node* const* tasks, size_t numTasks, std::string& output) const
+{
+	output.clear();
+
+	for (size_t task = 0; task < numTasks; task++)
+	{
+		if (format == EXPORT_FORMATS::CSV)
+			formatCsv(tasks[task]->task, output);
+		else
+			formatJson(tasks[task]->task, output);
+	}
+}
+
+// Name:   exportBatch(const Node* const* tasks, size_t numTasks)
+// Desc:   Format a batch of tasks in equal runs on the threads, then write
+//         the runs in order. The buffers keep their memory between
+//         batches, so a long export settles on a fixed footprint.
+// Param:  tasks: The first task of the batch.
+//         numTasks: The number of tasks in the batch.
+// Return: A boolean: True if the batch was written.
+bool TaskExporter::exportBatch(const Node* const* tasks, size_t numTasks)
+{
+	if (fileDescriptor < 0)
+	{
+		error = "The export has not been opened.";
+		return false;
+	}
+
+	if (numTasks == 0)
+		return true;
+
+	// Small batches are not worth starting threads for
+	const size_t numRuns = std::min<size_t>(numThreads, (numTasks + 1023) / 1024);
+	const size_t tasksPerRun = (numTasks + numRuns - 1) / numRuns;
+	std::vector<std::thread> threads;
+
+	for (size_t run = 1; run < numRuns; run++)
+	{
+		const size_t first = std::min(numTasks, run * tasksPerRun);
+		threads.emplace_back(&TaskExporter::formatRange, this, tasks + first, std::min(tasksPerRun, numTasks - first), std::ref(buffers[run]));
+	}
+
+	formatRange(tasks, std::min(tasksPerRun, numTasks), buffers[0]);
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	for (size_t run = 0; run < numRuns; run++)
+	{
+		if (!write(buffers[run]))
+			return false;
+	}
+
+	this->numTasks += numTasks;
+
+	return true;
+}
+
+// Name:   write(const string& data)
+// Desc:   Write a buffer to the output, continuing after partial writes.
+// Param:  data: The bytes to write.
+// Return: A boolean: True if every byte was written.
+bool TaskExporter::write(const std::string& data)
+{
+	size_t written = 0;
+
+	while (written < data.size())
+	{
+		ssize_t result = ::write(fileDescriptor, data.data() + written, data.size() - written);
+
+		if (result < 0 && errno == EINTR)
+			continue;
+
+		if (result <= 0)
+		{
+			error = std::string("Could not write the export: ") + strerror(errno);
+			return false;
+		}
+
+		written += result;
+	}
+
+	numBytes += data.size();
+
+	return true;
+}
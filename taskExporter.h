@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "taskManager.h"
+
+/*****************************************************************************
+# Description: An enum of the formats tasks can be exported in.
+               The TaskExporter class streams tasks to a file or to the
+			   standard output as RFC 4180 CSV or as JSON lines for other
+			   programs to read. Tasks are formatted in batches, each
+			   batch split between threads that write into their own
+			   buffer, and the buffers are written out in order. Only
+			   one batch is held in memory at a time.
+#****************************************************************************/
+
+enum EXPORT_FORMATS { CSV, JSON_LINES, NUM_FORMATS };
+
+class TaskExporter
+{
+public:
+	static const size_t tasksPerBatch = 1 << 16;
+
+	static const char* getFormatName(EXPORT_FORMATS format);
+	static bool getFormatFromName(const std::string& name, EXPORT_FORMATS& format);
+
+	TaskExporter(EXPORT_FORMATS format, unsigned int numThreads = 0);
+	TaskExporter(const TaskExporter& origExporter) = delete;
+	const TaskExporter& operator=(const TaskExporter& origExporter) = delete;
+	~TaskExporter();
+
+	bool open(const std::string& fileName);
+	bool exportView(const TaskManager& manager, VIEWS view);
+	bool exportTasks(const std::vector<const Node*>& tasks);
+	bool close();
+
+	const std::string& getError() const;
+	uint64_t getNumTasks() const;
+	uint64_t getNumBytes() const;
+
+private:
+	static void appendNumber(std::string& output, int number);
+	static void appendDate(std::string& output, const Date& date);
+	static void appendCsvText(std::string& output, std::string_view text);
+	static void appendJsonText(std::string& output, std::string_view text);
+	static void appendTags(std::string& output, uint64_t tags, const char* separator);
+	static const char* getFrequencyName(FREQUENCIES frequency);
+
+	void formatCsv(const Task& task, std::string& output) const;
+	void formatJson(const Task& task, std::string& output) const;
+	void formatRange(const Node* const* tasks, size_t numTasks, std::string& output) const;
+	bool exportBatch(const Node* const* tasks, size_t numTasks);
+	bool write(const std::string& data);
+
+	EXPORT_FORMATS format;
+	unsigned int numThreads;
+	std::vector<std::string> buffers;
+	int fileDescriptor;
+	bool ownsFile;
+	uint64_t numTasks;
+	uint64_t numBytes;
+	std::string error;
+};
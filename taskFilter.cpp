@@ -0,0 +1,908 @@
+#include "taskFilter.h"
+#include <algorithm>
+#include <climits>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include "taskTags.h"
+#include "parallelSort.h"
+
+// Name:   TaskFilter()
+// Desc:   Default constructor for a filter that matches every task.
+// Param:  None
+// Return: None
+TaskFilter::TaskFilter()
+	: position(0), tokenQuoted(false), firstSerial(INT_MIN), lastSerial(INT_MAX), requiredCompleted(-1),
+	requiredPriority(0), requiredTags(0)
+{
+}
+
+// Name:   ~TaskFilter()
+// Desc:   Destructor.
+// Param:  None
+// Return: None
+TaskFilter::~TaskFilter()
+{
+}
+
+// Name:   compile(const string& expression)
+// Desc:   Parse a filter expression and compile it into a program. An
+//         empty expression matches every task.
+// Param:  expression: A string that holds the filter expression.
+// Return: A boolean: True if the expression is valid, getError() tells why not.
+bool TaskFilter::compile(const std::string& expression)
+{
+	this->expression = expression;
+	position = 0;
+	error.clear();
+	root.reset();
+	program.clear();
+	patterns.clear();
+	firstSerial = INT_MIN;
+	lastSerial = INT_MAX;
+	requiredCompleted = -1;
+	requiredPriority = 0;
+	requiredTags = 0;
+
+	if (!nextToken())
+		return false;
+
+	if (token.empty() && !tokenQuoted)
+		return true;
+
+	std::unique_ptr<Term> term = parseOr();
+
+	if (!term)
+		return false;
+
+	if (!token.empty() || tokenQuoted)
+		return fail("Unexpected '" + token + "'");
+
+	root = std::move(term);
+	compileTerm(*root);
+	findBounds(*root);
+
+	return true;
+}
+
+// Name:   getError()
+// Desc:   Retrieve why the last expression could not be compiled.
+// Param:  None
+// Return: A constant string with the error message.
+const std::string& TaskFilter::getError() const
+{
+	return error;
+}
+
+// Name:   getDueBounds(int& firstSerial, int& lastSerial)
+// Desc:   Retrieve the due date range every match of the compiled
+//         expression is inside of, so a file can be loaded in part.
+// Param:  firstSerial: Receives the first due date, INT_MIN for no limit.
+//         lastSerial: Receives the last due date, INT_MAX for no limit.
+// Return: A boolean: True if the range has a limit.
+bool TaskFilter::getDueBounds(int& firstSerial, int& lastSerial) const
+{
+	firstSerial = this->firstSerial;
+	lastSerial = this->lastSerial;
+
+	return firstSerial != INT_MIN || lastSerial != INT_MAX;
+}
+
+// Name:   getScanName(const TaskManager& manager)
+// Desc:   Retrieve which tasks apply() walks for the compiled expression.
+// Param:  manager: The task list that would be filtered.
+// Return: A constant string that describes the scan.
+const char* TaskFilter::getScanName(const TaskManager& manager) const
+{
+	switch (chooseScan(manager))
+	{
+		case SCANS::INCOMPLETE_TASKS:
+			return "incomplete tasks in due date order";
+		case SCANS::COMPLETED_TASKS:
+			return "completed tasks in due date order";
+		case SCANS::DUE_RANGE:
+			return "due date range";
+		case SCANS::LABEL_POSTINGS:
+			return "priority and tag postings";
+		case SCANS::NO_TASKS:
+			return "no tasks";
+		default:
+			return "all tasks";
+	}
+}
+
+// Name:   matches(const Task& task)
+// Desc:   Run the compiled program for a task. The program keeps one result
+//         that each test overwrites, && and || jump over the right side
+//         when the left side already decides the result.
+// Param:  task: The task to test.
+// Return: A boolean: True if the task matches the filter.
+bool TaskFilter::matches(const Task& task) const
+{
+	const FilterInstruction* instructions = program.data();
+	const size_t numInstructions = program.size();
+	bool result = true;
+
+	for (size_t counter = 0; counter < numInstructions; counter++)
+	{
+		const FilterInstruction& instruction = instructions[counter];
+
+		switch (instruction.opcode)
+		{
+			case FILTER_OPCODES::TEST_COMPLETED:
+				result = task.getCompleted();
+				break;
+			case FILTER_OPCODES::TEST_RECURRING:
+				result = task.getRecurrence() != nullptr;
+				break;
+			case FILTER_OPCODES::DUE_BEFORE:
+				result = task.getDueSerial() < instruction.operand;
+				break;
+			case FILTER_OPCODES::DUE_AFTER:
+				result = task.getDueSerial() > instruction.operand;
+				break;
+			case FILTER_OPCODES::DUE_EQUALS:
+				result = task.getDueSerial() == instruction.operand;
+				break;
+			case FILTER_OPCODES::NAME_EQUALS:
+				result = task.getName() == patterns[instruction.operand];
+				break;
+			case FILTER_OPCODES::NAME_CONTAINS:
+				result = containsFolded(task.getName(), patterns[instruction.operand]);
+				break;
+			case FILTER_OPCODES::PRIORITY_BELOW:
+				result = task.getPriority() < instruction.operand;
+				break;
+			case FILTER_OPCODES::PRIORITY_ABOVE:
+				result = task.getPriority() > instruction.operand;
+				break;
+			case FILTER_OPCODES::PRIORITY_EQUALS:
+				result = task.getPriority() == instruction.operand;
+				break;
+			case FILTER_OPCODES::HAS_TAG:
+				result = instruction.operand >= 0 && ((task.getTags() >> instruction.operand) & 1);
+				break;
+			case FILTER_OPCODES::NOT:
+				result = !result;
+				break;
+			case FILTER_OPCODES::JUMP_IF_FALSE:
+				if (!result)
+					counter = instruction.operand - 1;
+				break;
+			case FILTER_OPCODES::JUMP_IF_TRUE:
+				if (result)
+					counter = instruction.operand - 1;
+				break;
+		}
+	}
+
+	return result;
+}
+
+// Name:   matchesTree(const Task& task)
+// Desc:   Test a task by walking the parsed expression directly. This gives
+//         the same answer as matches() and is kept to measure it against.
+// Param:  task: The task to test.
+// Return: A boolean: True if the task matches the filter.
+bool TaskFilter::matchesTree(const Task& task) const
+{
+	return !root || evaluate(*root, task);
+}
+
+// Name:   apply(const TaskManager& manager, VIEWS view)
+// Desc:   Find every task that matches the filter, in the order of a view.
+//         When every match has to have a priority or tags, only the tasks
+//         in the intersection of their postings are tested. When every
+//         match has to be incomplete, completed or due inside a range,
+//         only that part of the incomplete first or due date view is
+//         walked if it is small enough to beat walking the list.
+// Param:  manager: The task list to filter.
+//         view: The order to return the matches in.
+// Return: A vector of the matching nodes.
+std::vector<const Node*> TaskFilter::apply(const TaskManager& manager, VIEWS view) const
+{
+	std::vector<const Node*> results;
+	const SCANS scan = chooseScan(manager);
+	const VIEWS scanView = scan == SCANS::DUE_RANGE ? VIEWS::BY_DUE_DATE : VIEWS::INCOMPLETE_FIRST;
+	ViewIterator currNode = manager.viewEnd(scanView);
+
+	switch (scan)
+	{
+		case SCANS::NO_TASKS:
+			return results;
+
+		case SCANS::LABEL_POSTINGS:
+			for (const Node* node : manager.findLabeled(requiredPriority, requiredTags, requiredCompleted))
+			{
+				if (matches(node->task))
+					results.push_back(node);
+			}
+
+			if (view != VIEWS::INSERTION_ORDER)
+				sortResults(results, view);
+			return results;
+
+		case SCANS::ALL_TASKS:
+			// Large lists are tested in parallel on a vector of the nodes
+			if ((size_t)manager.getNumTasks() >= ParallelSort::serialThreshold)
+			{
+				std::vector<const Node*> nodes;
+				nodes.reserve(manager.getNumTasks());
+
+				for (const Node* listNode = manager.getTasks(); listNode; listNode = listNode->next)
+					nodes.push_back(listNode);
+
+				results = ParallelSort::filter(nodes, [this](const Node* node) { return matches(node->task); });
+			}
+			else
+			{
+				for (const Node* listNode = manager.getTasks(); listNode; listNode = listNode->next)
+				{
+					if (matches(listNode->task))
+						results.push_back(listNode);
+				}
+			}
+
+			if (view != VIEWS::INSERTION_ORDER)
+				sortResults(results, view);
+			return results;
+
+		case SCANS::INCOMPLETE_TASKS:
+			currNode = firstSerial != INT_MIN ? manager.findDue(scanView, firstSerial) : manager.viewBegin(scanView);
+			break;
+
+		case SCANS::COMPLETED_TASKS:
+			// The completed tasks start after every incomplete task
+			currNode = manager.findDue(scanView, INT_MAX);
+			break;
+
+		case SCANS::DUE_RANGE:
+			currNode = firstSerial != INT_MIN ? manager.findDue(scanView, firstSerial) : manager.viewBegin(scanView);
+			break;
+	}
+
+	for (; currNode != manager.viewEnd(scanView); ++currNode)
+	{
+		const Task& task = (*currNode)->task;
+
+		if ((scan == SCANS::INCOMPLETE_TASKS && task.getCompleted()) || task.getDueSerial() > lastSerial)
+			break;
+		if (matches(task))
+			results.push_back(*currNode);
+	}
+
+	// Tasks of one completion state are in the same order in both due date views
+	if (view != scanView && !(scan != SCANS::DUE_RANGE && view == VIEWS::BY_DUE_DATE))
+		sortResults(results, view);
+
+	return results;
+}
+
+// Name:   parseDate(const string& text, int& serial)
+// Desc:   Convert a date in m/d/yyyy or yyyy-mm-dd form to a serial date.
+// Param:  text: A string that holds the date.
+//         serial: Receives the serial date.
+// Return: A boolean: True if the text is a valid date.
+bool TaskFilter::parseDate(const std::string& text, int& serial)
+{
+	int month = 0;
+	int day = 0;
+	int year = 0;
+	char extra = 0;
+
+	if (sscanf(text.c_str(), "%d/%d/%d%c", &month, &day, &year, &extra) != 3
+		&& sscanf(text.c_str(), "%d-%d-%d%c", &year, &month, &day, &extra) != 3)
+		return false;
+
+	if (!Date::isValidDate(month, day, year))
+		return false;
+
+	serial = Date(month, day, year).getSerial();
+
+	return true;
+}
+
+// Name:   containsFolded(string_view text, const string& foldedPattern)
+// Desc:   Check if a text contains a pattern, ignoring case, without
+//         making a lower case copy of the text.
+// Param:  text: The text to search.
+//         foldedPattern: The pattern to find, already in lower case.
+// Return: A boolean: True if the pattern was found.
+bool TaskFilter::containsFolded(std::string_view text, const std::string& foldedPattern)
+{
+	const size_t patternLength = foldedPattern.size();
+
+	if (patternLength == 0)
+		return true;
+
+	if (text.size() < patternLength)
+		return false;
+
+	const unsigned char first = foldedPattern[0];
+	const size_t lastStart = text.size() - patternLength;
+
+	for (size_t start = 0; start <= lastStart; start++)
+	{
+		if (tolower((unsigned char)text[start]) != first)
+			continue;
+
+		size_t i = 1;
+		while (i < patternLength && tolower((unsigned char)text[start + i]) == (unsigned char)foldedPattern[i])
+			i++;
+
+		if (i == patternLength)
+			return true;
+	}
+
+	return false;
+}
+
+// Name:   sortResults(vector<const Node*>& results, VIEWS view)
+// Desc:   Put the matches in the order of a view. Insertion order is
+//         sorted on the sequence numbers read once, not on the nodes.
+//         Large results are sorted on the shared thread pool.
+// Param:  results: The matching nodes to sort.
+//         view: The view that decides the order.
+// Return: None
+void TaskFilter::sortResults(std::vector<const Node*>& results, VIEWS view)
+{
+	if (view != VIEWS::INSERTION_ORDER)
+	{
+		ParallelSort::sort(results, NodeOrder{ view });
+		return;
+	}
+
+	std::vector<std::pair<unsigned int, const Node*>> keys;
+	keys.reserve(results.size());
+
+	for (const Node* node : results)
+		keys.push_back({ node->sequence, node });
+
+	ParallelSort::sort(keys, std::less<std::pair<unsigned int, const Node*>>());
+
+	for (size_t i = 0; i < keys.size(); i++)
+		results[i] = keys[i].second;
+}
+
+// Name:   nextToken()
+// Desc:   Read the next token of the expression: an operator, a word or a
+//         quoted string. The token is empty at the end of the expression.
+// Param:  None
+// Return: A boolean: False if a quoted string is not closed.
+bool TaskFilter::nextToken()
+{
+	static const char* operators[] = { "&&", "||", "<=", ">=", "==", "!=", "<", ">", "!", "~", "(", ")" };
+
+	token.clear();
+	tokenQuoted = false;
+
+	while (position < expression.size() && isspace((unsigned char)expression[position]))
+		position++;
+
+	if (position >= expression.size())
+		return true;
+
+	if (expression[position] == '"')
+	{
+		tokenQuoted = true;
+
+		for (position++; position < expression.size() && expression[position] != '"'; position++)
+		{
+			if (expression[position] == '\\' && position + 1 < expression.size())
+				position++;
+			token += expression[position];
+		}
+
+		if (position >= expression.size())
+			return fail("A quoted name is not closed");
+
+		position++;
+		return true;
+	}
+
+	for (const char* op : operators)
+	{
+		if (expression.compare(position, std::char_traits<char>::length(op), op) == 0)
+		{
+			token = op;
+			position += token.size();
+			return true;
+		}
+	}
+
+	while (position < expression.size() && (isalnum((unsigned char)expression[position]) || strchr("/-_.", expression[position])))
+		token += expression[position++];
+
+	if (token.empty())
+		return fail(std::string("Unexpected '") + expression[position] + "'");
+
+	return true;
+}
+
+// Name:   parseOr()
+// Desc:   Parse terms joined by ||.
+// Param:  None
+// Return: The parsed term, or nullptr on an error.
+std::unique_ptr<TaskFilter::Term> TaskFilter::parseOr()
+{
+	std::unique_ptr<Term> left = parseAnd();
+
+	while (left && token == "||" && !tokenQuoted)
+	{
+		if (!nextToken())
+			return nullptr;
+
+		std::unique_ptr<Term> right = parseAnd();
+		if (!right)
+			return nullptr;
+
+		std::unique_ptr<Term> term(new Term{ TERMS::OR, "", 0, "", std::move(left), std::move(right) });
+		left = std::move(term);
+	}
+
+	return left;
+}
+
+// Name:   parseAnd()
+// Desc:   Parse terms joined by &&.
+// Param:  None
+// Return: The parsed term, or nullptr on an error.
+std::unique_ptr<TaskFilter::Term> TaskFilter::parseAnd()
+{
+	std::unique_ptr<Term> left = parseUnary();
+
+	while (left && token == "&&" && !tokenQuoted)
+	{
+		if (!nextToken())
+			return nullptr;
+
+		std::unique_ptr<Term> right = parseUnary();
+		if (!right)
+			return nullptr;
+
+		std::unique_ptr<Term> term(new Term{ TERMS::AND, "", 0, "", std::move(left), std::move(right) });
+		left = std::move(term);
+	}
+
+	return left;
+}
+
+// Name:   parseUnary()
+// Desc:   Parse a negated term, a term in parentheses or a single test.
+// Param:  None
+// Return: The parsed term, or nullptr on an error.
+std::unique_ptr<TaskFilter::Term> TaskFilter::parseUnary()
+{
+	const std::string word = token;
+
+	if (tokenQuoted)
+	{
+		fail("A quoted name has to follow name or tag");
+		return nullptr;
+	}
+
+	if (word.empty())
+	{
+		fail("The expression ends too early");
+		return nullptr;
+	}
+
+	if (!nextToken())
+		return nullptr;
+
+	if (word == "!")
+	{
+		std::unique_ptr<Term> operand = parseUnary();
+		if (!operand)
+			return nullptr;
+
+		return std::unique_ptr<Term>(new Term{ TERMS::NEGATE, "", 0, "", std::move(operand), nullptr });
+	}
+
+	if (word == "(")
+	{
+		std::unique_ptr<Term> inner = parseOr();
+		if (!inner)
+			return nullptr;
+
+		if (token != ")" || tokenQuoted)
+		{
+			fail("Missing ')'");
+			return nullptr;
+		}
+
+		if (!nextToken())
+			return nullptr;
+
+		return inner;
+	}
+
+	if (word == "completed")
+		return std::unique_ptr<Term>(new Term{ TERMS::COMPLETED, "", 0, "", nullptr, nullptr });
+	if (word == "recurring")
+		return std::unique_ptr<Term>(new Term{ TERMS::RECURRING, "", 0, "", nullptr, nullptr });
+	if (word == "due")
+		return parseComparison(TERMS::DUE);
+	if (word == "name")
+		return parseComparison(TERMS::NAME);
+	if (word == "priority")
+		return parseComparison(TERMS::PRIORITY);
+	if (word == "tag")
+		return parseComparison(TERMS::TAG);
+
+	fail("Unknown term '" + word + "'");
+	return nullptr;
+}
+
+// Name:   parseComparison(TERMS type)
+// Desc:   Parse the operator and value that follow due, name, priority
+//         or tag. A tag name is given an id if it is new, so the filter
+//         still works for tasks that are loaded after it is compiled.
+// Param:  type: The term the comparison is for.
+// Return: The parsed term, or nullptr on an error.
+std::unique_ptr<TaskFilter::Term> TaskFilter::parseComparison(TERMS type)
+{
+	static const char* dueOperators[] = { "<", "<=", ">", ">=", "==", "!=" };
+	static const char* nameOperators[] = { "==", "!=", "~" };
+	static const char* termNames[] = { "", "", "", "", "", "a due date", "a name", "a priority", "a tag" };
+	const std::string comparison = token;
+	bool valid = false;
+
+	if (type == TERMS::DUE || type == TERMS::PRIORITY)
+		valid = std::find(dueOperators, dueOperators + 6, comparison) != dueOperators + 6;
+	else if (type == TERMS::NAME)
+		valid = std::find(nameOperators, nameOperators + 3, comparison) != nameOperators + 3;
+	else
+		valid = std::find(nameOperators, nameOperators + 2, comparison) != nameOperators + 2;
+
+	if (!valid || tokenQuoted)
+	{
+		fail("'" + comparison + "' cannot compare " + termNames[type]);
+		return nullptr;
+	}
+
+	if (!nextToken())
+		return nullptr;
+
+	std::unique_ptr<Term> term(new Term{ type, comparison, 0, token, nullptr, nullptr });
+
+	if (type == TERMS::DUE && (tokenQuoted || !parseDate(token, term->serial)))
+	{
+		fail("'" + token + "' is not a date, use m/d/yyyy");
+		return nullptr;
+	}
+
+	if (type == TERMS::NAME && token.empty() && !tokenQuoted)
+	{
+		fail("A name is missing");
+		return nullptr;
+	}
+
+	if (type == TERMS::PRIORITY)
+	{
+		char* numberEnd = nullptr;
+		term->serial = (int)strtol(token.c_str(), &numberEnd, 10);
+
+		if (tokenQuoted || token.empty() || *numberEnd != '\0' || term->serial < 0 || term->serial > Task::maxPriority)
+		{
+			fail("'" + token + "' is not a priority, use 0 to " + std::to_string(Task::maxPriority));
+			return nullptr;
+		}
+	}
+
+	if (type == TERMS::TAG)
+	{
+		const std::string tagName = !token.empty() && token[0] == '#' ? token.substr(1) : token;
+
+		if (!TaskTags::isValidName(tagName))
+		{
+			fail("'" + token + "' is not a tag name");
+			return nullptr;
+		}
+
+		// A tag no task has is not added to the table, it is -1 and matches no task
+		term->serial = TaskTags::find(tagName);
+	}
+
+	if (!nextToken())
+		return nullptr;
+
+	return term;
+}
+
+// Name:   fail(const string& message)
+// Desc:   Record a parse error.
+// Param:  message: A string that describes the error.
+// Return: A boolean: Always false.
+bool TaskFilter::fail(const std::string& message)
+{
+	if (error.empty())
+		error = message + " (at character " + std::to_string(position) + ")";
+
+	return false;
+}
+
+// Name:   compileTerm(const Term& term)
+// Desc:   Append the instructions for a term to the program. Every due
+//         comparison becomes one of three tests against a fixed serial.
+// Param:  term: The term to compile.
+// Return: None
+void TaskFilter::compileTerm(const Term& term)
+{
+	switch (term.type)
+	{
+		case TERMS::AND:
+		case TERMS::OR:
+		{
+			compileTerm(*term.left);
+			size_t jump = program.size();
+			program.push_back({ term.type == TERMS::AND ? FILTER_OPCODES::JUMP_IF_FALSE : FILTER_OPCODES::JUMP_IF_TRUE, 0 });
+			compileTerm(*term.right);
+			program[jump].operand = (int)program.size();
+			break;
+		}
+
+		case TERMS::NEGATE:
+			compileTerm(*term.left);
+			program.push_back({ FILTER_OPCODES::NOT, 0 });
+			break;
+
+		case TERMS::COMPLETED:
+			program.push_back({ FILTER_OPCODES::TEST_COMPLETED, 0 });
+			break;
+
+		case TERMS::RECURRING:
+			program.push_back({ FILTER_OPCODES::TEST_RECURRING, 0 });
+			break;
+
+		case TERMS::DUE:
+			if (term.comparison == "<")
+				program.push_back({ FILTER_OPCODES::DUE_BEFORE, term.serial });
+			else if (term.comparison == "<=")
+				program.push_back({ FILTER_OPCODES::DUE_BEFORE, term.serial + 1 });
+			else if (term.comparison == ">")
+				program.push_back({ FILTER_OPCODES::DUE_AFTER, term.serial });
+			else if (term.comparison == ">=")
+				program.push_back({ FILTER_OPCODES::DUE_AFTER, term.serial - 1 });
+			else
+			{
+				program.push_back({ FILTER_OPCODES::DUE_EQUALS, term.serial });
+				if (term.comparison == "!=")
+					program.push_back({ FILTER_OPCODES::NOT, 0 });
+			}
+			break;
+
+		case TERMS::NAME:
+		{
+			std::string pattern = term.text;
+
+			if (term.comparison == "~")
+				std::transform(pattern.begin(), pattern.end(), pattern.begin(), [](unsigned char nameChar) { return (char)tolower(nameChar); });
+
+			program.push_back({ term.comparison == "~" ? FILTER_OPCODES::NAME_CONTAINS : FILTER_OPCODES::NAME_EQUALS, (int)patterns.size() });
+			patterns.push_back(pattern);
+
+			if (term.comparison == "!=")
+				program.push_back({ FILTER_OPCODES::NOT, 0 });
+			break;
+		}
+
+		case TERMS::PRIORITY:
+			if (term.comparison == "<")
+				program.push_back({ FILTER_OPCODES::PRIORITY_BELOW, term.serial });
+			else if (term.comparison == "<=")
+				program.push_back({ FILTER_OPCODES::PRIORITY_BELOW, term.serial + 1 });
+			else if (term.comparison == ">")
+				program.push_back({ FILTER_OPCODES::PRIORITY_ABOVE, term.serial });
+			else if (term.comparison == ">=")
+				program.push_back({ FILTER_OPCODES::PRIORITY_ABOVE, term.serial - 1 });
+			else
+			{
+				program.push_back({ FILTER_OPCODES::PRIORITY_EQUALS, term.serial });
+				if (term.comparison == "!=")
+					program.push_back({ FILTER_OPCODES::NOT, 0 });
+			}
+			break;
+
+		case TERMS::TAG:
+			program.push_back({ FILTER_OPCODES::HAS_TAG, term.serial });
+			if (term.comparison == "!=")
+				program.push_back({ FILTER_OPCODES::NOT, 0 });
+			break;
+	}
+}
+
+// Name:   findBounds(const Term& term)
+// Desc:   Narrow the due date range, completion state, priority and tags
+//         that every match has to have. Only terms joined to the top by
+//         && are used, a term under || or ! does not have to hold for
+//         every match.
+// Param:  term: The term to look at.
+// Return: None
+void TaskFilter::findBounds(const Term& term)
+{
+	switch (term.type)
+	{
+		case TERMS::AND:
+			findBounds(*term.left);
+			findBounds(*term.right);
+			break;
+
+		case TERMS::COMPLETED:
+			requiredCompleted = requiredCompleted == 0 || requiredCompleted == 2 ? 2 : 1;
+			break;
+
+		case TERMS::NEGATE:
+			if (term.left->type == TERMS::COMPLETED)
+				requiredCompleted = requiredCompleted == 1 || requiredCompleted == 2 ? 2 : 0;
+			break;
+
+		case TERMS::DUE:
+			if (term.comparison == "<")
+				lastSerial = std::min(lastSerial, term.serial - 1);
+			else if (term.comparison == "<=")
+				lastSerial = std::min(lastSerial, term.serial);
+			else if (term.comparison == ">")
+				firstSerial = std::max(firstSerial, term.serial + 1);
+			else if (term.comparison == ">=")
+				firstSerial = std::max(firstSerial, term.serial);
+			else if (term.comparison == "==")
+			{
+				firstSerial = std::max(firstSerial, term.serial);
+				lastSerial = std::min(lastSerial, term.serial);
+			}
+			break;
+
+		case TERMS::PRIORITY:
+			// Only a single priority has a posting, no priority is every other task
+			if (term.comparison == "==" && term.serial > 0)
+				requiredPriority = requiredPriority == 0 || requiredPriority == term.serial ? term.serial : -1;
+			break;
+
+		case TERMS::TAG:
+			if (term.comparison == "==" && term.serial >= 0)
+				requiredTags |= (uint64_t)1 << term.serial;
+			break;
+
+		default:
+			break;
+	}
+
+	// Two different priorities: nothing can match
+	if (requiredPriority < 0)
+	{
+		firstSerial = INT_MAX;
+		lastSerial = INT_MIN;
+	}
+
+	// Both completed and not completed: nothing can match
+	if (requiredCompleted == 2)
+	{
+		firstSerial = INT_MAX;
+		lastSerial = INT_MIN;
+	}
+}
+
+// Name:   chooseScan(const TaskManager& manager)
+// Desc:   Decide which tasks apply() walks. The label postings are used
+//         whenever a priority or tag is needed, since intersecting them
+//         reads a bit per task. Otherwise the number of tasks a view walk
+//         would visit is estimated from the completed count and the share
+//         of the due date range the bounds cover.
+// Param:  manager: The task list that will be filtered.
+// Return: The part of the task list to walk.
+TaskFilter::SCANS TaskFilter::chooseScan(const TaskManager& manager) const
+{
+	int firstDue = 0;
+	int lastDue = 0;
+
+	if (!manager.getDueRange(firstDue, lastDue) || firstSerial > lastSerial
+		|| std::max(firstSerial, firstDue) > std::min(lastSerial, lastDue))
+		return SCANS::NO_TASKS;
+
+	if (requiredPriority > 0 || requiredTags)
+		return SCANS::LABEL_POSTINGS;
+
+	const double numTasks = manager.getNumTasks();
+	const double dueShare = (std::min(lastSerial, lastDue) - std::max(firstSerial, firstDue) + 1.0) / (lastDue - firstDue + 1.0);
+	const bool dueBounded = firstSerial != INT_MIN || lastSerial != INT_MAX;
+	SCANS scan = SCANS::ALL_TASKS;
+	double numVisited = numTasks;
+
+	if (requiredCompleted == 0)
+	{
+		scan = SCANS::INCOMPLETE_TASKS;
+		numVisited = (numTasks - manager.getNumCompleted()) * dueShare;
+	}
+	else if (dueBounded)
+	{
+		scan = SCANS::DUE_RANGE;
+		numVisited = numTasks * dueShare;
+	}
+	else if (requiredCompleted == 1)
+	{
+		scan = SCANS::COMPLETED_TASKS;
+		numVisited = manager.getNumCompleted();
+	}
+
+	return numVisited * viewScanCost < numTasks ? scan : SCANS::ALL_TASKS;
+}
+
+// Name:   evaluate(const Term& term, const Task& task)
+// Desc:   Test a task against a parsed term by walking the term's tree.
+// Param:  term: The term to evaluate.
+//         task: The task to test.
+// Return: A boolean: True if the task passes the term.
+bool TaskFilter::evaluate(const Term& term, const Task& task) const
+{
+	switch (term.type)
+	{
+		case TERMS::AND:
+			return evaluate(*term.left, task) && evaluate(*term.right, task);
+
+		case TERMS::OR:
+			return evaluate(*term.left, task) || evaluate(*term.right, task);
+
+		case TERMS::NEGATE:
+			return !evaluate(*term.left, task);
+
+		case TERMS::COMPLETED:
+			return task.getCompleted();
+
+		case TERMS::RECURRING:
+			return task.getRecurrence() != nullptr;
+
+		case TERMS::DUE:
+		{
+			const int serial = task.getDueSerial();
+
+			if (term.comparison == "<")
+				return serial < term.serial;
+			if (term.comparison == "<=")
+				return serial <= term.serial;
+			if (term.comparison == ">")
+				return serial > term.serial;
+			if (term.comparison == ">=")
+				return serial >= term.serial;
+			if (term.comparison == "==")
+				return serial == term.serial;
+			return serial != term.serial;
+		}
+
+		case TERMS::NAME:
+		{
+			if (term.comparison == "==")
+				return task.getName() == term.text;
+			if (term.comparison == "!=")
+				return task.getName() != term.text;
+
+			std::string name(task.getName());
+			std::string pattern = term.text;
+			std::transform(name.begin(), name.end(), name.begin(), [](unsigned char nameChar) { return (char)tolower(nameChar); });
+			std::transform(pattern.begin(), pattern.end(), pattern.begin(), [](unsigned char nameChar) { return (char)tolower(nameChar); });
+			return name.find(pattern) != std::string::npos;
+		}
+
+		case TERMS::PRIORITY:
+		{
+			const int priority = task.getPriority();
+
+			if (term.comparison == "<")
+				return priority < term.serial;
+			if (term.comparison == "<=")
+				return priority <= term.serial;
+			if (term.comparison == ">")
+				return priority > term.serial;
+			if (term.comparison == ">=")
+				return priority >= term.serial;
+			if (term.comparison == "==")
+				return priority == term.serial;
+			return priority != term.serial;
+		}
+
+		case TERMS::TAG:
+			return (term.serial >= 0 && ((task.getTags() >> term.serial) & 1)) == (term.comparison == "==");
+	}
+
+	return false;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include "taskManager.h"
+
+/*****************************************************************************
+# Description: The TaskFilter class compiles a filter expression such as
+               !completed && due < 12/01/2024 && name ~ "report"
+			   into a flat program of tests and jumps that is run once per
+			   task. The terms are completed, recurring, due (compared with
+			   < <= > >= == != against m/d/yyyy or yyyy-mm-dd), name
+			   (== for an exact match, ~ to contain, ignoring case),
+			   priority (compared like due against 0 to 3, 0 is none) and
+			   tag (== or != a tag name). Terms are combined with !, &&,
+			   || and parentheses.
+			   Due date and completion terms that every match has to pass
+			   are used to walk only part of the sorted views, and the
+			   priority and tags every match needs are looked up in the
+			   label postings.
+#****************************************************************************/
+
+enum FILTER_OPCODES { TEST_COMPLETED, TEST_RECURRING, DUE_BEFORE, DUE_AFTER, DUE_EQUALS, NAME_EQUALS, NAME_CONTAINS,
+	PRIORITY_BELOW, PRIORITY_ABOVE, PRIORITY_EQUALS, HAS_TAG, NOT, JUMP_IF_FALSE, JUMP_IF_TRUE };
+
+struct FilterInstruction
+{
+	FILTER_OPCODES opcode;
+	int operand;
+};
+
+class TaskFilter
+{
+public:
+	TaskFilter();
+	TaskFilter(const TaskFilter& origFilter) = delete;
+	const TaskFilter& operator=(const TaskFilter& origFilter) = delete;
+	~TaskFilter();
+
+	bool compile(const std::string& expression);
+	const std::string& getError() const;
+	const char* getScanName(const TaskManager& manager) const;
+	bool getDueBounds(int& firstSerial, int& lastSerial) const;
+
+	bool matches(const Task& task) const;
+	bool matchesTree(const Task& task) const;
+	std::vector<const Node*> apply(const TaskManager& manager, VIEWS view) const;
+
+private:
+	enum TERMS { AND, OR, NEGATE, COMPLETED, RECURRING, DUE, NAME, PRIORITY, TAG };
+	enum SCANS { ALL_TASKS, INCOMPLETE_TASKS, COMPLETED_TASKS, DUE_RANGE, LABEL_POSTINGS, NO_TASKS };
+
+	// Walking a view visits the nodes out of memory order, which costs
+	// about this many times more per task than walking the list
+	static const int viewScanCost = 4;
+
+	struct Term
+	{
+		TERMS type;
+		std::string comparison;
+		int serial;
+		std::string text;
+		std::unique_ptr<Term> left;
+		std::unique_ptr<Term> right;
+	};
+
+	static bool parseDate(const std::string& text, int& serial);
+	static bool containsFolded(std::string_view text, const std::string& foldedPattern);
+	static void sortResults(std::vector<const Node*>& results, VIEWS view);
+
+	bool nextToken();
+	std::unique_ptr<Term> parseOr();
+	std::unique_ptr<Term> parseAnd();
+	std::unique_ptr<Term> parseUnary();
+	std::unique_ptr<Term> parseComparison(TERMS type);
+	bool fail(const std::string& message);
+
+	void compileTerm(const Term& term);
+	void findBounds(const Term& term);
+	SCANS chooseScan(const TaskManager& manager) const;
+	bool evaluate(const Term& term, const Task& task) const;
+
+	std::unique_ptr<Term> root;
+	std::vector<FilterInstruction> program;
+	std::vector<std::string> patterns;
+	std::string error;
+
+	// Parser state
+	std::string expression;
+	size_t position;
+	std::string token;
+	bool tokenQuoted;
+
+	// Bounds every match is inside of
+	int firstSerial;
+	int lastSerial;
+	int requiredCompleted;
+	int requiredPriority;
+	uint64_t requiredTags;
+};
@@ -0,0 +1,297 @@
+#include "taskGraph.h"
+#include <algorithm>
+
+// Name:   TaskGraph()
+// Desc:   Default constructor for a graph without edges.
+// Param:  None
+// Return: None
+TaskGraph::TaskGraph()
+	: numEdges(0), searchNum(0)
+{
+}
+
+// Name:   clear()
+// Desc:   Remove every edge.
+// Param:  None
+// Return: None
+void TaskGraph::clear()
+{
+	links.clear();
+	visited.clear();
+	numEdges = 0;
+	searchNum = 0;
+}
+
+// Name:   addEdge(uint32_t blocker, uint32_t dependent, bool blockerOpen)
+// Desc:   Make a task wait for another one. The edge is refused if it is
+//         already there or if the blocker already waits for the
+//         dependent, directly or through other tasks.
+// Param:  blocker: The slot of the task that has to be done first.
+//         dependent: The slot of the task that waits for it.
+//         blockerOpen: A boolean that is true if the blocker is not completed.
+// Return: A boolean: True if the edge was added.
+bool TaskGraph::addEdge(uint32_t blocker, uint32_t dependent, bool blockerOpen)
+{
+	if (hasEdge(blocker, dependent) || reaches(dependent, blocker))
+		return false;
+
+	links[blocker].dependents.push_back(dependent);
+
+	Links& dependentLinks = links[dependent];
+	dependentLinks.blockers.push_back(blocker);
+	dependentLinks.numOpenBlockers += blockerOpen;
+	numEdges++;
+
+	return true;
+}
+
+// Name:   removeEdge(uint32_t blocker, uint32_t dependent, bool blockerOpen)
+// Desc:   Stop a task from waiting for another one.
+// Param:  blocker: The slot of the task that had to be done first.
+//         dependent: The slot of the task that waits for it.
+//         blockerOpen: A boolean that is true if the blocker is not completed.
+// Return: A boolean: True if there was such an edge.
+bool TaskGraph::removeEdge(uint32_t blocker, uint32_t dependent, bool blockerOpen)
+{
+	if (!hasEdge(blocker, dependent))
+		return false;
+
+	Links& dependentLinks = links[dependent];
+
+	eraseSlot(links[blocker].dependents, dependent);
+	eraseSlot(dependentLinks.blockers, blocker);
+	dependentLinks.numOpenBlockers -= blockerOpen;
+	numEdges--;
+
+	eraseIfUnlinked(blocker);
+	eraseIfUnlinked(dependent);
+
+	return true;
+}
+
+// Name:   removeTask(uint32_t slot, bool open, vector<uint32_t>& changed)
+// Desc:   Remove every edge of a task that is being deleted. Its
+//         dependents no longer wait for it.
+// Param:  slot: The slot of the task.
+//         open: A boolean that is true if the task is not completed.
+//         changed: Receives the dependents that were unblocked.
+// Return: None
+void TaskGraph::removeTask(uint32_t slot, bool open, std::vector<uint32_t>& changed)
+{
+	std::unordered_map<uint32_t, Links>::iterator found = links.find(slot);
+
+	if (found == links.end())
+		return;
+
+	// The entry is taken out first, so no edge back to the task is left behind
+	const Links removed = std::move(found->second);
+	links.erase(found);
+
+	for (uint32_t dependent : removed.dependents)
+	{
+		Links& dependentLinks = links[dependent];
+
+		eraseSlot(dependentLinks.blockers, slot);
+
+		if (open && --dependentLinks.numOpenBlockers == 0)
+			changed.push_back(dependent);
+
+		eraseIfUnlinked(dependent);
+	}
+
+	for (uint32_t blocker : removed.blockers)
+	{
+		eraseSlot(links[blocker].dependents, slot);
+		eraseIfUnlinked(blocker);
+	}
+
+	numEdges -= removed.dependents.size() + removed.blockers.size();
+}
+
+// Name:   setOpen(uint32_t slot, bool open, vector<uint32_t>& changed)
+// Desc:   Update the dependents of a task that was completed or opened
+//         again. Only the dependents of the task are visited.
+// Param:  slot: The slot of the task.
+//         open: A boolean that is true if the task was opened again.
+//         changed: Receives the dependents that were blocked or unblocked.
+// Return: None
+void TaskGraph::setOpen(uint32_t slot, bool open, std::vector<uint32_t>& changed)
+{
+	std::unordered_map<uint32_t, Links>::const_iterator found = links.find(slot);
+
+	if (found == links.end())
+		return;
+
+	for (uint32_t dependent : found->second.dependents)
+	{
+		uint32_t& numOpenBlockers = links[dependent].numOpenBlockers;
+
+		if (open ? numOpenBlockers++ == 0 : --numOpenBlockers == 0)
+			changed.push_back(dependent);
+	}
+}
+
+// Name:   isBlocked(uint32_t slot)
+// Desc:   Check if a task waits for a task that is not completed.
+// Param:  slot: The slot of the task.
+// Return: A boolean: True if the task is blocked.
+bool TaskGraph::isBlocked(uint32_t slot) const
+{
+	std::unordered_map<uint32_t, Links>::const_iterator found = links.find(slot);
+
+	return found != links.end() && found->second.numOpenBlockers > 0;
+}
+
+// Name:   hasEdge(uint32_t blocker, uint32_t dependent)
+// Desc:   Check if a task waits for another one directly.
+// Param:  blocker: The slot of the task that has to be done first.
+//         dependent: The slot of the task that waits for it.
+// Return: A boolean: True if there is such an edge.
+bool TaskGraph::hasEdge(uint32_t blocker, uint32_t dependent) const
+{
+	const std::vector<uint32_t>& blockers = getBlockers(dependent);
+
+	return std::find(blockers.begin(), blockers.end(), blocker) != blockers.end();
+}
+
+// Name:   hasEdges(uint32_t slot)
+// Desc:   Check if a task waits for or blocks any task.
+// Param:  slot: The slot of the task.
+// Return: A boolean: True if the task has an edge.
+bool TaskGraph::hasEdges(uint32_t slot) const
+{
+	return links.count(slot) != 0;
+}
+
+// Name:   reaches(uint32_t from, uint32_t to)
+// Desc:   Check if a task is blocked by another one through a chain of
+//         dependents. The search only visits the tasks that wait for
+//         the first one, so it is cheap for the small chains of a list.
+// Param:  from: The slot of the task to start at.
+//         to: The slot of the task to look for.
+// Return: A boolean: True if the second task waits for the first one,
+//         or they are the same task.
+bool TaskGraph::reaches(uint32_t from, uint32_t to) const
+{
+	if (from == to)
+		return true;
+
+	if (!hasEdges(from) || !hasEdges(to))
+		return false;
+
+	// A new search number unmarks every slot without clearing the marks
+	if (++searchNum == 0)
+	{
+		std::fill(visited.begin(), visited.end(), 0);
+		searchNum = 1;
+	}
+
+	pending.assign(1, from);
+
+	while (!pending.empty())
+	{
+		const uint32_t slot = pending.back();
+		pending.pop_back();
+
+		for (uint32_t dependent : getDependents(slot))
+		{
+			if (dependent == to)
+				return true;
+
+			if (dependent >= visited.size())
+				visited.resize(dependent + 1, 0);
+
+			if (visited[dependent] != searchNum)
+			{
+				visited[dependent] = searchNum;
+				pending.push_back(dependent);
+			}
+		}
+	}
+
+	return false;
+}
+
+// Name:   getBlockers(uint32_t slot)
+// Desc:   Retrieve the tasks a task waits for.
+// Param:  slot: The slot of the task.
+// Return: A constant reference to the slots of the blockers.
+const std::vector<uint32_t>& TaskGraph::getBlockers(uint32_t slot) const
+{
+	static const std::vector<uint32_t> none;
+	std::unordered_map<uint32_t, Links>::const_iterator found = links.find(slot);
+
+	return found == links.end() ? none : found->second.blockers;
+}
+
+// Name:   getDependents(uint32_t slot)
+// Desc:   Retrieve the tasks that wait for a task.
+// Param:  slot: The slot of the task.
+// Return: A constant reference to the slots of the dependents.
+const std::vector<uint32_t>& TaskGraph::getDependents(uint32_t slot) const
+{
+	static const std::vector<uint32_t> none;
+	std::unordered_map<uint32_t, Links>::const_iterator found = links.find(slot);
+
+	return found == links.end() ? none : found->second.dependents;
+}
+
+// Name:   getNumEdges()
+// Desc:   Retrieve the number of dependencies.
+// Param:  None
+// Return: The number of edges.
+size_t TaskGraph::getNumEdges() const
+{
+	return numEdges;
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the bytes used by the edges, the table entries and
+//         the marks of the cycle search.
+// Param:  None
+// Return: The number of bytes.
+size_t TaskGraph::getMemoryUsed() const
+{
+	size_t bytes = links.bucket_count() * sizeof(void*) + visited.capacity() * sizeof(uint32_t)
+		+ pending.capacity() * sizeof(uint32_t);
+
+	for (const std::pair<const uint32_t, Links>& entry : links)
+	{
+		bytes += sizeof(entry) + sizeof(void*);
+		bytes += (entry.second.blockers.capacity() + entry.second.dependents.capacity()) * sizeof(uint32_t);
+	}
+
+	return bytes;
+}
+
+// Name:   eraseSlot(vector<uint32_t>& slots, uint32_t slot)
+// Desc:   Remove a slot from an edge list. The order of the list does
+//         not matter, so the last slot takes its place.
+// Param:  slots: The edge list.
+//         slot: The slot to remove.
+// Return: A boolean: True if the slot was in the list.
+bool TaskGraph::eraseSlot(std::vector<uint32_t>& slots, uint32_t slot)
+{
+	std::vector<uint32_t>::iterator found = std::find(slots.begin(), slots.end(), slot);
+
+	if (found == slots.end())
+		return false;
+
+	*found = slots.back();
+	slots.pop_back();
+
+	return true;
+}
+
+// Name:   eraseIfUnlinked(uint32_t slot)
+// Desc:   Drop the entry of a task that has no edges left, so the table
+//         only holds the tasks that are part of the graph.
+// Param:  slot: The slot of the task.
+// Return: None
+void TaskGraph::eraseIfUnlinked(uint32_t slot)
+{
+	std::unordered_map<uint32_t, Links>::iterator found = links.find(slot);
+
+	if (found != links.end() && found->second.blockers.empty() && found->second.dependents.empty())
+		links.erase(found);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: The TaskGraph class keeps the dependencies between tasks,
+               keyed by node slot: a dependent task is blocked by each of
+			   its blockers until they are completed. Only tasks with an
+			   edge have an entry, with the slots on both sides of their
+			   edges and a count of the blockers that are still open, so
+			   a task is blocked while its count is above zero. Opening
+			   or closing a task only visits its dependents. An edge that
+			   would close a cycle is refused, found by a search from the
+			   dependent along the dependents that stops at the blocker.
+#****************************************************************************/
+
+class TaskGraph
+{
+public:
+	TaskGraph();
+
+	void clear();
+	bool addEdge(uint32_t blocker, uint32_t dependent, bool blockerOpen);
+	bool removeEdge(uint32_t blocker, uint32_t dependent, bool blockerOpen);
+	void removeTask(uint32_t slot, bool open, std::vector<uint32_t>& changed);
+	void setOpen(uint32_t slot, bool open, std::vector<uint32_t>& changed);
+
+	bool isBlocked(uint32_t slot) const;
+	bool hasEdge(uint32_t blocker, uint32_t dependent) const;
+	bool hasEdges(uint32_t slot) const;
+	bool reaches(uint32_t from, uint32_t to) const;
+	const std::vector<uint32_t>& getBlockers(uint32_t slot) const;
+	const std::vector<uint32_t>& getDependents(uint32_t slot) const;
+	size_t getNumEdges() const;
+	size_t getMemoryUsed() const;
+
+private:
+	struct Links
+	{
+		std::vector<uint32_t> blockers;
+		std::vector<uint32_t> dependents;
+		uint32_t numOpenBlockers;
+	};
+
+	static bool eraseSlot(std::vector<uint32_t>& slots, uint32_t slot);
+	void eraseIfUnlinked(uint32_t slot);
+
+	std::unordered_map<uint32_t, Links> links;
+	size_t numEdges;
+
+	// The marks of the slots a cycle search has visited, by search number
+	mutable std::vector<uint32_t> visited;
+	mutable std::vector<uint32_t> pending;
+	mutable uint32_t searchNum;
+};
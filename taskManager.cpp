@@ -1,15 +1,33 @@
 #include "taskManager.h"
+#include "taskArchive.h"
+#include "segmentStore.h"
+#include "taskTags.h"
+#include "nameArena.h"
 #include <fstream>
 #include <filesystem>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <climits>
 
 // Name:   TaskManager()
 // Desc:   Default constructor.
 // Param:  None
 // Return: None
 TaskManager::TaskManager()
+	: views(nodes), recurringTasks(NodeOrder{ VIEWS::INSERTION_ORDER }, nodes), actionableTasks(NodeOrder{ VIEWS::BY_DUE_DATE }, nodes)
 {
 	head = nullptr;
+	tail = nullptr;
 	numNodes = 0;
+	numCompleted = 0;
+	nextSequence = 0;
+	deferViews = false;
+	activeDedup = nullptr;
+	storeBinding.epoch = 0;
+	loadReport.numRecords = 0;
+	loadReport.numLost = 0;
+	ioBackend = AsyncFile::getBestBackend();
 }
 
 // Name:   TaskManager(TaskManager& origTaskManager)
@@ -17,9 +35,19 @@ TaskManager::TaskManager()
 // Param:  origTaskManager: A reference to a TaskManager object.
 // Return: None
 TaskManager::TaskManager(const TaskManager& origTaskManager)
+	: views(nodes), recurringTasks(NodeOrder{ VIEWS::INSERTION_ORDER }, nodes), actionableTasks(NodeOrder{ VIEWS::BY_DUE_DATE }, nodes)
 {
 	head = nullptr;
+	tail = nullptr;
 	numNodes = 0;
+	numCompleted = 0;
+	nextSequence = 0;
+	deferViews = false;
+	activeDedup = nullptr;
+	storeBinding.epoch = 0;
+	loadReport.numRecords = 0;
+	loadReport.numLost = 0;
+	ioBackend = AsyncFile::getBestBackend();
 
 	*this = origTaskManager;
 }
@@ -36,11 +64,29 @@ const TaskManager& TaskManager::operator=(const TaskManager& origTaskManager)
 
 		Node* currNode = origTaskManager.head;
 
+		// The copies are found by the slots of the originals to copy the dependencies
+		std::vector<const Node*> copies(origTaskManager.graph.getNumEdges() ? origTaskManager.nodes.getNumSlots() : 0);
+
 		while (currNode)
 		{
-			addTask(currNode->task.getName(), currNode->task.getDueDate(), currNode->task.getCompleted());
+			Node* newNode = addTask(currNode->task.getName(), currNode->task.getDueDate(), currNode->task.getCompleted());
+
+			if (currNode->task.getRecurrence())
+				setRecurrence(newNode, *currNode->task.getRecurrence());
+
+			setLabels(newNode, currNode->task.getPriority(), currNode->task.getTags());
+
+			if (!copies.empty())
+				copies[currNode->slot] = newNode;
+
 			currNode = currNode->next;
 		}
+
+		for (const Node* copy = copies.empty() ? nullptr : head, *origNode = origTaskManager.head; copy; copy = copy->next, origNode = origNode->next)
+		{
+			for (uint32_t blocker : origTaskManager.graph.getBlockers(origNode->slot))
+				addDependency(copies[blocker], copy);
+		}
 	}
 
 	return *this;
@@ -56,23 +102,39 @@ TaskManager::~TaskManager()
 }
 
 // Name:   emptyTasks()
-// Desc:   Empty the task linked list.
+// Desc:   Empty the task linked list. The list is no longer bound to the
+//         store it was loaded from.
 // Param:  None
 // Return: None
 void TaskManager::emptyTasks()
 {
+	storeBinding.storePath.clear();
+	storeBinding.dirtyMonths.clear();
+
 	if (!head)
 		return;
 
 	while (head)
 	{
 		Node* tempNode = head->next;
-		delete head;
+		nodes.destroy(head);
 		head = tempNode;
 	}
 
+	if (reminders)
+		reminders->clear();
+
+	graph.clear();
+	actionableTasks.clear();
 	head = nullptr;
+	tail = nullptr;
 	numNodes = 0;
+	numCompleted = 0;
+	views.clear();
+	dueColumns.clear();
+	labelPostings.clear();
+	recurringTasks.clear();
+	nodes.clear();
 }
 
 // Name:   addTask(const string& name, Date& dueDate)
@@ -83,37 +145,309 @@ void TaskManager::emptyTasks()
 // Return: A boolean: True if adding succeeds, false otherwise.
 bool TaskManager::addTask(const std::string& name, const Date& dueDate)
 {
-	addTask(name, dueDate, false);
+	notifyChange(addTask(name, dueDate, false), false);
+
+	return true;
+}
+
+// Name:   addTask(const string& name, Date& dueDate, const Recurrence& rule)
+// Desc:   Add a new recurring task to the linked list.
+// Param:  name: A string that holds the task name.
+//         dueDate: A Date object that holds the date of the first occurrence.
+//         rule: The recurrence rule for the task.
+// Return: A boolean: True if adding succeeds, false otherwise.
+bool TaskManager::addTask(const std::string& name, const Date& dueDate, const Recurrence& rule)
+{
+	Node* newNode = addTask(name, dueDate, false);
+
+	setRecurrence(newNode, rule);
+	notifyChange(newNode, false);
 
 	return true;
 }
 
-// Name:   addTask(const string& name, Date& dueDate, bool completed)
-// Desc:   Recursive function that finds the location where the new task
-//         should be inserted.
+// Name:   addTask(string_view name, Date& dueDate, bool completed)
+// Desc:   Append a new task to the end of the linked list and
+//         add it to the sorted views.
 // Param:  name: A string that holds the task name.
 //         dueDate: A Date object that holds the task's due date.
 //         completed: A boolean to determine if the task is completed.
-// Return: None
-void TaskManager::addTask(const std::string& name, const Date& dueDate, bool completed)
+// Return: A pointer to the new node.
+Node* TaskManager::addTask(std::string_view name, const Date& dueDate, bool completed)
 {
+	Node* newNode = nodes.create(name, dueDate, completed);
+	newNode->sequence = nextSequence;
+	nextSequence += sequenceGap;
+
 	if (!head)
 	{
-		head = new Node(name, dueDate, completed);
+		head = newNode;
 	}
 	else
 	{
-		Node* currNode = head;
+		tail->next = newNode;
+		newNode->prev = tail;
+	}
+
+	tail = newNode;
+	numNodes++;
+	numCompleted += completed;
+
+	dueColumns.insert(newNode->slot, newNode->task.getDueSerial(), completed);
+	markDirty(newNode);
+
+	// A file load rebuilds the views once at the end instead
+	if (!deferViews)
+		views.insert(newNode);
+
+	if (!deferViews && !completed)
+		actionableTasks.insert(newNode);
+
+	updateReminder(newNode);
+
+	return newNode;
+}
+
+// Name:   beginLoad(bool append)
+// Desc:   Stop updating the sorted views until endLoad() is called.
+// Param:  append: A boolean to keep the current tasks instead of emptying the list.
+// Return: None
+void TaskManager::beginLoad(bool append)
+{
+	if (!append)
+		emptyTasks();
+
+	loadedLines.clear();
+	loadedDependencies.clear();
+	deferViews = true;
+}
+
+// Name:   addLoadedTask(const string& name, Date& dueDate, bool completed)
+// Desc:   Add a task read from a file. While a dedup engine is active a
+//         duplicate task is skipped, replaces the earlier task or merges
+//         its completion into it, depending on the engine's policy.
+// Param:  name: A string that holds the task name.
+//         dueDate: A Date object that holds the task's due date.
+//         completed: A boolean to determine if the task is completed.
+// Return: A pointer to the new node, or nullptr if the task was not added.
+Node* TaskManager::addLoadedTask(const std::string& name, const Date& dueDate, bool completed)
+{
+	if (!activeDedup)
+		return addTask(name, dueDate, completed);
+
+	const Node* existing = activeDedup->find(name, dueDate);
+
+	if (existing)
+	{
+		activeDedup->recordDuplicate(name, dueDate);
 
-		while (currNode->next)
+		switch (activeDedup->getPolicy())
 		{
-			currNode = currNode->next;
+			case DEDUP_POLICIES::SKIP_DUPLICATES:
+				return nullptr;
+
+			case DEDUP_POLICIES::MERGE_COMPLETION:
+				if (completed)
+					completeTask(existing);
+				return nullptr;
+
+			case DEDUP_POLICIES::REPLACE_DUPLICATES:
+				activeDedup->erase(existing);
+				deleteTask(existing);
+				break;
+
+			default:
+				// Keep the first copy in the table so later copies match it
+				return addTask(name, dueDate, completed);
 		}
+	}
 
-		currNode->next = new Node(name, dueDate, completed);
+	Node* newNode = addTask(name, dueDate, completed);
+	activeDedup->insert(newNode);
+
+	return newNode;
+}
+
+// Name:   endLoad()
+// Desc:   Rebuild the sorted views after the tasks of a file were added
+//         and add the dependencies between them.
+// Param:  None
+// Return: None
+void TaskManager::endLoad()
+{
+	views.rebuild(head);
+	deferViews = false;
+	addLoadedDependencies();
+
+	// The due date view is already in order, so the actionable tasks are appended
+	actionableTasks.clear();
+	for (ViewIterator position = views.begin(VIEWS::BY_DUE_DATE, head); position != views.end(VIEWS::BY_DUE_DATE); ++position)
+	{
+		if (isActionable(*position))
+			actionableTasks.append(*position);
 	}
 
-	numNodes++;
+	if (reminders)
+		reminders->rebuild(head);
+}
+
+// Name:   setRecurrence(Node* node, const Recurrence& rule)
+// Desc:   Set the recurrence rule of a task and track it as recurring.
+// Param:  node: The node of the task.
+//         rule: The recurrence rule, a rule that never repeats removes it.
+// Return: None
+void TaskManager::setRecurrence(Node* node, const Recurrence& rule)
+{
+	markDirty(node);
+	node->task.setRecurrence(rule);
+
+	if (node->task.getRecurrence())
+		recurringTasks.insert(node);
+	else
+		recurringTasks.erase(node);
+
+	updateReminder(node);
+}
+
+// Name:   setLabels(Node* node, int priority, uint64_t tags)
+// Desc:   Set the priority and tags of a task and move it in the postings.
+// Param:  node: The node of the task.
+//         priority: The priority from 1 to Task::maxPriority, 0 for none.
+//         tags: The tag mask of the task.
+// Return: None
+void TaskManager::setLabels(Node* node, int priority, uint64_t tags)
+{
+	markDirty(node);
+	labelPostings.erase(node->slot, node->task.getPriority(), node->task.getTags());
+
+	if (!node->task.setPriority(priority))
+		node->task.setPriority(0);
+	node->task.setTags(tags);
+
+	labelPostings.insert(node->slot, node->task.getPriority(), node->task.getTags());
+}
+
+// Name:   markDirty(const Node* node)
+// Desc:   Remember that the due month of a task changed, so the next save
+//         to the store the list is bound to rewrites it.
+// Param:  node: The node of the task that changed.
+// Return: None
+void TaskManager::markDirty(const Node* node)
+{
+	if (!storeBinding.storePath.empty())
+		storeBinding.dirtyMonths.insert(SegmentStore::getMonthKey(node->task.getDueSerial()));
+}
+
+// Name:   updateReminder(const Node* node)
+// Desc:   Move the reminder timer of a task that was added or changed. A
+//         file load sets every timer once at the end instead.
+// Param:  node: The node of the task.
+// Return: None
+void TaskManager::updateReminder(const Node* node)
+{
+	if (reminders && !deferViews)
+		reminders->schedule(node);
+}
+
+// Name:   notifyChange(const Node* node, bool removed)
+// Desc:   Tell the change handler about a task an edit added, changed or
+//         is about to remove. The tasks of a file load are not reported.
+// Param:  node: The node of the task.
+//         removed: A boolean that is true if the task is being removed.
+// Return: None
+void TaskManager::notifyChange(const Node* node, bool removed)
+{
+	if (changeHandler && !deferViews)
+		changeHandler(node, removed);
+}
+
+// Name:   updateActionable(const vector<uint32_t>& changed)
+// Desc:   Move the tasks whose blockers were completed, opened again or
+//         removed in or out of the actionable view. A file load builds
+//         the view once at the end instead.
+// Param:  changed: The slots of the tasks that were blocked or unblocked.
+// Return: None
+void TaskManager::updateActionable(const std::vector<uint32_t>& changed)
+{
+	if (deferViews)
+		return;
+
+	for (uint32_t slot : changed)
+	{
+		const Node* node = nodes.get(slot);
+
+		if (node->task.getCompleted())
+			continue;
+
+		if (graph.isBlocked(slot))
+			actionableTasks.erase(node);
+		else
+			actionableTasks.insert(node);
+	}
+}
+
+// Name:   addLoadedDependencies()
+// Desc:   Add the dependencies of the file that was just loaded, now
+//         that every line has its task. A dependency on a line that was
+//         lost or skipped, or one that would make the tasks wait for each
+//         other, is left out.
+// Param:  None
+// Return: None
+void TaskManager::addLoadedDependencies()
+{
+	for (const std::pair<uint64_t, uint64_t>& dependency : loadedDependencies)
+	{
+		if (dependency.first > loadedLines.size() || loadedLines[dependency.first - 1].dueSerial == INT_MIN)
+			continue;
+
+		const LoadedLine& blockerLine = loadedLines[dependency.first - 1];
+		const LoadedLine& dependentLine = loadedLines[dependency.second - 1];
+		const Node* blocker = findTask(blockerLine.dueSerial, blockerLine.sequence);
+		const Node* dependent = dependentLine.dueSerial == INT_MIN ? nullptr : findTask(dependentLine.dueSerial, dependentLine.sequence);
+
+		if (blocker && dependent)
+			graph.addEdge(blocker->slot, dependent->slot, !blocker->task.getCompleted());
+	}
+
+	loadedLines = std::vector<LoadedLine>();
+	loadedDependencies = std::vector<std::pair<uint64_t, uint64_t>>();
+}
+
+// Name:   getLineNumbers()
+// Desc:   Number the tasks by the line they are saved on, so the
+//         dependencies can name the tasks they wait for.
+// Param:  None
+// Return: A vector with the line number of each slot, empty if there are
+//         no dependencies to save.
+std::vector<uint32_t> TaskManager::getLineNumbers() const
+{
+	std::vector<uint32_t> lineNumbers;
+	uint32_t lineNum = 0;
+
+	if (graph.getNumEdges() == 0)
+		return lineNumbers;
+
+	lineNumbers.resize(nodes.getNumSlots(), 0);
+
+	for (const Node* currNode = head; currNode; currNode = currNode->next)
+		lineNumbers[currNode->slot] = ++lineNum;
+
+	return lineNumbers;
+}
+
+// Name:   formatBlockers(const Node* node, const vector<uint32_t>& lineNumbers)
+// Desc:   Convert the tasks a task waits for to the fields of its line.
+// Param:  node: The node of the task.
+//         lineNumbers: The line number of each slot.
+// Return: A string with a ,^line field for each blocker, empty if none.
+std::string TaskManager::formatBlockers(const Node* node, const std::vector<uint32_t>& lineNumbers) const
+{
+	std::string fields;
+
+	for (uint32_t blocker : graph.getBlockers(node->slot))
+		fields += ",^" + std::to_string(lineNumbers[blocker]);
+
+	return fields;
 }
 
 // Name:   deleteTask(int taskNum)
@@ -122,38 +456,59 @@ void TaskManager::addTask(const std::string& name, const Date& dueDate, bool com
 // Return: A boolean: True if removing succeeds, false otherwise.
 bool TaskManager::deleteTask(int taskNum)
 {
-	if (taskNum >= 1 && taskNum <= numNodes)
-	{
-		Node* currTask = head;
-		Node* prevTask = nullptr;
-		int currNum = 1;
+	return deleteTask(getNodeByNum(taskNum));
+}
 
-		while (currTask->next && currNum != taskNum)
-		{
-			prevTask = currTask;
-			currTask = currTask->next;
-			currNum++;
-		}
+// Name:   deleteTask(const Node* node)
+// Desc:   Remove a task from the task list and the sorted views.
+// Param:  node: A pointer to the node of the task to remove.
+// Return: A boolean: True if removing succeeds, false otherwise.
+bool TaskManager::deleteTask(const Node* node)
+{
+	if (!node)
+		return false;
 
-		if (currTask == head)
-		{
-			head = currTask->next;
-			delete currTask;
-			currTask = nullptr;
-			numNodes--;
-		}
-		else
-		{
-			prevTask->next = currTask->next;
-			delete currTask;
-			currTask = nullptr;
-			numNodes--;
-		}
+	// The nodes are owned by this list, only the public view of them is constant
+	Node* currTask = const_cast<Node*>(node);
 
-		return true;
-	}
+	std::vector<uint32_t> unblocked;
 
-	return false;
+	// The handler is told first, while the task can still be read
+	notifyChange(currTask, true);
+
+	markDirty(currTask);
+	views.erase(currTask);
+	recurringTasks.erase(currTask);
+	actionableTasks.erase(currTask);
+
+	// The tasks that waited for it are saved without the dependency
+	for (uint32_t slot : graph.getDependents(currTask->slot))
+		markDirty(nodes.get(slot));
+
+	graph.removeTask(currTask->slot, !currTask->task.getCompleted(), unblocked);
+	updateActionable(unblocked);
+
+	if (currTask->prev)
+		currTask->prev->next = currTask->next;
+	else
+		head = currTask->next;
+
+	if (currTask->next)
+		currTask->next->prev = currTask->prev;
+	else
+		tail = currTask->prev;
+
+	numCompleted -= currTask->task.getCompleted();
+	dueColumns.erase(currTask->slot);
+	labelPostings.erase(currTask->slot, currTask->task.getPriority(), currTask->task.getTags());
+
+	if (reminders)
+		reminders->cancel(currTask);
+
+	nodes.destroy(currTask);
+	numNodes--;
+
+	return true;
 }
 
 // Name:   completeTask(int taskNum)
@@ -162,132 +517,1603 @@ bool TaskManager::deleteTask(int taskNum)
 // Return: None
 void TaskManager::completeTask(int taskNum)
 {
-	Task* task = getTaskNodeByNum(taskNum);
-
-	if (task)
-		task->setComplete();
+	completeTask(getNodeByNum(taskNum));
 }
 
-// Name:   getTaskNodeByNum(int taskNum)
-// Desc:   Retrieve the chosen task.
-// Param:  taskNum: An integer that represents the location of the task to retrieve.
-// Return: A pointer to the task the user wanted to retrieve.
-Task* TaskManager::getTaskNodeByNum(int taskNum)
+// Name:   completeTask(const Node* node)
+// Desc:   Mark a task as completed and move it in the sorted views.
+// Param:  node: A pointer to the node of the task to complete.
+// Return: None
+void TaskManager::completeTask(const Node* node)
 {
-	Task* task = nullptr;
-	
-	if (taskNum >= 1 && taskNum <= numNodes)
-	{
-		Node* currTask = head;
-		int currNum = 1;
+	if (!node || node->task.getCompleted())
+		return;
 
-		while (currTask->next && currNum != taskNum)
-		{
-			currTask = currTask->next;
-			currNum++;
-		}
+	Node* currTask = const_cast<Node*>(node);
+
+	std::vector<uint32_t> unblocked;
+
+	// The views have to be updated around the change of the sort key
+	markDirty(currTask);
+	views.erase(currTask);
+	currTask->task.setComplete();
+	views.insert(currTask);
+	numCompleted++;
+	dueColumns.setCompleted(currTask->slot);
+	updateReminder(currTask);
+
+	// Only the tasks that wait for this one can become actionable
+	actionableTasks.erase(currTask);
+	graph.setOpen(currTask->slot, false, unblocked);
+	updateActionable(unblocked);
+	notifyChange(currTask, false);
+}
+
+// Name:   completeOccurrence(const Node* node, int serial)
+// Desc:   Mark one occurrence of a recurring task as completed. A task
+//         that does not repeat is completed as a whole.
+// Param:  node: A pointer to the node of the task.
+//         serial: The serial date of the occurrence.
+// Return: None
+void TaskManager::completeOccurrence(const Node* node, int serial)
+{
+	if (!node)
+		return;
 
-		if (currTask)
-			task = &currTask->task;
+	if (!node->task.getRecurrence())
+	{
+		completeTask(node);
+		return;
 	}
 
-	return task;
+	// Occurrences are not part of any sort key, so the views stay as they are
+	markDirty(node);
+	const_cast<Node*>(node)->task.completeOccurrence(serial);
+	updateReminder(node);
+	notifyChange(node, false);
 }
 
-// Name:   getNumTasks()
-// Desc:   Retrieve the number of stored tasks.
-// Param:  None
-// Return: An integer representing the number of tasks in the linked list.
-int TaskManager::getNumTasks() const
+// Name:   uncompleteTask(const Node* node)
+// Desc:   Mark a completed task as not completed and move it in the
+//         sorted views.
+// Param:  node: A pointer to the node of the task.
+// Return: None
+void TaskManager::uncompleteTask(const Node* node)
 {
-	return numNodes;
+	if (!node || !node->task.getCompleted())
+		return;
+
+	Node* currTask = const_cast<Node*>(node);
+
+	std::vector<uint32_t> blocked;
+
+	markDirty(currTask);
+	views.erase(currTask);
+	currTask->task.setIncomplete();
+	views.insert(currTask);
+	numCompleted--;
+	dueColumns.clearCompleted(currTask->slot);
+	updateReminder(currTask);
+
+	if (!deferViews && isActionable(currTask))
+		actionableTasks.insert(currTask);
+
+	graph.setOpen(currTask->slot, true, blocked);
+	updateActionable(blocked);
+	notifyChange(currTask, false);
 }
 
-// Name:   getTasks()
-// Desc:   Retrieve the list of tasks.
-// Param:  None
-// Return: A constant pointer to the head of the linked list.
-const Node* TaskManager::getTasks() const
+// Name:   uncompleteOccurrence(const Node* node, int serial)
+// Desc:   Mark one occurrence of a recurring task as not completed. A task
+//         that does not repeat is marked as not completed as a whole.
+// Param:  node: A pointer to the node of the task.
+//         serial: The serial date of the occurrence.
+// Return: None
+void TaskManager::uncompleteOccurrence(const Node* node, int serial)
 {
-	return head;
+	if (!node)
+		return;
+
+	if (!node->task.getRecurrence())
+	{
+		uncompleteTask(node);
+		return;
+	}
+
+	markDirty(node);
+	const_cast<Node*>(node)->task.uncompleteOccurrence(serial);
+	updateReminder(node);
+	notifyChange(node, false);
 }
 
-// Name:   loadFromFile(const string& fileName)
-// Desc:   Load a list of tasks from a file.
-// Param:  fileName: A string that holds a file name.
-// Return: A boolean: True if loading was successful, false otherwise.
-bool TaskManager::loadFromFile(const std::string& fileName)
+// Name:   restoreTask(const TaskRecord& record, unsigned int sequence, const Node* prev)
+// Desc:   Put a removed task back where it was in the list with the
+//         insertion sequence it had, so it sorts the same as before.
+// Param:  record: The task to restore.
+//         sequence: The insertion sequence the task had.
+//         prev: The node to insert the task after, nullptr for the head.
+// Return: A constant pointer to the new node.
+const Node* TaskManager::restoreTask(const TaskRecord& record, unsigned int sequence, const Node* prev)
 {
-	std::ifstream file;
-	file.open(fileName);
+	Node* newNode = nodes.create(record.name, record.dueDate, record.completed);
+	Node* prevNode = const_cast<Node*>(prev);
+	newNode->sequence = sequence;
 
-	if (!file.is_open())
-		return false;
+	newNode->prev = prevNode;
+	newNode->next = prevNode ? prevNode->next : head;
 
-	emptyTasks();
+	if (newNode->next)
+		newNode->next->prev = newNode;
+	else
+		tail = newNode;
 
-	std::string name;
-	int month = 0;
-	int day = 0;
-	int year = 0;
-	bool completed = 0;
+	if (prevNode)
+		prevNode->next = newNode;
+	else
+		head = newNode;
 
-	while (!file.eof())
-	{
-		std::getline(file, name, ',');
-		file >> month;
-		file.ignore(1);
-		file >> day;
-		file.ignore(1);
-		file >> year;
-		file.ignore(1);
-		file >> completed;
-		file.ignore(1);
+	numNodes++;
+	numCompleted += record.completed;
 
-		addTask(name, Date(month, day, year), completed);
-	}
+	dueColumns.insert(newNode->slot, newNode->task.getDueSerial(), record.completed);
+	markDirty(newNode);
+	views.insert(newNode);
+	updateReminder(newNode);
 
-	file.close();
+	if (!record.completed)
+		actionableTasks.insert(newNode);
 
-	return true;
+	if (!record.recurrenceFields.empty())
+		setRecurrence(newNode, parseRecurrence(record.recurrenceFields));
+
+	setLabels(newNode, record.priority, record.tags);
+	notifyChange(newNode, false);
+
+	return newNode;
 }
 
-// Name:   saveToFile(const string& fileName)
-// Desc:   Save the linked list to a file.
-// Param:  fileName: A string that holds a file name.
-// Return: A boolean: True if saving is successful, false otherwise.
-bool TaskManager::saveToFile(const std::string& fileName) const
+// Name:   updateTask(const Node* node, const TaskRecord& record)
+// Desc:   Replace every field of a task with those of a parsed line. The
+//         task keeps its place in the list, its insertion sequence and
+//         the tasks it waits for or that wait for it.
+// Param:  node: A pointer to the node of the task.
+//         record: The parsed task.
+// Return: None
+void TaskManager::updateTask(const Node* node, const TaskRecord& record)
 {
-	std::ofstream file;
-	file.open(fileName);
+	if (!node)
+		return;
 
-	if (!file.is_open())
-		return false;
+	Node* currTask = const_cast<Node*>(node);
+	const bool wasCompleted = currTask->task.getCompleted();
 
-	Node* currNode = head;
+	std::vector<uint32_t> changed;
 
-	while (currNode)
-	{
-		file << currNode->task.getName() << "," << currNode->task.getDueDate().getMonth()
-			<< "," << currNode->task.getDueDate().getDay() << "," << currNode->task.getDueDate().getYear()
-			<< "," << currNode->task.getCompleted();
+	// Every sort key can change, so the task leaves each index first
+	markDirty(currTask);
+	views.erase(currTask);
+	recurringTasks.erase(currTask);
+	actionableTasks.erase(currTask);
+	labelPostings.erase(currTask->slot, currTask->task.getPriority(), currTask->task.getTags());
+	dueColumns.erase(currTask->slot);
 
-		if (currNode->next)
-			file << std::endl;
+	currTask->task = Task(record.name, record.dueDate, record.completed);
+	numCompleted += (int)record.completed - (int)wasCompleted;
 
-		currNode = currNode->next;
+	dueColumns.insert(currTask->slot, currTask->task.getDueSerial(), record.completed);
+	markDirty(currTask);
+	views.insert(currTask);
+	updateReminder(currTask);
+
+	if (!record.recurrenceFields.empty())
+		setRecurrence(currTask, parseRecurrence(record.recurrenceFields));
+
+	setLabels(currTask, record.priority, record.tags);
+
+	if (wasCompleted != record.completed)
+	{
+		graph.setOpen(currTask->slot, !record.completed, changed);
+		updateActionable(changed);
 	}
 
-	file.close();
+	if (!deferViews && isActionable(currTask))
+		actionableTasks.insert(currTask);
 
-	return true;
+	notifyChange(currTask, false);
 }
 
-// Name:   checkFileExists(const string& fileName)
-// Desc:   Check if a file exists.
-// Param:  fileName: A string that holds a file name.
-// Return: A boolean: True if file exists, false otherwise.
-bool TaskManager::checkFileExists(const std::string& fileName)
+// Name:   moveTask(const Node* node, const Node* prev)
+// Desc:   Move a task to just after another one in the list. The task
+//         takes a sequence between the ones of its new neighbours, so the
+//         insertion order view stays the same as the list. Only when
+//         there is no room between them is the task spaced out again
+//         with the fewest tasks around it that leave room.
+// Param:  node: A pointer to the node of the task to move.
+//         prev: The node to move the task after, nullptr for the head.
+// Return: None
+void TaskManager::moveTask(const Node* node, const Node* prev)
 {
-	return std::filesystem::exists(fileName);
+	if (!node || node == prev || node->prev == prev)
+		return;
+
+	Node* currTask = const_cast<Node*>(node);
+	Node* prevNode = const_cast<Node*>(prev);
+
+	if (currTask->prev)
+		currTask->prev->next = currTask->next;
+	else
+		head = currTask->next;
+
+	if (currTask->next)
+		currTask->next->prev = currTask->prev;
+	else
+		tail = currTask->prev;
+
+	currTask->prev = prevNode;
+	currTask->next = prevNode ? prevNode->next : head;
+
+	if (currTask->next)
+		currTask->next->prev = currTask;
+	else
+		tail = currTask;
+
+	if (prevNode)
+		prevNode->next = currTask;
+	else
+		head = currTask;
+
+	// The sequences are compared as if the head had one before 0
+	const int64_t low = prevNode ? (int64_t)prevNode->sequence : -1;
+
+	if (!currTask->next)
+	{
+		spreadTasks(currTask, nullptr, low, std::max((int64_t)nextSequence, low + 1) - low);
+		return;
+	}
+
+	const int64_t high = currTask->next->sequence;
+
+	if (high - low >= 2)
+	{
+		spreadTasks(currTask, currTask->next, low, (high - low) / 2);
+		return;
+	}
+
+	// Widen the run around it on both sides until its tasks can be half a gap apart again
+	Node* firstNode = currTask;
+	Node* endNode = currTask->next;
+	int64_t numSpread = 1;
+
+	while (endNode && (int64_t)endNode->sequence - (firstNode->prev ? (int64_t)firstNode->prev->sequence : -1)
+		< (numSpread + 1) * (int64_t)(sequenceGap / 2))
+	{
+		if (firstNode->prev)
+		{
+			firstNode = firstNode->prev;
+			numSpread++;
+		}
+
+		endNode = endNode->next;
+		numSpread++;
+	}
+
+	const int64_t start = firstNode->prev ? (int64_t)firstNode->prev->sequence : -1;
+
+	spreadTasks(firstNode, endNode, start, endNode ? ((int64_t)endNode->sequence - start) / (numSpread + 1) : sequenceGap);
+}
+
+// Name:   spreadTasks(Node* firstNode, const Node* endNode, int64_t start, int64_t spacing)
+// Desc:   Give a run of tasks new insertion sequences a set distance
+//         apart and move them in the views. The months of the tasks and
+//         of the tasks that wait for them are marked changed, since a
+//         store names a blocker by its sequence.
+// Param:  firstNode: The node of the first task of the run.
+//         endNode: The node after the run, nullptr for the rest of the list.
+//         start: The sequence before the first new one.
+//         spacing: The distance between the new sequences.
+// Return: None
+void TaskManager::spreadTasks(Node* firstNode, const Node* endNode, int64_t start, int64_t spacing)
+{
+	std::vector<bool> actionable;
+
+	// The sequence breaks ties in every view, so the whole run leaves them before two tasks can share one
+	for (Node* currNode = firstNode; currNode != endNode; currNode = currNode->next)
+	{
+		actionable.push_back(!deferViews && isActionable(currNode));
+		views.erase(currNode);
+		recurringTasks.erase(currNode);
+		actionableTasks.erase(currNode);
+	}
+
+	int64_t sequence = start;
+	size_t runIndex = 0;
+
+	for (Node* currNode = firstNode; currNode != endNode; currNode = currNode->next)
+	{
+		sequence += spacing;
+		currNode->sequence = sequence;
+		markDirty(currNode);
+
+		for (uint32_t slot : graph.getDependents(currNode->slot))
+			markDirty(nodes.get(slot));
+
+		views.insert(currNode);
+		if (currNode->task.getRecurrence())
+			recurringTasks.insert(currNode);
+		if (actionable[runIndex++])
+			actionableTasks.insert(currNode);
+	}
+
+	if (!endNode)
+		nextSequence = sequence + sequenceGap;
+}
+
+// Name:   findTask(int dueSerial, unsigned int sequence)
+// Desc:   Find a task by its due date and insertion sequence without
+//         walking the list.
+// Param:  dueSerial: The serial due date of the task.
+//         sequence: The insertion sequence of the task.
+// Return: A constant pointer to the node, or nullptr if there is none.
+const Node* TaskManager::findTask(int dueSerial, unsigned int sequence) const
+{
+	return views.find(dueSerial, sequence);
+}
+
+// Name:   getNodeByNum(int taskNum)
+// Desc:   Retrieve the chosen task node in insertion order.
+// Param:  taskNum: An integer that represents the location of the task to retrieve.
+// Return: A pointer to the node the user wanted to retrieve.
+Node* TaskManager::getNodeByNum(int taskNum)
+{
+	Node* currTask = nullptr;
+	
+	if (taskNum >= 1 && taskNum <= numNodes)
+	{
+		currTask = head;
+		int currNum = 1;
+
+		while (currTask->next && currNum != taskNum)
+		{
+			currTask = currTask->next;
+			currNum++;
+		}
+	}
+
+	return currTask;
+}
+
+// Name:   getNumTasks()
+// Desc:   Retrieve the number of stored tasks.
+// Param:  None
+// Return: An integer representing the number of tasks in the linked list.
+int TaskManager::getNumTasks() const
+{
+	return numNodes;
+}
+
+// Name:   getNumCompleted()
+// Desc:   Retrieve the number of completed tasks.
+// Param:  None
+// Return: An integer representing the number of completed tasks.
+int TaskManager::getNumCompleted() const
+{
+	return numCompleted;
+}
+
+// Name:   getTasks()
+// Desc:   Retrieve the list of tasks.
+// Param:  None
+// Return: A constant pointer to the head of the linked list.
+const Node* TaskManager::getTasks() const
+{
+	return head;
+}
+
+// Name:   getLastTask()
+// Desc:   Retrieve the task that was added last.
+// Param:  None
+// Return: A constant pointer to the tail of the linked list.
+const Node* TaskManager::getLastTask() const
+{
+	return tail;
+}
+
+// Name:   getTaskInView(VIEWS view, int taskNum)
+// Desc:   Retrieve the task at a position of a view.
+// Param:  view: The view the position is counted in.
+//         taskNum: An integer that represents the location of the task, starting at 1.
+// Return: A constant pointer to the node, or nullptr if the position does not exist.
+const Node* TaskManager::getTaskInView(VIEWS view, int taskNum) const
+{
+	if (taskNum < 1 || taskNum > numNodes)
+		return nullptr;
+
+	ViewIterator currTask = viewBegin(view);
+
+	for (int currNum = 1; currNum < taskNum; currNum++)
+		++currTask;
+
+	return *currTask;
+}
+
+// Name:   viewBegin(VIEWS view)
+// Desc:   Retrieve an iterator to the first task of a view.
+// Param:  view: The view to walk.
+// Return: An iterator at the first task of the view.
+ViewIterator TaskManager::viewBegin(VIEWS view) const
+{
+	return views.begin(view, head);
+}
+
+// Name:   viewEnd(VIEWS view)
+// Desc:   Retrieve an iterator past the last task of a view.
+// Param:  view: The view to walk.
+// Return: An iterator past the end of the view.
+ViewIterator TaskManager::viewEnd(VIEWS view) const
+{
+	return views.end(view);
+}
+
+// Name:   getDueRange(int& firstSerial, int& lastSerial)
+// Desc:   Retrieve the earliest and latest due dates in the list.
+// Param:  firstSerial: Receives the earliest serial date.
+//         lastSerial: Receives the latest serial date.
+// Return: A boolean: False if there are no tasks.
+bool TaskManager::getDueRange(int& firstSerial, int& lastSerial) const
+{
+	return views.getDueRange(firstSerial, lastSerial);
+}
+
+// Name:   countDue(const vector<DueRange>& ranges, bool incompleteOnly)
+// Desc:   Count the tasks due in each of several date ranges with a
+//         single scan of the packed due date column.
+// Param:  ranges: The inclusive ranges of serial dates, at most DueColumns::maxRanges.
+//         incompleteOnly: A boolean to only count incomplete tasks.
+// Return: A vector with the number of tasks in each range.
+std::vector<uint64_t> TaskManager::countDue(const std::vector<DueRange>& ranges, bool incompleteOnly) const
+{
+	std::vector<uint64_t> counts(ranges.size(), 0);
+
+	for (size_t first = 0; first < ranges.size(); first += DueColumns::maxRanges)
+	{
+		dueColumns.countRanges(&ranges[first], std::min(DueColumns::maxRanges, ranges.size() - first),
+			incompleteOnly, &counts[first]);
+	}
+
+	return counts;
+}
+
+// Name:   getTasksDueIn(const DueRange& range, bool incompleteOnly)
+// Desc:   Retrieve the tasks due in a date range from the match bitmap
+//         of a due date column scan.
+// Param:  range: The inclusive range of serial dates.
+//         incompleteOnly: A boolean to only retrieve incomplete tasks.
+// Return: A vector of the matching nodes in insertion order.
+std::vector<const Node*> TaskManager::getTasksDueIn(const DueRange& range, bool incompleteOnly) const
+{
+	std::vector<const Node*> tasks;
+	std::vector<uint64_t> bitmap;
+	uint64_t count = 0;
+
+	dueColumns.countRanges(&range, 1, incompleteOnly, &count, &bitmap);
+	tasks.reserve(count);
+
+	for (size_t word = 0; word < bitmap.size(); word++)
+	{
+		for (uint64_t matches = bitmap[word]; matches; matches &= matches - 1)
+			tasks.push_back(nodes.get(word * 64 + __builtin_ctzll(matches)));
+	}
+
+	// Slots of removed tasks are reused, so put the tasks back in list order
+	std::sort(tasks.begin(), tasks.end(), NodeOrder{ VIEWS::INSERTION_ORDER });
+
+	return tasks;
+}
+
+// Name:   findLabeled(int priority, uint64_t tags, int completedState)
+// Desc:   Retrieve the tasks with a priority and every one of a set of
+//         tags by intersecting the label postings, without testing the
+//         tasks one at a time.
+// Param:  priority: The priority the tasks need, 0 for any.
+//         tags: The tags the tasks need, 0 for any.
+//         completedState: 0 for only incomplete tasks, 1 for only
+//         completed tasks, -1 for both.
+// Return: A vector of the matching nodes in insertion order.
+std::vector<const Node*> TaskManager::findLabeled(int priority, uint64_t tags, int completedState) const
+{
+	std::vector<const Node*> tasks;
+	std::vector<uint64_t> bitmap;
+
+	dueColumns.getUsedWords(completedState, bitmap);
+	tasks.reserve(labelPostings.intersect(priority, tags, bitmap));
+
+	for (size_t word = 0; word < bitmap.size(); word++)
+	{
+		for (uint64_t matches = bitmap[word]; matches; matches &= matches - 1)
+			tasks.push_back(nodes.get(word * 64 + __builtin_ctzll(matches)));
+	}
+
+	std::sort(tasks.begin(), tasks.end(), NodeOrder{ VIEWS::INSERTION_ORDER });
+
+	return tasks;
+}
+
+// Name:   findDue(VIEWS view, int dueSerial)
+// Desc:   Find the first task due on or after a date in the due date or
+//         incomplete first view.
+// Param:  view: The view to search.
+//         dueSerial: The serial date to search for.
+// Return: An iterator into the view.
+ViewIterator TaskManager::findDue(VIEWS view, int dueSerial) const
+{
+	return views.findDue(view, dueSerial);
+}
+
+// Name:   getNextDue(int count)
+// Desc:   Retrieve the incomplete tasks that are due the soonest.
+// Param:  count: The maximum number of tasks to retrieve.
+// Return: A vector of the next due tasks, soonest first.
+std::vector<const Node*> TaskManager::getNextDue(int count) const
+{
+	return views.getNextDue(count);
+}
+
+// Name:   getOccurrences(int fromSerial, int toSerial)
+// Desc:   Expand the tasks that fall inside a range of dates. Tasks that do
+//         not repeat are found through the due date view and recurring
+//         tasks only generate the occurrences inside the range.
+// Param:  fromSerial: The first serial date of the range.
+//         toSerial: The last serial date of the range.
+// Return: A vector of the occurrences in the range ordered by date.
+std::vector<Occurrence> TaskManager::getOccurrences(int fromSerial, int toSerial) const
+{
+	std::vector<Occurrence> occurrences;
+
+	for (ViewIterator currNode = views.findDue(VIEWS::BY_DUE_DATE, fromSerial); currNode != views.end(VIEWS::BY_DUE_DATE); ++currNode)
+	{
+		const Task& task = (*currNode)->task;
+
+		if (task.getDueSerial() > toSerial)
+			break;
+
+		if (!task.getRecurrence())
+			occurrences.push_back({ *currNode, task.getDueSerial(), task.getCompleted() });
+	}
+
+	for (const Node* node : recurringTasks)
+	{
+		for (OccurrenceIterator occurrence(node->task, fromSerial, toSerial); occurrence.isValid(); occurrence.next())
+			occurrences.push_back({ node, occurrence.getSerial(), occurrence.isCompleted() });
+	}
+
+	std::stable_sort(occurrences.begin(), occurrences.end(), [](const Occurrence& left, const Occurrence& right) {
+		if (left.serial != right.serial)
+			return left.serial < right.serial;
+		return left.node->sequence < right.node->sequence;
+	});
+
+	return occurrences;
+}
+
+// Name:   memoryUsage()
+// Desc:   Break down the memory the task list uses. Records are the nodes
+//         in the pool, names are the long names kept in the name arena,
+//         rules are the recurrence rules and indexes are the sorted views,
+//         due columns and label postings. The overhead is the free room in
+//         the node pool and the name arena, which is shared by every list,
+//         and an estimate of the heap header of every other block.
+// Param:  None
+// Return: The breakdown of the memory used in bytes.
+MemoryUsage TaskManager::memoryUsage() const
+{
+	const size_t heapHeader = 2 * sizeof(size_t);
+	MemoryUsage usage = {};
+	size_t numBlocks = 0;
+
+	usage.numTasks = numNodes;
+	usage.recordBytes = nodes.getNumNodes() * sizeof(Node);
+
+	for (const Node* currNode = head; currNode; currNode = currNode->next)
+	{
+		const size_t nameLength = currNode->task.getName().size();
+
+		if (nameLength > TaskName::inlineCapacity)
+			usage.nameBytes += NameArena::getBlockSize(nameLength);
+	}
+
+	for (const Node* node : recurringTasks)
+	{
+		const std::vector<int>& completedSerials = node->task.getRecurrence()->getCompletedSerials();
+
+		usage.ruleBytes += sizeof(Recurrence) + completedSerials.capacity() * sizeof(int);
+		numBlocks += completedSerials.capacity() ? 2 : 1;
+	}
+
+	usage.indexBytes = views.getMemoryUsed() + recurringTasks.getMemoryUsed() + dueColumns.getMemoryUsed()
+		+ labelPostings.getMemoryUsed() + (reminders ? reminders->getMemoryUsed() : 0) + graph.getMemoryUsed() + actionableTasks.getMemoryUsed();
+	numBlocks += (views.getMemoryUsed() + recurringTasks.getMemoryUsed() + actionableTasks.getMemoryUsed()) / (SortedView::maxChunkSize * sizeof(uint32_t));
+
+	usage.overheadBytes = nodes.getBytesFree() + NameArena::getBytesReserved() - NameArena::getBytesUsed()
+		+ numBlocks * heapHeader;
+	usage.totalBytes = usage.recordBytes + usage.nameBytes + usage.ruleBytes + usage.indexBytes + usage.overheadBytes;
+
+	return usage;
+}
+
+// Name:   loadFromFile(const string& fileName)
+// Desc:   Load a list of tasks from a file.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if loading was successful, false otherwise.
+bool TaskManager::loadFromFile(const std::string& fileName)
+{
+	return readFile(fileName, false);
+}
+
+// Name:   loadFromFile(const string& fileName, DedupEngine& dedup)
+// Desc:   Load a list of tasks from a file and handle the duplicate tasks
+//         in it with the policy of the dedup engine.
+// Param:  fileName: A string that holds a file name.
+//         dedup: The dedup engine that finds and reports the duplicates.
+// Return: A boolean: True if loading was successful, false otherwise.
+bool TaskManager::loadFromFile(const std::string& fileName, DedupEngine& dedup)
+{
+	dedup.clear();
+	activeDedup = &dedup;
+	bool loaded = readFile(fileName, false);
+	activeDedup = nullptr;
+
+	return loaded;
+}
+
+// Name:   importFromFile(const string& fileName, DedupEngine& dedup)
+// Desc:   Add the tasks of a file to the current list. Tasks that duplicate
+//         one already in the list or earlier in the file are handled with
+//         the policy of the dedup engine.
+// Param:  fileName: A string that holds a file name.
+//         dedup: The dedup engine that finds and reports the duplicates.
+// Return: A boolean: True if importing was successful, false otherwise.
+bool TaskManager::importFromFile(const std::string& fileName, DedupEngine& dedup)
+{
+	dedup.clear();
+	dedup.indexTasks(*this);
+	activeDedup = &dedup;
+	bool imported = readFile(fileName, true);
+	activeDedup = nullptr;
+
+	return imported;
+}
+
+// Name:   loadDueRange(const string& fileName, int firstSerial, int lastSerial)
+// Desc:   Load the tasks of a file that are due in a range. A segmented
+//         store only opens the segments of the range, any other file is
+//         loaded whole.
+// Param:  fileName: A string that holds a file name.
+//         firstSerial: The first due date to load, INT_MIN for no limit.
+//         lastSerial: The last due date to load, INT_MAX for no limit.
+// Return: A boolean: True if loading was successful, false otherwise.
+bool TaskManager::loadDueRange(const std::string& fileName, int firstSerial, int lastSerial)
+{
+	loadReport = LoadReport();
+
+	if (SegmentStore::isStoreName(fileName))
+		return SegmentStore::load(*this, fileName, false, firstSerial, lastSerial);
+
+	return readFile(fileName, false);
+}
+
+// Name:   readFile(const string& fileName, bool append)
+// Desc:   Read the tasks of a file. Segmented stores are recognized by
+//         their extension and compressed files by their header, anything
+//         else is read as text. The records that could not be read are
+//         skipped and listed in the load report.
+// Param:  fileName: A string that holds a file name.
+//         append: A boolean to keep the current tasks instead of replacing them.
+// Return: A boolean: True if reading was successful, false otherwise.
+bool TaskManager::readFile(const std::string& fileName, bool append)
+{
+	loadReport = LoadReport();
+
+	if (SegmentStore::isStoreName(fileName))
+		return SegmentStore::load(*this, fileName, append);
+
+	if (TaskArchive::isArchiveFile(fileName))
+	{
+		TaskArchive archive;
+
+		if (!archive.open(fileName))
+			return false;
+
+		beginLoad(append);
+		archive.addTasks(*this);
+		endLoad();
+
+		return true;
+	}
+
+	if (ioBackend != IO_BACKENDS::STREAMS)
+	{
+		AsyncFile file(ioBackend);
+
+		if (!file.openRead(fileName))
+			return false;
+
+		beginLoad(append);
+		const bool read = readTextBlocks(file);
+		endLoad();
+
+		return file.close() && read;
+	}
+
+	std::ifstream file;
+	file.open(fileName);
+
+	if (!file.is_open())
+		return false;
+
+	beginLoad(append);
+	readTextTasks(file);
+	endLoad();
+
+	// A read error ends the lines early, unlike the end of the file
+	return !file.bad();
+}
+
+// Name:   readTextTasks(istream& file)
+// Desc:   Add the tasks of a text file one line at a time. Empty lines are
+//         skipped and lines that are not complete tasks are reported.
+// Param:  file: The stream to read the lines from.
+// Return: None
+void TaskManager::readTextTasks(std::istream& file)
+{
+	std::string line;
+	TaskRecord record;
+	uint64_t lineNum = 0;
+
+	while (readTextLine(file, line, record, lineNum, loadReport))
+		addTextTask(record, lineNum);
+}
+
+// Name:   readTextBlocks(AsyncFile& file)
+// Desc:   Add the tasks of a text file one block at a time. The lines of
+//         a block are parsed while the reads of the next blocks are in
+//         flight, and a line cut off at the end of a block is carried
+//         into the next one.
+// Param:  file: The file to read the blocks from, open for reading.
+// Return: A boolean: False if a read failed.
+bool TaskManager::readTextBlocks(AsyncFile& file)
+{
+	std::string line;
+	TaskRecord record;
+	uint64_t lineNum = 0;
+	const char* data = nullptr;
+	size_t length = 0;
+	bool read = true;
+
+	while ((read = file.read(data, length)) && length > 0)
+	{
+		const char* const end = data + length;
+
+		for (const char* start = data; start < end; )
+		{
+			const char* newline = (const char*)memchr(start, '\n', end - start);
+
+			if (!newline)
+			{
+				line.append(start, end);
+				break;
+			}
+
+			line.append(start, newline);
+			if (checkTextLine(line, false, record, ++lineNum, loadReport))
+				addTextTask(record, lineNum);
+
+			line.clear();
+			start = newline + 1;
+		}
+	}
+
+	// A last line without a newline is only complete if the file was read to the end
+	if (read && !line.empty() && checkTextLine(line, true, record, ++lineNum, loadReport))
+		addTextTask(record, lineNum);
+
+	return read;
+}
+
+// Name:   addTextTask(const TaskRecord& record, uint64_t lineNum)
+// Desc:   Add a task parsed from a text file during a load and remember
+//         its line for the dependencies of the file.
+// Param:  record: The parsed task.
+//         lineNum: The line of the file the task is on.
+// Return: None
+void TaskManager::addTextTask(const TaskRecord& record, uint64_t lineNum)
+{
+	Node* newNode = addLoadedTask(record.name, record.dueDate, record.completed);
+
+	if (newNode && !record.recurrenceFields.empty())
+		setRecurrence(newNode, parseRecurrence(record.recurrenceFields));
+
+	if (newNode && (record.priority || record.tags))
+		setLabels(newNode, record.priority, record.tags);
+
+	addLoadedLine(newNode, lineNum, record.blockerLines);
+}
+
+// Name:   addLoadedLine(const Node* node, uint64_t lineNum, const vector<uint64_t>& blockerLines)
+// Desc:   Remember the task of a line or record of a file being loaded
+//         and the lines it waits for. A line can wait for a later line,
+//         so endLoad() adds the dependencies once every task is read.
+// Param:  node: The node of the task, nullptr if the line was not added.
+//         lineNum: The line of the file the task is on, from 1.
+//         blockerLines: The lines of the tasks it waits for.
+// Return: None
+void TaskManager::addLoadedLine(const Node* node, uint64_t lineNum, const std::vector<uint64_t>& blockerLines)
+{
+	if (lineNum > loadedLines.size())
+		loadedLines.resize(lineNum, LoadedLine{ INT_MIN, 0 });
+
+	if (!node)
+		return;
+
+	loadedLines[lineNum - 1] = { node->task.getDueSerial(), node->sequence };
+
+	for (uint64_t blockerLine : blockerLines)
+		loadedDependencies.emplace_back(blockerLine, lineNum);
+}
+
+// Name:   readTextLine(istream& file, string& line, TaskRecord& record, uint64_t& lineNum, LoadReport& report)
+// Desc:   Read up to the next line of a text file that holds a task.
+//         Empty lines are skipped. Other lines that are not complete tasks
+//         are reported as lost, a last line without a newline as a torn
+//         tail since a save that was cut off leaves one behind.
+// Param:  file: The stream to read the lines from.
+//         line: Receives the line.
+//         record: Receives the parsed task.
+//         lineNum: The number of the last line read, moved forward.
+//         report: Receives the lines that are lost.
+// Return: A boolean: True if a task was read, false at the end of the file.
+bool TaskManager::readTextLine(std::istream& file, std::string& line, TaskRecord& record, uint64_t& lineNum, LoadReport& report)
+{
+	while (std::getline(file, line))
+	{
+		if (checkTextLine(line, file.eof(), record, ++lineNum, report))
+			return true;
+	}
+
+	return false;
+}
+
+// Name:   checkTextLine(const string& line, bool lastLine, TaskRecord& record, uint64_t lineNum, LoadReport& report)
+// Desc:   Parse a line of a text file and count it. An empty line is
+//         skipped and a line that is not a complete task is reported as
+//         lost, as a torn tail if it is the last line and has no newline.
+// Param:  line: The line without its newline.
+//         lastLine: A boolean that is true if the file ended without a newline.
+//         record: Receives the parsed task.
+//         lineNum: The number of the line.
+//         report: Receives the line if it is lost.
+// Return: A boolean: True if the line holds a task.
+bool TaskManager::checkTextLine(const std::string& line, bool lastLine, TaskRecord& record, uint64_t lineNum, LoadReport& report)
+{
+	if (line.empty())
+		return false;
+
+	std::string problem;
+
+	report.numRecords++;
+
+	if (parseTaskLine(line, record, std::string::npos, &problem))
+		return true;
+
+	addLostRecords(report, lineNum, 1, lastLine ? "torn tail" : problem);
+
+	return false;
+}
+
+// Name:   addTask(const TaskRecord& record)
+// Desc:   Add a task that was parsed from a line of a text file.
+// Param:  record: The parsed task.
+// Return: A constant pointer to the new node.
+const Node* TaskManager::addTask(const TaskRecord& record)
+{
+	Node* newNode = addTask(record.name, record.dueDate, record.completed);
+
+	if (!record.recurrenceFields.empty())
+		setRecurrence(newNode, parseRecurrence(record.recurrenceFields));
+
+	setLabels(newNode, record.priority, record.tags);
+	notifyChange(newNode, false);
+
+	return newNode;
+}
+
+// Name:   parseTaskLine(const string& line, TaskRecord& record, size_t nameEnd, string* problem)
+// Desc:   Parse one line of a text task file: the name, month, day, year
+//         and completed fields, followed by the recurrence fields if the
+//         task repeats and the labels: !1 to !3 for the priority and
+//         #name for each tag. Each ^line names a task of the same file
+//         this one waits for by its line number. A date, a recurrence
+//         rule or a tag that cannot be kept fails the line, since a save
+//         would change it.
+// Param:  line: A string that holds the line without its newline.
+//         record: Receives the parsed task.
+//         nameEnd: The length of the name if it is known, so a name can
+//         hold commas. By default the name ends at the first comma.
+//         problem: Receives why the line is not a task, if not nullptr.
+// Return: A boolean: True if the line holds a complete task.
+bool TaskManager::parseTaskLine(const std::string& line, TaskRecord& record, size_t nameEnd, std::string* problem)
+{
+	if (problem)
+		*problem = "not a complete task";
+
+	if (nameEnd == std::string::npos)
+		nameEnd = line.find(',');
+
+	if (nameEnd >= line.size() || line[nameEnd] != ',')
+		return false;
+
+	const char* position = line.c_str() + nameEnd + 1;
+	long fields[4] = { 0, 0, 0, 0 };
+
+	for (int i = 0; i < 4; i++)
+	{
+		char* fieldEnd = nullptr;
+		fields[i] = strtol(position, &fieldEnd, 10);
+
+		// Every field has to be a number followed by a comma, the last one may end the line
+		if (fieldEnd == position || (*fieldEnd != ',' && (i < 3 || *fieldEnd != '\0')))
+			return false;
+
+		position = *fieldEnd == ',' ? fieldEnd + 1 : fieldEnd;
+	}
+
+	if (fields[3] != 0 && fields[3] != 1)
+		return false;
+
+	// A task only keeps the serial of its date, so a date without one would be saved as another date
+	if (!Date::isValidDate(fields[0], fields[1], fields[2]))
+	{
+		if (problem)
+			*problem = "not a valid due date";
+		return false;
+	}
+
+	record.name.assign(line, 0, nameEnd);
+	record.dueDate = Date(fields[0], fields[1], fields[2]);
+	record.completed = fields[3] == 1;
+	record.priority = 0;
+	record.tags = 0;
+	record.blockerLines.clear();
+
+	// No recurrence field starts with !, # or ^, so the labels and dependencies are taken off the end
+	const char* fieldsEnd = line.c_str() + line.size();
+
+	while (fieldsEnd > position)
+	{
+		const char* label = fieldsEnd;
+		while (label > position && label[-1] != ',')
+			label--;
+
+		if (*label == '!' && label + 2 == fieldsEnd && label[1] >= '1' && label[1] <= '0' + Task::maxPriority)
+			record.priority = label[1] - '0';
+		else if (*label == '#')
+		{
+			const std::string tagName(label + 1, fieldsEnd);
+			const int tagId = TaskTags::intern(tagName);
+
+			if (tagId < 0)
+			{
+				if (problem)
+					*problem = TaskTags::isValidName(tagName) ? "tag #" + tagName + " does not fit in the table of "
+						+ std::to_string(TaskTags::maxTags) + " tags" : "#" + tagName + " is not a tag name";
+				return false;
+			}
+
+			record.tags |= (uint64_t)1 << tagId;
+		}
+		else if (*label == '^' && label + 1 < fieldsEnd && isdigit((unsigned char)label[1]))
+		{
+			char* lineEnd = nullptr;
+			const uint64_t blockerLine = strtoull(label + 1, &lineEnd, 10);
+
+			if (lineEnd != fieldsEnd || blockerLine == 0)
+				break;
+
+			record.blockerLines.push_back(blockerLine);
+		}
+		else
+			break;
+
+		fieldsEnd = label > position ? label - 1 : label;
+	}
+
+	record.recurrenceFields.assign(position, fieldsEnd);
+
+	if (!record.recurrenceFields.empty() && !isValidRecurrence(record.recurrenceFields))
+	{
+		if (problem)
+			*problem = "not a valid recurrence rule";
+		return false;
+	}
+
+	return true;
+}
+
+// Name:   formatTaskLine(const Task& task)
+// Desc:   Convert a task into a line of a text task file.
+// Param:  task: The task to convert.
+// Return: A string that holds the line without a newline.
+std::string TaskManager::formatTaskLine(const Task& task)
+{
+	const Date dueDate = task.getDueDate();
+	std::string line = std::string(task.getName()) + "," + std::to_string(dueDate.getMonth())
+		+ "," + std::to_string(dueDate.getDay()) + "," + std::to_string(dueDate.getYear())
+		+ "," + (task.getCompleted() ? "1" : "0");
+
+	if (task.getRecurrence())
+		line += "," + formatRecurrence(*task.getRecurrence());
+
+	if (task.getPriority())
+		line += ",!" + std::to_string(task.getPriority());
+
+	if (task.getTags())
+		line += "," + TaskTags::formatTags(task.getTags(), ",", "#");
+
+	return line;
+}
+
+// Name:   saveToFile(const string& fileName)
+// Desc:   Save the linked list to a file. File names with the compressed
+//         extension are saved in the compressed format, names with the
+//         store extension as a segmented store and other names as text.
+//         Only text files keep the dependencies between tasks.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if saving is successful, false otherwise.
+bool TaskManager::saveToFile(const std::string& fileName) const
+{
+	if (SegmentStore::isStoreName(fileName))
+		return SegmentStore::save(*this, fileName);
+
+	if (TaskArchive::isArchiveName(fileName))
+		return TaskArchive::save(*this, fileName);
+
+	if (ioBackend != IO_BACKENDS::STREAMS)
+	{
+		AsyncFile file(ioBackend);
+
+		if (!file.openWrite(fileName))
+			return false;
+
+		const bool written = writeTextBlocks(file);
+
+		return file.close() && written;
+	}
+
+	std::ofstream file;
+	file.open(fileName);
+
+	if (!file.is_open())
+		return false;
+
+	const std::vector<uint32_t> lineNumbers = getLineNumbers();
+	Node* currNode = head;
+
+	while (currNode)
+	{
+		file << formatTaskLine(currNode->task);
+
+		if (!lineNumbers.empty())
+			file << formatBlockers(currNode, lineNumbers);
+
+		if (currNode->next)
+			file << "\n";
+
+		currNode = currNode->next;
+	}
+
+	file.close();
+
+	return true;
+}
+
+// Name:   writeTextBlocks(AsyncFile& file)
+// Desc:   Format the tasks as text lines in batches and hand each batch
+//         to the file, which writes whole blocks while the next batch is
+//         formatted.
+// Param:  file: The file to write the lines to, open for writing.
+// Return: A boolean: False if a write failed.
+bool TaskManager::writeTextBlocks(AsyncFile& file) const
+{
+	const size_t batchSize = 64 * 1024;
+	const std::vector<uint32_t> lineNumbers = getLineNumbers();
+	std::string batch;
+
+	batch.reserve(batchSize + 256);
+
+	for (const Node* currNode = head; currNode; currNode = currNode->next)
+	{
+		batch += formatTaskLine(currNode->task);
+
+		if (!lineNumbers.empty())
+			batch += formatBlockers(currNode, lineNumbers);
+
+		if (currNode->next)
+			batch += '\n';
+
+		if (batch.size() >= batchSize)
+		{
+			if (!file.write(batch.data(), batch.size()))
+				return false;
+
+			batch.clear();
+		}
+	}
+
+	return file.write(batch.data(), batch.size());
+}
+
+// Name:   setIoBackend(IO_BACKENDS backend)
+// Desc:   Choose how text files are read and written. An asynchronous
+//         backend the kernel does not support falls back to the best one.
+// Param:  backend: The backend, STREAMS for blocking streams.
+// Return: None
+void TaskManager::setIoBackend(IO_BACKENDS backend)
+{
+	ioBackend = backend;
+}
+
+// Name:   getIoBackend()
+// Desc:   Retrieve how text files are read and written.
+// Param:  None
+// Return: The backend.
+IO_BACKENDS TaskManager::getIoBackend() const
+{
+	return ioBackend;
+}
+
+// Name:   startReminders(const ReminderFunction& notify, const ClockFunction& clock)
+// Desc:   Start keeping a reminder timer for every incomplete task. Only
+//         reminders after the current time of the clock fire.
+// Param:  notify: The function called with each reminder that fires.
+//         clock: The function that tells the time, local time by default.
+// Return: None
+void TaskManager::startReminders(const Reminders::ReminderFunction& notify, const Reminders::ClockFunction& clock)
+{
+	reminders = std::make_unique<Reminders>(nodes, notify, clock);
+	reminders->rebuild(head);
+}
+
+// Name:   stopReminders()
+// Desc:   Stop keeping reminder timers.
+// Param:  None
+// Return: None
+void TaskManager::stopReminders()
+{
+	reminders.reset();
+}
+
+// Name:   checkReminders()
+// Desc:   Fire the reminders that came up on the clock since the last
+//         check, oldest first. The notify function may change the list.
+// Param:  None
+// Return: The number of reminders that fired.
+size_t TaskManager::checkReminders()
+{
+	return reminders ? reminders->check() : 0;
+}
+
+// Name:   getNextReminderTime()
+// Desc:   Retrieve when the next check could fire a reminder.
+// Param:  None
+// Return: The seconds of local time since 1/1/1970, INT64_MAX if none.
+int64_t TaskManager::getNextReminderTime() const
+{
+	return reminders ? reminders->getNextTime() : INT64_MAX;
+}
+
+// Name:   addDependency(const Node* blocker, const Node* dependent)
+// Desc:   Make a task wait for another one until it is completed.
+// Param:  blocker: The node of the task that has to be done first.
+//         dependent: The node of the task that waits for it.
+// Return: A boolean: False if either task is missing, the dependency is
+//         already there or it would make the tasks wait for each other.
+bool TaskManager::addDependency(const Node* blocker, const Node* dependent)
+{
+	if (!blocker || !dependent || !graph.addEdge(blocker->slot, dependent->slot, !blocker->task.getCompleted()))
+		return false;
+
+	// The dependency is saved with the dependent
+	markDirty(dependent);
+
+	if (graph.isBlocked(dependent->slot))
+		actionableTasks.erase(dependent);
+
+	return true;
+}
+
+// Name:   removeDependency(const Node* blocker, const Node* dependent)
+// Desc:   Stop a task from waiting for another one.
+// Param:  blocker: The node of the task that had to be done first.
+//         dependent: The node of the task that waits for it.
+// Return: A boolean: True if there was such a dependency.
+bool TaskManager::removeDependency(const Node* blocker, const Node* dependent)
+{
+	if (!blocker || !dependent || !graph.removeEdge(blocker->slot, dependent->slot, !blocker->task.getCompleted()))
+		return false;
+
+	markDirty(dependent);
+
+	if (isActionable(dependent) && actionableTasks.find(dependent) == actionableTasks.end())
+		actionableTasks.insert(dependent);
+
+	return true;
+}
+
+// Name:   isBlocked(const Node* node)
+// Desc:   Check if a task waits for a task that is not completed.
+// Param:  node: The node of the task.
+// Return: A boolean: True if the task is blocked.
+bool TaskManager::isBlocked(const Node* node) const
+{
+	return graph.isBlocked(node->slot);
+}
+
+// Name:   isActionable(const Node* node)
+// Desc:   Check if a task can be worked on: it is not completed and it
+//         does not wait for a task that is not completed.
+// Param:  node: The node of the task.
+// Return: A boolean: True if the task is actionable.
+bool TaskManager::isActionable(const Node* node) const
+{
+	return !node->task.getCompleted() && !graph.isBlocked(node->slot);
+}
+
+// Name:   getBlockers(const Node* node)
+// Desc:   Retrieve the tasks a task waits for.
+// Param:  node: The node of the task.
+// Return: A vector with the nodes of the blockers.
+std::vector<const Node*> TaskManager::getBlockers(const Node* node) const
+{
+	std::vector<const Node*> blockers;
+
+	for (uint32_t slot : graph.getBlockers(node->slot))
+		blockers.push_back(nodes.get(slot));
+
+	return blockers;
+}
+
+// Name:   getDependents(const Node* node)
+// Desc:   Retrieve the tasks that wait for a task.
+// Param:  node: The node of the task.
+// Return: A vector with the nodes of the dependents.
+std::vector<const Node*> TaskManager::getDependents(const Node* node) const
+{
+	std::vector<const Node*> dependents;
+
+	for (uint32_t slot : graph.getDependents(node->slot))
+		dependents.push_back(nodes.get(slot));
+
+	return dependents;
+}
+
+// Name:   getActionable(int count)
+// Desc:   Retrieve the first actionable tasks in due date order. They are
+//         read from their own view, so the time taken is proportional to
+//         the number returned.
+// Param:  count: The most tasks to return.
+// Return: A vector with the nodes of the actionable tasks.
+std::vector<const Node*> TaskManager::getActionable(int count) const
+{
+	std::vector<const Node*> actionable;
+
+	for (SortedView::const_iterator position = actionableTasks.begin(); position != actionableTasks.end() && (int)actionable.size() < count; ++position)
+		actionable.push_back(*position);
+
+	return actionable;
+}
+
+// Name:   getNumActionable()
+// Desc:   Retrieve the number of actionable tasks.
+// Param:  None
+// Return: The number of tasks that are not completed and not blocked.
+int TaskManager::getNumActionable() const
+{
+	return actionableTasks.size();
+}
+
+// Name:   getNumDependencies()
+// Desc:   Retrieve the number of dependencies between the tasks.
+// Param:  None
+// Return: The number of dependencies.
+int TaskManager::getNumDependencies() const
+{
+	return graph.getNumEdges();
+}
+
+// Name:   setChangeHandler(const ChangeFunction& handler)
+// Desc:   Set the function told about every task an edit adds, changes or
+//         is about to remove, after the change for the first two.
+// Param:  handler: The function, or nullptr to stop telling anyone.
+// Return: None
+void TaskManager::setChangeHandler(const ChangeFunction& handler)
+{
+	changeHandler = handler;
+}
+
+// Name:   getLoadReport()
+// Desc:   Retrieve the records the last load could not read.
+// Param:  None
+// Return: A constant reference to the report.
+const LoadReport& TaskManager::getLoadReport() const
+{
+	return loadReport;
+}
+
+// Name:   verifyFile(const string& fileName, LoadReport& report, string& error)
+// Desc:   Check every record of a file without loading it. The checksums
+//         of compressed files and stores are checked and their records
+//         decoded, the lines of text files parsed.
+// Param:  fileName: A string that holds a file name.
+//         report: Receives the number of records and the lost ones.
+//         error: Receives why the file could not be checked at all.
+// Return: A boolean: True if the file could be checked.
+bool TaskManager::verifyFile(const std::string& fileName, LoadReport& report, std::string& error)
+{
+	report = LoadReport();
+
+	if (SegmentStore::isStoreName(fileName))
+		return SegmentStore::verify(fileName, report, error);
+
+	if (TaskArchive::isArchiveFile(fileName))
+	{
+		TaskArchive archive;
+
+		if (!archive.open(fileName))
+		{
+			error = archive.getError();
+			return false;
+		}
+
+		archive.verify(report);
+
+		return true;
+	}
+
+	std::ifstream file(fileName);
+	std::string line;
+	TaskRecord record;
+	uint64_t lineNum = 0;
+
+	if (!file.is_open())
+	{
+		error = "The file could not be opened.";
+		return false;
+	}
+
+	// Only the lost lines are of interest, the tasks are dropped
+	while (readTextLine(file, line, record, lineNum, report))
+		continue;
+
+	if (file.bad())
+	{
+		error = "The file could not be read to the end.";
+		return false;
+	}
+
+	return true;
+}
+
+// Name:   addLostRecords(LoadReport& report, uint64_t firstRecord, uint64_t numRecords, const string& reason)
+// Desc:   Add records that could not be read to a report. A run that
+//         follows the last one for the same reason is merged into it.
+// Param:  report: The report to add to.
+//         firstRecord: The number of the first record, from 1.
+//         numRecords: The number of records.
+//         reason: Why the records could not be read.
+// Return: None
+void TaskManager::addLostRecords(LoadReport& report, uint64_t firstRecord, uint64_t numRecords, const std::string& reason)
+{
+	report.numLost += numRecords;
+
+	if (!report.lost.empty() && report.lost.back().reason == reason
+		&& report.lost.back().firstRecord + report.lost.back().numRecords == firstRecord)
+	{
+		report.lost.back().numRecords += numRecords;
+		return;
+	}
+
+	report.lost.push_back({ firstRecord, numRecords, reason });
+}
+
+// Name:   formatLostRecords(const LostRecords& lost)
+// Desc:   Describe a run of lost records for display.
+// Param:  lost: The run of records.
+// Return: A string such as "records 4097-8192: torn tail".
+std::string TaskManager::formatLostRecords(const LostRecords& lost)
+{
+	if (lost.numRecords == 1)
+		return "record " + std::to_string(lost.firstRecord) + ": " + lost.reason;
+
+	return "records " + std::to_string(lost.firstRecord) + "-" + std::to_string(lost.firstRecord + lost.numRecords - 1)
+		+ ": " + lost.reason;
+}
+
+// Name:   checkFileExists(const string& fileName)
+// Desc:   Check if a file exists.
+// Param:  fileName: A string that holds a file name.
+// Return: A boolean: True if file exists, false otherwise.
+bool TaskManager::checkFileExists(const std::string& fileName)
+{
+	return std::filesystem::exists(fileName);
+}
+
+// Name:   formatRecurrence(const Recurrence& rule)
+// Desc:   Convert a recurrence rule into the fields used in task files.
+//         The fields are the frequency code, the interval, the end date
+//         (0 for no end) and the completed occurrences as serial dates
+//         separated by semicolons.
+// Param:  rule: The recurrence rule to convert.
+// Return: A string that holds the fields.
+std::string TaskManager::formatRecurrence(const Recurrence& rule)
+{
+	std::ostringstream fields;
+	const Date& endDate = rule.getEndDate();
+
+	fields << Recurrence::getFrequencyCode(rule.getFrequency()) << "," << rule.getInterval() << ",";
+
+	if (endDate.getSerial() < 0)
+		fields << 0;
+	else
+		fields << endDate.getMonth() << "/" << endDate.getDay() << "/" << endDate.getYear();
+
+	fields << ",";
+
+	const std::vector<int>& completedSerials = rule.getCompletedSerials();
+	for (size_t i = 0; i < completedSerials.size(); i++)
+	{
+		if (i > 0)
+			fields << ";";
+		fields << completedSerials[i];
+	}
+
+	return fields.str();
+}
+
+// Name:   parseRecurrence(const string& fields)
+// Desc:   Convert the recurrence fields of a task file back into a rule.
+// Param:  fields: A string that holds the fields written by formatRecurrence.
+// Return: The recurrence rule, a rule that never repeats if the fields are not valid.
+Recurrence TaskManager::parseRecurrence(const std::string& fields)
+{
+	std::istringstream stream(fields);
+	char code = 'n';
+	int interval = 1;
+	int endMonth = 0;
+	int endDay = 0;
+	int endYear = 0;
+
+	stream >> code;
+	stream.ignore(1);
+	stream >> interval;
+	stream.ignore(1);
+	stream >> endMonth;
+
+	if (stream.peek() == '/')
+	{
+		stream.ignore(1);
+		stream >> endDay;
+		stream.ignore(1);
+		stream >> endYear;
+	}
+
+	if (!stream)
+		return Recurrence();
+
+	Recurrence rule(Recurrence::getFrequencyFromCode(code), interval, endDay ? Date(endMonth, endDay, endYear) : Date());
+	int serial = 0;
+
+	stream.ignore(1);
+	while (stream >> serial)
+	{
+		rule.completeOccurrence(serial);
+		stream.ignore(1);
+	}
+
+	return rule;
+}
+
+// Name:   isValidRecurrence(const string& fields)
+// Desc:   Check the recurrence fields of a task file: a known frequency
+//         code, an interval of at least 1, an end date that is 0 or a
+//         valid date and completed occurrences that are serial dates.
+// Param:  fields: A string that holds the fields written by formatRecurrence.
+// Return: A boolean: True if parseRecurrence() reads the fields as they are.
+bool TaskManager::isValidRecurrence(const std::string& fields)
+{
+	const char* position = fields.c_str();
+	char* fieldEnd = nullptr;
+	long endFields[3] = { 0, 0, 0 };
+
+	if (Recurrence::getFrequencyFromCode(position[0]) == FREQUENCIES::NEVER || position[1] != ',')
+		return false;
+
+	position += 2;
+	const long interval = strtol(position, &fieldEnd, 10);
+
+	if (fieldEnd == position || *fieldEnd != ',' || interval < 1 || interval > INT_MAX)
+		return false;
+
+	// The end date is 0 when the task repeats forever
+	position = fieldEnd + 1;
+
+	for (int i = 0; i < 3; i++)
+	{
+		endFields[i] = strtol(position, &fieldEnd, 10);
+
+		if (fieldEnd == position)
+			return false;
+
+		position = fieldEnd;
+
+		if (i == 0 && endFields[0] == 0)
+			break;
+
+		if (i < 2 && *position++ != '/')
+			return false;
+	}
+
+	if (endFields[0] != 0 && !Date::isValidDate(endFields[0], endFields[1], endFields[2]))
+		return false;
+
+	// The completed occurrences are always written, even when there are none
+	if (*position++ != ',')
+		return false;
+
+	while (*position != '\0')
+	{
+		const long serial = strtol(position, &fieldEnd, 10);
+
+		if (fieldEnd == position || serial < 0 || serial > INT_MAX || (*fieldEnd != ';' && *fieldEnd != '\0'))
+			return false;
+
+		position = *fieldEnd == ';' ? fieldEnd + 1 : fieldEnd;
+	}
+
+	return true;
+}
+
+// Name:   getDaysUntilDue(const vector<const Node*>& tasks, int todaySerial)
+// Desc:   Work out how many days away the due date of every task in a
+//         list is, in one pass over the list.
+// Param:  tasks: The tasks to check.
+//         todaySerial: The serial date to count from.
+// Return: A vector with the days until each task is due, negative if
+//         it is overdue.
+std::vector<int> TaskManager::getDaysUntilDue(const std::vector<const Node*>& tasks, int todaySerial)
+{
+	std::vector<int> days(tasks.size());
+
+	for (size_t task = 0; task < tasks.size(); task++)
+		days[task] = tasks[task]->task.getDueSerial() - todaySerial;
+
+	return days;
+}
+
+// Name:   getWeeksUntilDue(const vector<const Node*>& tasks, int todaySerial)
+// Desc:   Bucket every task in a list by the Monday to Sunday week it is
+//         due in, in one pass over the list.
+// Param:  tasks: The tasks to bucket.
+//         todaySerial: The serial date of the current week.
+// Return: A vector with the week of each task: 0 for the current week,
+//         1 for next week, -1 for last week and so on.
+std::vector<int> TaskManager::getWeeksUntilDue(const std::vector<const Node*>& tasks, int todaySerial)
+{
+	std::vector<int> weeks(tasks.size());
+
+	// Serial 0 is a Thursday, so adding 3 numbers the weeks from a Monday
+	const int currWeek = (todaySerial + 3) / 7;
+
+	for (size_t task = 0; task < tasks.size(); task++)
+		weeks[task] = (tasks[task]->task.getDueSerial() + 3) / 7 - currWeek;
+
+	return weeks;
 }
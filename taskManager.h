@@ -1,26 +1,91 @@
 #pragma once
 #include "task.h"
+#include "nodePool.h"
+#include "taskViews.h"
+#include "dedupEngine.h"
+#include "dueColumns.h"
+#include "labelPostings.h"
+#include "segmentStore.h"
+#include "asyncFile.h"
+#include "reminders.h"
+#include "taskGraph.h"
+#include <memory>
+#include <functional>
 
 /*****************************************************************************
-# Description: A node structure for use with a linked list.
+# Description: The Occurrence structure is one expanded date of a task.
+			   The TaskRecord structure is one parsed line of a text file,
+			   with the lines of the tasks it waits for in the same file.
+			   The LostRecords structure is a run of records of a file
+			   that could not be read and why, numbered from 1 in file
+			   order: lines of a text file, tasks of the other formats.
+			   The LoadReport structure lists the lost records of the
+			   last load or verification.
+			   The MemoryUsage structure is a breakdown of the memory a
+			   task list uses.
                The TaskManager class handles operations for a
-			   linked list of tasks.
+			   linked list of tasks and keeps its sorted views current.
+			   Text files are read and written through an AsyncFile, so
+			   lines are parsed and formatted while the next blocks are
+			   in flight, unless the blocking stream backend is chosen.
+			   Once reminders are started, every change to a task moves
+			   its timer, and checkReminders() fires the reminders that
+			   came up on the clock since the last check.
+			   A task can wait for other tasks. The tasks that are not
+			   completed and wait for nothing open are kept in due date
+			   order, so the actionable tasks are read without a scan.
+			   A change handler is told about every task an edit adds,
+			   changes or removes, but not about the tasks of a load.
 #****************************************************************************/
 
-struct Node
+struct Occurrence
 {
-	Node(std::string name, const Date& dueDate, bool completed)
-		: task(name, dueDate, completed), next(nullptr)
-	{
-	}
+	const Node* node;
+	int serial;
+	bool completed;
+};
+
+struct TaskRecord
+{
+	std::string name;
+	Date dueDate;
+	bool completed;
+	std::string recurrenceFields;
+	int priority;
+	uint64_t tags;
+	std::vector<uint64_t> blockerLines;
+};
+
+struct LostRecords
+{
+	uint64_t firstRecord;
+	uint64_t numRecords;
+	std::string reason;
+};
+
+struct LoadReport
+{
+	uint64_t numRecords;
+	uint64_t numLost;
+	std::vector<LostRecords> lost;
+};
 
-	Task task;
-	Node* next;
+struct MemoryUsage
+{
+	size_t numTasks;
+	size_t recordBytes;
+	size_t nameBytes;
+	size_t ruleBytes;
+	size_t indexBytes;
+	size_t overheadBytes;
+	size_t totalBytes;
 };
 
 class TaskManager
 {
 public:
+	typedef std::function<void(const Node* node, bool removed)> ChangeFunction;
+
 	TaskManager();
 	TaskManager(const TaskManager& origTaskManager);
 	const TaskManager& operator=(const TaskManager& origTaskManager);
@@ -28,18 +93,128 @@ public:
 
 	void emptyTasks();
 	bool addTask(const std::string& name, const Date& dueDate);
+	bool addTask(const std::string& name, const Date& dueDate, const Recurrence& rule);
 	bool deleteTask(int taskNum);
+	bool deleteTask(const Node* node);
 	void completeTask(int taskNum);
+	void completeTask(const Node* node);
+	void completeOccurrence(const Node* node, int serial);
+	void uncompleteTask(const Node* node);
+	void uncompleteOccurrence(const Node* node, int serial);
+	const Node* restoreTask(const TaskRecord& record, unsigned int sequence, const Node* prev);
+	const Node* findTask(int dueSerial, unsigned int sequence) const;
 	int getNumTasks() const;
+	int getNumCompleted() const;
 	const Node* getTasks() const;
+	const Node* getLastTask() const;
+	const Node* getTaskInView(VIEWS view, int taskNum) const;
+	ViewIterator viewBegin(VIEWS view) const;
+	ViewIterator viewEnd(VIEWS view) const;
+	ViewIterator findDue(VIEWS view, int dueSerial) const;
+	bool getDueRange(int& firstSerial, int& lastSerial) const;
+	std::vector<uint64_t> countDue(const std::vector<DueRange>& ranges, bool incompleteOnly) const;
+	std::vector<const Node*> getTasksDueIn(const DueRange& range, bool incompleteOnly) const;
+	std::vector<const Node*> findLabeled(int priority, uint64_t tags, int completedState) const;
+	std::vector<const Node*> getNextDue(int count) const;
+	std::vector<Occurrence> getOccurrences(int fromSerial, int toSerial) const;
+	MemoryUsage memoryUsage() const;
 	bool loadFromFile(const std::string& fileName);
+	bool loadFromFile(const std::string& fileName, DedupEngine& dedup);
+	bool importFromFile(const std::string& fileName, DedupEngine& dedup);
+	bool loadDueRange(const std::string& fileName, int firstSerial, int lastSerial);
 	bool saveToFile(const std::string& fileName) const;
 	bool checkFileExists(const std::string& fileName);
+	const LoadReport& getLoadReport() const;
+	void setIoBackend(IO_BACKENDS backend);
+	IO_BACKENDS getIoBackend() const;
+	void startReminders(const Reminders::ReminderFunction& notify, const Reminders::ClockFunction& clock = Reminders::getLocalTime);
+	void stopReminders();
+	size_t checkReminders();
+	int64_t getNextReminderTime() const;
+	bool addDependency(const Node* blocker, const Node* dependent);
+	bool removeDependency(const Node* blocker, const Node* dependent);
+	bool isBlocked(const Node* node) const;
+	bool isActionable(const Node* node) const;
+	std::vector<const Node*> getBlockers(const Node* node) const;
+	std::vector<const Node*> getDependents(const Node* node) const;
+	std::vector<const Node*> getActionable(int count) const;
+	int getNumActionable() const;
+	int getNumDependencies() const;
+	void setChangeHandler(const ChangeFunction& handler);
+
+	const Node* addTask(const TaskRecord& record);
+	static bool parseTaskLine(const std::string& line, TaskRecord& record, size_t nameEnd = std::string::npos, std::string* problem = nullptr);
+	static std::string formatTaskLine(const Task& task);
+	static std::string formatRecurrence(const Recurrence& rule);
+	static Recurrence parseRecurrence(const std::string& fields);
+	static bool isValidRecurrence(const std::string& fields);
+	static std::vector<int> getDaysUntilDue(const std::vector<const Node*>& tasks, int todaySerial);
+	static std::vector<int> getWeeksUntilDue(const std::vector<const Node*>& tasks, int todaySerial);
+	static bool verifyFile(const std::string& fileName, LoadReport& report, std::string& error);
+	static void addLostRecords(LoadReport& report, uint64_t firstRecord, uint64_t numRecords, const std::string& reason);
+	static std::string formatLostRecords(const LostRecords& lost);
 
 private:
-	void addTask(const std::string& name, const Date& dueDate, bool completed);
-	Task* getTaskNodeByNum(int taskNum);
+	friend class TaskArchive;
+	friend class SegmentStore;
+	friend class SharedStore;
+	friend class FileWatcher;
+
+	// Sequences are handed out with room between them for the tasks that are moved
+	static const unsigned int sequenceGap = 16;
+
+	Node* addTask(std::string_view name, const Date& dueDate, bool completed);
+	void updateTask(const Node* node, const TaskRecord& record);
+	void moveTask(const Node* node, const Node* prev);
+	void spreadTasks(Node* firstNode, const Node* endNode, int64_t start, int64_t spacing);
+	bool readFile(const std::string& fileName, bool append);
+	void readTextTasks(std::istream& file);
+	static bool readTextLine(std::istream& file, std::string& line, TaskRecord& record, uint64_t& lineNum, LoadReport& report);
+	bool readTextBlocks(AsyncFile& file);
+	static bool checkTextLine(const std::string& line, bool lastLine, TaskRecord& record, uint64_t lineNum, LoadReport& report);
+	void addTextTask(const TaskRecord& record, uint64_t lineNum);
+	void addLoadedLine(const Node* node, uint64_t lineNum, const std::vector<uint64_t>& blockerLines);
+	bool writeTextBlocks(AsyncFile& file) const;
+	void beginLoad(bool append);
+	Node* addLoadedTask(const std::string& name, const Date& dueDate, bool completed);
+	void endLoad();
+	void setRecurrence(Node* node, const Recurrence& rule);
+	void setLabels(Node* node, int priority, uint64_t tags);
+	void markDirty(const Node* node);
+	void updateReminder(const Node* node);
+	void notifyChange(const Node* node, bool removed);
+	void updateActionable(const std::vector<uint32_t>& changed);
+	void addLoadedDependencies();
+	std::vector<uint32_t> getLineNumbers() const;
+	std::string formatBlockers(const Node* node, const std::vector<uint32_t>& lineNumbers) const;
+	Node* getNodeByNum(int taskNum);
 
 	Node* head;
+	Node* tail;
 	int numNodes;
+	int numCompleted;
+	unsigned int nextSequence;
+	bool deferViews;
+	DedupEngine* activeDedup;
+	NodePool nodes;
+	TaskViews views;
+	DueColumns dueColumns;
+	LabelPostings labelPostings;
+	SortedView recurringTasks;
+	mutable StoreBinding storeBinding;
+	LoadReport loadReport;
+	IO_BACKENDS ioBackend;
+	std::unique_ptr<Reminders> reminders;
+	TaskGraph graph;
+	SortedView actionableTasks;
+	ChangeFunction changeHandler;
+
+	// The tasks of the lines or records of a file being loaded and the lines they wait for
+	struct LoadedLine
+	{
+		int dueSerial;
+		unsigned int sequence;
+	};
+	std::vector<LoadedLine> loadedLines;
+	std::vector<std::pair<uint64_t, uint64_t>> loadedDependencies;
 };
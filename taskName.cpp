@@ -0,0 +1,139 @@
+#include "taskName.h"
+#include "nameArena.h"
+#include <cstring>
+
+static_assert(sizeof(TaskName) == 24, "A task name has to fit in 24 bytes");
+
+// Name:   TaskName()
+// Desc:   Default constructor for an empty name.
+// Param:  None
+// Return: None
+TaskName::TaskName()
+{
+	bytes[inlineCapacity] = 0;
+}
+
+// Name:   TaskName(string_view text)
+// Desc:   Constructor that copies a name.
+// Param:  text: The name.
+// Return: None
+TaskName::TaskName(std::string_view text)
+{
+	assign(text);
+}
+
+// Name:   TaskName(const TaskName& origName)
+// Desc:   Copy constructor. A name in the arena gets its own copy.
+// Param:  origName: A reference to a TaskName object.
+// Return: None
+TaskName::TaskName(const TaskName& origName)
+{
+	assign(origName.view());
+}
+
+// Name:   operator=()
+// Desc:   Allow the TaskName class to use the assignment operator.
+// Param:  origName: A reference to a TaskName object.
+// Return: A constant reference to this object.
+const TaskName& TaskName::operator=(const TaskName& origName)
+{
+	if (this != &origName)
+	{
+		release();
+		assign(origName.view());
+	}
+
+	return *this;
+}
+
+// Name:   ~TaskName()
+// Desc:   Destructor that gives a long name back to the arena.
+// Param:  None
+// Return: None
+TaskName::~TaskName()
+{
+	release();
+}
+
+// Name:   view()
+// Desc:   Retrieve the characters of the name.
+// Param:  None
+// Return: A view of the name, valid until the name is changed.
+std::string_view TaskName::view() const
+{
+	if (isInline())
+		return std::string_view(bytes, (uint8_t)bytes[inlineCapacity]);
+
+	const char* data = nullptr;
+	uint32_t length = 0;
+
+	memcpy(&data, bytes, sizeof(data));
+	memcpy(&length, bytes + sizeof(data), sizeof(length));
+
+	return std::string_view(data, length);
+}
+
+// Name:   size()
+// Desc:   Retrieve the length of the name.
+// Param:  None
+// Return: The number of characters.
+size_t TaskName::size() const
+{
+	return view().size();
+}
+
+// Name:   isInline()
+// Desc:   Check if the name is stored inline.
+// Param:  None
+// Return: A boolean: True if the name is not in the arena.
+bool TaskName::isInline() const
+{
+	return (uint8_t)bytes[inlineCapacity] != spilledLength;
+}
+
+// Name:   getSpilledBytes()
+// Desc:   Retrieve the arena bytes the name uses.
+// Param:  None
+// Return: The size of the arena block, 0 for an inline name.
+size_t TaskName::getSpilledBytes() const
+{
+	return isInline() ? 0 : NameArena::getBlockSize(size());
+}
+
+// Name:   assign(string_view text)
+// Desc:   Store a name, in the arena if it does not fit inline. Any name
+//         held before has to be released first.
+// Param:  text: The name.
+// Return: None
+void TaskName::assign(std::string_view text)
+{
+	if (text.size() <= inlineCapacity)
+	{
+		memcpy(bytes, text.data(), text.size());
+		bytes[inlineCapacity] = (char)text.size();
+		return;
+	}
+
+	char* data = NameArena::allocate(text.size());
+	const uint32_t length = (uint32_t)text.size();
+
+	memcpy(data, text.data(), text.size());
+	memcpy(bytes, &data, sizeof(data));
+	memcpy(bytes + sizeof(data), &length, sizeof(length));
+	bytes[inlineCapacity] = (char)spilledLength;
+}
+
+// Name:   release()
+// Desc:   Give a name in the arena back and leave an empty name.
+// Param:  None
+// Return: None
+void TaskName::release()
+{
+	if (!isInline())
+	{
+		const std::string_view text = view();
+		NameArena::release(const_cast<char*>(text.data()), text.size());
+	}
+
+	bytes[inlineCapacity] = 0;
+}
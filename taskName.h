@@ -0,0 +1,37 @@
+#pragma once
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: The TaskName class stores a task name in 24 bytes. Names of
+               up to 23 characters are kept inline. Longer names are kept
+			   in the NameArena and the 24 bytes hold a pointer to them
+			   and their length. The last byte is the inline length, or
+			   spilledLength for a name in the arena.
+#****************************************************************************/
+
+class TaskName
+{
+public:
+	static const size_t inlineCapacity = 23;
+
+	TaskName();
+	TaskName(std::string_view text);
+	TaskName(const TaskName& origName);
+	const TaskName& operator=(const TaskName& origName);
+	~TaskName();
+
+	std::string_view view() const;
+	size_t size() const;
+	bool isInline() const;
+	size_t getSpilledBytes() const;
+
+private:
+	static const uint8_t spilledLength = 0xff;
+
+	void assign(std::string_view text);
+	void release();
+
+	char bytes[inlineCapacity + 1];
+};
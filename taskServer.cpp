@@ -0,0 +1,503 @@
+#include "taskServer.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+const char* TaskServer::defaultSocket = "/tmp/simpleTaskManager.sock";
+
+// Name:   TaskServer()
+// Desc:   Default constructor that initializes the members.
+// Param:  None
+// Return: None
+TaskServer::TaskServer()
+	: listenFd(-1), epollFd(-1), stopFd(-1), running(false), modified(false)
+{
+}
+
+// Name:   ~TaskServer()
+// Desc:   Destructor. Closes every client and removes the socket file.
+// Param:  None
+// Return: None
+TaskServer::~TaskServer()
+{
+	for (std::pair<const int, Client>& client : clients)
+		close(client.first);
+
+	if (listenFd >= 0)
+	{
+		close(listenFd);
+		unlink(socketPath.c_str());
+	}
+
+	if (epollFd >= 0)
+		close(epollFd);
+
+	if (stopFd >= 0)
+		close(stopFd);
+}
+
+// Name:   start(const string& socketPath, const string& fileName)
+// Desc:   Load the task file and start listening on the socket. A socket
+//         file left behind by a server that is no longer running is
+//         replaced, one that a server still answers on is not.
+// Param:  socketPath: The path of the Unix domain socket.
+//         fileName: The task file to serve, created on the first save if it does not exist.
+// Return: A boolean: True if the server is ready to run.
+bool TaskServer::start(const std::string& socketPath, const std::string& fileName)
+{
+	sockaddr_un address = {};
+
+	if (socketPath.size() >= sizeof(address.sun_path))
+		return false;
+
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath.c_str());
+
+	int probeFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	bool inUse = probeFd >= 0 && connect(probeFd, (sockaddr*)&address, sizeof(address)) == 0;
+
+	if (probeFd >= 0)
+		close(probeFd);
+
+	if (inUse)
+		return false;
+
+	unlink(socketPath.c_str());
+
+	if (manager.checkFileExists(fileName) && !manager.loadFromFile(fileName))
+		return false;
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		addTaskId(currNode);
+
+	manager.startReminders(printReminder);
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (listenFd < 0 || epollFd < 0 || stopFd < 0)
+		return false;
+
+	if (bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, SOMAXCONN) != 0)
+	{
+		close(listenFd);
+		listenFd = -1;
+		return false;
+	}
+
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = listenFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+	event.data.fd = stopFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event);
+
+	this->socketPath = socketPath;
+	this->fileName = fileName;
+	running = true;
+
+	return true;
+}
+
+// Name:   run()
+// Desc:   Serve clients until stop() is called or a client sends STOP.
+// Param:  None
+// Return: None
+void TaskServer::run()
+{
+	epoll_event events[maxEvents];
+
+	while (running)
+	{
+		int numEvents = epoll_wait(epollFd, events, maxEvents, getWaitMilliseconds());
+
+		if (numEvents < 0 && errno != EINTR)
+			break;
+
+		manager.checkReminders();
+
+		for (int i = 0; i < numEvents; i++)
+		{
+			const int fd = events[i].data.fd;
+
+			if (fd == stopFd)
+			{
+				running = false;
+				continue;
+			}
+
+			if (fd == listenFd)
+			{
+				acceptClients();
+				continue;
+			}
+
+			std::unordered_map<int, Client>::iterator found = clients.find(fd);
+			if (found == clients.end())
+				continue;
+
+			Client& client = found->second;
+			bool open = !(events[i].events & (EPOLLERR | EPOLLHUP)) || (events[i].events & EPOLLIN);
+
+			if (open && (events[i].events & EPOLLIN))
+				open = readClient(client);
+
+			if (open)
+				open = writeClient(client);
+
+			if (!open)
+				closeClient(fd);
+		}
+	}
+}
+
+// Name:   stop()
+// Desc:   Make run() return. This can be called from any thread.
+// Param:  None
+// Return: None
+void TaskServer::stop()
+{
+	const uint64_t one = 1;
+
+	if (stopFd >= 0 && write(stopFd, &one, sizeof(one)) < 0)
+		perror("stop");
+}
+
+// Name:   save()
+// Desc:   Save the tasks to the file that was loaded.
+// Param:  None
+// Return: A boolean: True if the file was saved.
+bool TaskServer::save()
+{
+	if (!manager.saveToFile(fileName))
+		return false;
+
+	modified = false;
+
+	return true;
+}
+
+// Name:   getNumTasks()
+// Desc:   Retrieve the number of tasks being served.
+// Param:  None
+// Return: The number of tasks as an integer.
+int TaskServer::getNumTasks() const
+{
+	return manager.getNumTasks();
+}
+
+// Name:   isModified()
+// Desc:   Check if the tasks changed since the file was loaded or saved.
+// Param:  None
+// Return: A boolean: True if there are unsaved changes.
+bool TaskServer::isModified() const
+{
+	return modified;
+}
+
+// Name:   acceptClients()
+// Desc:   Accept every waiting connection and add it to the epoll set.
+// Param:  None
+// Return: None
+void TaskServer::acceptClients()
+{
+	int fd = -1;
+
+	while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		epoll_event event = {};
+		event.events = EPOLLIN | EPOLLRDHUP;
+		event.data.fd = fd;
+
+		if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+		{
+			close(fd);
+			continue;
+		}
+
+		clients[fd] = { fd, std::string(), std::string(), false };
+	}
+}
+
+// Name:   readClient(Client& client)
+// Desc:   Read what the client sent and answer every complete request.
+//         Clients may send several requests without waiting for the
+//         responses, they are answered in order.
+// Param:  client: The client to read from.
+// Return: A boolean: False if the connection should be closed.
+bool TaskServer::readClient(Client& client)
+{
+	char buffer[16 * 1024];
+	ssize_t length = 0;
+	bool open = true;
+
+	while ((length = recv(client.fd, buffer, sizeof(buffer), 0)) > 0)
+		client.input.append(buffer, length);
+
+	if (length == 0 || (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		open = false;
+
+	size_t start = 0;
+	size_t end = 0;
+	std::string response;
+
+	while ((end = client.input.find('\n', start)) != std::string::npos)
+	{
+		response.clear();
+		handleRequest(client.input.substr(start, end - start), response);
+		client.output += response;
+		start = end + 1;
+	}
+
+	client.input.erase(0, start);
+
+	// A request this long without a newline is not a request
+	if (client.input.size() > maxRequestLength)
+		return false;
+
+	// Send what is left to the client even if it already closed its end
+	return open || !client.output.empty();
+}
+
+// Name:   writeClient(Client& client)
+// Desc:   Send as much of the pending output as the socket takes and only
+//         wait for the socket to be writable while output is left.
+// Param:  client: The client to write to.
+// Return: A boolean: False if the connection should be closed.
+bool TaskServer::writeClient(Client& client)
+{
+	size_t sent = 0;
+
+	while (sent < client.output.size())
+	{
+		ssize_t length = send(client.fd, client.output.data() + sent, client.output.size() - sent, MSG_NOSIGNAL);
+
+		if (length < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return false;
+			break;
+		}
+
+		sent += length;
+	}
+
+	client.output.erase(0, sent);
+
+	const bool writing = !client.output.empty();
+	if (writing != client.writing)
+	{
+		epoll_event event = {};
+		event.events = EPOLLIN | EPOLLRDHUP | (writing ? (uint32_t)EPOLLOUT : 0);
+		event.data.fd = client.fd;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+		client.writing = writing;
+	}
+
+	return true;
+}
+
+// Name:   closeClient(int fd)
+// Desc:   Close a client connection.
+// Param:  fd: The socket of the client.
+// Return: None
+void TaskServer::closeClient(int fd)
+{
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+	close(fd);
+	clients.erase(fd);
+}
+
+// Name:   handleRequest(const string& request, string& response)
+// Desc:   Answer one request. The commands are:
+//           ADD <name> <m/d/y>       -> OK <id>
+//           COMPLETE <id>            -> OK
+//           DELETE <id>              -> OK
+//           QUERY <view> <count>     -> OK <n>, then n task lines
+//           NEXT <count>             -> OK <n>, then n task lines
+//           COUNT                    -> OK <number of tasks>
+//           SAVE                     -> OK
+//           STOP                     -> OK, the server stops after answering
+//         Task lines are <id> <name> <m/d/y> <completed>. Fields are
+//         separated by tabs and errors are answered with ERR <message>.
+// Param:  request: A string that holds the request without its newline.
+//         response: Receives the response lines.
+// Return: None
+void TaskServer::handleRequest(const std::string& request, std::string& response)
+{
+	std::vector<std::string> fields;
+	size_t start = 0;
+	size_t end = 0;
+
+	do
+	{
+		end = request.find('\t', start);
+		fields.push_back(request.substr(start, end == std::string::npos ? std::string::npos : end - start));
+		start = end + 1;
+	} while (end != std::string::npos);
+
+	if (!fields.empty() && !fields.back().empty() && fields.back().back() == '\r')
+		fields.back().pop_back();
+
+	const std::string& command = fields[0];
+	std::vector<const Node*> tasks;
+
+	if (command == "ADD" && fields.size() == 3)
+	{
+		int month = 0;
+		int day = 0;
+		int year = 0;
+
+		if (fields[1].empty() || fields[1].find(',') != std::string::npos)
+		{
+			response = "ERR\tThe name has to be set and cannot contain a comma\n";
+			return;
+		}
+
+		if (sscanf(fields[2].c_str(), "%d/%d/%d", &month, &day, &year) != 3 || !Date::isValidDate(month, day, year))
+		{
+			response = "ERR\tThe date has to be a valid m/d/y\n";
+			return;
+		}
+
+		TaskRecord record = { fields[1], Date(month, day, year), false, std::string(), 0, 0, {} };
+		const Node* node = manager.addTask(record);
+		addTaskId(node);
+		modified = true;
+		response = "OK\t" + std::to_string(node->sequence) + "\n";
+		return;
+	}
+
+	if ((command == "COMPLETE" || command == "DELETE") && fields.size() == 2)
+	{
+		const Node* node = findTask(fields[1]);
+
+		if (!node)
+		{
+			response = "ERR\tNo task with that id\n";
+			return;
+		}
+
+		if (command == "COMPLETE")
+			manager.completeTask(node);
+		else
+		{
+			tasksById.erase(node->sequence);
+			manager.deleteTask(node);
+		}
+
+		modified = true;
+		response = "OK\n";
+		return;
+	}
+
+	if (command == "QUERY" && fields.size() == 3)
+	{
+		const int view = atoi(fields[1].c_str());
+		const int count = atoi(fields[2].c_str());
+
+		if (view < VIEWS::INSERTION_ORDER || view >= VIEWS::NUM_VIEWS || count < 0)
+		{
+			response = "ERR\tThe view has to be 0 to " + std::to_string(VIEWS::NUM_VIEWS - 1) + "\n";
+			return;
+		}
+
+		for (ViewIterator position = manager.viewBegin((VIEWS)view); position != manager.viewEnd((VIEWS)view) && (int)tasks.size() < count; ++position)
+			tasks.push_back(*position);
+	}
+	else if (command == "NEXT" && fields.size() == 2)
+		tasks = manager.getNextDue(atoi(fields[1].c_str()));
+	else if (command == "COUNT" && fields.size() == 1)
+	{
+		response = "OK\t" + std::to_string(manager.getNumTasks()) + "\n";
+		return;
+	}
+	else if (command == "SAVE" && fields.size() == 1)
+	{
+		response = save() ? "OK\n" : "ERR\tThe file could not be saved\n";
+		return;
+	}
+	else if (command == "STOP" && fields.size() == 1)
+	{
+		running = false;
+		response = "OK\n";
+		return;
+	}
+	else
+	{
+		response = "ERR\tUnknown request\n";
+		return;
+	}
+
+	response = "OK\t" + std::to_string(tasks.size()) + "\n";
+
+	for (const Node* node : tasks)
+	{
+		const Date dueDate = node->task.getDueDate();
+
+		response += std::to_string(node->sequence) + "\t" + std::string(node->task.getName()) + "\t" + std::to_string(dueDate.getMonth())
+			+ "/" + std::to_string(dueDate.getDay()) + "/" + std::to_string(dueDate.getYear())
+			+ "\t" + (node->task.getCompleted() ? "1" : "0") + "\n";
+	}
+}
+
+// Name:   findTask(const string& id)
+// Desc:   Find a task by its id.
+// Param:  id: A string that holds the id.
+// Return: A constant pointer to the node, or nullptr if there is no such task.
+const Node* TaskServer::findTask(const std::string& id) const
+{
+	char* idEnd = nullptr;
+	unsigned long sequence = strtoul(id.c_str(), &idEnd, 10);
+
+	if (id.empty() || *idEnd != '\0')
+		return nullptr;
+
+	std::unordered_map<unsigned int, const Node*>::const_iterator found = tasksById.find(sequence);
+
+	return found == tasksById.end() ? nullptr : found->second;
+}
+
+// Name:   addTaskId(const Node* node)
+// Desc:   Make a task findable by its id.
+// Param:  node: The node of the task.
+// Return: None
+void TaskServer::addTaskId(const Node* node)
+{
+	tasksById[node->sequence] = node;
+}
+
+// Name:   getWaitMilliseconds()
+// Desc:   Work out how long the loop can wait for clients before the next
+//         reminder is due. The wait is capped, so a change of the clock
+//         is noticed within a minute.
+// Param:  None
+// Return: The timeout for epoll_wait in milliseconds.
+int TaskServer::getWaitMilliseconds() const
+{
+	const int64_t waitSeconds = manager.getNextReminderTime() - Reminders::getLocalTime();
+
+	if (waitSeconds <= 0)
+		return 0;
+
+	return waitSeconds >= maxWaitMilliseconds / 1000 ? maxWaitMilliseconds : (int)waitSeconds * 1000;
+}
+
+// Name:   printReminder(const Reminder& reminder)
+// Desc:   Print a reminder as an event line on the standard output:
+//         REMINDER, the task id, due or overdue, the date of the
+//         occurrence and the task name, separated by tabs.
+// Param:  reminder: The reminder that fired.
+// Return: None
+void TaskServer::printReminder(const Reminder& reminder)
+{
+	printf("REMINDER\t%u\t%s\n", reminder.node->sequence, Reminders::formatReminder(reminder).c_str());
+	fflush(stdout);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "taskManager.h"
+
+/*****************************************************************************
+# Description: The TaskServer class keeps one task list loaded and serves
+               it to other processes over a Unix domain socket, so short
+			   scripts do not have to load and save the whole file for
+			   every change. One thread runs an epoll loop for all
+			   clients. Requests and responses are single lines with
+			   tab separated fields (see handleRequest for the commands).
+			   Tasks are named by an id that does not change when other
+			   tasks are added or removed. Reminders of the served tasks
+			   are printed to the standard output as event lines, and the
+			   loop wakes up in time for the next one.
+#****************************************************************************/
+
+class TaskServer
+{
+public:
+	static const char* defaultSocket;
+
+	TaskServer();
+	TaskServer(const TaskServer& origServer) = delete;
+	const TaskServer& operator=(const TaskServer& origServer) = delete;
+	~TaskServer();
+
+	bool start(const std::string& socketPath, const std::string& fileName);
+	void run();
+	void stop();
+	bool save();
+
+	int getNumTasks() const;
+	bool isModified() const;
+
+private:
+	struct Client
+	{
+		int fd;
+		std::string input;
+		std::string output;
+		bool writing;
+	};
+
+	static const int maxEvents = 64;
+	static const size_t maxRequestLength = 64 * 1024;
+	static const int maxWaitMilliseconds = 60 * 1000;
+
+	void acceptClients();
+	bool readClient(Client& client);
+	bool writeClient(Client& client);
+	void closeClient(int fd);
+	void handleRequest(const std::string& request, std::string& response);
+	const Node* findTask(const std::string& id) const;
+	void addTaskId(const Node* node);
+	int getWaitMilliseconds() const;
+	static void printReminder(const Reminder& reminder);
+
+	TaskManager manager;
+	std::unordered_map<unsigned int, const Node*> tasksById;
+	std::unordered_map<int, Client> clients;
+	std::string socketPath;
+	std::string fileName;
+	int listenFd;
+	int epollFd;
+	int stopFd;
+	bool running;
+	bool modified;
+};
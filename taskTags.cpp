@@ -0,0 +1,161 @@
+#include "taskTags.h"
+#include <cctype>
+
+std::mutex TaskTags::tableMutex;
+std::string TaskTags::names[TaskTags::maxTags];
+std::atomic<int> TaskTags::numTags(0);
+
+// Name:   isValidName(const string& name)
+// Desc:   Check if a string can be used as a tag name.
+// Param:  name: The name to check.
+// Return: A boolean: True if the name is not empty and only holds
+//         letters, digits, '-' and '_'.
+bool TaskTags::isValidName(const std::string& name)
+{
+	if (name.empty())
+		return false;
+
+	for (char nameChar : name)
+	{
+		if (!isalnum((unsigned char)nameChar) && nameChar != '-' && nameChar != '_')
+			return false;
+	}
+
+	return true;
+}
+
+// Name:   intern(const string& name)
+// Desc:   Retrieve the id of a tag, giving it the next free id if the
+//         name is new.
+// Param:  name: The name of the tag.
+// Return: The id of the tag, or -1 if the name is not valid or every
+//         id is taken.
+int TaskTags::intern(const std::string& name)
+{
+	if (!isValidName(name))
+		return -1;
+
+	std::lock_guard<std::mutex> lock(tableMutex);
+	const int count = numTags.load(std::memory_order_relaxed);
+
+	for (int tagId = 0; tagId < count; tagId++)
+	{
+		if (names[tagId] == name)
+			return tagId;
+	}
+
+	if (count == maxTags)
+		return -1;
+
+	// The name is in place before the id can be seen by getName()
+	names[count] = name;
+	numTags.store(count + 1, std::memory_order_release);
+
+	return count;
+}
+
+// Name:   find(const string& name)
+// Desc:   Retrieve the id of a tag without adding it.
+// Param:  name: The name of the tag.
+// Return: The id of the tag, or -1 if no task has used it.
+int TaskTags::find(const std::string& name)
+{
+	const int count = numTags.load(std::memory_order_acquire);
+
+	for (int tagId = 0; tagId < count; tagId++)
+	{
+		if (names[tagId] == name)
+			return tagId;
+	}
+
+	return -1;
+}
+
+// Name:   getName(int tagId)
+// Desc:   Retrieve the name of a tag. A name never changes once it has
+//         an id, so no lock is needed.
+// Param:  tagId: The id of the tag.
+// Return: A constant reference to the name, empty if the id is not used.
+const std::string& TaskTags::getName(int tagId)
+{
+	static const std::string noName;
+
+	if (tagId < 0 || tagId >= numTags.load(std::memory_order_acquire))
+		return noName;
+
+	return names[tagId];
+}
+
+// Name:   getNumTags()
+// Desc:   Retrieve the number of tag names that have an id.
+// Param:  None
+// Return: The number of tags.
+int TaskTags::getNumTags()
+{
+	return numTags.load(std::memory_order_acquire);
+}
+
+// Name:   parseTags(const string& text, uint64_t& tags, string& badTag)
+// Desc:   Convert a list of tag names separated by spaces or commas into a
+//         mask. A name may start with '#'.
+// Param:  text: The list of names.
+//         tags: Receives the mask of the tags.
+//         badTag: Receives the first name that could not be used.
+// Return: A boolean: True if every name was valid and got an id.
+bool TaskTags::parseTags(const std::string& text, uint64_t& tags, std::string& badTag)
+{
+	size_t position = 0;
+
+	tags = 0;
+
+	while (position < text.size())
+	{
+		while (position < text.size() && (isspace((unsigned char)text[position]) || text[position] == ','))
+			position++;
+
+		const size_t start = position;
+
+		while (position < text.size() && !isspace((unsigned char)text[position]) && text[position] != ',')
+			position++;
+
+		if (start == position)
+			break;
+
+		std::string name = text.substr(start, position - start);
+		if (name[0] == '#')
+			name.erase(0, 1);
+
+		const int tagId = intern(name);
+
+		if (tagId < 0)
+		{
+			badTag = name;
+			return false;
+		}
+
+		tags |= (uint64_t)1 << tagId;
+	}
+
+	return true;
+}
+
+// Name:   formatTags(uint64_t tags, const string& separator, const string& prefix)
+// Desc:   Convert a mask of tags into their names, in id order.
+// Param:  tags: The mask of the tags.
+//         separator: The text to put between the names.
+//         prefix: The text to put before each name.
+// Return: A string that holds the names.
+std::string TaskTags::formatTags(uint64_t tags, const std::string& separator, const std::string& prefix)
+{
+	std::string text;
+
+	for (uint64_t bits = tags; bits; bits &= bits - 1)
+	{
+		if (!text.empty())
+			text += separator;
+
+		text += prefix + getName(__builtin_ctzll(bits));
+	}
+
+	return text;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+/*****************************************************************************
+# Description: The TaskTags class interns tag names into ids from 0 to 63,
+               so the tags of a task are one bit each in a 64 bit mask.
+			   The table is shared by every task list in the process and
+			   only grows, so an id keeps its name while the program runs.
+			   Tag names are letters, digits, '-' and '_'.
+#****************************************************************************/
+
+class TaskTags
+{
+public:
+	static const int maxTags = 64;
+
+	static bool isValidName(const std::string& name);
+	static int intern(const std::string& name);
+	static int find(const std::string& name);
+	static const std::string& getName(int tagId);
+	static int getNumTags();
+
+	static bool parseTags(const std::string& text, uint64_t& tags, std::string& badTag);
+	static std::string formatTags(uint64_t tags, const std::string& separator, const std::string& prefix);
+
+private:
+	static std::mutex tableMutex;
+	static std::string names[maxTags];
+	static std::atomic<int> numTags;
+};
@@ -0,0 +1,706 @@
+#include "taskViews.h"
+#include "taskManager.h"
+#include "parallelSort.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <string_view>
+
+// Name:   operator()(const Node* left, const Node* right)
+// Desc:   Orders two task nodes for the view the comparison belongs to.
+//         Ties are broken by the insertion sequence so every task has a
+//         unique position in each view.
+// Param:  left: The first node to compare.
+//         right: The second node to compare.
+// Return: A boolean: True if left should be listed before right.
+bool NodeOrder::operator()(const Node* left, const Node* right) const
+{
+	const Task& leftTask = left->task;
+	const Task& rightTask = right->task;
+
+	switch (view)
+	{
+		case VIEWS::BY_DUE_DATE:
+			if (leftTask.getDueSerial() != rightTask.getDueSerial())
+				return leftTask.getDueSerial() < rightTask.getDueSerial();
+			break;
+
+		case VIEWS::BY_NAME:
+		{
+			int compare = leftTask.getName().compare(rightTask.getName());
+			if (compare != 0)
+				return compare < 0;
+			break;
+		}
+
+		case VIEWS::INCOMPLETE_FIRST:
+			if (leftTask.getCompleted() != rightTask.getCompleted())
+				return !leftTask.getCompleted();
+			if (leftTask.getDueSerial() != rightTask.getDueSerial())
+				return leftTask.getDueSerial() < rightTask.getDueSerial();
+			break;
+
+		default:
+			break;
+	}
+
+	return left->sequence < right->sequence;
+}
+
+// Name:   operator()(const Node* left, int dueSerial)
+// Desc:   Compares a node's due date against a serial date so the due date
+//         views can be searched without a node to compare against. In the
+//         incomplete first view the date stands for an incomplete task.
+// Param:  left: The node to compare.
+//         dueSerial: The serial date to compare against.
+// Return: A boolean: True if the node is listed before the date.
+bool NodeOrder::operator()(const Node* left, int dueSerial) const
+{
+	if (view == VIEWS::INCOMPLETE_FIRST && left->task.getCompleted())
+		return false;
+
+	return left->task.getDueSerial() < dueSerial;
+}
+
+// Name:   operator()(int dueSerial, const Node* right)
+// Desc:   Compares a serial date against a node's due date.
+// Param:  dueSerial: The serial date to compare.
+//         right: The node to compare against.
+// Return: A boolean: True if the date is listed before the node.
+bool NodeOrder::operator()(int dueSerial, const Node* right) const
+{
+	if (view == VIEWS::INCOMPLETE_FIRST && right->task.getCompleted())
+		return true;
+
+	return dueSerial < right->task.getDueSerial();
+}
+
+// Name:   const_iterator()
+// Desc:   Default constructor for an iterator that is not in a view.
+// Param:  None
+// Return: None
+SortedView::const_iterator::const_iterator()
+	: view(nullptr), chunk(0), position(0)
+{
+}
+
+// Name:   const_iterator(const SortedView* view, size_t chunk, size_t position)
+// Desc:   Constructor for an iterator at a position of a view.
+// Param:  view: The view to walk.
+//         chunk: The chunk the position is in, the number of chunks for the end.
+//         position: The position in the chunk.
+// Return: None
+SortedView::const_iterator::const_iterator(const SortedView* view, size_t chunk, size_t position)
+	: view(view), chunk(chunk), position(position)
+{
+}
+
+// Name:   operator*()
+// Desc:   Retrieve the node the iterator is at.
+// Param:  None
+// Return: A constant pointer to the current node.
+const Node* SortedView::const_iterator::operator*() const
+{
+	return view->get(view->chunks[chunk][position]);
+}
+
+// Name:   operator++()
+// Desc:   Move the iterator to the next node, which can be in the next chunk.
+// Param:  None
+// Return: A reference to this iterator.
+SortedView::const_iterator& SortedView::const_iterator::operator++()
+{
+	if (++position == view->chunks[chunk].size())
+	{
+		chunk++;
+		position = 0;
+	}
+
+	return *this;
+}
+
+// Name:   operator==(const const_iterator& other)
+// Desc:   Check if two iterators are at the same position.
+// Param:  other: The iterator to compare against.
+// Return: A boolean: True if the iterators are at the same position.
+bool SortedView::const_iterator::operator==(const const_iterator& other) const
+{
+	return chunk == other.chunk && position == other.position;
+}
+
+// Name:   operator!=(const const_iterator& other)
+// Desc:   Check if two iterators are at different positions.
+// Param:  other: The iterator to compare against.
+// Return: A boolean: True if the iterators are at different positions.
+bool SortedView::const_iterator::operator!=(const const_iterator& other) const
+{
+	return !(*this == other);
+}
+
+// Name:   SortedView(NodeOrder order, const NodePool& pool)
+// Desc:   Constructor for an empty view.
+// Param:  order: The order the view keeps its nodes in.
+//         pool: The pool the nodes of the view are in.
+// Return: None
+SortedView::SortedView(NodeOrder order, const NodePool& pool)
+	: order(order), pool(&pool), numNodes(0)
+{
+}
+
+// Name:   search(const Key& key)
+// Desc:   Find the first node that is not ordered before a key. The
+//         chunks are searched by their last node, then the chunk.
+// Param:  key: A node or a serial date to search for.
+// Return: An iterator at the node, or end() if every node is before the key.
+template <typename Key>
+SortedView::const_iterator SortedView::search(const Key& key) const
+{
+	const size_t chunk = std::partition_point(chunks.begin(), chunks.end(), [this, &key](const std::vector<uint32_t>& slots) {
+		return order(get(slots.back()), key);
+	}) - chunks.begin();
+
+	if (chunk == chunks.size())
+		return end();
+
+	const std::vector<uint32_t>& slots = chunks[chunk];
+	const size_t position = std::partition_point(slots.begin(), slots.end(), [this, &key](uint32_t slot) {
+		return order(get(slot), key);
+	}) - slots.begin();
+
+	return const_iterator(this, chunk, position);
+}
+
+// Name:   insert(const Node* node)
+// Desc:   Add a node at its sorted position. A full chunk first moves
+//         some of its slots to a neighbour that has room, and is only
+//         split in half when neither has. Tasks are mostly added near the
+//         end of a view, so splitting right away would leave every chunk
+//         behind the end half empty.
+// Param:  node: The node to add.
+// Return: None
+void SortedView::insert(const Node* node)
+{
+	if (chunks.empty())
+	{
+		append(node);
+		return;
+	}
+
+	const_iterator position = search(node);
+	size_t chunk = position == end() ? chunks.size() - 1 : position.chunk;
+	size_t offset = position == end() ? chunks[chunk].size() : position.position;
+
+	if (chunks[chunk].size() == maxChunkSize && chunk > 0 && chunks[chunk - 1].size() < maxChunkSize)
+	{
+		std::vector<uint32_t>& slots = chunks[chunk];
+		std::vector<uint32_t>& prevSlots = chunks[chunk - 1];
+		const size_t numMoved = (maxChunkSize - prevSlots.size() + 1) / 2;
+
+		prevSlots.insert(prevSlots.end(), slots.begin(), slots.begin() + numMoved);
+		slots.erase(slots.begin(), slots.begin() + numMoved);
+
+		if (offset < numMoved)
+		{
+			chunk--;
+			offset += prevSlots.size() - numMoved;
+		}
+		else
+			offset -= numMoved;
+	}
+	else if (chunks[chunk].size() == maxChunkSize && chunk + 1 < chunks.size() && chunks[chunk + 1].size() < maxChunkSize)
+	{
+		std::vector<uint32_t>& slots = chunks[chunk];
+		std::vector<uint32_t>& nextSlots = chunks[chunk + 1];
+		const size_t numMoved = (maxChunkSize - nextSlots.size() + 1) / 2;
+
+		nextSlots.insert(nextSlots.begin(), slots.end() - numMoved, slots.end());
+		slots.resize(slots.size() - numMoved);
+
+		if (offset > slots.size())
+		{
+			chunk++;
+			offset -= slots.size();
+		}
+	}
+	else if (chunks[chunk].size() == maxChunkSize)
+	{
+		std::vector<uint32_t> upper;
+		upper.reserve(maxChunkSize);
+		upper.assign(chunks[chunk].begin() + maxChunkSize / 2, chunks[chunk].end());
+		chunks[chunk].resize(maxChunkSize / 2);
+		chunks.insert(chunks.begin() + chunk + 1, std::move(upper));
+
+		if (offset > maxChunkSize / 2)
+		{
+			chunk++;
+			offset -= maxChunkSize / 2;
+		}
+	}
+
+	chunks[chunk].insert(chunks[chunk].begin() + offset, node->slot);
+	numNodes++;
+}
+
+// Name:   erase(const Node* node)
+// Desc:   Remove a node. An emptied chunk is dropped and a chunk that
+//         fits in half a chunk with the one after it is merged into it.
+// Param:  node: The node to remove, with the sort keys it was added with.
+// Return: None
+void SortedView::erase(const Node* node)
+{
+	const_iterator position = search(node);
+
+	if (position == end() || *position != node)
+		return;
+
+	std::vector<uint32_t>& slots = chunks[position.chunk];
+	slots.erase(slots.begin() + position.position);
+	numNodes--;
+
+	if (slots.empty())
+		chunks.erase(chunks.begin() + position.chunk);
+	else if (position.chunk + 1 < chunks.size() && slots.size() + chunks[position.chunk + 1].size() <= maxChunkSize / 2)
+	{
+		slots.insert(slots.end(), chunks[position.chunk + 1].begin(), chunks[position.chunk + 1].end());
+		chunks.erase(chunks.begin() + position.chunk + 1);
+	}
+}
+
+// Name:   append(const Node* node)
+// Desc:   Add a node after every node in the view. Used to fill the view
+//         in order, which leaves every chunk but the last one full.
+// Param:  node: The node to add, ordered after the last node.
+// Return: None
+void SortedView::append(const Node* node)
+{
+	if (chunks.empty() || chunks.back().size() == maxChunkSize)
+	{
+		chunks.emplace_back();
+		chunks.back().reserve(maxChunkSize);
+	}
+
+	chunks.back().push_back(node->slot);
+	numNodes++;
+}
+
+// Name:   clear()
+// Desc:   Remove every node and free the chunks.
+// Param:  None
+// Return: None
+void SortedView::clear()
+{
+	std::vector<std::vector<uint32_t>>().swap(chunks);
+	numNodes = 0;
+}
+
+// Name:   empty()
+// Desc:   Check if the view has no nodes.
+// Param:  None
+// Return: A boolean: True if the view is empty.
+bool SortedView::empty() const
+{
+	return numNodes == 0;
+}
+
+// Name:   size()
+// Desc:   Retrieve the number of nodes in the view.
+// Param:  None
+// Return: The number of nodes.
+size_t SortedView::size() const
+{
+	return numNodes;
+}
+
+// Name:   front()
+// Desc:   Retrieve the first node. Only valid if the view is not empty.
+// Param:  None
+// Return: A constant pointer to the node.
+const Node* SortedView::front() const
+{
+	return get(chunks.front().front());
+}
+
+// Name:   back()
+// Desc:   Retrieve the last node. Only valid if the view is not empty.
+// Param:  None
+// Return: A constant pointer to the node.
+const Node* SortedView::back() const
+{
+	return get(chunks.back().back());
+}
+
+// Name:   begin()
+// Desc:   Retrieve an iterator at the first node.
+// Param:  None
+// Return: An iterator, equal to end() if the view is empty.
+SortedView::const_iterator SortedView::begin() const
+{
+	return const_iterator(this, 0, 0);
+}
+
+// Name:   end()
+// Desc:   Retrieve an iterator past the last node.
+// Param:  None
+// Return: An iterator past the end of the view.
+SortedView::const_iterator SortedView::end() const
+{
+	return const_iterator(this, chunks.size(), 0);
+}
+
+// Name:   lower_bound(int dueSerial)
+// Desc:   Find the first node that is due on or after a date, in a view
+//         ordered by due date.
+// Param:  dueSerial: The serial date to search for.
+// Return: An iterator at the node, or end() if there is none.
+SortedView::const_iterator SortedView::lower_bound(int dueSerial) const
+{
+	return search(dueSerial);
+}
+
+// Name:   find(const Node* key)
+// Desc:   Find the node that has the same sort keys as a key node.
+// Param:  key: A node to compare against, it does not have to be in the view.
+// Return: An iterator at the node, or end() if there is none.
+SortedView::const_iterator SortedView::find(const Node* key) const
+{
+	const_iterator position = search(key);
+
+	if (position == end() || order(key, *position))
+		return end();
+
+	return position;
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the memory used by the chunks, including their unused room.
+// Param:  None
+// Return: The number of bytes.
+size_t SortedView::getMemoryUsed() const
+{
+	size_t bytes = chunks.capacity() * sizeof(std::vector<uint32_t>);
+
+	for (const std::vector<uint32_t>& slots : chunks)
+		bytes += slots.capacity() * sizeof(uint32_t);
+
+	return bytes;
+}
+
+// Name:   get(uint32_t slot)
+// Desc:   Retrieve the node in a pool slot.
+// Param:  slot: The slot of the node.
+// Return: A constant pointer to the node.
+const Node* SortedView::get(uint32_t slot) const
+{
+	return pool->get(slot);
+}
+
+// Name:   ViewIterator(const Node* node)
+// Desc:   Constructor for walking the linked list in insertion order.
+// Param:  node: The node to start from, nullptr for the end.
+// Return: None
+ViewIterator::ViewIterator(const Node* node)
+	: node(node), useList(true)
+{
+}
+
+// Name:   ViewIterator(SortedView::const_iterator position)
+// Desc:   Constructor for walking one of the sorted views.
+// Param:  position: The position in the sorted view to start from.
+// Return: None
+ViewIterator::ViewIterator(SortedView::const_iterator position)
+	: node(nullptr), position(position), useList(false)
+{
+}
+
+// Name:   operator*()
+// Desc:   Retrieve the node the iterator is at.
+// Param:  None
+// Return: A constant pointer to the current node.
+const Node* ViewIterator::operator*() const
+{
+	return useList ? node : *position;
+}
+
+// Name:   operator++()
+// Desc:   Move the iterator to the next node in the view.
+// Param:  None
+// Return: A reference to this iterator.
+ViewIterator& ViewIterator::operator++()
+{
+	if (useList)
+		node = node->next;
+	else
+		++position;
+
+	return *this;
+}
+
+// Name:   operator!=(const ViewIterator& other)
+// Desc:   Check if two iterators are at different positions.
+// Param:  other: The iterator to compare against.
+// Return: A boolean: True if the iterators are at different positions.
+bool ViewIterator::operator!=(const ViewIterator& other) const
+{
+	if (useList)
+		return node != other.node;
+
+	return position != other.position;
+}
+
+// Name:   getViewName(VIEWS view)
+// Desc:   Retrieve a display name for a view.
+// Param:  view: The view to name.
+// Return: A constant string with the name of the view.
+const char* TaskViews::getViewName(VIEWS view)
+{
+	switch (view)
+	{
+		case VIEWS::INSERTION_ORDER:
+			return "Insertion Order";
+		case VIEWS::BY_DUE_DATE:
+			return "Due Date";
+		case VIEWS::BY_NAME:
+			return "Name";
+		case VIEWS::INCOMPLETE_FIRST:
+			return "Incomplete First";
+		default:
+			return "Unknown";
+	}
+}
+
+// Name:   TaskViews(const NodePool& pool)
+// Desc:   Constructor that creates an empty index for each sorted view.
+// Param:  pool: The pool the nodes of the views are in.
+// Return: None
+TaskViews::TaskViews(const NodePool& pool)
+{
+	for (int view = 0; view < VIEWS::NUM_VIEWS; view++)
+		sorted.push_back(SortedView(NodeOrder{ (VIEWS)view }, pool));
+}
+
+// Name:   insert(const Node* node)
+// Desc:   Add a node to every sorted view.
+// Param:  node: The node to add.
+// Return: None
+void TaskViews::insert(const Node* node)
+{
+	// The insertion order view is the linked list itself
+	for (int view = VIEWS::INSERTION_ORDER + 1; view < VIEWS::NUM_VIEWS; view++)
+		sorted[view].insert(node);
+}
+
+// Name:   erase(const Node* node)
+// Desc:   Remove a node from every sorted view. This has to be called
+//         before any of the node's sort keys are changed.
+// Param:  node: The node to remove.
+// Return: None
+void TaskViews::erase(const Node* node)
+{
+	for (int view = VIEWS::INSERTION_ORDER + 1; view < VIEWS::NUM_VIEWS; view++)
+		sorted[view].erase(node);
+}
+
+// Name:   clear()
+// Desc:   Remove every node from the sorted views.
+// Param:  None
+// Return: None
+void TaskViews::clear()
+{
+	for (SortedView& view : sorted)
+		view.clear();
+}
+
+// Name:   rebuild(const Node* head)
+// Desc:   Rebuild every sorted view from the linked list. Sorting a vector
+//         and appending it in order is much faster than inserting the
+//         nodes one at a time when a whole file is loaded, and leaves
+//         the chunks full. The date views
+//         are sorted on packed integer keys so the sort does not have to
+//         visit the nodes, and large lists are sorted on the shared
+//         thread pool.
+// Param:  head: The head of the linked list.
+// Return: None
+void TaskViews::rebuild(const Node* head)
+{
+	std::vector<std::pair<uint64_t, const Node*>> keys;
+	std::vector<const Node*> nodes;
+
+	for (const Node* currNode = head; currNode; currNode = currNode->next)
+		nodes.push_back(currNode);
+
+	keys.reserve(nodes.size());
+
+	for (int view = VIEWS::INSERTION_ORDER + 1; view < VIEWS::NUM_VIEWS; view++)
+	{
+		sorted[view].clear();
+
+		// Key layout: name rank or completed flag and due serial, then sequence
+		keys.clear();
+		if (view == VIEWS::BY_NAME)
+		{
+			std::vector<uint32_t> ranks = getNameRanks(nodes);
+
+			for (size_t i = 0; i < nodes.size(); i++)
+				keys.push_back({ (uint64_t)ranks[i] << 32 | nodes[i]->sequence, nodes[i] });
+		}
+		else
+		{
+			for (const Node* node : nodes)
+			{
+				uint64_t key = (uint64_t)(uint32_t)(node->task.getDueSerial() + 1) << 32 | node->sequence;
+
+				if (view == VIEWS::INCOMPLETE_FIRST && node->task.getCompleted())
+					key |= (uint64_t)1 << 63;
+
+				keys.push_back({ key, node });
+			}
+		}
+
+		ParallelSort::sort(keys, std::less<std::pair<uint64_t, const Node*>>());
+
+		for (const std::pair<uint64_t, const Node*>& key : keys)
+			sorted[view].append(key.second);
+	}
+}
+
+// Name:   getNameRanks(const vector<const Node*>& nodes)
+// Desc:   Number the distinct task names in sorted order. Task lists
+//         repeat the same names a lot, so sorting the distinct names and
+//         then sorting the tasks by rank is much cheaper than comparing
+//         the names of every pair of tasks.
+// Param:  nodes: The nodes to rank.
+// Return: A vector with the name rank of each node.
+std::vector<uint32_t> TaskViews::getNameRanks(const std::vector<const Node*>& nodes)
+{
+	std::unordered_map<std::string_view, uint32_t> nameRanks;
+	std::vector<std::string_view> distinctNames;
+	std::vector<uint32_t> ranks;
+
+	ranks.reserve(nodes.size());
+
+	for (const Node* node : nodes)
+		nameRanks.emplace(node->task.getName(), 0);
+
+	for (const std::pair<const std::string_view, uint32_t>& name : nameRanks)
+		distinctNames.push_back(name.first);
+
+	std::sort(distinctNames.begin(), distinctNames.end());
+
+	for (size_t i = 0; i < distinctNames.size(); i++)
+		nameRanks[distinctNames[i]] = i;
+
+	for (const Node* node : nodes)
+		ranks.push_back(nameRanks[node->task.getName()]);
+
+	return ranks;
+}
+
+// Name:   begin(VIEWS view, const Node* head)
+// Desc:   Retrieve an iterator to the first task of a view.
+// Param:  view: The view to walk.
+//         head: The head of the linked list, used for the insertion order view.
+// Return: An iterator at the first task of the view.
+ViewIterator TaskViews::begin(VIEWS view, const Node* head) const
+{
+	if (view <= VIEWS::INSERTION_ORDER || view >= VIEWS::NUM_VIEWS)
+		return ViewIterator(head);
+
+	return ViewIterator(sorted[view].begin());
+}
+
+// Name:   end(VIEWS view)
+// Desc:   Retrieve an iterator past the last task of a view.
+// Param:  view: The view to walk.
+// Return: An iterator past the end of the view.
+ViewIterator TaskViews::end(VIEWS view) const
+{
+	if (view <= VIEWS::INSERTION_ORDER || view >= VIEWS::NUM_VIEWS)
+		return ViewIterator((const Node*)nullptr);
+
+	return ViewIterator(sorted[view].end());
+}
+
+// Name:   findDue(VIEWS view, int dueSerial)
+// Desc:   Find the first task in a view ordered by due date that is due on
+//         or after a date. In the incomplete first view this is the first
+//         such incomplete task, or the first completed task if there is none.
+// Param:  view: The due date or incomplete first view.
+//         dueSerial: The serial date to search for.
+// Return: An iterator into the view.
+ViewIterator TaskViews::findDue(VIEWS view, int dueSerial) const
+{
+	if (view != VIEWS::INCOMPLETE_FIRST)
+		view = VIEWS::BY_DUE_DATE;
+
+	return ViewIterator(sorted[view].lower_bound(dueSerial));
+}
+
+// Name:   find(int dueSerial, unsigned int sequence)
+// Desc:   Find a task by its due date and insertion sequence, which are
+//         the sort key of the due date view and never change.
+// Param:  dueSerial: The serial due date of the task.
+//         sequence: The insertion sequence of the task.
+// Return: A constant pointer to the node, or nullptr if there is none.
+const Node* TaskViews::find(int dueSerial, unsigned int sequence) const
+{
+	Node key("", Date::fromSerial(dueSerial), false);
+	key.sequence = sequence;
+
+	SortedView::const_iterator position = sorted[VIEWS::BY_DUE_DATE].find(&key);
+
+	return position == sorted[VIEWS::BY_DUE_DATE].end() ? nullptr : *position;
+}
+
+// Name:   getDueRange(int& firstSerial, int& lastSerial)
+// Desc:   Retrieve the earliest and latest due dates from the ends of the
+//         due date view.
+// Param:  firstSerial: Receives the earliest serial date.
+//         lastSerial: Receives the latest serial date.
+// Return: A boolean: False if the view is empty.
+bool TaskViews::getDueRange(int& firstSerial, int& lastSerial) const
+{
+	const SortedView& dueView = sorted[VIEWS::BY_DUE_DATE];
+
+	if (dueView.empty())
+		return false;
+
+	firstSerial = dueView.front()->task.getDueSerial();
+	lastSerial = dueView.back()->task.getDueSerial();
+
+	return true;
+}
+
+// Name:   getNextDue(int count)
+// Desc:   Retrieve the incomplete tasks that are due the soonest. The
+//         incomplete first view keeps incomplete tasks ordered by due date
+//         at its front, so this only reads the first few entries of it.
+// Param:  count: The maximum number of tasks to retrieve.
+// Return: A vector of the next due tasks, soonest first.
+std::vector<const Node*> TaskViews::getNextDue(int count) const
+{
+	std::vector<const Node*> nextDue;
+
+	for (const Node* node : sorted[VIEWS::INCOMPLETE_FIRST])
+	{
+		if ((int)nextDue.size() >= count || node->task.getCompleted())
+			break;
+
+		nextDue.push_back(node);
+	}
+
+	return nextDue;
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the memory used by the sorted views.
+// Param:  None
+// Return: The number of bytes.
+size_t TaskViews::getMemoryUsed() const
+{
+	size_t bytes = sorted.capacity() * sizeof(SortedView);
+
+	for (const SortedView& view : sorted)
+		bytes += view.getMemoryUsed();
+
+	return bytes;
+}
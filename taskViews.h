@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*****************************************************************************
+# Description: An enum of the orders a task list can be displayed in.
+               The TaskViews class keeps a sorted index of the tasks for
+			   every view so switching between them does not need a sort.
+			   The views are updated one task at a time as tasks are
+			   added, removed and completed.
+			   The SortedView class is one sorted index. It keeps the pool
+			   slots of the nodes, 4 bytes per task, in sorted chunks of
+			   at most 512 slots, so an insert only moves part of a chunk
+			   and there is no tree node per task.
+#****************************************************************************/
+
+enum VIEWS { INSERTION_ORDER, BY_DUE_DATE, BY_NAME, INCOMPLETE_FIRST, NUM_VIEWS };
+
+struct Node;
+class NodePool;
+
+struct NodeOrder
+{
+	typedef void is_transparent;
+
+	bool operator()(const Node* left, const Node* right) const;
+	bool operator()(const Node* left, int dueSerial) const;
+	bool operator()(int dueSerial, const Node* right) const;
+
+	VIEWS view;
+};
+
+class SortedView
+{
+public:
+	static const size_t maxChunkSize = 512;
+
+	class const_iterator
+	{
+	public:
+		const_iterator();
+		const_iterator(const SortedView* view, size_t chunk, size_t position);
+
+		const Node* operator*() const;
+		const_iterator& operator++();
+		bool operator==(const const_iterator& other) const;
+		bool operator!=(const const_iterator& other) const;
+
+	private:
+		friend class SortedView;
+
+		const SortedView* view;
+		size_t chunk;
+		size_t position;
+	};
+
+	SortedView(NodeOrder order, const NodePool& pool);
+
+	void insert(const Node* node);
+	void erase(const Node* node);
+	void append(const Node* node);
+	void clear();
+
+	bool empty() const;
+	size_t size() const;
+	const Node* front() const;
+	const Node* back() const;
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator lower_bound(int dueSerial) const;
+	const_iterator find(const Node* key) const;
+	size_t getMemoryUsed() const;
+
+private:
+	template <typename Key>
+	const_iterator search(const Key& key) const;
+	const Node* get(uint32_t slot) const;
+
+	NodeOrder order;
+	const NodePool* pool;
+	std::vector<std::vector<uint32_t>> chunks;
+	size_t numNodes;
+};
+
+class ViewIterator
+{
+public:
+	ViewIterator(const Node* node);
+	ViewIterator(SortedView::const_iterator position);
+
+	const Node* operator*() const;
+	ViewIterator& operator++();
+	bool operator!=(const ViewIterator& other) const;
+
+private:
+	const Node* node;
+	SortedView::const_iterator position;
+	bool useList;
+};
+
+class TaskViews
+{
+public:
+	static const char* getViewName(VIEWS view);
+
+	TaskViews(const NodePool& pool);
+
+	void insert(const Node* node);
+	void erase(const Node* node);
+	void clear();
+	void rebuild(const Node* head);
+
+	ViewIterator begin(VIEWS view, const Node* head) const;
+	ViewIterator end(VIEWS view) const;
+	ViewIterator findDue(VIEWS view, int dueSerial) const;
+	const Node* find(int dueSerial, unsigned int sequence) const;
+	bool getDueRange(int& firstSerial, int& lastSerial) const;
+	std::vector<const Node*> getNextDue(int count) const;
+	size_t getMemoryUsed() const;
+
+private:
+	static std::vector<uint32_t> getNameRanks(const std::vector<const Node*>& nodes);
+
+	std::vector<SortedView> sorted;
+};
@@ -0,0 +1,77 @@
+#include "threadPool.h"
+
+// Name:   getDefaultThreadCount()
+// Desc:   Retrieve the number of threads to use when none is given.
+// Param:  None
+// Return: The number of hardware threads, at least 1.
+int ThreadPool::getDefaultThreadCount()
+{
+	const int numThreads = std::thread::hardware_concurrency();
+
+	return numThreads > 0 ? numThreads : 1;
+}
+
+// Name:   ThreadPool(int numThreads)
+// Desc:   Constructor that starts the worker threads.
+// Param:  numThreads: The number of worker threads to start.
+// Return: None
+ThreadPool::ThreadPool(int numThreads)
+	: stopping(false)
+{
+	if (numThreads < 1)
+		numThreads = 1;
+
+	for (int i = 0; i < numThreads; i++)
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+// Name:   ~ThreadPool()
+// Desc:   Destructor. Finishes the queued jobs and stops the workers.
+// Param:  None
+// Return: None
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+
+	jobAdded.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+// Name:   getNumThreads()
+// Desc:   Retrieve the number of worker threads.
+// Param:  None
+// Return: The number of worker threads.
+int ThreadPool::getNumThreads() const
+{
+	return workers.size();
+}
+
+// Name:   workerLoop()
+// Desc:   Run queued jobs until the pool is stopped and the queue is empty.
+// Param:  None
+// Return: None
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			jobAdded.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+			if (jobs.empty())
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop();
+		}
+
+		job();
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+/*****************************************************************************
+# Description: The ThreadPool class runs jobs on a fixed set of worker
+               threads. Submitting a job returns a future for its result.
+#****************************************************************************/
+
+class ThreadPool
+{
+public:
+	static int getDefaultThreadCount();
+
+	ThreadPool(int numThreads = getDefaultThreadCount());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int getNumThreads() const;
+
+	// Name:   submit(Function job)
+	// Desc:   Queue a job to run on one of the worker threads.
+	// Param:  job: A callable object that takes no parameters.
+	// Return: A future that receives the job's result.
+	template <typename Function>
+	auto submit(Function job) -> std::future<decltype(job())>
+	{
+		typedef decltype(job()) Result;
+		std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(std::move(job));
+		std::future<Result> result = task->get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			jobs.push([task]() { (*task)(); });
+		}
+
+		jobAdded.notify_one();
+
+		return result;
+	}
+
+private:
+	void workerLoop();
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> jobs;
+	std::mutex queueMutex;
+	std::condition_variable jobAdded;
+	bool stopping;
+};
@@ -0,0 +1,295 @@
+#include "timingWheel.h"
+
+// Name:   TimingWheel(int64_t startTime)
+// Desc:   Constructor for an empty wheel.
+// Param:  startTime: The current time in seconds.
+// Return: None
+TimingWheel::TimingWheel(int64_t startTime)
+{
+	clear(startTime);
+}
+
+// Name:   schedule(uint32_t id, int64_t expires)
+// Desc:   Start a timer, or move it if it is already scheduled. A timer
+//         that expires at or before the current time fires on the next
+//         advance.
+// Param:  id: The id of the timer.
+//         expires: The time in seconds the timer fires at.
+// Return: None
+void TimingWheel::schedule(uint32_t id, int64_t expires)
+{
+	if (id >= timers.size())
+		timers.resize(id + 1, Timer{ 0, noTimer, noTimer, notListed });
+
+	if (timers[id].list != notListed)
+		unlink(id);
+	else
+		numScheduled++;
+
+	timers[id].expires = expires;
+	link(id, getList(expires));
+}
+
+// Name:   cancel(uint32_t id)
+// Desc:   Stop a timer. Ids that are not scheduled are ignored.
+// Param:  id: The id of the timer.
+// Return: None
+void TimingWheel::cancel(uint32_t id)
+{
+	if (!isScheduled(id))
+		return;
+
+	unlink(id);
+	numScheduled--;
+}
+
+// Name:   clear(int64_t startTime)
+// Desc:   Stop every timer and set the current time.
+// Param:  startTime: The current time in seconds.
+// Return: None
+void TimingWheel::clear(int64_t startTime)
+{
+	timers.clear();
+
+	for (uint32_t& head : heads)
+		head = noTimer;
+	for (uint64_t& used : usedSlots)
+		used = 0;
+
+	currentTime = startTime;
+	numScheduled = 0;
+}
+
+// Name:   advance(int64_t now, const ExpireFunction& expire)
+// Desc:   Move the current time forward and fire every timer that
+//         expires up to it, in order of expiry. The current time is the
+//         expiry of each timer while it fires, so the function can
+//         schedule the next timer of an id from there, and it can
+//         schedule or cancel any other timer.
+// Param:  now: The new current time in seconds, earlier times are ignored.
+//         expire: The function called with the id of each timer that fires.
+// Return: The number of timers that fired.
+size_t TimingWheel::advance(int64_t now, const ExpireFunction& expire)
+{
+	size_t numExpired = 0;
+
+	while (true)
+	{
+		while (heads[expiredList] != noTimer)
+		{
+			const uint32_t id = heads[expiredList];
+
+			unlink(id);
+			numScheduled--;
+			numExpired++;
+			expire(id);
+		}
+
+		uint16_t list = 0;
+		const int64_t nextTime = findNextList(list);
+
+		if (nextTime > now)
+			break;
+
+		// Every level below the list is empty, so the time can jump to it
+		currentTime = nextTime;
+		cascade(list);
+	}
+
+	if (now > currentTime)
+		currentTime = now;
+
+	return numExpired;
+}
+
+// Name:   isScheduled(uint32_t id)
+// Desc:   Check if a timer is waiting to fire.
+// Param:  id: The id of the timer.
+// Return: A boolean: True if the timer is scheduled.
+bool TimingWheel::isScheduled(uint32_t id) const
+{
+	return id < timers.size() && timers[id].list != notListed;
+}
+
+// Name:   getExpiry(uint32_t id)
+// Desc:   Retrieve the time a scheduled timer fires at.
+// Param:  id: The id of a scheduled timer.
+// Return: The expiry time in seconds.
+int64_t TimingWheel::getExpiry(uint32_t id) const
+{
+	return timers[id].expires;
+}
+
+// Name:   getTime()
+// Desc:   Retrieve the current time of the wheel.
+// Param:  None
+// Return: The time in seconds the wheel was last advanced to.
+int64_t TimingWheel::getTime() const
+{
+	return currentTime;
+}
+
+// Name:   getNextExpiry()
+// Desc:   Find when the wheel next has to be advanced. For a slot of a
+//         higher level this is the start of the slot, which can be before
+//         the first timer in it.
+// Param:  None
+// Return: The time in seconds, INT64_MAX if no timer is scheduled.
+int64_t TimingWheel::getNextExpiry() const
+{
+	uint16_t list = 0;
+
+	if (heads[expiredList] != noTimer)
+		return currentTime;
+
+	return findNextList(list);
+}
+
+// Name:   getNumScheduled()
+// Desc:   Retrieve the number of timers waiting to fire.
+// Param:  None
+// Return: The number of scheduled timers.
+size_t TimingWheel::getNumScheduled() const
+{
+	return numScheduled;
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the bytes used by the timers.
+// Param:  None
+// Return: The number of bytes.
+size_t TimingWheel::getMemoryUsed() const
+{
+	return timers.capacity() * sizeof(Timer);
+}
+
+// Name:   getList(int64_t expires)
+// Desc:   Find the list a timer belongs in at the current time: the slot
+//         of the highest 6 bit group where its expiry differs from the
+//         current time.
+// Param:  expires: The expiry time of the timer.
+// Return: The index of the list.
+uint16_t TimingWheel::getList(int64_t expires) const
+{
+	if (expires <= currentTime)
+		return expiredList;
+
+	const uint64_t differentBits = (uint64_t)expires ^ (uint64_t)currentTime;
+	const int level = (63 - __builtin_clzll(differentBits)) / bitsPerLevel;
+
+	if (level >= numLevels)
+		return overflowList;
+
+	const int slot = ((uint64_t)expires >> (level * bitsPerLevel)) & (slotsPerLevel - 1);
+
+	return level * slotsPerLevel + slot;
+}
+
+// Name:   link(uint32_t id, uint16_t list)
+// Desc:   Add a timer to the front of a list and mark its slot as used.
+// Param:  id: The id of the timer.
+//         list: The index of the list.
+// Return: None
+void TimingWheel::link(uint32_t id, uint16_t list)
+{
+	Timer& timer = timers[id];
+
+	timer.list = list;
+	timer.prev = noTimer;
+	timer.next = heads[list];
+
+	if (timer.next != noTimer)
+		timers[timer.next].prev = id;
+
+	heads[list] = id;
+
+	if (list < expiredList)
+		usedSlots[list / slotsPerLevel] |= (uint64_t)1 << (list % slotsPerLevel);
+}
+
+// Name:   unlink(uint32_t id)
+// Desc:   Remove a timer from its list and clear the slot's bit once the
+//         list is empty.
+// Param:  id: The id of a scheduled timer.
+// Return: None
+void TimingWheel::unlink(uint32_t id)
+{
+	Timer& timer = timers[id];
+
+	if (timer.prev != noTimer)
+		timers[timer.prev].next = timer.next;
+	else
+		heads[timer.list] = timer.next;
+
+	if (timer.next != noTimer)
+		timers[timer.next].prev = timer.prev;
+
+	if (timer.list < expiredList && heads[timer.list] == noTimer)
+		usedSlots[timer.list / slotsPerLevel] &= ~((uint64_t)1 << (timer.list % slotsPerLevel));
+
+	timer.list = notListed;
+}
+
+// Name:   cascade(uint16_t list)
+// Desc:   Move every timer of a list to the list it belongs in now that
+//         the current time has reached it. Timers of a level 0 slot, and
+//         any others that expire now, go to the expired list, and
+//         overflow timers that are still too far ahead go back to the
+//         overflow list.
+// Param:  list: The index of the list.
+// Return: None
+void TimingWheel::cascade(uint16_t list)
+{
+	uint32_t id = heads[list];
+
+	// The list is taken whole first, overflow timers can go back into it
+	heads[list] = noTimer;
+
+	if (list < expiredList)
+		usedSlots[list / slotsPerLevel] &= ~((uint64_t)1 << (list % slotsPerLevel));
+
+	while (id != noTimer)
+	{
+		const uint32_t nextId = timers[id].next;
+
+		link(id, getList(timers[id].expires));
+		id = nextId;
+	}
+}
+
+// Name:   findNextList(uint16_t& list)
+// Desc:   Find the first used slot after the current time on the lowest
+//         level that has one, or the overflow list if every level is
+//         empty. Only the slots after the current position of a level
+//         can be used, the earlier ones were moved down or fired.
+// Param:  list: Receives the index of the list.
+// Return: The time the list is reached, INT64_MAX if there is none.
+int64_t TimingWheel::findNextList(uint16_t& list) const
+{
+	for (int level = 0; level < numLevels; level++)
+	{
+		const int shift = level * bitsPerLevel;
+		const int position = ((uint64_t)currentTime >> shift) & (slotsPerLevel - 1);
+		const uint64_t ahead = position == slotsPerLevel - 1 ? 0 : usedSlots[level] & (~(uint64_t)0 << (position + 1));
+
+		if (ahead)
+		{
+			const int slot = __builtin_ctzll(ahead);
+			const int windowShift = shift + bitsPerLevel;
+
+			list = level * slotsPerLevel + slot;
+
+			return (int64_t)(((uint64_t)currentTime >> windowShift << windowShift) | ((uint64_t)slot << shift));
+		}
+	}
+
+	if (heads[overflowList] == noTimer)
+		return INT64_MAX;
+
+	// The overflow timers are sorted out again when the top level starts a new window
+	const int topShift = numLevels * bitsPerLevel;
+
+	list = overflowList;
+
+	return (int64_t)((((uint64_t)currentTime >> topShift) + 1) << topShift);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+
+/*****************************************************************************
+# Description: The TimingWheel class schedules timers by id, each with an
+               expiry time in seconds, and fires them as time advances.
+			   It is a hierarchical wheel of 5 levels of 64 slots. A timer
+			   is kept on the level of the highest 6 bit group where its
+			   expiry differs from the current time, in the slot of that
+			   group, so adding and cancelling a timer only links or
+			   unlinks it from one slot list. When time reaches a slot of
+			   a higher level its timers move down to the lower levels,
+			   and a bitmap of the used slots of each level lets an
+			   advance jump straight to the next used slot, so skipping
+			   days or years of empty time costs a few steps. Timers
+			   that differ above the top level wait in an overflow list.
+			   The ids are small dense numbers such as node slots.
+#****************************************************************************/
+
+class TimingWheel
+{
+public:
+	typedef std::function<void(uint32_t id)> ExpireFunction;
+
+	static const int numLevels = 5;
+	static const int slotsPerLevel = 64;
+	static const int bitsPerLevel = 6;
+
+	TimingWheel(int64_t startTime = 0);
+
+	void schedule(uint32_t id, int64_t expires);
+	void cancel(uint32_t id);
+	void clear(int64_t startTime);
+	size_t advance(int64_t now, const ExpireFunction& expire);
+
+	bool isScheduled(uint32_t id) const;
+	int64_t getExpiry(uint32_t id) const;
+	int64_t getTime() const;
+	int64_t getNextExpiry() const;
+	size_t getNumScheduled() const;
+	size_t getMemoryUsed() const;
+
+private:
+	static const uint32_t noTimer = UINT32_MAX;
+	static const uint16_t notListed = UINT16_MAX;
+
+	// The lists after the slots of the levels
+	static const uint16_t expiredList = numLevels * slotsPerLevel;
+	static const uint16_t overflowList = expiredList + 1;
+	static const uint16_t numLists = overflowList + 1;
+
+	struct Timer
+	{
+		int64_t expires;
+		uint32_t next;
+		uint32_t prev;
+		uint16_t list;
+	};
+
+	uint16_t getList(int64_t expires) const;
+	void link(uint32_t id, uint16_t list);
+	void unlink(uint32_t id);
+	void cascade(uint16_t list);
+	int64_t findNextList(uint16_t& list) const;
+
+	std::vector<Timer> timers;
+	uint32_t heads[numLists];
+	uint64_t usedSlots[numLevels];
+	int64_t currentTime;
+	size_t numScheduled;
+};
@@ -0,0 +1,275 @@
+#include "traceReplay.h"
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <sys/resource.h>
+
+// Name:   getScratchName(const string& fileName)
+// Desc:   Find the name a replay saves to: the task file's name with
+//         .replay before its extension, so it is saved in the same format.
+// Param:  fileName: The name of the task file.
+// Return: A string with the name of the scratch file.
+std::string TraceReplay::getScratchName(const std::string& fileName)
+{
+	std::filesystem::path path(fileName);
+	const std::string extension = path.extension().string();
+
+	path.replace_extension();
+
+	return path.string() + ".replay" + extension;
+}
+
+// Name:   getPeakResidentBytes()
+// Desc:   Retrieve the most memory the process has held in RAM so far.
+// Param:  None
+// Return: The number of bytes, 0 if it is not known.
+size_t TraceReplay::getPeakResidentBytes()
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	// Linux reports the peak in kilobytes
+	return (size_t)usage.ru_maxrss * 1024;
+}
+
+// Name:   TraceReplay(TaskManager& manager, const string& fileName)
+// Desc:   Constructor that sets the task manager and the task file a
+//         replay starts from.
+// Param:  manager: The task manager to run the trace against.
+//         fileName: The name of the task file.
+// Return: None
+TraceReplay::TraceReplay(TaskManager& manager, const std::string& fileName)
+	: manager(manager), fileName(fileName), scratchName(getScratchName(fileName)), saved(false), numSkipped(0),
+	loadSeconds(0), totalSeconds(0)
+{
+}
+
+// Name:   run(const string& traceName)
+// Desc:   Load the task file and run every operation of a trace, one line
+//         at a time so a long trace is never held in memory. Blank lines
+//         are ignored.
+// Param:  traceName: The name of the trace file.
+// Return: A boolean: False if the trace has a malformed line or a file
+//         could not be read or written, see getError().
+bool TraceReplay::run(const std::string& traceName)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	std::ifstream trace(traceName);
+	std::string line;
+	TraceOp op;
+	uint64_t lineNum = 0;
+
+	if (!trace)
+	{
+		error = "Could not open " + traceName + ".";
+		return false;
+	}
+
+	for (std::vector<double>& opLatencies : latencies)
+		opLatencies.clear();
+	numSkipped = 0;
+	saved = false;
+	error.clear();
+
+	Clock::time_point start = Clock::now();
+	if (!load(fileName))
+		return false;
+	loadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+	collectNodes();
+
+	totalSeconds = 0;
+
+	while (std::getline(trace, line))
+	{
+		lineNum++;
+
+		if (line.empty())
+			continue;
+
+		if (!Workload::parseOp(line, op))
+		{
+			error = "Line " + std::to_string(lineNum) + " of " + traceName + " is not an operation.";
+			return false;
+		}
+
+		start = Clock::now();
+		const bool ran = runOp(op);
+		const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		if (!error.empty())
+			return false;
+
+		if (!ran)
+		{
+			numSkipped++;
+			continue;
+		}
+
+		latencies[op.op].push_back(seconds);
+		totalSeconds += seconds;
+
+		// The nodes to pick from are collected outside the timing
+		if (op.op == TRACE_OPS::OP_LOAD)
+			collectNodes();
+	}
+
+	return true;
+}
+
+// Name:   getError()
+// Desc:   Retrieve the reason the last replay stopped.
+// Param:  None
+// Return: A constant reference to the message.
+const std::string& TraceReplay::getError() const
+{
+	return error;
+}
+
+// Name:   getLoadSeconds()
+// Desc:   Retrieve the time the task file took to load before the trace.
+// Param:  None
+// Return: The time in seconds.
+double TraceReplay::getLoadSeconds() const
+{
+	return loadSeconds;
+}
+
+// Name:   getTotalSeconds()
+// Desc:   Retrieve the time spent in the operations of the trace.
+// Param:  None
+// Return: The time in seconds.
+double TraceReplay::getTotalSeconds() const
+{
+	return totalSeconds;
+}
+
+// Name:   getNumOps(TRACE_OPS op)
+// Desc:   Retrieve the number of operations of a kind that ran.
+// Param:  op: The kind of operation.
+// Return: The number of operations.
+uint64_t TraceReplay::getNumOps(TRACE_OPS op) const
+{
+	return latencies[op].size();
+}
+
+// Name:   getNumSkipped()
+// Desc:   Retrieve the number of completes and deletes that had no task
+//         to pick because the list was empty.
+// Param:  None
+// Return: The number of operations.
+uint64_t TraceReplay::getNumSkipped() const
+{
+	return numSkipped;
+}
+
+// Name:   getPercentile(TRACE_OPS op, double percentile)
+// Desc:   Retrieve a percentile of the latencies of a kind of operation.
+//         The latencies are partly reordered to find it.
+// Param:  op: The kind of operation.
+//         percentile: The percentile from 0 to 100.
+// Return: The latency in seconds, 0 if no such operation ran.
+double TraceReplay::getPercentile(TRACE_OPS op, double percentile)
+{
+	std::vector<double>& values = latencies[op];
+
+	if (values.empty())
+		return 0;
+
+	size_t position = std::min(values.size() - 1, (size_t)(values.size() * percentile / 100));
+	std::nth_element(values.begin(), values.begin() + position, values.end());
+
+	return values[position];
+}
+
+// Name:   load(const string& fileName)
+// Desc:   Load a task file.
+// Param:  fileName: The name of the file.
+// Return: A boolean: True if the file was loaded.
+bool TraceReplay::load(const std::string& fileName)
+{
+	if (!manager.checkFileExists(fileName) || !manager.loadFromFile(fileName))
+	{
+		error = "Could not load " + fileName + ".";
+		return false;
+	}
+
+	return true;
+}
+
+// Name:   collectNodes()
+// Desc:   Collect the nodes of a list that was just loaded to pick from.
+// Param:  None
+// Return: None
+void TraceReplay::collectNodes()
+{
+	liveNodes.clear();
+
+	for (const Node* currNode = manager.getTasks(); currNode; currNode = currNode->next)
+		liveNodes.push_back(currNode);
+}
+
+// Name:   runOp(const TraceOp& op)
+// Desc:   Run one operation of a trace.
+// Param:  op: The operation.
+// Return: A boolean: False if it was skipped because there was no task
+//         to pick, or it failed and set the error.
+bool TraceReplay::runOp(const TraceOp& op)
+{
+	switch (op.op)
+	{
+		case TRACE_OPS::OP_ADD:
+			manager.addTask(op.name, Date::fromSerial(op.serial));
+			liveNodes.push_back(manager.getLastTask());
+			return true;
+
+		case TRACE_OPS::OP_COMPLETE:
+			if (liveNodes.empty())
+				return false;
+
+			manager.completeTask(liveNodes[op.pick % liveNodes.size()]);
+			return true;
+
+		case TRACE_OPS::OP_DELETE:
+		{
+			if (liveNodes.empty())
+				return false;
+
+			const size_t position = op.pick % liveNodes.size();
+
+			manager.deleteTask(liveNodes[position]);
+			liveNodes[position] = liveNodes.back();
+			liveNodes.pop_back();
+			return true;
+		}
+
+		case TRACE_OPS::OP_DISPLAY:
+		{
+			int numShown = 0;
+
+			page.clear();
+			for (ViewIterator pos = manager.viewBegin((VIEWS)op.view); pos != manager.viewEnd((VIEWS)op.view) && numShown < op.count; ++pos, numShown++)
+				page += TaskManager::formatTaskLine((*pos)->task) + "\n";
+			return true;
+		}
+
+		case TRACE_OPS::OP_SAVE:
+			if (!manager.saveToFile(scratchName))
+			{
+				error = "Could not save " + scratchName + ".";
+				return false;
+			}
+
+			saved = true;
+			return true;
+
+		case TRACE_OPS::OP_LOAD:
+			return load(saved ? scratchName : fileName);
+
+		default:
+			return false;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "workload.h"
+
+/*****************************************************************************
+# Description: The TraceReplay class runs a trace against a task manager
+               without the menu and times every operation. Tasks to
+			   complete or delete are picked from an array of the live
+			   nodes, and a display formats a page of a view the way a
+			   save would, so only the work of the task manager is timed.
+			   Saves go to a scratch file next to the task file, in the
+			   same format, and a load reads the scratch file once there
+			   is one, so the task file itself is never written.
+#****************************************************************************/
+
+class TraceReplay
+{
+public:
+	static std::string getScratchName(const std::string& fileName);
+	static size_t getPeakResidentBytes();
+
+	TraceReplay(TaskManager& manager, const std::string& fileName);
+	TraceReplay(const TraceReplay& origReplay) = delete;
+	const TraceReplay& operator=(const TraceReplay& origReplay) = delete;
+
+	bool run(const std::string& traceName);
+
+	const std::string& getError() const;
+	double getLoadSeconds() const;
+	double getTotalSeconds() const;
+	uint64_t getNumOps(TRACE_OPS op) const;
+	uint64_t getNumSkipped() const;
+	double getPercentile(TRACE_OPS op, double percentile);
+
+private:
+	bool load(const std::string& fileName);
+	void collectNodes();
+	bool runOp(const TraceOp& op);
+
+	TaskManager& manager;
+	std::string fileName;
+	std::string scratchName;
+	bool saved;
+	std::vector<const Node*> liveNodes;
+	std::string page;
+	std::vector<double> latencies[TRACE_OPS::NUM_TRACE_OPS];
+	uint64_t numSkipped;
+	double loadSeconds;
+	double totalSeconds;
+	std::string error;
+};
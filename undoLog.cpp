@@ -0,0 +1,389 @@
+#include "undoLog.h"
+#include <algorithm>
+#include <utility>
+
+// Name:   getActionName(UNDO_ACTIONS action)
+// Desc:   Retrieve a display name for a change.
+// Param:  action: The change to name.
+// Return: A constant string with the name of the change.
+const char* UndoLog::getActionName(UNDO_ACTIONS action)
+{
+	switch (action)
+	{
+		case UNDO_ACTIONS::ADD_TASK:
+			return "Add Task";
+		case UNDO_ACTIONS::REMOVE_TASK:
+			return "Remove Task";
+		case UNDO_ACTIONS::COMPLETE_TASK:
+			return "Complete Task";
+		default:
+			return "Unknown";
+	}
+}
+
+// Name:   UndoLog(size_t memoryLimit)
+// Desc:   Constructor that creates an empty history.
+// Param:  memoryLimit: The most bytes the history may use.
+// Return: None
+UndoLog::UndoLog(size_t memoryLimit)
+	: first(0), numRecords(0), numDone(0), lineBytes(0), memoryLimit(memoryLimit)
+{
+
+}
+
+// Name:   clear()
+// Desc:   Forget every change, for when the list is replaced or changed
+//         in a way the history does not know about.
+// Param:  None
+// Return: None
+void UndoLog::clear()
+{
+	std::vector<UndoRecord>().swap(records);
+	first = 0;
+	numRecords = 0;
+	numDone = 0;
+	lineBytes = 0;
+}
+
+// Name:   setMemoryLimit(size_t memoryLimit)
+// Desc:   Change the most memory the history may use. The history is
+//         cleared since the ring buffer is sized from the limit.
+// Param:  memoryLimit: The most bytes the history may use.
+// Return: None
+void UndoLog::setMemoryLimit(size_t memoryLimit)
+{
+	clear();
+	this->memoryLimit = memoryLimit;
+}
+
+// Name:   getMemoryUsed()
+// Desc:   Retrieve the memory used by the ring buffer and the saved lines.
+// Param:  None
+// Return: The number of bytes used.
+size_t UndoLog::getMemoryUsed() const
+{
+	return records.size() * sizeof(UndoRecord) + lineBytes;
+}
+
+// Name:   recordAdd(const Node* node)
+// Desc:   Record a task that was just added.
+// Param:  node: The node of the new task.
+// Return: None
+void UndoLog::recordAdd(const Node* node)
+{
+	if (!node)
+		return;
+
+	UndoRecord record;
+	record.action = UNDO_ACTIONS::ADD_TASK;
+	record.occurrenceSerial = -1;
+
+	// Redo puts the task back from its line, since undo removes the node
+	record.line = TaskManager::formatTaskLine(node->task);
+	record.nameLength = node->task.getName().size();
+	push(record, node);
+}
+
+// Name:   recordRemove(const Node* node)
+// Desc:   Record a task that is about to be removed.
+// Param:  node: The node of the task.
+// Return: None
+void UndoLog::recordRemove(const Node* node)
+{
+	if (!node)
+		return;
+
+	UndoRecord record;
+	record.action = UNDO_ACTIONS::REMOVE_TASK;
+	record.occurrenceSerial = -1;
+	record.line = TaskManager::formatTaskLine(node->task);
+	record.nameLength = node->task.getName().size();
+	push(record, node);
+}
+
+// Name:   recordComplete(const Node* node, int serial)
+// Desc:   Record a task or occurrence that is about to be completed.
+//         Nothing is recorded if it is already completed.
+// Param:  node: The node of the task.
+//         serial: The serial date of the occurrence of a recurring task,
+//         -1 to complete the whole task.
+// Return: None
+void UndoLog::recordComplete(const Node* node, int serial)
+{
+	if (!node)
+		return;
+
+	const Recurrence* rule = node->task.getRecurrence();
+
+	if (!rule || serial < 0)
+	{
+		if (node->task.getCompleted())
+			return;
+
+		serial = -1;
+	}
+	else if (rule->isOccurrenceCompleted(serial))
+		return;
+
+	UndoRecord record;
+	record.action = UNDO_ACTIONS::COMPLETE_TASK;
+	record.occurrenceSerial = serial;
+	record.nameLength = 0;
+	push(record, node);
+}
+
+// Name:   canUndo()
+// Desc:   Check if there is a change to undo.
+// Param:  None
+// Return: A boolean: True if undo() has a change to reverse.
+bool UndoLog::canUndo() const
+{
+	return numDone > 0;
+}
+
+// Name:   canRedo()
+// Desc:   Check if there is an undone change to apply again.
+// Param:  None
+// Return: A boolean: True if redo() has a change to apply.
+bool UndoLog::canRedo() const
+{
+	return numDone < numRecords;
+}
+
+// Name:   getUndoAction()
+// Desc:   Retrieve the change undo() would reverse. Only valid if canUndo().
+// Param:  None
+// Return: The action of the last change.
+UNDO_ACTIONS UndoLog::getUndoAction() const
+{
+	return getRecord(numDone - 1).action;
+}
+
+// Name:   getRedoAction()
+// Desc:   Retrieve the change redo() would apply. Only valid if canRedo().
+// Param:  None
+// Return: The action of the last undone change.
+UNDO_ACTIONS UndoLog::getRedoAction() const
+{
+	return getRecord(numDone).action;
+}
+
+// Name:   undo(TaskManager& manager)
+// Desc:   Reverse the last change.
+// Param:  manager: The task manager the change was made to.
+// Return: A boolean: True if a change was reversed. If the list does not
+//         match the history any more, the history is cleared.
+bool UndoLog::undo(TaskManager& manager)
+{
+	if (!canUndo())
+		return false;
+
+	const UndoRecord& record = getRecord(numDone - 1);
+	const Node* node = nullptr;
+	bool undone = false;
+
+	switch (record.action)
+	{
+		case UNDO_ACTIONS::ADD_TASK:
+			undone = removeTask(manager, record);
+			break;
+
+		case UNDO_ACTIONS::REMOVE_TASK:
+			undone = restoreTask(manager, record);
+			break;
+
+		case UNDO_ACTIONS::COMPLETE_TASK:
+			node = manager.findTask(record.dueSerial, record.sequence);
+			undone = node != nullptr;
+
+			if (node && record.occurrenceSerial < 0)
+				manager.uncompleteTask(node);
+			else if (node)
+				manager.uncompleteOccurrence(node, record.occurrenceSerial);
+			break;
+
+		default:
+			break;
+	}
+
+	if (!undone)
+	{
+		clear();
+		return false;
+	}
+
+	numDone--;
+
+	return true;
+}
+
+// Name:   redo(TaskManager& manager)
+// Desc:   Apply the last undone change again.
+// Param:  manager: The task manager the change was undone in.
+// Return: A boolean: True if a change was applied. If the list does not
+//         match the history any more, the history is cleared.
+bool UndoLog::redo(TaskManager& manager)
+{
+	if (!canRedo())
+		return false;
+
+	const UndoRecord& record = getRecord(numDone);
+	const Node* node = nullptr;
+	bool redone = false;
+
+	switch (record.action)
+	{
+		case UNDO_ACTIONS::ADD_TASK:
+			redone = restoreTask(manager, record);
+			break;
+
+		case UNDO_ACTIONS::REMOVE_TASK:
+			redone = removeTask(manager, record);
+			break;
+
+		case UNDO_ACTIONS::COMPLETE_TASK:
+			node = manager.findTask(record.dueSerial, record.sequence);
+			redone = node != nullptr;
+
+			if (node && record.occurrenceSerial < 0)
+				manager.completeTask(node);
+			else if (node)
+				manager.completeOccurrence(node, record.occurrenceSerial);
+			break;
+
+		default:
+			break;
+	}
+
+	if (!redone)
+	{
+		clear();
+		return false;
+	}
+
+	numDone++;
+
+	return true;
+}
+
+// Name:   getRecord(size_t recordNum)
+// Desc:   Retrieve a record by its position from the oldest change.
+// Param:  recordNum: The position of the record.
+// Return: A reference to the record in the ring buffer.
+UndoRecord& UndoLog::getRecord(size_t recordNum)
+{
+	return records[(first + recordNum) % records.size()];
+}
+
+// Name:   getRecord(size_t recordNum)
+// Desc:   Retrieve a record by its position from the oldest change.
+// Param:  recordNum: The position of the record.
+// Return: A constant reference to the record in the ring buffer.
+const UndoRecord& UndoLog::getRecord(size_t recordNum) const
+{
+	return records[(first + recordNum) % records.size()];
+}
+
+// Name:   push(UndoRecord& record, const Node* node)
+// Desc:   Add a change to the history. The undone changes can not be
+//         redone after a new change, and the oldest changes are dropped
+//         until the new one fits.
+// Param:  record: The change, its line is moved into the history.
+//         node: The node of the task that is changed, used to find it
+//         and the task before it again.
+// Return: None
+void UndoLog::push(UndoRecord& record, const Node* node)
+{
+	record.sequence = node->sequence;
+	record.dueSerial = node->task.getDueSerial();
+	record.hasPrev = node->prev != nullptr;
+	record.prevSequence = node->prev ? node->prev->sequence : 0;
+	record.prevSerial = node->prev ? node->prev->task.getDueSerial() : -1;
+
+	while (numRecords > numDone)
+	{
+		release(getRecord(numRecords - 1));
+		numRecords--;
+	}
+
+	// A quarter of the memory goes to the ring buffer, the rest to the lines
+	if (records.empty())
+		records.resize(std::max<size_t>(16, memoryLimit / 4 / sizeof(UndoRecord)));
+
+	const size_t ringBytes = records.size() * sizeof(UndoRecord);
+	const size_t lineLimit = memoryLimit > ringBytes ? memoryLimit - ringBytes : 0;
+
+	if (record.line.capacity() > lineLimit)
+	{
+		clear();
+		return;
+	}
+
+	while (numRecords == records.size() || lineBytes + record.line.capacity() > lineLimit)
+		dropOldest();
+
+	lineBytes += record.line.capacity();
+	getRecord(numRecords) = std::move(record);
+	numRecords++;
+	numDone = numRecords;
+}
+
+// Name:   dropOldest()
+// Desc:   Forget the oldest change.
+// Param:  None
+// Return: None
+void UndoLog::dropOldest()
+{
+	release(getRecord(0));
+	first = (first + 1) % records.size();
+	numRecords--;
+	numDone--;
+}
+
+// Name:   release(UndoRecord& record)
+// Desc:   Free the line a record holds.
+// Param:  record: The record to empty.
+// Return: None
+void UndoLog::release(UndoRecord& record)
+{
+	lineBytes -= record.line.capacity();
+	std::string().swap(record.line);
+}
+
+// Name:   removeTask(TaskManager& manager, const UndoRecord& record)
+// Desc:   Remove the task a record is about.
+// Param:  manager: The task manager that holds the task.
+//         record: The change that names the task.
+// Return: A boolean: True if the task was found and removed.
+bool UndoLog::removeTask(TaskManager& manager, const UndoRecord& record)
+{
+	const Node* node = manager.findTask(record.dueSerial, record.sequence);
+
+	return node && manager.deleteTask(node);
+}
+
+// Name:   restoreTask(TaskManager& manager, const UndoRecord& record)
+// Desc:   Put the task a record holds back after the task that was
+//         before it.
+// Param:  manager: The task manager to restore the task in.
+//         record: The change that holds the task.
+// Return: A boolean: True if the task was restored.
+bool UndoLog::restoreTask(TaskManager& manager, const UndoRecord& record)
+{
+	const Node* prev = nullptr;
+	TaskRecord task;
+
+	if (record.hasPrev)
+	{
+		prev = manager.findTask(record.prevSerial, record.prevSequence);
+		if (!prev)
+			return false;
+	}
+
+	if (!TaskManager::parseTaskLine(record.line, task, record.nameLength))
+		return false;
+
+	manager.restoreTask(task, record.sequence, prev);
+
+	return true;
+}
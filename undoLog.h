@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "taskManager.h"
+
+/*****************************************************************************
+# Description: An enum of the changes that can be undone.
+               The UndoRecord structure is one change and what it takes
+			   to reverse it: a task is found again by its due date and
+			   insertion sequence, a removed task is kept as its file line.
+			   The UndoLog class keeps the changes in a ring buffer that
+			   drops the oldest changes to stay under a memory limit. Undo
+			   and redo each apply one record, so their cost does not grow
+			   with the history or copy the list.
+#****************************************************************************/
+
+enum UNDO_ACTIONS { ADD_TASK, REMOVE_TASK, COMPLETE_TASK };
+
+struct UndoRecord
+{
+	UNDO_ACTIONS action;
+	unsigned int sequence;
+	int dueSerial;
+	int occurrenceSerial;
+	bool hasPrev;
+	unsigned int prevSequence;
+	int prevSerial;
+	size_t nameLength;
+	std::string line;
+};
+
+class UndoLog
+{
+public:
+	static const size_t defaultMemoryLimit = 1 << 20;
+
+	static const char* getActionName(UNDO_ACTIONS action);
+
+	UndoLog(size_t memoryLimit = defaultMemoryLimit);
+	UndoLog(const UndoLog& origLog) = delete;
+	const UndoLog& operator=(const UndoLog& origLog) = delete;
+
+	void clear();
+	void setMemoryLimit(size_t memoryLimit);
+	size_t getMemoryUsed() const;
+
+	void recordAdd(const Node* node);
+	void recordRemove(const Node* node);
+	void recordComplete(const Node* node, int serial = -1);
+
+	bool canUndo() const;
+	bool canRedo() const;
+	UNDO_ACTIONS getUndoAction() const;
+	UNDO_ACTIONS getRedoAction() const;
+	bool undo(TaskManager& manager);
+	bool redo(TaskManager& manager);
+
+private:
+	UndoRecord& getRecord(size_t recordNum);
+	const UndoRecord& getRecord(size_t recordNum) const;
+	void push(UndoRecord& record, const Node* node);
+	void dropOldest();
+	void release(UndoRecord& record);
+	bool removeTask(TaskManager& manager, const UndoRecord& record);
+	bool restoreTask(TaskManager& manager, const UndoRecord& record);
+
+	std::vector<UndoRecord> records;
+	size_t first;
+	size_t numRecords;
+	size_t numDone;
+	size_t lineBytes;
+	size_t memoryLimit;
+};
@@ -0,0 +1,468 @@
+#include "workload.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+// Name:   getDefaultProfile()
+// Desc:   Retrieve the profile used when no option changes it: names of 8
+//         to 40 characters, due dates spread evenly over two years from
+//         1/1/2024, 40% completed, and a trace that mostly displays and
+//         edits with an occasional save and load.
+// Param:  None
+// Return: The default profile.
+WorkloadProfile Workload::getDefaultProfile()
+{
+	WorkloadProfile profile;
+
+	profile.minNameLength = 8;
+	profile.maxNameLength = 40;
+	profile.startSerial = Date(1, 1, 2024).getSerial();
+	profile.numDays = 730;
+	profile.dates = DATE_DISTRIBUTIONS::UNIFORM_DATES;
+	profile.completedShare = 0.4;
+	profile.completion = COMPLETION_DISTRIBUTIONS::RANDOM_COMPLETION;
+	profile.opWeights[TRACE_OPS::OP_ADD] = 30;
+	profile.opWeights[TRACE_OPS::OP_COMPLETE] = 20;
+	profile.opWeights[TRACE_OPS::OP_DELETE] = 10;
+	profile.opWeights[TRACE_OPS::OP_DISPLAY] = 38;
+	profile.opWeights[TRACE_OPS::OP_SAVE] = 1;
+	profile.opWeights[TRACE_OPS::OP_LOAD] = 1;
+	profile.pageSize = 20;
+	profile.seed = 1;
+
+	return profile;
+}
+
+// Name:   getDatesName(DATE_DISTRIBUTIONS dates)
+// Desc:   Retrieve the name of a due date spread as it is typed on the
+//         command line.
+// Param:  dates: The spread to name.
+// Return: A constant string with the name of the spread.
+const char* Workload::getDatesName(DATE_DISTRIBUTIONS dates)
+{
+	switch (dates)
+	{
+		case DATE_DISTRIBUTIONS::UNIFORM_DATES:
+			return "uniform";
+		case DATE_DISTRIBUTIONS::NORMAL_DATES:
+			return "normal";
+		case DATE_DISTRIBUTIONS::SOON_DATES:
+			return "soon";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   getDatesFromName(const string& name, DATE_DISTRIBUTIONS& dates)
+// Desc:   Find the due date spread with a name.
+// Param:  name: The name of the spread.
+//         dates: Receives the spread.
+// Return: A boolean: True if there is a spread with the name.
+bool Workload::getDatesFromName(const std::string& name, DATE_DISTRIBUTIONS& dates)
+{
+	for (int currDates = 0; currDates < DATE_DISTRIBUTIONS::NUM_DATE_DISTRIBUTIONS; currDates++)
+	{
+		if (name == getDatesName((DATE_DISTRIBUTIONS)currDates))
+		{
+			dates = (DATE_DISTRIBUTIONS)currDates;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Name:   getCompletionName(COMPLETION_DISTRIBUTIONS completion)
+// Desc:   Retrieve the name of a completion spread as it is typed on the
+//         command line.
+// Param:  completion: The spread to name.
+// Return: A constant string with the name of the spread.
+const char* Workload::getCompletionName(COMPLETION_DISTRIBUTIONS completion)
+{
+	switch (completion)
+	{
+		case COMPLETION_DISTRIBUTIONS::RANDOM_COMPLETION:
+			return "random";
+		case COMPLETION_DISTRIBUTIONS::EARLY_COMPLETION:
+			return "early";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   getCompletionFromName(const string& name, COMPLETION_DISTRIBUTIONS& completion)
+// Desc:   Find the completion spread with a name.
+// Param:  name: The name of the spread.
+//         completion: Receives the spread.
+// Return: A boolean: True if there is a spread with the name.
+bool Workload::getCompletionFromName(const std::string& name, COMPLETION_DISTRIBUTIONS& completion)
+{
+	for (int currCompletion = 0; currCompletion < COMPLETION_DISTRIBUTIONS::NUM_COMPLETION_DISTRIBUTIONS; currCompletion++)
+	{
+		if (name == getCompletionName((COMPLETION_DISTRIBUTIONS)currCompletion))
+		{
+			completion = (COMPLETION_DISTRIBUTIONS)currCompletion;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Name:   getOpName(TRACE_OPS op)
+// Desc:   Retrieve the name of an operation as it is written in a trace.
+// Param:  op: The operation to name.
+// Return: A constant string with the name of the operation.
+const char* Workload::getOpName(TRACE_OPS op)
+{
+	switch (op)
+	{
+		case TRACE_OPS::OP_ADD:
+			return "add";
+		case TRACE_OPS::OP_COMPLETE:
+			return "complete";
+		case TRACE_OPS::OP_DELETE:
+			return "delete";
+		case TRACE_OPS::OP_DISPLAY:
+			return "display";
+		case TRACE_OPS::OP_SAVE:
+			return "save";
+		case TRACE_OPS::OP_LOAD:
+			return "load";
+		default:
+			return "unknown";
+	}
+}
+
+// Name:   getOpFromName(const string& name, TRACE_OPS& op)
+// Desc:   Find the operation with a name.
+// Param:  name: The name of the operation.
+//         op: Receives the operation.
+// Return: A boolean: True if there is an operation with the name.
+bool Workload::getOpFromName(const std::string& name, TRACE_OPS& op)
+{
+	for (int currOp = 0; currOp < TRACE_OPS::NUM_TRACE_OPS; currOp++)
+	{
+		if (name == getOpName((TRACE_OPS)currOp))
+		{
+			op = (TRACE_OPS)currOp;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Name:   parseMix(const string& mix, WorkloadProfile& profile)
+// Desc:   Set the weights of the operations from text such as
+//         add=40,display=50,save=1. Operations that are not named keep
+//         their weight.
+// Param:  mix: The comma separated name=weight pairs.
+//         profile: The profile whose weights are set.
+// Return: A boolean: False if a pair is malformed or every weight is 0.
+bool Workload::parseMix(const std::string& mix, WorkloadProfile& profile)
+{
+	std::istringstream fields(mix);
+	std::string field;
+	int total = 0;
+
+	while (std::getline(fields, field, ','))
+	{
+		const size_t equals = field.find('=');
+		TRACE_OPS op = TRACE_OPS::OP_ADD;
+
+		if (equals == std::string::npos || !getOpFromName(field.substr(0, equals), op))
+			return false;
+
+		const int weight = atoi(field.c_str() + equals + 1);
+
+		if (weight < 0)
+			return false;
+
+		profile.opWeights[op] = weight;
+	}
+
+	for (int weight : profile.opWeights)
+		total += weight;
+
+	return total > 0;
+}
+
+// Name:   formatOp(const TraceOp& op)
+// Desc:   Convert an operation to a line of a trace: its name followed by
+//         the due date as mm/dd/yyyy and the name of a task to add, the
+//         pick of a task to complete or delete, or the view and the
+//         number of tasks to display.
+// Param:  op: The operation.
+// Return: A string with the line, without the newline.
+std::string Workload::formatOp(const TraceOp& op)
+{
+	std::string line = getOpName(op.op);
+
+	switch (op.op)
+	{
+		case TRACE_OPS::OP_ADD:
+		{
+			const Date dueDate = Date::fromSerial(op.serial);
+			char dateText[32];
+
+			snprintf(dateText, sizeof(dateText), "%02d/%02d/%04d", dueDate.getMonth(), dueDate.getDay(), dueDate.getYear());
+			line += "\t" + std::string(dateText) + "\t" + op.name;
+			break;
+		}
+
+		case TRACE_OPS::OP_COMPLETE:
+		case TRACE_OPS::OP_DELETE:
+			line += "\t" + std::to_string(op.pick);
+			break;
+
+		case TRACE_OPS::OP_DISPLAY:
+			line += "\t" + std::to_string(op.view) + "\t" + std::to_string(op.count);
+			break;
+
+		default:
+			break;
+	}
+
+	return line;
+}
+
+// Name:   parseOp(const string& line, TraceOp& op)
+// Desc:   Read an operation from a line of a trace.
+// Param:  line: The line, without the newline.
+//         op: Receives the operation.
+// Return: A boolean: False if the line is not an operation.
+bool Workload::parseOp(const std::string& line, TraceOp& op)
+{
+	std::vector<std::string> fields;
+	size_t start = 0;
+
+	// The name of a task is the last field, so it is kept whole
+	while (fields.size() < 2)
+	{
+		const size_t tab = line.find('\t', start);
+
+		if (tab == std::string::npos)
+			break;
+
+		fields.push_back(line.substr(start, tab - start));
+		start = tab + 1;
+	}
+	fields.push_back(line.substr(start));
+
+	if (!getOpFromName(fields[0], op.op))
+		return false;
+
+	op.pick = 0;
+	op.serial = 0;
+	op.view = 0;
+	op.count = 0;
+	op.name.clear();
+
+	switch (op.op)
+	{
+		case TRACE_OPS::OP_ADD:
+		{
+			int month = 0;
+			int day = 0;
+			int year = 0;
+			char extra = 0;
+
+			// Read directly, a long trace would spend its parsing in the regular expressions of validateDate()
+			if (fields.size() != 3 || fields[2].empty() || sscanf(fields[1].c_str(), "%d/%d/%d%c", &month, &day, &year, &extra) != 3)
+				return false;
+
+			if (!Date::isValidDate(month, day, year))
+				return false;
+
+			op.serial = Date(month, day, year).getSerial();
+			op.name = fields[2];
+			return true;
+		}
+
+		case TRACE_OPS::OP_COMPLETE:
+		case TRACE_OPS::OP_DELETE:
+			if (fields.size() != 2)
+				return false;
+
+			op.pick = (uint32_t)strtoul(fields[1].c_str(), nullptr, 10);
+			return true;
+
+		case TRACE_OPS::OP_DISPLAY:
+			if (fields.size() != 3)
+				return false;
+
+			op.view = atoi(fields[1].c_str());
+			op.count = atoi(fields[2].c_str());
+			return op.view >= 0 && op.view < VIEWS::NUM_VIEWS && op.count > 0;
+
+		default:
+			return fields.size() == 1;
+	}
+}
+
+// Name:   Workload(const WorkloadProfile& profile)
+// Desc:   Constructor that seeds the generator from a profile.
+// Param:  profile: The shape of the lists and traces to make.
+// Return: None
+Workload::Workload(const WorkloadProfile& profile)
+	: profile(profile), random(profile.seed), ops(profile.opWeights, profile.opWeights + TRACE_OPS::NUM_TRACE_OPS)
+{
+	this->profile.minNameLength = std::max(1, profile.minNameLength);
+	this->profile.maxNameLength = std::max(this->profile.minNameLength, profile.maxNameLength);
+	this->profile.numDays = std::max(1, profile.numDays);
+}
+
+// Name:   fillTasks(TaskManager& manager, uint64_t numTasks)
+// Desc:   Replace the tasks of a task manager with a generated list.
+// Param:  manager: The task manager to fill.
+//         numTasks: The number of tasks to make.
+// Return: None
+void Workload::fillTasks(TaskManager& manager, uint64_t numTasks)
+{
+	TaskRecord record{};
+
+	manager.emptyTasks();
+
+	for (uint64_t i = 0; i < numTasks; i++)
+	{
+		const int serial = makeSerial();
+
+		record.name = makeName();
+		record.dueDate = Date::fromSerial(serial);
+		record.completed = makeCompleted(serial);
+		manager.addTask(record);
+	}
+}
+
+// Name:   makeOp()
+// Desc:   Make the next operation of a trace, picked by the weights of
+//         the profile. Added tasks are shaped like the generated lists.
+// Param:  None
+// Return: The operation.
+TraceOp Workload::makeOp()
+{
+	TraceOp op{};
+
+	op.op = (TRACE_OPS)ops(random);
+
+	switch (op.op)
+	{
+		case TRACE_OPS::OP_ADD:
+			op.serial = makeSerial();
+			op.name = makeName();
+			break;
+
+		case TRACE_OPS::OP_COMPLETE:
+		case TRACE_OPS::OP_DELETE:
+			op.pick = (uint32_t)random();
+			break;
+
+		case TRACE_OPS::OP_DISPLAY:
+			op.view = random() % VIEWS::NUM_VIEWS;
+			op.count = std::max(1, profile.pageSize);
+			break;
+
+		default:
+			break;
+	}
+
+	return op;
+}
+
+// Name:   writeTrace(const string& fileName, uint64_t numOps)
+// Desc:   Write a trace of generated operations to a file.
+// Param:  fileName: The name of the trace file.
+//         numOps: The number of operations.
+// Return: A boolean: True if the trace was written.
+bool Workload::writeTrace(const std::string& fileName, uint64_t numOps)
+{
+	std::ofstream file(fileName);
+
+	if (!file)
+		return false;
+
+	for (uint64_t i = 0; i < numOps; i++)
+		file << formatOp(makeOp()) << '\n';
+
+	file.close();
+
+	return !file.fail();
+}
+
+// Name:   makeName()
+// Desc:   Make a task name of words from a small vocabulary followed by a
+//         number, cut to a length drawn evenly from the range of the
+//         profile, so names repeat their words like a real list.
+// Param:  None
+// Return: A string with the name.
+std::string Workload::makeName()
+{
+	static const char* words[] = { "Report", "review", "deploy", "backup", "invoice", "sync", "audit", "meeting",
+		"cleanup", "release", "budget", "client", "server", "draft", "plan", "call", "update", "fix", "test", "notes" };
+	const int numWords = sizeof(words) / sizeof(words[0]);
+	const int length = profile.minNameLength + (int)(random() % (profile.maxNameLength - profile.minNameLength + 1));
+	std::string name;
+
+	while ((int)name.size() < length)
+	{
+		if (!name.empty())
+			name += ' ';
+
+		name += random() % 4 ? words[random() % numWords] : std::to_string(random() % 10000);
+	}
+
+	name.resize(length);
+
+	// A cut can leave a space at the end, which the text format would not keep
+	if (name.back() == ' ')
+		name.pop_back();
+
+	return name;
+}
+
+// Name:   makeSerial()
+// Desc:   Make a due date in the range of the profile: spread evenly,
+//         around the middle of the range, or mostly in its first days.
+// Param:  None
+// Return: The serial day number of the due date.
+int Workload::makeSerial()
+{
+	const double numDays = profile.numDays;
+	double offset = 0;
+
+	switch (profile.dates)
+	{
+		case DATE_DISTRIBUTIONS::NORMAL_DATES:
+			offset = std::normal_distribution<double>(numDays / 2, numDays / 6)(random);
+			break;
+
+		case DATE_DISTRIBUTIONS::SOON_DATES:
+			offset = std::exponential_distribution<double>(5 / numDays)(random);
+			break;
+
+		default:
+			offset = std::uniform_real_distribution<double>(0, numDays)(random);
+			break;
+	}
+
+	return profile.startSerial + (int)std::min(numDays - 1, std::max(0.0, offset));
+}
+
+// Name:   makeCompleted(int serial)
+// Desc:   Decide if a task is completed. Either every task has the same
+//         chance, or the chance falls from twice the share at the start
+//         of the range to 0 at its end, so old tasks are mostly done.
+// Param:  serial: The serial day number of the task's due date.
+// Return: A boolean: True if the task is completed.
+bool Workload::makeCompleted(int serial)
+{
+	double chance = profile.completedShare;
+
+	if (profile.completion == COMPLETION_DISTRIBUTIONS::EARLY_COMPLETION)
+		chance *= 2 * (1 - (double)(serial - profile.startSerial) / profile.numDays);
+
+	return std::uniform_real_distribution<double>(0, 1)(random) < chance;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <random>
+#include <cstdint>
+#include "taskManager.h"
+
+/*****************************************************************************
+# Description: Enums of the ways the due dates and the completed tasks of a
+               generated list can be spread, and of the operations a trace
+			   is made of.
+			   The WorkloadProfile structure holds the shape of a generated
+			   list and the mix of a trace: the range of name lengths, the
+			   range and spread of due dates, the share of completed tasks,
+			   a weight per operation and the seed.
+			   The TraceOp structure is one operation of a trace.
+			   The Workload class makes task lists and operation traces
+			   from a profile, the same ones for the same seed. A trace is
+			   a text file with one operation per line, its fields split
+			   by tabs. A task to complete or delete is picked by a random
+			   number the replay reduces by the number of tasks it holds,
+			   so a trace runs against any list.
+#****************************************************************************/
+
+enum DATE_DISTRIBUTIONS { UNIFORM_DATES, NORMAL_DATES, SOON_DATES, NUM_DATE_DISTRIBUTIONS };
+enum COMPLETION_DISTRIBUTIONS { RANDOM_COMPLETION, EARLY_COMPLETION, NUM_COMPLETION_DISTRIBUTIONS };
+enum TRACE_OPS { OP_ADD, OP_COMPLETE, OP_DELETE, OP_DISPLAY, OP_SAVE, OP_LOAD, NUM_TRACE_OPS };
+
+struct WorkloadProfile
+{
+	int minNameLength;
+	int maxNameLength;
+	int startSerial;
+	int numDays;
+	DATE_DISTRIBUTIONS dates;
+	double completedShare;
+	COMPLETION_DISTRIBUTIONS completion;
+	int opWeights[NUM_TRACE_OPS];
+	int pageSize;
+	unsigned int seed;
+};
+
+struct TraceOp
+{
+	TRACE_OPS op;
+	uint32_t pick;
+	int serial;
+	int view;
+	int count;
+	std::string name;
+};
+
+class Workload
+{
+public:
+	static WorkloadProfile getDefaultProfile();
+	static const char* getDatesName(DATE_DISTRIBUTIONS dates);
+	static bool getDatesFromName(const std::string& name, DATE_DISTRIBUTIONS& dates);
+	static const char* getCompletionName(COMPLETION_DISTRIBUTIONS completion);
+	static bool getCompletionFromName(const std::string& name, COMPLETION_DISTRIBUTIONS& completion);
+	static const char* getOpName(TRACE_OPS op);
+	static bool getOpFromName(const std::string& name, TRACE_OPS& op);
+	static bool parseMix(const std::string& mix, WorkloadProfile& profile);
+	static std::string formatOp(const TraceOp& op);
+	static bool parseOp(const std::string& line, TraceOp& op);
+
+	Workload(const WorkloadProfile& profile);
+
+	void fillTasks(TaskManager& manager, uint64_t numTasks);
+	TraceOp makeOp();
+	bool writeTrace(const std::string& fileName, uint64_t numOps);
+
+private:
+	std::string makeName();
+	int makeSerial();
+	bool makeCompleted(int serial);
+
+	WorkloadProfile profile;
+	std::mt19937_64 random;
+	std::discrete_distribution<int> ops;
+};
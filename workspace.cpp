@@ -0,0 +1,307 @@
+#include "workspace.h"
+#include <algorithm>
+
+// Name:   MergedIterator(const vector<unique_ptr<WorkspaceFile>>& files, VIEWS view, bool incompleteOnly)
+// Desc:   Constructor that starts a merge of the same view of every file.
+//         The next task is picked from a heap holding one position per file.
+// Param:  files: The files of the workspace.
+//         view: The view to merge.
+//         incompleteOnly: A boolean to skip completed tasks. This is cheapest
+//                         with the incomplete first view, where each file
+//                         stops at its first completed task.
+// Return: None
+MergedIterator::MergedIterator(const std::vector<std::unique_ptr<WorkspaceFile>>& files, VIEWS view, bool incompleteOnly)
+	: order{ view }, incompleteOnly(incompleteOnly)
+{
+	for (size_t fileNum = 0; fileNum < files.size(); fileNum++)
+	{
+		const TaskManager& manager = files[fileNum]->manager;
+		Stream stream = { manager.viewBegin(view), manager.viewEnd(view), (int)fileNum };
+
+		while (incompleteOnly && stream.position != stream.end && (*stream.position)->task.getCompleted() && view != VIEWS::INCOMPLETE_FIRST)
+			++stream.position;
+
+		if (!isFinished(stream))
+			heap.push_back(stream);
+	}
+
+	std::make_heap(heap.begin(), heap.end(), [this](const Stream& left, const Stream& right) { return isAfter(left, right); });
+}
+
+// Name:   isValid()
+// Desc:   Check if the iterator is at a task.
+// Param:  None
+// Return: A boolean: True if there is a task.
+bool MergedIterator::isValid() const
+{
+	return !heap.empty();
+}
+
+// Name:   operator*()
+// Desc:   Retrieve the task the iterator is at.
+// Param:  None
+// Return: The task and the number of the file it belongs to.
+WorkspaceTask MergedIterator::operator*() const
+{
+	return { *heap.front().position, heap.front().fileNum };
+}
+
+// Name:   operator++()
+// Desc:   Move to the next task across all files.
+// Param:  None
+// Return: A reference to this iterator.
+MergedIterator& MergedIterator::operator++()
+{
+	auto after = [this](const Stream& left, const Stream& right) { return isAfter(left, right); };
+
+	std::pop_heap(heap.begin(), heap.end(), after);
+	Stream& stream = heap.back();
+
+	do
+	{
+		++stream.position;
+	} while (incompleteOnly && stream.position != stream.end && (*stream.position)->task.getCompleted() && order.view != VIEWS::INCOMPLETE_FIRST);
+
+	if (isFinished(stream))
+		heap.pop_back();
+	else
+		std::push_heap(heap.begin(), heap.end(), after);
+
+	return *this;
+}
+
+// Name:   isFinished(const Stream& stream)
+// Desc:   Check if a file has no more tasks to merge.
+// Param:  stream: The position in the file's view.
+// Return: A boolean: True if the file has no more tasks.
+bool MergedIterator::isFinished(const Stream& stream) const
+{
+	if (!(stream.position != stream.end))
+		return true;
+
+	return incompleteOnly && (*stream.position)->task.getCompleted();
+}
+
+// Name:   isAfter(const Stream& left, const Stream& right)
+// Desc:   Heap order: check if the next task of left comes after the
+//         next task of right. Ties between files go to the lower file number.
+// Param:  left: The first file position.
+//         right: The second file position.
+// Return: A boolean: True if left's task comes after right's task.
+bool MergedIterator::isAfter(const Stream& left, const Stream& right) const
+{
+	if (order(*right.position, *left.position))
+		return true;
+	if (order(*left.position, *right.position))
+		return false;
+
+	return left.fileNum > right.fileNum;
+}
+
+// Name:   Workspace(int numThreads)
+// Desc:   Constructor that starts the thread pool used for file operations.
+// Param:  numThreads: The number of threads to load and save with.
+// Return: None
+Workspace::Workspace(int numThreads)
+	: pool(numThreads)
+{
+}
+
+// Name:   openFiles(const vector<string>& fileNames)
+// Desc:   Load task files into the workspace at the same time. Files that
+//         are already open are skipped.
+// Param:  fileNames: The names of the files to open.
+// Return: The number of files that were loaded.
+int Workspace::openFiles(const std::vector<std::string>& fileNames)
+{
+	std::vector<std::unique_ptr<WorkspaceFile>> newFiles;
+	std::vector<std::future<bool>> results;
+
+	for (const std::string& fileName : fileNames)
+	{
+		bool alreadyOpen = false;
+
+		for (const std::unique_ptr<WorkspaceFile>& file : files)
+			alreadyOpen = alreadyOpen || file->fileName == fileName;
+
+		for (const std::unique_ptr<WorkspaceFile>& file : newFiles)
+			alreadyOpen = alreadyOpen || file->fileName == fileName;
+
+		if (alreadyOpen)
+			continue;
+
+		newFiles.emplace_back(new WorkspaceFile{ fileName, TaskManager(), false });
+	}
+
+	// Each job only touches its own TaskManager
+	for (std::unique_ptr<WorkspaceFile>& file : newFiles)
+	{
+		WorkspaceFile* loadFile = file.get();
+		results.push_back(pool.submit([loadFile]() {
+			return loadFile->manager.checkFileExists(loadFile->fileName) && loadFile->manager.loadFromFile(loadFile->fileName);
+		}));
+	}
+
+	int numLoaded = 0;
+
+	for (size_t i = 0; i < newFiles.size(); i++)
+	{
+		if (results[i].get())
+		{
+			files.push_back(std::move(newFiles[i]));
+			numLoaded++;
+		}
+	}
+
+	return numLoaded;
+}
+
+// Name:   saveModified()
+// Desc:   Save every modified file back to where it was loaded from, at
+//         the same time. Files that were not changed are not written.
+// Param:  None
+// Return: The number of files that were saved.
+int Workspace::saveModified()
+{
+	std::vector<std::pair<WorkspaceFile*, std::future<bool>>> results;
+
+	for (std::unique_ptr<WorkspaceFile>& file : files)
+	{
+		if (!file->modified)
+			continue;
+
+		WorkspaceFile* saveFile = file.get();
+		results.emplace_back(saveFile, pool.submit([saveFile]() {
+			return saveFile->manager.saveToFile(saveFile->fileName);
+		}));
+	}
+
+	int numSaved = 0;
+
+	for (std::pair<WorkspaceFile*, std::future<bool>>& result : results)
+	{
+		if (result.second.get())
+		{
+			result.first->modified = false;
+			numSaved++;
+		}
+	}
+
+	return numSaved;
+}
+
+// Name:   closeFiles()
+// Desc:   Remove every file from the workspace without saving.
+// Param:  None
+// Return: None
+void Workspace::closeFiles()
+{
+	files.clear();
+}
+
+// Name:   getNumFiles()
+// Desc:   Retrieve the number of open files.
+// Param:  None
+// Return: The number of open files.
+int Workspace::getNumFiles() const
+{
+	return files.size();
+}
+
+// Name:   getFileName(int fileNum)
+// Desc:   Retrieve the name of an open file.
+// Param:  fileNum: The number of the file, starting at 0.
+// Return: A constant reference to the file name.
+const std::string& Workspace::getFileName(int fileNum) const
+{
+	return files[fileNum]->fileName;
+}
+
+// Name:   getManager(int fileNum)
+// Desc:   Retrieve the tasks of an open file.
+// Param:  fileNum: The number of the file, starting at 0.
+// Return: A constant reference to the file's task manager.
+const TaskManager& Workspace::getManager(int fileNum) const
+{
+	return files[fileNum]->manager;
+}
+
+// Name:   isModified(int fileNum)
+// Desc:   Check if an open file has unsaved changes.
+// Param:  fileNum: The number of the file, starting at 0.
+// Return: A boolean: True if the file was changed since it was loaded or saved.
+bool Workspace::isModified(int fileNum) const
+{
+	return files[fileNum]->modified;
+}
+
+// Name:   hasModified()
+// Desc:   Check if any open file has unsaved changes.
+// Param:  None
+// Return: A boolean: True if at least one file was changed.
+bool Workspace::hasModified() const
+{
+	for (const std::unique_ptr<WorkspaceFile>& file : files)
+	{
+		if (file->modified)
+			return true;
+	}
+
+	return false;
+}
+
+// Name:   getMerged(VIEWS view, bool incompleteOnly)
+// Desc:   Retrieve an iterator over the tasks of every file in one order.
+// Param:  view: The view to merge.
+//         incompleteOnly: A boolean to skip completed tasks.
+// Return: An iterator at the first task.
+MergedIterator Workspace::getMerged(VIEWS view, bool incompleteOnly) const
+{
+	return MergedIterator(files, view, incompleteOnly);
+}
+
+// Name:   addTask(int fileNum, const string& name, const Date& dueDate)
+// Desc:   Add a task to one of the open files.
+// Param:  fileNum: The number of the file, starting at 0.
+//         name: A string that holds the task name.
+//         dueDate: A Date object that holds the task's due date.
+// Return: A boolean: True if adding succeeds, false otherwise.
+bool Workspace::addTask(int fileNum, const std::string& name, const Date& dueDate)
+{
+	if (fileNum < 0 || fileNum >= (int)files.size())
+		return false;
+
+	files[fileNum]->modified = true;
+
+	return files[fileNum]->manager.addTask(name, dueDate);
+}
+
+// Name:   completeTask(const WorkspaceTask& task)
+// Desc:   Complete a task in the file it belongs to.
+// Param:  task: The task and the number of its file.
+// Return: None
+void Workspace::completeTask(const WorkspaceTask& task)
+{
+	if (task.fileNum < 0 || task.fileNum >= (int)files.size() || !task.node)
+		return;
+
+	files[task.fileNum]->manager.completeTask(task.node);
+	files[task.fileNum]->modified = true;
+}
+
+// Name:   deleteTask(const WorkspaceTask& task)
+// Desc:   Remove a task from the file it belongs to.
+// Param:  task: The task and the number of its file.
+// Return: A boolean: True if removing succeeds, false otherwise.
+bool Workspace::deleteTask(const WorkspaceTask& task)
+{
+	if (task.fileNum < 0 || task.fileNum >= (int)files.size())
+		return false;
+
+	if (!files[task.fileNum]->manager.deleteTask(task.node))
+		return false;
+
+	files[task.fileNum]->modified = true;
+
+	return true;
+}
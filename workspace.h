@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include "taskManager.h"
+#include "threadPool.h"
+
+/*****************************************************************************
+# Description: The Workspace class holds several task files at once. Files
+               are loaded and saved on a thread pool and each file keeps
+			   its own TaskManager, so a task is always saved back to the
+			   file it came from. The MergedIterator class walks the views
+			   of every file as one list without copying any tasks.
+#****************************************************************************/
+
+struct WorkspaceTask
+{
+	const Node* node;
+	int fileNum;
+};
+
+struct WorkspaceFile
+{
+	std::string fileName;
+	TaskManager manager;
+	bool modified;
+};
+
+class MergedIterator
+{
+public:
+	MergedIterator(const std::vector<std::unique_ptr<WorkspaceFile>>& files, VIEWS view, bool incompleteOnly);
+
+	bool isValid() const;
+	WorkspaceTask operator*() const;
+	MergedIterator& operator++();
+
+private:
+	struct Stream
+	{
+		ViewIterator position;
+		ViewIterator end;
+		int fileNum;
+	};
+
+	bool isFinished(const Stream& stream) const;
+	bool isAfter(const Stream& left, const Stream& right) const;
+
+	std::vector<Stream> heap;
+	NodeOrder order;
+	bool incompleteOnly;
+};
+
+class Workspace
+{
+public:
+	Workspace(int numThreads = ThreadPool::getDefaultThreadCount());
+
+	int openFiles(const std::vector<std::string>& fileNames);
+	int saveModified();
+	void closeFiles();
+
+	int getNumFiles() const;
+	const std::string& getFileName(int fileNum) const;
+	const TaskManager& getManager(int fileNum) const;
+	bool isModified(int fileNum) const;
+	bool hasModified() const;
+	MergedIterator getMerged(VIEWS view, bool incompleteOnly = false) const;
+
+	bool addTask(int fileNum, const std::string& name, const Date& dueDate);
+	void completeTask(const WorkspaceTask& task);
+	bool deleteTask(const WorkspaceTask& task);
+
+private:
+	std::vector<std::unique_ptr<WorkspaceFile>> files;
+	ThreadPool pool;
+};